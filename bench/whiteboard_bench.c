@@ -0,0 +1,638 @@
+/*
+
+  Copyright (c) 2009, Nokia Corporation
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.  
+    * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in
+    the documentation and/or other materials provided with the
+    distribution.  
+    * Neither the name of Nokia nor the names of its contributors 
+    may be used to endorse or promote products derived from this 
+    software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+  EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+/*
+ * Whiteboard Library
+ *
+ * whiteboard_bench.c
+ *
+ * Microbenchmarks for the M3 XML generators and parsers and the SSAP
+ * message functions. Every benchmark is run over synthetic corpora of
+ * varying triple counts, literal sizes and namespace map sizes. The corpora
+ * are generated deterministically, so numbers from different builds can be
+ * compared directly.
+ *
+ * Copyright 2009 Nokia Corporation
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <glib.h>
+
+#include "sibdefs.h"
+#include "sibmsg.h"
+#include "m3_sib_tokens.h"
+#include "whiteboard_node.h"
+
+#define BENCH_SPACE_ID ((ssElement_ct)"X")
+#define BENCH_NODE_ID ((ssElement_ct)"bench-node")
+#define BENCH_NS_URI "http://example.org/bench/ns%u#"
+#define BENCH_BASE_URI "http://example.org/bench/"
+#define BENCH_PREDICATES 8
+
+/* Counted by the GLib allocator hooks, see bench_malloc() */
+static gulong bench_allocs = 0;
+static gboolean bench_allocs_counted = FALSE;
+
+static gchar *opt_triples = "1,10,100,1000";
+static gchar *opt_literal_sizes = "16,1024";
+static gchar *opt_namespaces = "0,16";
+static gint opt_min_time = 200;
+static gchar *opt_filter = NULL;
+
+static GOptionEntry bench_options[] =
+{
+  { "triples", 't', 0, G_OPTION_ARG_STRING, &opt_triples,
+    "Comma separated triple counts (default 1,10,100,1000)", "LIST" },
+  { "literal-sizes", 'l', 0, G_OPTION_ARG_STRING, &opt_literal_sizes,
+    "Comma separated literal sizes in bytes (default 16,1024)", "LIST" },
+  { "namespaces", 'n', 0, G_OPTION_ARG_STRING, &opt_namespaces,
+    "Comma separated namespace map sizes (default 0,16)", "LIST" },
+  { "min-time", 'm', 0, G_OPTION_ARG_INT, &opt_min_time,
+    "Minimum run time of each case in milliseconds (default 200)", "MS" },
+  { "filter", 'f', 0, G_OPTION_ARG_STRING, &opt_filter,
+    "Run only benchmarks whose name contains STRING", "STRING" },
+  { NULL }
+};
+
+typedef struct _BenchCorpus
+{
+  guint triples;
+  guint literal_size;
+  guint namespaces;
+
+  GHashTable *ns_map;     // prefix -> namespace, NULL without namespaces
+  GHashTable *sparql_ns;  // as ns_map, but never NULL
+  ssNsTrie_t *ns_trie;    // built from ns_map, as the node caches it
+  GSList *triple_list;    // ssTriple_t, prefixed URIs when namespaces are used
+  GSList *sparql_select;  // ssPathNode_t
+  GSList *sparql_where;   // sparqlTriple_t
+
+  gchar *triple_xml;      // triple_list generated with ns_map
+  gchar *wql_xml;         // node_list of as many nodes as triples
+  gchar *sparql_xml;      // SPARQL select results of as many rows as triples
+  gchar *insert_msg;      // SSAP insert request carrying triple_xml
+  gchar *query_rsp;       // SSAP query confirmation carrying triple_xml
+} BenchCorpus;
+
+/* Runs one operation over the corpus, bd is an empty buffer kept between
+   runs. Returns the number of bytes generated or parsed, 0 on failure. */
+typedef gsize (*BenchFunc)(BenchCorpus *c, ssBufDesc_t *bd);
+
+typedef struct _Bench
+{
+  const gchar *name;
+  BenchFunc func;
+} Bench;
+
+static gpointer bench_malloc(gsize n)
+{
+  bench_allocs++;
+  return malloc(n);
+}
+
+static gpointer bench_realloc(gpointer mem, gsize n)
+{
+  bench_allocs++;
+  return realloc(mem, n);
+}
+
+static gpointer bench_calloc(gsize n, gsize size)
+{
+  bench_allocs++;
+  return calloc(n, size);
+}
+
+static GMemVTable bench_mem_vtable =
+{
+  bench_malloc,
+  bench_realloc,
+  free,
+  bench_calloc,
+  bench_malloc,
+  bench_realloc
+};
+
+static gint64 bench_now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (gint64)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static GArray *bench_parse_list(const gchar *list)
+{
+  GArray *values = g_array_new(FALSE, FALSE, sizeof(guint));
+  gchar **items = g_strsplit(list, ",", 0);
+  gint i;
+
+  for (i = 0; items[i]; i++)
+    {
+      guint value = (guint)strtoul(items[i], NULL, 10);
+      g_array_append_val(values, value);
+    }
+  g_strfreev(items);
+  return values;
+}
+
+/* Literal text of exactly size bytes, including characters the
+   generators have to escape */
+static gchar *bench_literal(guint size, guint seed)
+{
+  static const gchar text[] = "The quick brown fox <jumps> over the lazy dog & ";
+  gchar *lit = g_malloc(size + 1);
+  guint i;
+
+  for (i = 0; i < size; i++)
+    lit[i] = text[(i + seed) % (sizeof(text) - 1)];
+  lit[size] = 0;
+  return lit;
+}
+
+static gchar *bench_uri(BenchCorpus *c, const gchar *local, guint index)
+{
+  if (c->namespaces)
+    return g_strdup_printf("ns%u:%s%u", index % c->namespaces, local, index);
+  return g_strdup_printf(BENCH_BASE_URI "%s%u", local, index);
+}
+
+static gchar *bench_full_uri(BenchCorpus *c, const gchar *local, guint index)
+{
+  if (c->namespaces)
+    return g_strdup_printf(BENCH_NS_URI "%s%u", index % c->namespaces, local, index);
+  return g_strdup_printf(BENCH_BASE_URI "%s%u", local, index);
+}
+
+static gchar *bench_steal_message(ssBufDesc_t *bd)
+{
+  gchar *msg = g_strndup(ssBufDesc_GetMessage(bd), ssBufDesc_GetMessageLen(bd));
+
+  ssBufDesc_reset(bd);
+  return msg;
+}
+
+static BenchCorpus *bench_corpus_new(guint triples, guint literal_size, guint namespaces)
+{
+  BenchCorpus *c = g_new0(BenchCorpus, 1);
+  ssBufDesc_t *bd = ssBufDesc_new();
+  GString *xml = g_string_new("");
+  GSList *l;
+  guint i;
+
+  c->triples = triples;
+  c->literal_size = literal_size;
+  c->namespaces = namespaces;
+
+  c->sparql_ns = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+  if (namespaces)
+    c->ns_map = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+  for (i = 0; i < namespaces; i++)
+    {
+      g_hash_table_insert(c->ns_map, g_strdup_printf("ns%u", i), g_strdup_printf(BENCH_NS_URI, i));
+      g_hash_table_insert(c->sparql_ns, g_strdup_printf("ns%u", i), g_strdup_printf(BENCH_NS_URI, i));
+    }
+  if (c->ns_map)
+    c->ns_trie = ssNsTrie_new(c->ns_map);
+
+  // every other object is a literal
+  for (i = 0; i < triples; i++)
+    {
+      gchar *s = bench_uri(c, "item", i);
+      gchar *p = bench_uri(c, "prop", i % BENCH_PREDICATES);
+      gchar *o = (i & 1) ? bench_uri(c, "item", i + 1) : bench_literal(literal_size, i);
+
+      ssPrependTriple(&c->triple_list, (ssElement_ct)s, (ssElement_ct)p, (ssElement_ct)o,
+		      ssElement_TYPE_URI, (i & 1) ? ssElement_TYPE_URI : ssElement_TYPE_LIT);
+      g_free(s);
+      g_free(p);
+      g_free(o);
+    }
+
+  for (i = 0; i < 2; i++)
+    {
+      ssPathNode_t *var = g_new0(ssPathNode_t, 1);
+      var->string = (ssElement_t)g_strdup(i ? "o" : "s");
+      var->nodeType = ssElement_TYPE_BNODE;
+      c->sparql_select = g_slist_append(c->sparql_select, var);
+    }
+  for (i = 0; i < triples; i++)
+    {
+      sparqlTriple_t *t = g_new0(sparqlTriple_t, 1);
+      t->subject.string = (ssElement_t)g_strdup("s");
+      t->subject.nodeType = ssElement_TYPE_BNODE;
+      t->predicate.string = (ssElement_t)bench_uri(c, "prop", i);
+      t->predicate.nodeType = ssElement_TYPE_URI;
+      t->object.string = (ssElement_t)g_strdup("o");
+      t->object.nodeType = ssElement_TYPE_BNODE;
+      c->sparql_where = g_slist_append(c->sparql_where, t);
+    }
+
+  // parser input is generated by the generators under test where possible
+  addXML_start(bd, &SIB_TRIPLELIST, NULL, NULL, 0);
+  for (l = c->triple_list; l; l = l->next)
+    addXML_templateTriple(l->data, c->ns_map, bd);
+  addXML_end(bd, &SIB_TRIPLELIST);
+  c->triple_xml = bench_steal_message(bd);
+
+  g_string_append(xml, "<node_list>");
+  for (i = 0; i < triples; i++)
+    {
+      if (i & 1)
+	{
+	  gchar *uri = bench_full_uri(c, "item", i);
+	  g_string_append_printf(xml, "<uri>%s</uri>", uri);
+	  g_free(uri);
+	}
+      else
+	{
+	  gchar *lit = bench_literal(literal_size, i);
+	  gchar *escaped = g_markup_escape_text(lit, -1);
+	  g_string_append_printf(xml, "<literal>%s</literal>", escaped);
+	  g_free(escaped);
+	  g_free(lit);
+	}
+    }
+  g_string_append(xml, "</node_list>");
+  c->wql_xml = g_strdup(xml->str);
+
+  g_string_truncate(xml, 0);
+  g_string_append(xml, "<sparql_results><head><variable name=\"s\"/><variable name=\"o\"/></head><results>");
+  for (i = 0; i < triples; i++)
+    {
+      gchar *s = bench_full_uri(c, "item", i);
+      g_string_append_printf(xml, "<result><binding name=\"s\"><uri>%s</uri></binding>", s);
+      if (i & 1)
+	{
+	  gchar *o = bench_full_uri(c, "item", i + 1);
+	  g_string_append_printf(xml, "<binding name=\"o\"><uri>%s</uri></binding>", o);
+	  g_free(o);
+	}
+      else
+	{
+	  gchar *lit = bench_literal(literal_size, i);
+	  gchar *escaped = g_markup_escape_text(lit, -1);
+	  g_string_append_printf(xml, "<binding name=\"o\"><literal>%s</literal></binding>", escaped);
+	  g_free(escaped);
+	  g_free(lit);
+	}
+      g_string_append(xml, "</result>");
+      g_free(s);
+    }
+  g_string_append(xml, "</results></sparql_results>");
+  c->sparql_xml = g_strdup(xml->str);
+
+  ssBufDesc_CreateInsertMessage(bd, BENCH_SPACE_ID, BENCH_NODE_ID, 1, EncodingM3XML,
+				(const guchar *)c->triple_xml, TRUE);
+  c->insert_msg = bench_steal_message(bd);
+  ssBufDesc_CreateQueryResponse(bd, BENCH_NODE_ID, BENCH_SPACE_ID, 1, MSG_E_OK,
+				(const guchar *)c->triple_xml);
+  c->query_rsp = bench_steal_message(bd);
+
+  g_string_free(xml, TRUE);
+  ssBufDesc_free(&bd);
+  return c;
+}
+
+static void bench_corpus_free(BenchCorpus *c)
+{
+  GSList *l;
+
+  for (l = c->sparql_where; l; l = l->next)
+    {
+      sparqlTriple_t *t = (sparqlTriple_t *)l->data;
+      g_free(t->subject.string);
+      g_free(t->predicate.string);
+      g_free(t->object.string);
+      g_free(t);
+    }
+  g_slist_free(c->sparql_where);
+  ssFreePathNodeList(&c->sparql_select);
+  ssFreeTripleList(&c->triple_list);
+  ssNsTrie_free(c->ns_trie);
+  if (c->ns_map)
+    g_hash_table_destroy(c->ns_map);
+  g_hash_table_destroy(c->sparql_ns);
+  g_free(c->triple_xml);
+  g_free(c->wql_xml);
+  g_free(c->sparql_xml);
+  g_free(c->insert_msg);
+  g_free(c->query_rsp);
+  g_free(c);
+}
+
+/*****************************************************************************
+ * Generators
+ *****************************************************************************/
+
+static gsize bench_addXML_templateTriple(BenchCorpus *c, ssBufDesc_t *bd)
+{
+  GSList *l;
+  ssStatus_t status = ss_StatusOK;
+
+  ssBufDesc_reset(bd);
+  for (l = c->triple_list; status == ss_StatusOK && l; l = l->next)
+    status = addXML_templateTriple(l->data, c->ns_map, bd);
+  return (status) ? 0 : ssBufDesc_GetMessageLen(bd);
+}
+
+static gsize bench_generateSPARQLSelectQueryString(BenchCorpus *c, ssBufDesc_t *bd)
+{
+  ssBufDesc_reset(bd);
+  if (generateSPARQLSelectQueryString(bd, c->sparql_select, c->sparql_where, NULL, c->sparql_ns))
+    return 0;
+  return ssBufDesc_GetMessageLen(bd);
+}
+
+static gsize bench_CreateJoinMessage(BenchCorpus *c, ssBufDesc_t *bd)
+{
+  if (ssBufDesc_CreateJoinMessage(bd, BENCH_SPACE_ID, BENCH_NODE_ID, 1))
+    return 0;
+  return ssBufDesc_GetMessageLen(bd);
+}
+
+static gsize bench_CreateInsertMessage(BenchCorpus *c, ssBufDesc_t *bd)
+{
+  if (ssBufDesc_CreateInsertMessage(bd, BENCH_SPACE_ID, BENCH_NODE_ID, 1, EncodingM3XML,
+				    (const guchar *)c->triple_xml, TRUE))
+    return 0;
+  return ssBufDesc_GetMessageLen(bd);
+}
+
+static gsize bench_CreateUpdateMessage(BenchCorpus *c, ssBufDesc_t *bd)
+{
+  if (ssBufDesc_CreateUpdateMessage(bd, BENCH_SPACE_ID, BENCH_NODE_ID, 1, EncodingM3XML,
+				    (const guchar *)c->triple_xml, (const guchar *)c->triple_xml, TRUE))
+    return 0;
+  return ssBufDesc_GetMessageLen(bd);
+}
+
+static gsize bench_CreateRemoveMessage(BenchCorpus *c, ssBufDesc_t *bd)
+{
+  if (ssBufDesc_CreateRemoveMessage(bd, BENCH_SPACE_ID, BENCH_NODE_ID, 1, EncodingM3XML,
+				    (const guchar *)c->triple_xml))
+    return 0;
+  return ssBufDesc_GetMessageLen(bd);
+}
+
+static gsize bench_CreateQueryMessage(BenchCorpus *c, ssBufDesc_t *bd)
+{
+  if (ssBufDesc_CreateQueryMessage(bd, BENCH_SPACE_ID, BENCH_NODE_ID, 1, QueryTypeTemplate,
+				   (const guchar *)c->triple_xml))
+    return 0;
+  return ssBufDesc_GetMessageLen(bd);
+}
+
+static gsize bench_CreateSubscribeMessage(BenchCorpus *c, ssBufDesc_t *bd)
+{
+  if (ssBufDesc_CreateSubscribeMessage(bd, BENCH_SPACE_ID, BENCH_NODE_ID, 1, QueryTypeTemplate,
+				       (const guchar *)c->triple_xml))
+    return 0;
+  return ssBufDesc_GetMessageLen(bd);
+}
+
+static gsize bench_CreateQueryResponse(BenchCorpus *c, ssBufDesc_t *bd)
+{
+  if (ssBufDesc_CreateQueryResponse(bd, BENCH_NODE_ID, BENCH_SPACE_ID, 1, MSG_E_OK,
+				    (const guchar *)c->triple_xml))
+    return 0;
+  return ssBufDesc_GetMessageLen(bd);
+}
+
+static gsize bench_CreateSubscriptionIndMessage(BenchCorpus *c, ssBufDesc_t *bd)
+{
+  if (ssBufDesc_CreateSubscriptionIndMessage(bd, BENCH_NODE_ID, BENCH_SPACE_ID, 1, 1,
+					     (const guchar *)"1",
+					     (const guchar *)c->triple_xml,
+					     (const guchar *)c->triple_xml))
+    return 0;
+  return ssBufDesc_GetMessageLen(bd);
+}
+
+/*****************************************************************************
+ * Parsers
+ *****************************************************************************/
+
+static gsize bench_parseM3_triples(BenchCorpus *c, ssBufDesc_t *bd)
+{
+  GSList *triples = NULL;
+  ssStatus_t status;
+
+  status = parseM3_triples_trie(&triples, c->triple_xml, c->ns_trie);
+  ssFreeTripleList(&triples);
+  return (status) ? 0 : strlen(c->triple_xml);
+}
+
+#ifdef SIBUSER_ROLE
+static gsize bench_parseM3_query_cnf_wql(BenchCorpus *c, ssBufDesc_t *bd)
+{
+  GSList *nodes = NULL;
+  ssStatus_t status;
+
+  status = parseM3_query_cnf_wql(&nodes, c->wql_xml);
+  ssFreePathNodeList(&nodes);
+  return (status) ? 0 : strlen(c->wql_xml);
+}
+
+static gsize bench_parseM3_query_results_sparql_select(BenchCorpus *c, ssBufDesc_t *bd)
+{
+  GSList *variables = NULL;
+  GSList *rows = NULL;
+  GSList *l;
+  ssStatus_t status;
+
+  status = parseM3_query_results_sparql_select_trie(&variables, &rows, c->sparql_xml, c->ns_trie);
+  for (l = rows; l; l = l->next)
+    ssFreePathNodeList((GSList **)&l->data);
+  g_slist_free(rows);
+  g_slist_foreach(variables, (GFunc)g_free, NULL);
+  g_slist_free(variables);
+  return (status) ? 0 : strlen(c->sparql_xml);
+}
+#endif /* SIBUSER_ROLE */
+
+static gsize bench_parse_ssap(gchar *msg)
+{
+  NodeMsgContent_t *parsed = parseSSAPmsg_new();
+  gsize len = strlen(msg);
+  ssStatus_t status;
+
+  if (!parsed)
+    return 0;
+  status = parseSSAPmsg_section(parsed, msg, len, TRUE);
+  parseSSAPmsg_free(&parsed);
+  return (status) ? 0 : len;
+}
+
+static gsize bench_parseSSAPmsg_section_insert(BenchCorpus *c, ssBufDesc_t *bd)
+{
+  return bench_parse_ssap(c->insert_msg);
+}
+
+static gsize bench_parseSSAPmsg_section_query_rsp(BenchCorpus *c, ssBufDesc_t *bd)
+{
+  return bench_parse_ssap(c->query_rsp);
+}
+
+static const Bench benches[] =
+{
+  { "addXML_templateTriple", bench_addXML_templateTriple },
+  { "generateSPARQLSelectQuery", bench_generateSPARQLSelectQueryString },
+  { "CreateJoinMessage", bench_CreateJoinMessage },
+  { "CreateInsertMessage", bench_CreateInsertMessage },
+  { "CreateUpdateMessage", bench_CreateUpdateMessage },
+  { "CreateRemoveMessage", bench_CreateRemoveMessage },
+  { "CreateQueryMessage", bench_CreateQueryMessage },
+  { "CreateSubscribeMessage", bench_CreateSubscribeMessage },
+  { "CreateQueryResponse", bench_CreateQueryResponse },
+  { "CreateSubscriptionInd", bench_CreateSubscriptionIndMessage },
+  { "parseM3_triples", bench_parseM3_triples },
+#ifdef SIBUSER_ROLE
+  { "parseM3_query_cnf_wql", bench_parseM3_query_cnf_wql },
+  { "parseM3_sparql_select", bench_parseM3_query_results_sparql_select },
+#endif
+  { "parseSSAPmsg_insert", bench_parseSSAPmsg_section_insert },
+  { "parseSSAPmsg_query_rsp", bench_parseSSAPmsg_section_query_rsp },
+  { NULL, NULL }
+};
+
+/*****************************************************************************
+ * Runner
+ *****************************************************************************/
+
+/* Runs bench in batches of doubling size until min_time has passed */
+static void bench_run(const Bench *bench, BenchCorpus *c, ssBufDesc_t *bd)
+{
+  gint64 min_time = (gint64)opt_min_time * 1000000;
+  gint64 start, elapsed;
+  gulong iterations = 0;
+  gulong batch = 1;
+  gulong allocs;
+  gsize bytes = 0;
+  gulong i;
+
+  // warm up caches and pooled parsers before measuring
+  if (bench->func(c, bd) == 0)
+    {
+      printf("%-28s %7u %7u %4u  failed\n", bench->name,
+	     c->triples, c->literal_size, c->namespaces);
+      return;
+    }
+
+  allocs = bench_allocs;
+  start = bench_now();
+  do
+    {
+      for (i = 0; i < batch; i++)
+	bytes += bench->func(c, bd);
+      iterations += batch;
+      batch *= 2;
+      elapsed = bench_now() - start;
+    }
+  while (elapsed < min_time);
+  allocs = bench_allocs - allocs;
+
+  printf("%-28s %7u %7u %4u %10lu %12.1f %9.2f ", bench->name,
+	 c->triples, c->literal_size, c->namespaces, iterations,
+	 iterations * 1e9 / elapsed, bytes * 1e9 / elapsed / (1024 * 1024));
+  if (bench_allocs_counted)
+    printf("%10.1f\n", (gdouble)allocs / iterations);
+  else
+    printf("%10s\n", "-");
+}
+
+int main(int argc, char *argv[])
+{
+  GOptionContext *context;
+  GError *error = NULL;
+  GArray *triples, *literal_sizes, *namespaces;
+  ssBufDesc_t *bd;
+  gpointer probe;
+  guint t, l, n;
+  gint b;
+
+  /* Must come before anything is allocated through GLib. GSlice would
+     bypass the hooks, so list nodes are allocated with g_malloc too. */
+  g_setenv("G_SLICE", "always-malloc", TRUE);
+  g_mem_set_vtable(&bench_mem_vtable);
+  probe = g_malloc(1);
+  bench_allocs_counted = (bench_allocs > 0);
+  g_free(probe);
+
+  context = g_option_context_new("- benchmark the M3 XML generators and parsers");
+  g_option_context_add_main_entries(context, bench_options, NULL);
+  if (!g_option_context_parse(context, &argc, &argv, &error))
+    {
+      fprintf(stderr, "%s\n", error->message);
+      g_error_free(error);
+      g_option_context_free(context);
+      return EXIT_FAILURE;
+    }
+  g_option_context_free(context);
+
+  triples = bench_parse_list(opt_triples);
+  literal_sizes = bench_parse_list(opt_literal_sizes);
+  namespaces = bench_parse_list(opt_namespaces);
+  bd = ssBufDesc_new();
+
+  printf("%-28s %7s %7s %4s %10s %12s %9s %10s\n",
+	 "benchmark", "triples", "literal", "ns", "iterations", "ops/s", "MB/s", "allocs/op");
+
+  for (t = 0; t < triples->len; t++)
+    for (l = 0; l < literal_sizes->len; l++)
+      for (n = 0; n < namespaces->len; n++)
+	{
+	  BenchCorpus *c = bench_corpus_new(g_array_index(triples, guint, t),
+					    g_array_index(literal_sizes, guint, l),
+					    g_array_index(namespaces, guint, n));
+	  for (b = 0; benches[b].name; b++)
+	    {
+	      if (opt_filter && !strstr(benches[b].name, opt_filter))
+		continue;
+	      bench_run(&benches[b], c, bd);
+	    }
+	  bench_corpus_free(c);
+	}
+
+  ssBufDesc_free(&bd);
+  g_array_free(triples, TRUE);
+  g_array_free(literal_sizes, TRUE);
+  g_array_free(namespaces, TRUE);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,673 @@
+/*
+
+  Copyright (c) 2009, Nokia Corporation
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.  
+    * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in
+    the documentation and/or other materials provided with the
+    distribution.  
+    * Neither the name of Nokia nor the names of its contributors 
+    may be used to endorse or promote products derived from this 
+    software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+  EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+/*
+ * Whiteboard Library
+ *
+ * whiteboard_load.c
+ *
+ * End-to-end load generator. Starts a private D-Bus daemon and the
+ * in-process stand-in whiteboard daemon, then drives a number of
+ * WhiteBoardNode instances, each from its own thread, through a mix of
+ * inserts, template queries and subscriptions for a fixed time. The
+ * throughput and latency percentiles are taken from the statistics the
+ * nodes keep.
+ *
+ * With --external the nodes talk to the whiteboard daemon on the current
+ * session bus instead, and join the smartspace given with --sib.
+ *
+ * Copyright 2009 Nokia Corporation
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include <glib.h>
+#include <glib-object.h>
+#include <dbus/dbus.h>
+
+#include "sibdefs.h"
+#include "whiteboard_node.h"
+#include "whiteboard_standin.h"
+
+#define LOAD_BASE_URI "http://example.org/load/"
+
+/* How long to wait for the results of one operation, in milliseconds */
+#define LOAD_WAIT_TIMEOUT 10000
+
+typedef enum
+{
+  LOAD_OP_INSERT,
+  LOAD_OP_QUERY,
+  LOAD_OP_SUBSCRIBE,
+  LOAD_OP_LAST
+} LoadOp;
+
+typedef struct _LoadWorker
+{
+  guint index;
+  GThread *thread;
+  GMainContext *context;
+  WhiteBoardNode *node;
+  GRand *rand;
+  gboolean joined;
+
+  /* Callbacks still to come for the current operation: join completion,
+     query results, initial subscription results and unsubscribe
+     completion */
+  gint pending;
+
+  GHashTable *subscriptions; // access id -> LoadSubscription
+  GQueue *active;            // access ids of live subscriptions, oldest first
+  guint item;                // next item to insert
+
+  guint64 ops[LOAD_OP_LAST];
+  guint64 failed[LOAD_OP_LAST];
+  guint64 indications;
+  WhiteBoardNodeStats stats;
+} LoadWorker;
+
+typedef struct _LoadSubscription
+{
+  LoadWorker *worker;
+  gboolean initial;          // initial results received
+} LoadSubscription;
+
+static gint opt_nodes = 4;
+static gint opt_duration = 10;
+static gint opt_latency = 0;
+static gint opt_jitter = 0;
+static gint opt_insert = 6;
+static gint opt_query = 3;
+static gint opt_subscribe = 1;
+static gint opt_triples = 4;
+static gint opt_result_triples = 10;
+static gint opt_subscriptions = 2;
+static gboolean opt_indications = FALSE;
+static gboolean opt_external = FALSE;
+static gchar *opt_sib = "X";
+static gchar *opt_dbus_daemon = "dbus-daemon";
+
+static GOptionEntry load_options[] =
+{
+  { "nodes", 'n', 0, G_OPTION_ARG_INT, &opt_nodes,
+    "Number of nodes, each driven by its own thread (default 4)", "N" },
+  { "duration", 'd', 0, G_OPTION_ARG_INT, &opt_duration,
+    "Length of the run in seconds (default 10)", "S" },
+  { "latency", 'l', 0, G_OPTION_ARG_INT, &opt_latency,
+    "Latency of the stand-in smartspace in milliseconds (default 0)", "MS" },
+  { "jitter", 'j', 0, G_OPTION_ARG_INT, &opt_jitter,
+    "Random extra latency of the stand-in in milliseconds (default 0)", "MS" },
+  { "insert", 0, 0, G_OPTION_ARG_INT, &opt_insert,
+    "Relative weight of inserts (default 6)", "W" },
+  { "query", 0, 0, G_OPTION_ARG_INT, &opt_query,
+    "Relative weight of template queries (default 3)", "W" },
+  { "subscribe", 0, 0, G_OPTION_ARG_INT, &opt_subscribe,
+    "Relative weight of template subscriptions (default 1)", "W" },
+  { "triples", 't', 0, G_OPTION_ARG_INT, &opt_triples,
+    "Triples per insert (default 4)", "N" },
+  { "result-triples", 'r', 0, G_OPTION_ARG_INT, &opt_result_triples,
+    "Triples in stand-in query and subscription results (default 10)", "N" },
+  { "subscriptions", 's', 0, G_OPTION_ARG_INT, &opt_subscriptions,
+    "Live subscriptions per node, older ones are cancelled (default 2)", "N" },
+  { "indications", 'i', 0, G_OPTION_ARG_NONE, &opt_indications,
+    "Have the stand-in indicate every insert to all subscriptions", NULL },
+  { "external", 'x', 0, G_OPTION_ARG_NONE, &opt_external,
+    "Use the whiteboard daemon on the current session bus", NULL },
+  { "sib", 0, 0, G_OPTION_ARG_STRING, &opt_sib,
+    "Smartspace to join (default X)", "UDN" },
+  { "dbus-daemon", 0, 0, G_OPTION_ARG_STRING, &opt_dbus_daemon,
+    "D-Bus daemon to start the private bus with (default dbus-daemon)", "PATH" },
+  { NULL }
+};
+
+/* The workers join first and start the load together */
+static GMutex *load_lock = NULL;
+static GCond *load_cond = NULL;
+static gint load_ready = 0;
+static gboolean load_started = FALSE;
+static gint load_stop = 0;
+
+static const gchar *load_op_names[LOAD_OP_LAST] = { "insert", "query", "subscribe" };
+
+static gint64 load_now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (gint64)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/*****************************************************************************
+ * Private bus
+ *****************************************************************************/
+
+static gboolean load_bus_start(GPid *pid)
+{
+  gchar *argv[] = { opt_dbus_daemon, "--session", "--nofork", "--print-address", NULL };
+  GError *error = NULL;
+  GIOChannel *out = NULL;
+  gchar *address = NULL;
+  gint out_fd = -1;
+
+  if (!g_spawn_async_with_pipes(NULL, argv, NULL,
+				G_SPAWN_SEARCH_PATH | G_SPAWN_DO_NOT_REAP_CHILD,
+				NULL, NULL, pid, NULL, &out_fd, NULL, &error))
+    {
+      fprintf(stderr, "Could not start %s: %s\n", opt_dbus_daemon, error->message);
+      g_error_free(error);
+      return FALSE;
+    }
+
+  // the daemon prints its address once it accepts connections
+  out = g_io_channel_unix_new(out_fd);
+  g_io_channel_set_close_on_unref(out, TRUE);
+  if (G_IO_STATUS_NORMAL != g_io_channel_read_line(out, &address, NULL, NULL, &error))
+    {
+      fprintf(stderr, "Could not read the address of %s: %s\n", opt_dbus_daemon,
+	      error ? error->message : "end of file");
+      if (error)
+	g_error_free(error);
+      g_io_channel_unref(out);
+      kill(*pid, SIGTERM);
+      waitpid(*pid, NULL, 0);
+      g_spawn_close_pid(*pid);
+      return FALSE;
+    }
+  g_io_channel_unref(out);
+
+  // read by the stand-in and by the discovery of every node
+  g_strchomp(address);
+  g_setenv("DBUS_SESSION_BUS_ADDRESS", address, TRUE);
+  g_free(address);
+  return TRUE;
+}
+
+static void load_bus_stop(GPid pid)
+{
+  kill(pid, SIGTERM);
+  waitpid(pid, NULL, 0);
+  g_spawn_close_pid(pid);
+}
+
+/*****************************************************************************
+ * Node callbacks, called from the thread of the worker
+ *****************************************************************************/
+
+static void load_join_complete(WhiteBoardNode *node, ssStatus_t status, gpointer data)
+{
+  LoadWorker *w = (LoadWorker *)data;
+
+  w->joined = (ss_StatusOK == status);
+  w->pending--;
+}
+
+static void load_query_results(gint status, GSList **results, gpointer data)
+{
+  LoadWorker *w = (LoadWorker *)data;
+
+  if (results)
+    {
+      ssFreeTripleList(results);
+      g_free(results);
+    }
+  w->pending--;
+}
+
+static void load_subscription_ind(ssStatus_t status, GSList **added,
+				  GSList **removed, gpointer data)
+{
+  LoadSubscription *sub = (LoadSubscription *)data;
+
+  if (added)
+    {
+      ssFreeTripleList(added);
+      g_free(added);
+    }
+  if (removed)
+    {
+      ssFreeTripleList(removed);
+      g_free(removed);
+    }
+
+  if (!sub->initial)
+    {
+      sub->initial = TRUE;
+      sub->worker->pending--;
+    }
+  else
+    sub->worker->indications++;
+}
+
+static void load_unsubscribe_complete(WhiteBoardNode *node, gint access_id,
+				      ssStatus_t status, gpointer data)
+{
+  LoadWorker *w = (LoadWorker *)data;
+
+  // the node has dropped the subscription, and with it the user data
+  if (g_hash_table_remove(w->subscriptions, GINT_TO_POINTER(access_id)))
+    w->pending--;
+}
+
+/*****************************************************************************
+ * Operations
+ *****************************************************************************/
+
+static gboolean load_wait_timeout(gpointer data)
+{
+  *(gboolean *)data = TRUE;
+  return FALSE;
+}
+
+/* Run the main context of the node until the pending callbacks have come */
+static gboolean load_wait(LoadWorker *w)
+{
+  gboolean timed_out = FALSE;
+  GSource *timeout;
+
+  if (w->pending <= 0)
+    return TRUE;
+
+  timeout = g_timeout_source_new(LOAD_WAIT_TIMEOUT);
+  g_source_set_callback(timeout, load_wait_timeout, &timed_out, NULL);
+  g_source_attach(timeout, w->context);
+  while (w->pending > 0 && !timed_out)
+    g_main_context_iteration(w->context, TRUE);
+  g_source_destroy(timeout);
+  g_source_unref(timeout);
+
+  return (w->pending <= 0);
+}
+
+/* Template matching everything the stand-in returns and the workers insert */
+static GSList *load_template(void)
+{
+  GSList *templates = NULL;
+
+  ssPrependTriple(&templates, ssMATCH_ANY, (ssElement_ct)LOAD_BASE_URI "value",
+		  ssMATCH_ANY, ssElement_TYPE_URI, ssElement_TYPE_URI);
+  return templates;
+}
+
+static gboolean load_insert(LoadWorker *w)
+{
+  GSList *triples = NULL;
+  ssStatus_t status;
+  gint i;
+
+  for (i = 0; i < opt_triples; i++, w->item++)
+    {
+      gchar *s = g_strdup_printf(LOAD_BASE_URI "node%u/item%u", w->index, w->item);
+      gchar *o = g_strdup_printf("value %u", w->item);
+
+      ssPrependTriple(&triples, (ssElement_ct)s, (ssElement_ct)LOAD_BASE_URI "value",
+		      (ssElement_ct)o, ssElement_TYPE_URI, ssElement_TYPE_LIT);
+      g_free(s);
+      g_free(o);
+    }
+
+  status = whiteboard_node_sib_access_insert_M3Triples(w->node, triples, NULL);
+  ssFreeTripleList(&triples);
+  return (ss_StatusOK == status);
+}
+
+static gboolean load_query(LoadWorker *w)
+{
+  GSList *templates = load_template();
+  ssStatus_t status;
+
+  w->pending++;
+  status = whiteboard_node_sib_access_query_template(w->node, templates, NULL,
+						     load_query_results, w);
+  ssFreeTripleList(&templates);
+  if (ss_StatusOK != status)
+    {
+      w->pending--;
+      return FALSE;
+    }
+  return load_wait(w);
+}
+
+static void load_unsubscribe_oldest(LoadWorker *w)
+{
+  gint access_id = GPOINTER_TO_INT(g_queue_pop_head(w->active));
+
+  // on failure the node may still call back, so the data is kept
+  w->pending++;
+  if (ss_StatusOK != whiteboard_node_sib_access_unsubscribe(w->node, access_id))
+    w->pending--;
+}
+
+static gboolean load_subscribe(LoadWorker *w)
+{
+  LoadSubscription *sub = g_new0(LoadSubscription, 1);
+  GSList *templates = load_template();
+  gint access_id = -1;
+  ssStatus_t status;
+
+  sub->worker = w;
+  w->pending++;
+  status = whiteboard_node_sib_access_subscribe_template(w->node, templates, NULL,
+							 load_subscription_ind,
+							 &access_id, sub);
+  ssFreeTripleList(&templates);
+  if (ss_StatusOK != status)
+    {
+      w->pending--;
+      g_free(sub);
+      return FALSE;
+    }
+  g_hash_table_insert(w->subscriptions, GINT_TO_POINTER(access_id), sub);
+  g_queue_push_tail(w->active, GINT_TO_POINTER(access_id));
+
+  while (g_queue_get_length(w->active) > (guint)opt_subscriptions)
+    load_unsubscribe_oldest(w);
+  return load_wait(w);
+}
+
+static void load_worker_op(LoadWorker *w)
+{
+  gint r = g_rand_int_range(w->rand, 0, opt_insert + opt_query + opt_subscribe);
+  LoadOp op;
+  gboolean ok;
+
+  if (r < opt_insert)
+    {
+      op = LOAD_OP_INSERT;
+      ok = load_insert(w);
+    }
+  else if (r < opt_insert + opt_query)
+    {
+      op = LOAD_OP_QUERY;
+      ok = load_query(w);
+    }
+  else
+    {
+      op = LOAD_OP_SUBSCRIBE;
+      ok = load_subscribe(w);
+    }
+
+  w->ops[op]++;
+  if (!ok)
+    w->failed[op]++;
+}
+
+static gpointer load_worker_run(gpointer data)
+{
+  LoadWorker *w = (LoadWorker *)data;
+
+  w->context = g_main_context_new();
+  w->subscriptions = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, g_free);
+  w->active = g_queue_new();
+
+  // blocks until the node has registered with the daemon
+  w->node = WHITEBOARD_NODE(whiteboard_node_new(w->context));
+  g_signal_connect(G_OBJECT(w->node), WHITEBOARD_NODE_SIGNAL_JOIN_COMPLETE,
+		   G_CALLBACK(load_join_complete), w);
+  g_signal_connect(G_OBJECT(w->node), WHITEBOARD_NODE_SIGNAL_UNSUBSCRIBE_COMPLETE,
+		   G_CALLBACK(load_unsubscribe_complete), w);
+
+  w->pending = 1;
+  if (ss_StatusOK != whiteboard_node_sib_access_join(w->node, (ssElement_ct)opt_sib))
+    w->pending = 0;
+  else
+    load_wait(w);
+  if (!w->joined)
+    fprintf(stderr, "Node %u could not join %s\n", w->index, opt_sib);
+
+  g_mutex_lock(load_lock);
+  load_ready++;
+  g_cond_broadcast(load_cond);
+  while (!load_started)
+    g_cond_wait(load_cond, load_lock);
+  g_mutex_unlock(load_lock);
+
+  if (w->joined)
+    {
+      while (!g_atomic_int_get(&load_stop))
+	load_worker_op(w);
+
+      while (!g_queue_is_empty(w->active))
+	load_unsubscribe_oldest(w);
+      load_wait(w);
+      whiteboard_node_sib_access_leave(w->node);
+    }
+
+  whiteboard_node_get_stats(w->node, &w->stats);
+  g_object_unref(G_OBJECT(w->node));
+  g_hash_table_destroy(w->subscriptions);
+  g_queue_free(w->active);
+  g_main_context_unref(w->context);
+  return NULL;
+}
+
+/*****************************************************************************
+ * Report
+ *****************************************************************************/
+
+static void load_histogram_merge(WhiteBoardNodeHistogram *dst,
+				 const WhiteBoardNodeHistogram *src)
+{
+  gint i;
+
+  dst->count += src->count;
+  dst->errors += src->errors;
+  dst->total_us += src->total_us;
+  if (src->max_us > dst->max_us)
+    dst->max_us = src->max_us;
+  for (i = 0; i < WHITEBOARD_NODE_HISTOGRAM_BUCKETS; i++)
+    dst->buckets[i] += src->buckets[i];
+}
+
+/* elapsed is 0 for operations outside of the measured run */
+static void load_print_histogram(const gchar *name, const WhiteBoardNodeHistogram *h,
+				 gint64 elapsed)
+{
+  if (0 == h->count)
+    return;
+
+  printf("%-22s %9" G_GUINT64_FORMAT " %7" G_GUINT64_FORMAT " ",
+	 name, h->count, h->errors);
+  if (elapsed > 0)
+    printf("%10.1f ", h->count * 1e6 / elapsed);
+  else
+    printf("%10s ", "-");
+  printf("%9.0f %9" G_GUINT64_FORMAT " %9" G_GUINT64_FORMAT " %9" G_GUINT64_FORMAT
+	 " %9" G_GUINT64_FORMAT "\n",
+	 (gdouble)h->total_us / h->count,
+	 whiteboard_node_histogram_percentile(h, 50.0),
+	 whiteboard_node_histogram_percentile(h, 90.0),
+	 whiteboard_node_histogram_percentile(h, 99.0),
+	 h->max_us);
+}
+
+static void load_report(LoadWorker *workers, gint64 elapsed)
+{
+  WhiteBoardNodeStats *total = g_new0(WhiteBoardNodeStats, 1);
+  guint64 ops[LOAD_OP_LAST] = { 0 };
+  guint64 failed[LOAD_OP_LAST] = { 0 };
+  guint64 indications = 0;
+  guint64 all = 0;
+  gint i, k;
+
+  for (i = 0; i < opt_nodes; i++)
+    {
+      LoadWorker *w = &workers[i];
+
+      for (k = 0; k < WHITEBOARD_NODE_STAT_LAST; k++)
+	load_histogram_merge(&total->ops[k], &w->stats.ops[k]);
+      load_histogram_merge(&total->parse, &w->stats.parse);
+      load_histogram_merge(&total->xml_build, &w->stats.xml_build);
+      total->bytes_out += w->stats.bytes_out;
+      total->bytes_in += w->stats.bytes_in;
+      for (k = 0; k < LOAD_OP_LAST; k++)
+	{
+	  ops[k] += w->ops[k];
+	  failed[k] += w->failed[k];
+	}
+      indications += w->indications;
+    }
+
+  printf("%-22s %9s %7s %10s %9s %9s %9s %9s %9s\n", "operation", "count",
+	 "errors", "ops/s", "mean_us", "p50_us", "p90_us", "p99_us", "max_us");
+  for (k = 0; k < WHITEBOARD_NODE_STAT_LAST; k++)
+    load_print_histogram(whiteboard_node_stat_name(k), &total->ops[k],
+			 (WHITEBOARD_NODE_STAT_JOIN == k ||
+			  WHITEBOARD_NODE_STAT_LEAVE == k) ? 0 : elapsed);
+  load_print_histogram("parse", &total->parse, 0);
+  load_print_histogram("xml_build", &total->xml_build, 0);
+
+  printf("\n%d nodes, %.1f s:", opt_nodes, elapsed / 1e6);
+  for (k = 0; k < LOAD_OP_LAST; k++)
+    {
+      printf(" %" G_GUINT64_FORMAT " %s (%" G_GUINT64_FORMAT " failed)",
+	     ops[k], load_op_names[k], failed[k]);
+      all += ops[k];
+    }
+  printf("\n%.1f operations/s, %" G_GUINT64_FORMAT " indications, "
+	 "payload out %.2f MB/s, in %.2f MB/s\n",
+	 all * 1e6 / elapsed, indications,
+	 total->bytes_out * 1e6 / elapsed / (1024 * 1024),
+	 total->bytes_in * 1e6 / elapsed / (1024 * 1024));
+
+  g_free(total);
+}
+
+int main(int argc, char *argv[])
+{
+  GOptionContext *context;
+  GError *error = NULL;
+  WhiteBoardStandin *standin = NULL;
+  WhiteBoardStandinConfig config;
+  WhiteBoardStandinStats standin_stats;
+  LoadWorker *workers;
+  GPid bus_pid = 0;
+  gint64 start, elapsed;
+  gint i;
+
+  g_thread_init(NULL);
+  dbus_threads_init_default();
+  g_type_init();
+
+  context = g_option_context_new("- drive whiteboard nodes against a stand-in daemon");
+  g_option_context_add_main_entries(context, load_options, NULL);
+  if (!g_option_context_parse(context, &argc, &argv, &error))
+    {
+      fprintf(stderr, "%s\n", error->message);
+      g_error_free(error);
+      g_option_context_free(context);
+      return EXIT_FAILURE;
+    }
+  g_option_context_free(context);
+
+  if (opt_nodes <= 0 || opt_duration <= 0 || opt_latency < 0 || opt_jitter < 0 ||
+      opt_insert < 0 || opt_query < 0 || opt_subscribe < 0 ||
+      opt_insert + opt_query + opt_subscribe <= 0 ||
+      opt_triples <= 0 || opt_result_triples < 0 || opt_subscriptions < 0)
+    {
+      fprintf(stderr, "Invalid arguments\n");
+      return EXIT_FAILURE;
+    }
+
+  if (!opt_external)
+    {
+      if (!load_bus_start(&bus_pid))
+	return EXIT_FAILURE;
+
+      config.latency = opt_latency;
+      config.jitter = opt_jitter;
+      config.result_triples = opt_result_triples;
+      config.indications = opt_indications;
+      standin = whiteboard_standin_start(&config);
+      if (NULL == standin)
+	{
+	  load_bus_stop(bus_pid);
+	  return EXIT_FAILURE;
+	}
+    }
+
+  load_lock = g_mutex_new();
+  load_cond = g_cond_new();
+  workers = g_new0(LoadWorker, opt_nodes);
+  for (i = 0; i < opt_nodes; i++)
+    {
+      workers[i].index = i;
+      workers[i].rand = g_rand_new_with_seed(i + 1);
+      workers[i].thread = g_thread_create(load_worker_run, &workers[i], TRUE, NULL);
+    }
+
+  g_mutex_lock(load_lock);
+  while (load_ready < opt_nodes)
+    g_cond_wait(load_cond, load_lock);
+  load_started = TRUE;
+  start = load_now();
+  g_cond_broadcast(load_cond);
+  g_mutex_unlock(load_lock);
+
+  g_usleep((gulong)opt_duration * G_USEC_PER_SEC);
+  /* no g_atomic_int_set() in GLib 2.8 */
+  g_atomic_int_compare_and_exchange(&load_stop, 0, 1);
+  elapsed = load_now() - start;
+
+  for (i = 0; i < opt_nodes; i++)
+    {
+      g_thread_join(workers[i].thread);
+      g_rand_free(workers[i].rand);
+    }
+
+  load_report(workers, elapsed);
+
+  if (standin)
+    {
+      whiteboard_standin_get_stats(standin, &standin_stats);
+      printf("stand-in: %" G_GUINT64_FORMAT " registrations, %" G_GUINT64_FORMAT
+	     " requests, %" G_GUINT64_FORMAT " indications sent\n",
+	     standin_stats.registrations, standin_stats.requests,
+	     standin_stats.indications);
+      whiteboard_standin_stop(standin);
+      load_bus_stop(bus_pid);
+    }
+
+  g_free(workers);
+  g_cond_free(load_cond);
+  g_mutex_free(load_lock);
+  return EXIT_SUCCESS;
+}
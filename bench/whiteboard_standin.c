@@ -0,0 +1,714 @@
+/*
+
+  Copyright (c) 2009, Nokia Corporation
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.  
+    * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in
+    the documentation and/or other materials provided with the
+    distribution.  
+    * Neither the name of Nokia nor the names of its contributors 
+    may be used to endorse or promote products derived from this 
+    software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+  EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+/*
+ * Whiteboard Library
+ *
+ * whiteboard_standin.c
+ *
+ * Minimal in-process stand-in for the whiteboard daemon. It implements
+ * just enough of the node interface for WhiteBoardNode instances to join,
+ * insert, update, remove, query and subscribe, and answers on behalf of
+ * the smartspace after a configurable latency.
+ *
+ * Copyright 2009 Nokia Corporation
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdio.h>
+#include <string.h>
+
+#include <glib.h>
+#include <dbus/dbus.h>
+#include <dbus/dbus-glib-lowlevel.h>
+
+#include "sibdefs.h"
+#include "sibmsg.h"
+#include "m3_sib_tokens.h"
+#include "whiteboard_dbus_ifaces.h"
+#include "whiteboard_util.h"
+#include "whiteboard_log.h"
+#include "whiteboard_node.h"
+#include "whiteboard_standin.h"
+
+#define STANDIN_LISTEN_ADDRESS "unix:tmpdir=/tmp"
+#define STANDIN_BASE_URI "http://example.org/standin/"
+
+typedef struct _StandinRequest StandinRequest;
+
+/* Sends the answer to a request once its latency has passed */
+typedef void (*StandinSendFunc)(StandinRequest *r);
+
+struct _StandinRequest
+{
+  WhiteBoardStandin *standin;
+  DBusConnection *conn;
+  DBusMessage *msg;        // the request, NULL for signals
+  StandinSendFunc send;
+  dbus_int32_t access_id;
+  gchar *subscription_id;
+  gchar *triples;          // inserted triples to indicate, NULL if none
+};
+
+typedef struct _StandinSubscription
+{
+  DBusConnection *conn;
+  dbus_int32_t access_id;
+  dbus_int32_t update_sequence;
+  gchar *id;
+} StandinSubscription;
+
+struct _WhiteBoardStandin
+{
+  WhiteBoardStandinConfig config;
+
+  GMainContext *context;
+  GMainLoop *loop;
+  GThread *thread;
+
+  DBusConnection *bus;
+  DBusServer *server;
+  gchar *address;
+  GList *connections;      // peer connections of the nodes
+
+  /* Only used from the stand-in thread */
+  GHashTable *subscriptions; // subscription id -> StandinSubscription
+  GRand *rand;
+  dbus_int32_t next_access_id;
+  gchar *results;          // triple_list of config.result_triples triples
+  gchar *no_results;       // empty triple_list
+
+  GMutex *stats_lock;
+  WhiteBoardStandinStats stats;
+};
+
+static WhiteBoardUtilDispatchTable *standin_dispatch_table = NULL;
+
+static void standin_count(WhiteBoardStandin *s, guint64 *counter)
+{
+  g_mutex_lock(s->stats_lock);
+  (*counter)++;
+  g_mutex_unlock(s->stats_lock);
+}
+
+static gchar *standin_triple_list(guint n)
+{
+  ssBufDesc_t *bd = ssBufDesc_new();
+  GSList *triples = NULL;
+  GSList *l;
+  gchar *xml;
+  guint i;
+
+  // prepended backwards, so that the list is in order
+  for (i = n; i > 0; i--)
+    {
+      gchar *s = g_strdup_printf(STANDIN_BASE_URI "item%u", i - 1);
+      gchar *o = g_strdup_printf("value %u", i - 1);
+
+      ssPrependTriple(&triples, (ssElement_ct)s, (ssElement_ct)STANDIN_BASE_URI "value",
+		      (ssElement_ct)o, ssElement_TYPE_URI, ssElement_TYPE_LIT);
+      g_free(s);
+      g_free(o);
+    }
+
+  addXML_start(bd, &SIB_TRIPLELIST, NULL, NULL, 0);
+  for (l = triples; l; l = l->next)
+    addXML_templateTriple(l->data, NULL, bd);
+  addXML_end(bd, &SIB_TRIPLELIST);
+  xml = g_strndup((const gchar *)ssBufDesc_GetMessage(bd), ssBufDesc_GetMessageLen(bd));
+
+  ssFreeTripleList(&triples);
+  ssBufDesc_free(&bd);
+  return xml;
+}
+
+static void standin_subscription_free(gpointer data)
+{
+  StandinSubscription *sub = (StandinSubscription *)data;
+
+  dbus_connection_unref(sub->conn);
+  g_free(sub->id);
+  g_free(sub);
+}
+
+/*****************************************************************************
+ * Delayed answers
+ *****************************************************************************/
+
+static StandinRequest *standin_request_new(WhiteBoardStandin *s,
+					   DBusConnection *conn,
+					   DBusMessage *msg,
+					   StandinSendFunc send)
+{
+  StandinRequest *r = g_new0(StandinRequest, 1);
+
+  r->standin = s;
+  r->conn = dbus_connection_ref(conn);
+  r->msg = (DBUS_MESSAGE_TYPE_METHOD_CALL == dbus_message_get_type(msg)) ?
+    dbus_message_ref(msg) : NULL;
+  r->send = send;
+  return r;
+}
+
+static void standin_request_free(gpointer data)
+{
+  StandinRequest *r = (StandinRequest *)data;
+
+  dbus_connection_unref(r->conn);
+  if (r->msg)
+    dbus_message_unref(r->msg);
+  g_free(r->subscription_id);
+  g_free(r->triples);
+  g_free(r);
+}
+
+static gboolean standin_request_dispatch(gpointer data)
+{
+  StandinRequest *r = (StandinRequest *)data;
+
+  if (dbus_connection_get_is_connected(r->conn))
+    r->send(r);
+  return FALSE;
+}
+
+/* Send the answer of the smartspace to a request after the latency */
+static void standin_defer(StandinRequest *r)
+{
+  WhiteBoardStandin *s = r->standin;
+  guint delay = s->config.latency;
+  GSource *source;
+
+  if (s->config.jitter)
+    delay += g_rand_int_range(s->rand, 0, s->config.jitter + 1);
+
+  if (0 == delay)
+    {
+      standin_request_dispatch(r);
+      standin_request_free(r);
+      return;
+    }
+
+  source = g_timeout_source_new(delay);
+  g_source_set_callback(source, standin_request_dispatch, r, standin_request_free);
+  g_source_attach(source, s->context);
+  g_source_unref(source);
+}
+
+static void standin_indicate(WhiteBoardStandin *s, const gchar *added)
+{
+  GHashTableIter iter;
+  gpointer value;
+
+  g_hash_table_iter_init(&iter, s->subscriptions);
+  while (g_hash_table_iter_next(&iter, NULL, &value))
+    {
+      StandinSubscription *sub = (StandinSubscription *)value;
+
+      // 1, 2 .. SSAP_IND_WRAP_NUM-1, 1, 2 .. as the node expects
+      if (++sub->update_sequence == SSAP_IND_WRAP_NUM)
+	sub->update_sequence = 1;
+
+      whiteboard_util_send_signal(WHITEBOARD_DBUS_OBJECT,
+				  WHITEBOARD_DBUS_NODE_INTERFACE,
+				  WHITEBOARD_DBUS_NODE_SIGNAL_SUBSCRIPTION_IND,
+				  sub->conn,
+				  DBUS_TYPE_INT32, &sub->access_id,
+				  DBUS_TYPE_INT32, &sub->update_sequence,
+				  DBUS_TYPE_STRING, &sub->id,
+				  DBUS_TYPE_STRING, &added,
+				  DBUS_TYPE_STRING, &s->no_results,
+				  WHITEBOARD_UTIL_LIST_END);
+      standin_count(s, &s->stats.indications);
+    }
+}
+
+static void standin_send_join_complete(StandinRequest *r)
+{
+  dbus_int32_t status = ss_StatusOK;
+
+  whiteboard_util_send_signal(WHITEBOARD_DBUS_OBJECT,
+			      WHITEBOARD_DBUS_NODE_INTERFACE,
+			      WHITEBOARD_DBUS_NODE_SIGNAL_JOIN_COMPLETE,
+			      r->conn,
+			      DBUS_TYPE_INT32, &r->access_id,
+			      DBUS_TYPE_INT32, &status,
+			      WHITEBOARD_UTIL_LIST_END);
+}
+
+static void standin_send_status(StandinRequest *r)
+{
+  dbus_int32_t status = ss_StatusOK;
+
+  whiteboard_util_send_method_return(r->conn, r->msg,
+				     DBUS_TYPE_INT32, &status,
+				     WHITEBOARD_UTIL_LIST_END);
+}
+
+static void standin_send_response(StandinRequest *r)
+{
+  dbus_int32_t status = ss_StatusOK;
+  const gchar *response = "";
+
+  whiteboard_util_send_method_return(r->conn, r->msg,
+				     DBUS_TYPE_INT32, &status,
+				     DBUS_TYPE_STRING, &response,
+				     WHITEBOARD_UTIL_LIST_END);
+  if (r->triples)
+    standin_indicate(r->standin, r->triples);
+}
+
+static void standin_send_query_results(StandinRequest *r)
+{
+  dbus_int32_t status = ss_StatusOK;
+
+  whiteboard_util_send_signal(WHITEBOARD_DBUS_OBJECT,
+			      WHITEBOARD_DBUS_NODE_INTERFACE,
+			      WHITEBOARD_DBUS_NODE_METHOD_QUERY,
+			      r->conn,
+			      DBUS_TYPE_INT32, &r->access_id,
+			      DBUS_TYPE_INT32, &status,
+			      DBUS_TYPE_STRING, &r->standin->results,
+			      WHITEBOARD_UTIL_LIST_END);
+}
+
+static void standin_send_subscribe_results(StandinRequest *r)
+{
+  WhiteBoardStandin *s = r->standin;
+  StandinSubscription *sub = g_new0(StandinSubscription, 1);
+  dbus_int32_t status = ss_StatusOK;
+
+  // indications start only after the initial results
+  sub->conn = dbus_connection_ref(r->conn);
+  sub->access_id = r->access_id;
+  sub->id = g_strdup(r->subscription_id);
+  g_hash_table_replace(s->subscriptions, sub->id, sub);
+
+  whiteboard_util_send_signal(WHITEBOARD_DBUS_OBJECT,
+			      WHITEBOARD_DBUS_NODE_INTERFACE,
+			      WHITEBOARD_DBUS_NODE_METHOD_SUBSCRIBE,
+			      r->conn,
+			      DBUS_TYPE_INT32, &r->access_id,
+			      DBUS_TYPE_INT32, &status,
+			      DBUS_TYPE_STRING, &r->subscription_id,
+			      DBUS_TYPE_STRING, &s->results,
+			      WHITEBOARD_UTIL_LIST_END);
+}
+
+static void standin_send_unsubscribe_complete(StandinRequest *r)
+{
+  dbus_int32_t status = MSG_E_OK;
+
+  whiteboard_util_send_signal(WHITEBOARD_DBUS_OBJECT,
+			      WHITEBOARD_DBUS_NODE_INTERFACE,
+			      WHITEBOARD_DBUS_NODE_SIGNAL_UNSUBSCRIBE_COMPLETE,
+			      r->conn,
+			      DBUS_TYPE_INT32, &r->access_id,
+			      DBUS_TYPE_INT32, &status,
+			      DBUS_TYPE_STRING, &r->subscription_id,
+			      WHITEBOARD_UTIL_LIST_END);
+}
+
+/*****************************************************************************
+ * Message handlers
+ *****************************************************************************/
+
+static DBusHandlerResult standin_register(DBusConnection *conn,
+					  DBusMessage *msg,
+					  void *data)
+{
+  WhiteBoardStandin *s = (WhiteBoardStandin *)data;
+  dbus_int32_t success = 0;
+
+  standin_count(s, &s->stats.registrations);
+  whiteboard_util_send_method_return(conn, msg,
+				     DBUS_TYPE_INT32, &success,
+				     WHITEBOARD_UTIL_LIST_END);
+  return DBUS_HANDLER_RESULT_HANDLED;
+}
+
+static DBusHandlerResult standin_unregister(DBusConnection *conn,
+					    DBusMessage *msg,
+					    void *data)
+{
+  return DBUS_HANDLER_RESULT_HANDLED;
+}
+
+static DBusHandlerResult standin_join(DBusConnection *conn,
+				      DBusMessage *msg,
+				      void *data)
+{
+  WhiteBoardStandin *s = (WhiteBoardStandin *)data;
+  StandinRequest *r = standin_request_new(s, conn, msg, standin_send_join_complete);
+
+  standin_count(s, &s->stats.requests);
+  r->access_id = s->next_access_id++;
+  whiteboard_util_send_method_return(conn, msg,
+				     DBUS_TYPE_INT32, &r->access_id,
+				     WHITEBOARD_UTIL_LIST_END);
+  standin_defer(r);
+  return DBUS_HANDLER_RESULT_HANDLED;
+}
+
+static DBusHandlerResult standin_leave(DBusConnection *conn,
+				       DBusMessage *msg,
+				       void *data)
+{
+  WhiteBoardStandin *s = (WhiteBoardStandin *)data;
+
+  standin_count(s, &s->stats.requests);
+  standin_defer(standin_request_new(s, conn, msg, standin_send_status));
+  return DBUS_HANDLER_RESULT_HANDLED;
+}
+
+/* insert, update and remove */
+static DBusHandlerResult standin_modify(DBusConnection *conn,
+					DBusMessage *msg,
+					void *data)
+{
+  WhiteBoardStandin *s = (WhiteBoardStandin *)data;
+  StandinRequest *r = standin_request_new(s, conn, msg, standin_send_response);
+  const gchar *nodeid = NULL;
+  const gchar *sib = NULL;
+  const gchar *triples = NULL;
+  dbus_int32_t msgnum = 0;
+  dbus_int32_t encoding = 0;
+
+  standin_count(s, &s->stats.requests);
+  if (s->config.indications &&
+      dbus_message_is_method_call(msg, WHITEBOARD_DBUS_NODE_INTERFACE,
+				  WHITEBOARD_DBUS_NODE_METHOD_INSERT) &&
+      whiteboard_util_parse_message(msg,
+				    DBUS_TYPE_STRING, &nodeid,
+				    DBUS_TYPE_STRING, &sib,
+				    DBUS_TYPE_INT32, &msgnum,
+				    DBUS_TYPE_INT32, &encoding,
+				    DBUS_TYPE_STRING, &triples,
+				    WHITEBOARD_UTIL_LIST_END) &&
+      EncodingM3XML == encoding)
+    r->triples = g_strdup(triples);
+
+  standin_defer(r);
+  return DBUS_HANDLER_RESULT_HANDLED;
+}
+
+static DBusHandlerResult standin_query(DBusConnection *conn,
+				       DBusMessage *msg,
+				       void *data)
+{
+  WhiteBoardStandin *s = (WhiteBoardStandin *)data;
+  StandinRequest *r = standin_request_new(s, conn, msg, standin_send_query_results);
+
+  standin_count(s, &s->stats.requests);
+  r->access_id = s->next_access_id++;
+  whiteboard_util_send_method_return(conn, msg,
+				     DBUS_TYPE_INT32, &r->access_id,
+				     WHITEBOARD_UTIL_LIST_END);
+  standin_defer(r);
+  return DBUS_HANDLER_RESULT_HANDLED;
+}
+
+static DBusHandlerResult standin_subscribe(DBusConnection *conn,
+					   DBusMessage *msg,
+					   void *data)
+{
+  WhiteBoardStandin *s = (WhiteBoardStandin *)data;
+  StandinRequest *r = standin_request_new(s, conn, msg, standin_send_subscribe_results);
+
+  standin_count(s, &s->stats.requests);
+  r->access_id = s->next_access_id++;
+  r->subscription_id = g_strdup_printf("standin-subscription-%d", r->access_id);
+  whiteboard_util_send_method_return(conn, msg,
+				     DBUS_TYPE_INT32, &r->access_id,
+				     WHITEBOARD_UTIL_LIST_END);
+  standin_defer(r);
+  return DBUS_HANDLER_RESULT_HANDLED;
+}
+
+static DBusHandlerResult standin_unsubscribe(DBusConnection *conn,
+					     DBusMessage *msg,
+					     void *data)
+{
+  WhiteBoardStandin *s = (WhiteBoardStandin *)data;
+  StandinRequest *r = NULL;
+  dbus_int32_t access_id = -1;
+  const gchar *nodeid = NULL;
+  const gchar *sib = NULL;
+  dbus_int32_t msgnum = 0;
+  const gchar *subscription_id = NULL;
+
+  if (!whiteboard_util_parse_message(msg,
+				     DBUS_TYPE_INT32, &access_id,
+				     DBUS_TYPE_STRING, &nodeid,
+				     DBUS_TYPE_STRING, &sib,
+				     DBUS_TYPE_INT32, &msgnum,
+				     DBUS_TYPE_STRING, &subscription_id,
+				     WHITEBOARD_UTIL_LIST_END))
+    return DBUS_HANDLER_RESULT_HANDLED;
+
+  standin_count(s, &s->stats.requests);
+  g_hash_table_remove(s->subscriptions, subscription_id);
+
+  r = standin_request_new(s, conn, msg, standin_send_unsubscribe_complete);
+  r->access_id = access_id;
+  r->subscription_id = g_strdup(subscription_id);
+  standin_defer(r);
+  return DBUS_HANDLER_RESULT_HANDLED;
+}
+
+static gboolean standin_subscription_on(gpointer key, gpointer value, gpointer conn)
+{
+  return ((StandinSubscription *)value)->conn == conn;
+}
+
+static DBusHandlerResult standin_disconnected(DBusConnection *conn,
+					      DBusMessage *msg,
+					      void *data)
+{
+  WhiteBoardStandin *s = (WhiteBoardStandin *)data;
+
+  g_hash_table_foreach_remove(s->subscriptions, standin_subscription_on, conn);
+  s->connections = g_list_remove(s->connections, conn);
+  dbus_connection_unref(conn);
+  return DBUS_HANDLER_RESULT_HANDLED;
+}
+
+static DBusHandlerResult standin_dispatch_message(DBusConnection *conn,
+						  DBusMessage *msg,
+						  void *data)
+{
+  DBusObjectPathMessageFunction handler = NULL;
+
+  handler = whiteboard_util_dispatch_table_lookup(standin_dispatch_table, msg);
+  if (handler)
+    return handler(conn, msg, data);
+
+  whiteboard_log_warning("Stand-in: unknown message: type:%d, if:%s, mem:%s\n",
+			 dbus_message_get_type(msg),
+			 dbus_message_get_interface(msg),
+			 dbus_message_get_member(msg));
+  return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+}
+
+/* Discovery, on the session bus */
+static DBusHandlerResult standin_bus_message(DBusConnection *conn,
+					     DBusMessage *msg,
+					     void *data)
+{
+  WhiteBoardStandin *s = (WhiteBoardStandin *)data;
+
+  if (!dbus_message_is_method_call(msg, WHITEBOARD_DBUS_INTERFACE,
+				   WHITEBOARD_DBUS_METHOD_DISCOVERY))
+    return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+
+  whiteboard_util_send_method_return(conn, msg,
+				     DBUS_TYPE_STRING, &s->address,
+				     WHITEBOARD_UTIL_LIST_END);
+  return DBUS_HANDLER_RESULT_HANDLED;
+}
+
+static void standin_new_connection(DBusServer *server,
+				   DBusConnection *conn,
+				   void *data)
+{
+  WhiteBoardStandin *s = (WhiteBoardStandin *)data;
+
+  dbus_connection_ref(conn);
+  dbus_connection_set_exit_on_disconnect(conn, FALSE);
+  dbus_connection_add_filter(conn, standin_dispatch_message, s, NULL);
+  dbus_connection_setup_with_g_main(conn, s->context);
+  s->connections = g_list_prepend(s->connections, conn);
+}
+
+/*****************************************************************************
+ * Public functions
+ *****************************************************************************/
+
+static gpointer standin_run(gpointer data)
+{
+  WhiteBoardStandin *s = (WhiteBoardStandin *)data;
+
+  g_main_loop_run(s->loop);
+  return NULL;
+}
+
+static void standin_free(WhiteBoardStandin *s)
+{
+  GList *l;
+
+  for (l = s->connections; l; l = l->next)
+    {
+      dbus_connection_close((DBusConnection *)l->data);
+      dbus_connection_unref((DBusConnection *)l->data);
+    }
+  g_list_free(s->connections);
+
+  if (s->server)
+    {
+      dbus_server_disconnect(s->server);
+      dbus_server_unref(s->server);
+    }
+  if (s->bus)
+    {
+      dbus_connection_close(s->bus);
+      dbus_connection_unref(s->bus);
+    }
+
+  // pending answers are freed with their sources
+  g_hash_table_destroy(s->subscriptions);
+  g_main_loop_unref(s->loop);
+  g_main_context_unref(s->context);
+  g_rand_free(s->rand);
+  g_mutex_free(s->stats_lock);
+  g_free(s->address);
+  g_free(s->results);
+  g_free(s->no_results);
+  g_free(s);
+}
+
+WhiteBoardStandin *whiteboard_standin_start(const WhiteBoardStandinConfig *config)
+{
+  WhiteBoardStandin *s = NULL;
+  DBusError err;
+  gchar *address = NULL;
+  gint ret;
+
+  g_return_val_if_fail(config != NULL, NULL);
+
+  if (NULL == standin_dispatch_table)
+    {
+      static const WhiteBoardUtilDispatchEntry entries[] = {
+	{ DBUS_MESSAGE_TYPE_METHOD_CALL, WHITEBOARD_DBUS_REGISTER_INTERFACE,
+	  WHITEBOARD_DBUS_REGISTER_METHOD_NODE, standin_register },
+	{ DBUS_MESSAGE_TYPE_SIGNAL, WHITEBOARD_DBUS_REGISTER_INTERFACE,
+	  WHITEBOARD_DBUS_REGISTER_SIGNAL_UNREGISTER_NODE, standin_unregister },
+	{ DBUS_MESSAGE_TYPE_METHOD_CALL, WHITEBOARD_DBUS_NODE_INTERFACE,
+	  WHITEBOARD_DBUS_NODE_METHOD_JOIN, standin_join },
+	{ DBUS_MESSAGE_TYPE_METHOD_CALL, WHITEBOARD_DBUS_NODE_INTERFACE,
+	  WHITEBOARD_DBUS_NODE_METHOD_LEAVE, standin_leave },
+	{ DBUS_MESSAGE_TYPE_METHOD_CALL, WHITEBOARD_DBUS_NODE_INTERFACE,
+	  WHITEBOARD_DBUS_NODE_METHOD_INSERT, standin_modify },
+	{ DBUS_MESSAGE_TYPE_METHOD_CALL, WHITEBOARD_DBUS_NODE_INTERFACE,
+	  WHITEBOARD_DBUS_NODE_METHOD_UPDATE, standin_modify },
+	{ DBUS_MESSAGE_TYPE_METHOD_CALL, WHITEBOARD_DBUS_NODE_INTERFACE,
+	  WHITEBOARD_DBUS_NODE_METHOD_REMOVE, standin_modify },
+	{ DBUS_MESSAGE_TYPE_METHOD_CALL, WHITEBOARD_DBUS_NODE_INTERFACE,
+	  WHITEBOARD_DBUS_NODE_METHOD_QUERY, standin_query },
+	{ DBUS_MESSAGE_TYPE_METHOD_CALL, WHITEBOARD_DBUS_NODE_INTERFACE,
+	  WHITEBOARD_DBUS_NODE_METHOD_SUBSCRIBE, standin_subscribe },
+	{ DBUS_MESSAGE_TYPE_SIGNAL, WHITEBOARD_DBUS_NODE_INTERFACE,
+	  WHITEBOARD_DBUS_NODE_SIGNAL_UNSUBSCRIBE, standin_unsubscribe },
+	{ DBUS_MESSAGE_TYPE_SIGNAL, DBUS_INTERFACE_LOCAL,
+	  "Disconnected", standin_disconnected },
+	{ 0, NULL, NULL, NULL }
+      };
+
+      standin_dispatch_table = whiteboard_util_dispatch_table_new(entries);
+    }
+
+  s = g_new0(WhiteBoardStandin, 1);
+  s->config = *config;
+  s->context = g_main_context_new();
+  s->loop = g_main_loop_new(s->context, FALSE);
+  s->subscriptions = g_hash_table_new_full(g_str_hash, g_str_equal,
+					   NULL, standin_subscription_free);
+  s->rand = g_rand_new_with_seed(1);
+  s->next_access_id = 1;
+  s->results = standin_triple_list(config->result_triples);
+  s->no_results = standin_triple_list(0);
+  s->stats_lock = g_mutex_new();
+
+  dbus_error_init(&err);
+  s->bus = dbus_bus_get_private(DBUS_BUS_SESSION, &err);
+  if (NULL == s->bus)
+    {
+      fprintf(stderr, "Could not connect to the session bus: %s\n", err.message);
+      dbus_error_free(&err);
+      standin_free(s);
+      return NULL;
+    }
+  dbus_connection_set_exit_on_disconnect(s->bus, FALSE);
+
+  ret = dbus_bus_request_name(s->bus, WHITEBOARD_DBUS_SERVICE,
+			      DBUS_NAME_FLAG_DO_NOT_QUEUE, &err);
+  if (DBUS_REQUEST_NAME_REPLY_PRIMARY_OWNER != ret)
+    {
+      fprintf(stderr, "Could not own %s: %s\n", WHITEBOARD_DBUS_SERVICE,
+	      dbus_error_is_set(&err) ? err.message : "name taken");
+      dbus_error_free(&err);
+      standin_free(s);
+      return NULL;
+    }
+
+  s->server = dbus_server_listen(STANDIN_LISTEN_ADDRESS, &err);
+  if (NULL == s->server)
+    {
+      fprintf(stderr, "Could not listen on %s: %s\n", STANDIN_LISTEN_ADDRESS,
+	      err.message);
+      dbus_error_free(&err);
+      standin_free(s);
+      return NULL;
+    }
+  address = dbus_server_get_address(s->server);
+  s->address = g_strdup(address);
+  dbus_free(address);
+
+  dbus_connection_add_filter(s->bus, standin_bus_message, s, NULL);
+  dbus_connection_setup_with_g_main(s->bus, s->context);
+  dbus_server_set_new_connection_function(s->server, standin_new_connection, s, NULL);
+  dbus_server_setup_with_g_main(s->server, s->context);
+
+  s->thread = g_thread_create(standin_run, s, TRUE, NULL);
+  return s;
+}
+
+void whiteboard_standin_stop(WhiteBoardStandin *standin)
+{
+  g_return_if_fail(standin != NULL);
+
+  g_main_loop_quit(standin->loop);
+  g_thread_join(standin->thread);
+  standin_free(standin);
+}
+
+void whiteboard_standin_get_stats(WhiteBoardStandin *standin,
+				  WhiteBoardStandinStats *stats)
+{
+  g_return_if_fail(standin != NULL);
+  g_return_if_fail(stats != NULL);
+
+  g_mutex_lock(standin->stats_lock);
+  *stats = standin->stats;
+  g_mutex_unlock(standin->stats_lock);
+}
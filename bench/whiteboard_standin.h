@@ -0,0 +1,108 @@
+/*
+
+  Copyright (c) 2009, Nokia Corporation
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.  
+    * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in
+    the documentation and/or other materials provided with the
+    distribution.  
+    * Neither the name of Nokia nor the names of its contributors 
+    may be used to endorse or promote products derived from this 
+    software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+  EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+/*
+ * Whiteboard Library
+ *
+ * whiteboard_standin.h
+ *
+ * Minimal in-process stand-in for the whiteboard daemon, for driving
+ * WhiteBoardNode instances without a daemon and a SIB.
+ *
+ * Copyright 2009 Nokia Corporation
+ */
+
+#ifndef WHITEBOARD_STANDIN_H
+#define WHITEBOARD_STANDIN_H
+
+#include <glib.h>
+
+typedef struct _WhiteBoardStandin WhiteBoardStandin;
+
+/**
+ * Behaviour of the stand-in daemon.
+ */
+typedef struct _WhiteBoardStandinConfig
+{
+  guint latency;        /* ms before a smartspace answer is sent */
+  guint jitter;         /* ms of uniformly distributed extra latency */
+  guint result_triples; /* triples in query and subscription results */
+  gboolean indications; /* indicate every insert to all subscriptions */
+} WhiteBoardStandinConfig;
+
+/**
+ * Requests handled by the stand-in daemon.
+ */
+typedef struct _WhiteBoardStandinStats
+{
+  guint64 registrations;
+  guint64 requests;     /* join, leave, insert, update, remove, query, subscribe, unsubscribe */
+  guint64 indications;
+  guint subscriptions;  /* active at the time of the snapshot */
+} WhiteBoardStandinStats;
+
+/**
+ * Start the stand-in daemon in its own thread. It owns the whiteboard
+ * service name on the session bus and answers discovery with the address
+ * of its private server, like whiteboardd does. Every join succeeds, and
+ * queries and subscriptions of any type get a fixed triple list as their
+ * results.
+ *
+ * Replies that would come from the smartspace (join completion, insert,
+ * update, remove and leave replies, query and subscription results,
+ * indications and unsubscribe completion) are delayed by the configured
+ * latency. The access id for a query or subscription is returned at once.
+ *
+ * @param config Behaviour of the daemon, copied
+ * @return New stand-in daemon, NULL if the session bus can not be used or
+ * the service name is taken
+ */
+WhiteBoardStandin *whiteboard_standin_start(const WhiteBoardStandinConfig *config);
+
+/**
+ * Stop the stand-in daemon, disconnecting all nodes.
+ *
+ * @param standin A stand-in daemon
+ */
+void whiteboard_standin_stop(WhiteBoardStandin *standin);
+
+/**
+ * Get the request counts of a stand-in daemon.
+ *
+ * @param standin A stand-in daemon
+ * @param stats Filled with the counts
+ */
+void whiteboard_standin_get_stats(WhiteBoardStandin *standin,
+				  WhiteBoardStandinStats *stats);
+
+#endif /* WHITEBOARD_STANDIN_H */
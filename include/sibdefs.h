@@ -103,6 +103,11 @@ typedef enum {
 typedef enum {ssElement_TYPE_URI=0, ssElement_TYPE_LIT,
 	      ssElement_TYPE_BNODE, ssElement_TYPE_eot} ssElementType_t;
 
+/* Set in the subjType of shared triples, see ssTriple_new_shared().
+   ssElementType() gives the type without it. */
+#define ssElement_TYPE_SHARED 0x100
+#define ssElementType(type) ((ssElementType_t)((type) & ~ssElement_TYPE_SHARED))
+
 typedef unsigned char * ssElement_t;
 typedef const unsigned char * ssElement_ct; //read only
 
@@ -115,6 +120,18 @@ typedef struct {
                   objType;
 } ssTriple_t;
 
+/* Element strings shared by many triples, see ssTermDict_new() */
+typedef struct _ssTermDict ssTermDict_t;
+
+/* Triples stored by column with a single string heap, see ssTripleBatch_new() */
+typedef struct _ssTripleBatch ssTripleBatch_t;
+
+/* Read-only triples stored in a single block, see parseM3_triples_arena() */
+typedef struct _ssTripleArena ssTripleArena_t;
+
+/* Namespace lookup built from a prefix to namespace map, see ssNsTrie_new() */
+typedef struct _ssNsTrie ssNsTrie_t;
+
 typedef struct {
   ssElement_t     string;
   ssElementType_t nodeType; /*never: ssElement_TYPE_BNODE */
@@ -44,6 +44,16 @@
 
 ssBufDesc_t *ssBufDesc_new(void);
 
+/* Allocates a buffer descriptor with room for capacity bytes of message,
+   to avoid reallocations when the final size can be estimated */
+ssBufDesc_t *ssBufDesc_new_sized(guint capacity);
+
+/* Makes sure the buffer can hold capacity bytes without reallocation */
+ssStatus_t ssBufDesc_reserve(ssBufDesc_t *desc, guint capacity);
+
+/* Empties the message but keeps the allocated buffer for reuse */
+void ssBufDesc_reset(ssBufDesc_t *desc);
+
 gchar *ssBufDesc_GetMessage(ssBufDesc_t *desc);
 
 gint ssBufDesc_GetMessageLen(ssBufDesc_t *desc);
@@ -277,11 +287,65 @@ ssStatus_t parseM3_triples_SIB(GSList ** list_pp,
 #define parseM3_triples(list_pp, rdfXMLstr, prefix_uri_map) \
   parseM3_triples_SIB(list_pp, rdfXMLstr, prefix_uri_map, NULL)
 
+/* Like parseM3_triples_SIB(), but with a trie built by ssNsTrie_new(), so
+   that parsing many documents with the same map builds it only once */
+ssStatus_t parseM3_triples_SIB_trie(GSList ** list_pp,
+				    const char * rdfXMLstr,
+				    const ssNsTrie_t *ns_trie,
+				    gchar **bNodeUriList_str);
+
+#define parseM3_triples_trie(list_pp, rdfXMLstr, ns_trie) \
+  parseM3_triples_SIB_trie(list_pp, rdfXMLstr, ns_trie, NULL)
+
+/* Parses triples like parseM3_triples(), but into a single allocated
+   block kept in document order. The triples and their strings are owned
+   by the arena and are freed together by ssTripleArena_free(). */
+ssStatus_t parseM3_triples_arena(ssTripleArena_t **arena,
+				 const char * rdfXMLstr,
+				 const ssNsTrie_t *ns_trie);
+
+guint ssTripleArena_length(const ssTripleArena_t *arena);
+
+const ssTriple_t *ssTripleArena_get(const ssTripleArena_t *arena, guint index);
+
+void ssTripleArena_free(ssTripleArena_t **arena);
+
+/* Parses triples like parseM3_triples(), appending them to batch in
+   document order */
+ssStatus_t parseM3_triples_batch(ssTripleBatch_t *batch,
+				 const char * rdfXMLstr,
+				 const ssNsTrie_t *ns_trie);
+
+/* Called for each triple of a stream parse, in document order. The triple
+   is freed when the callback returns, use ssCopyTriple() to keep it.
+   Returning FALSE stops the parse. */
+typedef gboolean (*ssTripleStreamCB)(const ssTriple_t *triple, gpointer user_data);
+
+typedef struct _ssTripleStream ssTripleStream_t;
+
+/* Starts a triple parse that is fed in chunks with
+   parseM3_triples_stream_feed(), passing each triple to cb as soon as it
+   has been parsed. ns_trie, if not NULL, must outlive the stream. */
+ssTripleStream_t *parseM3_triples_stream_new(const ssNsTrie_t *ns_trie,
+					     ssTripleStreamCB cb,
+					     gpointer user_data);
+
+/* Parses the next len bytes of the document, isFinal is TRUE for the last
+   chunk. Chunks fed after cb has stopped the parse are ignored. */
+ssStatus_t parseM3_triples_stream_feed(ssTripleStream_t *stream,
+				       const gchar *data,
+				       gint len,
+				       gboolean isFinal);
+
+void parseM3_triples_stream_free(ssTripleStream_t **stream);
+
 
 #ifdef SIBUSER_ROLE
 ssStatus_t parseM3_query_cnf_wql(GSList **results, const gchar *response);
 
 ssStatus_t parseM3_query_results_sparql_select(GSList **selectedVariables, GSList **valRows, const gchar *resultXML, const GHashTable *prefix_ns_map);
+
+ssStatus_t parseM3_query_results_sparql_select_trie(GSList **selectedVariables, GSList **valRows, const gchar *resultXML, const ssNsTrie_t *ns_trie);
 #endif /* SIBUSER_ROLE */
 
 #ifdef SIB_ROLE
@@ -508,6 +572,11 @@ ssStatus_t addXML_end   (ssBufDesc_t *desc,
 ssStatus_t addXML_append_str(ssBufDesc_t *desc, 
 			     charStr *str);
 
+/* Appends str of len bytes as a CDATA section, escaping any "]]>" */
+ssStatus_t addXML_append_CDATA(ssBufDesc_t *desc,
+			       const gchar *str,
+			       gint len);
+
 ssStatus_t addXML_queryResultNode (ssBufDesc_t *bD, 
 				   const ssPathNode_t *node);
 
@@ -139,6 +139,13 @@
 #define WHITEBOARD_DBUS_CONTROL_METHOD_REFRESH "refresh"
 #define WHITEBOARD_DBUS_CONTROL_METHOD_GET_DESCRIPTION "get_description"
 #define WHITEBOARD_DBUS_CONTROL_METHOD_HEALTHCHECK "healthcheck"
+/**
+ * Definition of get_stats method. Answered by nodes with statistics export
+ * enabled, see whiteboard_node_set_stats_export(). The reply holds an array
+ * of (name, count, errors, mean, p50, p99, max) with latencies in
+ * microseconds, followed by bytes sent and received: a(stttttt)tt
+ **/
+#define WHITEBOARD_DBUS_CONTROL_METHOD_GET_STATS "get_stats"
 #define WHITEBOARD_DBUS_CONTROL_METHOD_CUSTOM_COMMAND WHITEBOARD_DBUS_METHOD_CUSTOM_COMMAND
 
 /* Signals */
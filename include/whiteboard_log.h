@@ -472,19 +472,152 @@ void whiteboard_log_debug_fb2(const char *called_from);
 
 #else //REALLY CHANGE ALL THIS
 
+#include <dbus/dbus.h>
+
+/**
+ * Sinks the asynchronous log writer delivers records to. Debug, trace and
+ * warning records are formatted on the calling thread into a per-thread
+ * ring buffer and written out by a background thread, so producers never
+ * block on I/O. Records that do not fit into a full ring are dropped and
+ * counted, see whiteboard_log_get_dropped().
+ */
+typedef enum
+{
+	WHITEBOARD_LOG_SINK_GLOG   = 1 << 0, /* g_log() from the writer thread */
+	WHITEBOARD_LOG_SINK_STREAM = 1 << 1, /* stream set with whiteboard_log_set_stream() */
+	WHITEBOARD_LOG_SINK_SYSLOG = 1 << 2, /* syslog(), openlog() is up to the application */
+	WHITEBOARD_LOG_SINK_DBUS   = 1 << 3  /* WHITEBOARD_DBUS_LOG_SIGNAL_MESSAGE signal */
+} WhiteBoardLogSink;
+
+/**
+ * Select the sinks log records are written to. Defaults to
+ * WHITEBOARD_LOG_SINK_GLOG.
+ *
+ * @param sinks Bitwise OR of WhiteBoardLogSink values
+ */
+void whiteboard_log_set_sinks(guint sinks);
+
+/**
+ * Set the stream used by WHITEBOARD_LOG_SINK_STREAM.
+ *
+ * @param stream Stream to write to, NULL for stderr
+ */
+void whiteboard_log_set_stream(FILE *stream);
+
+/**
+ * Set the connection used by WHITEBOARD_LOG_SINK_DBUS.
+ *
+ * @param conn Connection to emit log signals on, NULL to unset
+ */
+void whiteboard_log_set_dbus_connection(DBusConnection *conn);
+
+/**
+ * Write out all records queued so far by every thread. Records are
+ * otherwise written by a background thread within 20 ms. Called
+ * automatically at exit and before whiteboard_log_error() aborts.
+ */
+void whiteboard_log_flush(void);
+
+/**
+ * Get the number of records dropped because a ring buffer was full.
+ *
+ * @return Total number of dropped records
+ */
+guint whiteboard_log_get_dropped(void);
+
+/**
+ * Debug contexts. Each context can be switched on and off at run time
+ * through the WHITEBOARD_LOG_FILTER_ENV environment variable, read once,
+ * or whiteboard_log_set_debug_mask(). The variable holds a comma separated
+ * list of context names, for example
+ * export WHITEBOARD_LOG_FILTER="WHITEBOARD_DEBUG_BASIC,WHITEBOARD_DEBUG_USER_4"
+ * All contexts are enabled when it is not set.
+ */
+typedef enum
+{
+	WHITEBOARD_DEBUG_BEGIN_END,   /* whiteboard_log_debug_fb() and _fe() */
+	WHITEBOARD_DEBUG_BASIC,       /* whiteboard_log_debug() */
+
+	WHITEBOARD_DEBUG_DISCOVER,    /* Reserved for Whiteboard */
+	WHITEBOARD_DEBUG_DBUS,        /* Reserved for Whiteboard */
+	WHITEBOARD_DEBUG_SIB_HANDLER, /* Reserved for Whiteboard */
+	WHITEBOARD_DEBUG_NODE,        /* Reserved for Whiteboard */
+	WHITEBOARD_DEBUG_SIB,         /* Reserved for Whiteboard */
+
+	/* User debug levels */
+	WHITEBOARD_DEBUG_USER_0,
+	WHITEBOARD_DEBUG_USER_1,
+	WHITEBOARD_DEBUG_USER_2,
+	WHITEBOARD_DEBUG_USER_3,
+	WHITEBOARD_DEBUG_USER_4,
+	WHITEBOARD_DEBUG_USER_5,
+	WHITEBOARD_DEBUG_USER_6,
+	WHITEBOARD_DEBUG_USER_7,
+	WHITEBOARD_DEBUG_USER_8,
+	WHITEBOARD_DEBUG_USER_9,
+
+	WHITEBOARD_DEBUG_LAST
+} WhiteBoardDebugContext;
+
+#define WHITEBOARD_LOG_FILTER_ENV "WHITEBOARD_LOG_FILTER"
+
+/* Contexts compiled in; calls for other contexts generate no code.
+   Set with configure --with-debug-contexts=MASK. */
+#ifndef WHITEBOARD_LOG_COMPILED_CONTEXTS
+#define WHITEBOARD_LOG_COMPILED_CONTEXTS 0xffffffffu
+#endif
+
+/* Run time mask of enabled contexts, all bits set until the filter has
+   been read */
+extern volatile gint whiteboard_log_debug_mask;
+
+#define WHITEBOARD_LOG_DEBUG_ENABLED(context) \
+	((WHITEBOARD_LOG_COMPILED_CONTEXTS & (1u << (context))) && \
+	 G_UNLIKELY(whiteboard_log_debug_mask & (1 << (context))))
+
+/**
+ * Set the enabled debug contexts, overriding WHITEBOARD_LOG_FILTER_ENV.
+ *
+ * @param mask Bitwise OR of (1 << WhiteBoardDebugContext) values
+ */
+void whiteboard_log_set_debug_mask(guint mask);
+
+/**
+ * Get the enabled debug contexts.
+ *
+ * @return Bitwise OR of (1 << WhiteBoardDebugContext) values
+ */
+guint whiteboard_log_get_debug_mask(void);
+
 void whiteboard_log_debug2(const gchar *fmt, ...);
+void whiteboard_log_debugc2(WhiteBoardDebugContext context,
+			    const gchar *fmt, ...);
 void whiteboard_log_warning2(const gchar *fmt, ...);
+void whiteboard_log_trace2(const gchar *fmt, ...);
 #if WHITEBOARD_DEBUG==1
-#define whiteboard_log_debug( fmt, ...) whiteboard_log_debug2("%s: %s() (line %u): " fmt ,__FILE__  ,__FUNCTION__ ,__LINE__, ##__VA_ARGS__  )
+#define whiteboard_log_debugc(context, fmt, ...) \
+	do { \
+		if (WHITEBOARD_LOG_DEBUG_ENABLED(context)) \
+			whiteboard_log_debugc2(context, fmt, ##__VA_ARGS__); \
+	} while (0)
+
+#define whiteboard_log_debug( fmt, ...) whiteboard_log_debugc(WHITEBOARD_DEBUG_BASIC, "%s: %s() (line %u): " fmt ,__FILE__  ,__FUNCTION__ ,__LINE__, ##__VA_ARGS__  )
 #define whiteboard_log_warning( fmt, ...) whiteboard_log_warning2("%s: %s() (line %u): " fmt ,__FILE__  ,__FUNCTION__ ,__LINE__, ##__VA_ARGS__  )
   
-#define whiteboard_log_debugc(context, fmt, ...) g_log(G_LOG_DOMAIN, G_LOG_LEVEL_DEBUG, fmt, ##__VA_ARGS__)
-#define whiteboard_log_debug_fb() g_log(G_LOG_DOMAIN, G_LOG_LEVEL_DEBUG, "%s() BEGIN\n", __FUNCTION__)
-#define whiteboard_log_debug_fe()g_log(G_LOG_DOMAIN, G_LOG_LEVEL_DEBUG, "%s() END\n", __FUNCTION__)
+#define whiteboard_log_debug_fb() whiteboard_log_debugc(WHITEBOARD_DEBUG_BEGIN_END, "%s() BEGIN\n", __FUNCTION__)
+#define whiteboard_log_debug_fe() whiteboard_log_debugc(WHITEBOARD_DEBUG_BEGIN_END, "%s() END\n", __FUNCTION__)
 //#define whiteboard_log_warning(fmt, ...) g_log(G_LOG_DOMAIN, G_LOG_LEVEL_WARNING, fmt, ##__VA_ARGS__)
-#define whiteboard_log_error(fmt, ...) g_log(G_LOG_DOMAIN, G_LOG_LEVEL_ERROR, fmt, ##__VA_ARGS__)
-#define whiteboard_log_error_id(id, fmt, ...) g_log(G_LOG_DOMAIN, G_LOG_LEVEL_ERROR, "%s: %s() (line %u): " fmt , __FILE__, __FUNCTION__, __LINE__, ##__VA_ARGS__  ) 
-#define whiteboard_log_trace(fmt, ...) g_log(G_LOG_DOMAIN, G_LOG_LEVEL_INFO, "%s: %s() (line %u): Trace: " fmt , __FILE__, __FUNCTION__, __LINE__, ##__VA_ARGS__  ) 
+#define whiteboard_log_error(fmt, ...) \
+	do { \
+		whiteboard_log_flush(); \
+		g_log(G_LOG_DOMAIN, G_LOG_LEVEL_ERROR, fmt, ##__VA_ARGS__); \
+	} while (0)
+#define whiteboard_log_error_id(id, fmt, ...) \
+	do { \
+		whiteboard_log_flush(); \
+		g_log(G_LOG_DOMAIN, G_LOG_LEVEL_ERROR, "%s: %s() (line %u): " fmt , __FILE__, __FUNCTION__, __LINE__, ##__VA_ARGS__  ); \
+	} while (0)
+#define whiteboard_log_trace(fmt, ...) whiteboard_log_trace2("%s: %s() (line %u): Trace: " fmt , __FILE__, __FUNCTION__, __LINE__, ##__VA_ARGS__  ) 
 
 #else
 
@@ -495,8 +628,16 @@ void whiteboard_log_warning2(const gchar *fmt, ...);
 #define whiteboard_log_warning(fmt, ...)
 
 
-#define whiteboard_log_error(fmt, ...)  g_log(G_LOG_DOMAIN, G_LOG_LEVEL_ERROR, fmt, ##__VA_ARGS__)
-#define whiteboard_log_error_id(id, fmt, ...) g_log(G_LOG_DOMAIN, G_LOG_LEVEL_ERROR, "%s: %s() (line %u): " fmt , __FILE__, __FUNCTION__, __LINE__, ##__VA_ARGS__  ) 
+#define whiteboard_log_error(fmt, ...) \
+	do { \
+		whiteboard_log_flush(); \
+		g_log(G_LOG_DOMAIN, G_LOG_LEVEL_ERROR, fmt, ##__VA_ARGS__); \
+	} while (0)
+#define whiteboard_log_error_id(id, fmt, ...) \
+	do { \
+		whiteboard_log_flush(); \
+		g_log(G_LOG_DOMAIN, G_LOG_LEVEL_ERROR, "%s: %s() (line %u): " fmt , __FILE__, __FUNCTION__, __LINE__, ##__VA_ARGS__  ); \
+	} while (0)
 #define whiteboard_log_trace(fmt, ...)
 #endif
 
@@ -488,6 +488,9 @@ typedef struct _WhiteBoardNode WhiteBoardNode;
 struct _WhiteBoardNodeClass;
 typedef struct _WhiteBoardNodeClass WhiteBoardNodeClass;
 
+struct _WhiteBoardNodeInsertBatch;
+typedef struct _WhiteBoardNodeInsertBatch WhiteBoardNodeInsertBatch;
+
 /*****************************************************************************
  * Source callback prototypes
  *****************************************************************************/
@@ -612,6 +615,17 @@ typedef void (*WhiteBoardNodeSubscriptionIndSPARQLselectCB) (ssStatus_t status,
 							     GSList **valRows_removed,
 							     gpointer userdata);
 
+/**
+ * Type definition for callback that is called when the smartspace has answered an asynchronous insert, update or remove request. Pointer to the callback is given to the library in a corresponding whiteboard_node_sib_access_*_M3Triples_async call.
+ *
+ * @param context The WhiteBoardNode instance the request was made with.
+ * @param status ss_StatusOK (zero) if the operation was successful, otherwise a non-zero ssStatus_t value.
+ * @param userdata pointer to userdata given in the corresponding call.
+ */
+typedef void (*WhiteBoardNodeAsyncCompleteCB) (WhiteBoardNode *context,
+					       ssStatus_t status,
+					       gpointer userdata);
+
 
 /*****************************************************************************
  * Custom command callback types
@@ -718,6 +732,105 @@ GMainContext *whiteboard_node_get_main_context(WhiteBoardNode *self);
  */
 const gchar *whiteboard_node_get_uuid(WhiteBoardNode *self);
 
+/*****************************************************************************
+ * Statistics
+ *****************************************************************************/
+
+/**
+ * Operation kinds a WhiteBoardNode keeps latency statistics for. Queries are
+ * counted per QueryType, from sending the query to receiving its results.
+ */
+typedef enum
+{
+  WHITEBOARD_NODE_STAT_JOIN,
+  WHITEBOARD_NODE_STAT_LEAVE,
+  WHITEBOARD_NODE_STAT_INSERT,
+  WHITEBOARD_NODE_STAT_UPDATE,
+  WHITEBOARD_NODE_STAT_REMOVE,
+  WHITEBOARD_NODE_STAT_SUBSCRIBE,
+  WHITEBOARD_NODE_STAT_QUERY_TEMPLATE,
+  WHITEBOARD_NODE_STAT_QUERY_WQL_VALUES,
+  WHITEBOARD_NODE_STAT_QUERY_WQL_NODETYPES,
+  WHITEBOARD_NODE_STAT_QUERY_WQL_RELATED,
+  WHITEBOARD_NODE_STAT_QUERY_WQL_ISTYPE,
+  WHITEBOARD_NODE_STAT_QUERY_WQL_ISSUBTYPE,
+  WHITEBOARD_NODE_STAT_QUERY_SPARQL_SELECT,
+  WHITEBOARD_NODE_STAT_INDICATION, /* subscription indications handled */
+  WHITEBOARD_NODE_STAT_LAST
+} WhiteBoardNodeStatKind;
+
+/* Log-linear buckets with 8 sub-buckets per power of two, covering
+   0 .. 2^32 microseconds with a relative error below 12.5% */
+#define WHITEBOARD_NODE_HISTOGRAM_SUB_BITS 3
+#define WHITEBOARD_NODE_HISTOGRAM_BUCKETS ((32 - WHITEBOARD_NODE_HISTOGRAM_SUB_BITS + 1) << WHITEBOARD_NODE_HISTOGRAM_SUB_BITS)
+
+/**
+ * Latency histogram, values in microseconds.
+ */
+typedef struct _WhiteBoardNodeHistogram
+{
+  guint64 count;
+  guint64 errors;   /* operations that did not return ss_StatusOK */
+  guint64 total_us;
+  guint64 max_us;
+  guint32 buckets[WHITEBOARD_NODE_HISTOGRAM_BUCKETS];
+} WhiteBoardNodeHistogram;
+
+/**
+ * Snapshot of the statistics of a WhiteBoardNode.
+ */
+typedef struct _WhiteBoardNodeStats
+{
+  WhiteBoardNodeHistogram ops[WHITEBOARD_NODE_STAT_LAST];
+  WhiteBoardNodeHistogram parse;     /* parsing of query and indication results */
+  WhiteBoardNodeHistogram xml_build; /* generating request XML */
+  guint64 bytes_out; /* SSAP payload sent */
+  guint64 bytes_in;  /* SSAP payload received */
+} WhiteBoardNodeStats;
+
+/**
+ * Get a consistent copy of the statistics of a node.
+ *
+ * @param self A WhiteBoardNode instance
+ * @param stats Filled with the statistics
+ */
+void whiteboard_node_get_stats(WhiteBoardNode *self, WhiteBoardNodeStats *stats);
+
+/**
+ * Clear the statistics of a node.
+ *
+ * @param self A WhiteBoardNode instance
+ */
+void whiteboard_node_reset_stats(WhiteBoardNode *self);
+
+/**
+ * Answer WHITEBOARD_DBUS_CONTROL_METHOD_GET_STATS calls with the statistics
+ * of this node. Disabled by default.
+ *
+ * @param self A WhiteBoardNode instance
+ * @param enable TRUE to answer, FALSE to reply with an error
+ */
+void whiteboard_node_set_stats_export(WhiteBoardNode *self, gboolean enable);
+
+/**
+ * Get the name of an operation kind, as used in the D-Bus statistics.
+ *
+ * @param kind A WhiteBoardNodeStatKind
+ * @return A static string, NULL for an invalid kind
+ */
+const gchar *whiteboard_node_stat_name(WhiteBoardNodeStatKind kind);
+
+/**
+ * Estimate a percentile of a histogram.
+ *
+ * @param h A histogram from WhiteBoardNodeStats
+ * @param percentile 0.0 .. 100.0
+ * @return Lower bound of the bucket holding the percentile in microseconds,
+ * 0 for an empty histogram
+ */
+guint64 whiteboard_node_histogram_percentile(const WhiteBoardNodeHistogram *h,
+					     gdouble percentile);
+
 /*****************************************************************************
  * SIB ACCESS functions
  *****************************************************************************/
@@ -826,6 +939,44 @@ ssStatus_t whiteboard_node_sib_access_remove_graph(WhiteBoardNode *self,
 					     gchar *graph,
 					     EncodingType encoding);
 
+/**
+ * Insert triples from a triple batch into the smartspace the node is currently joined to. As whiteboard_node_sib_access_insert_M3Triples(), but the message is generated directly from the batch.
+ *
+ * @param self A WhiteBoardNode instance
+ * @param triples Batch of triples to insert (Blank Nodes allowed, Wildcards not allowed)
+ * @param nameSpace NULL if no namespace, else one or more namespaces corresponding to prefixes used in the the triple element strings
+ * @return ss_StatusOK (zero) if the operation was successful, otherwise a non-zero ssStatus_t value.
+ */
+ssStatus_t whiteboard_node_sib_access_insert_TripleBatch(WhiteBoardNode *self,
+							 const ssTripleBatch_t *triples,
+							 const gchar *nameSpace);
+
+/**
+ * Update information in the smartspace the node is currently joined to from triple batches. As whiteboard_node_sib_access_update_M3Triples().
+ *
+ * @param self A WhiteBoardNode instance
+ * @param insert_triples Batch of triples to add, or NULL (Blank Nodes allowed, Wildcards not allowed)
+ * @param remove_triples Batch of triples to remove, or NULL (Blank Nodes not allowed, Wildcards allowed)
+ * @param nameSpace NULL if no namespace, else one or more namespaces corresponding to prefixes used in the the triple element strings
+ * @return ss_StatusOK (zero) if the operation was successful, otherwise a non-zero ssStatus_t value.
+ */
+ssStatus_t whiteboard_node_sib_access_update_TripleBatch(WhiteBoardNode *self,
+							 const ssTripleBatch_t *insert_triples,
+							 const ssTripleBatch_t *remove_triples,
+							 const gchar *nameSpace);
+
+/**
+ * Remove triples of a triple batch from the smartspace the node is currently joined to. As whiteboard_node_sib_access_remove_M3Triples().
+ *
+ * @param self A WhiteBoardNode instance
+ * @param triples Batch of triples to remove
+ * @param nameSpace NULL if no namespace, else one or more namespaces corresponding to prefixes used in the the triple element strings
+ * @return ss_StatusOK (zero) if the operation was successful, otherwise a non-zero ssStatus_t value.
+ */
+ssStatus_t whiteboard_node_sib_access_remove_TripleBatch(WhiteBoardNode *self,
+							 const ssTripleBatch_t *triples,
+							 const gchar *nameSpace);
+
 
 /**
  * Query smartspace the node is joined to. This is asynchronous. 
@@ -1018,6 +1169,241 @@ ssStatus_t whiteboard_node_sib_access_query_wql_isSubclass(WhiteBoardNode *self,
  */
 ssStatus_t whiteboard_node_sib_access_unsubscribe(WhiteBoardNode *self, gint subscription_id);
 
+/*****************************************************************************
+ * Asynchronous SIB ACCESS functions
+ *
+ * These send the request and return without waiting for the WhiteBoard
+ * daemon to answer, so that several requests can be in flight at the same
+ * time. The result is delivered to the callback from the GMainContext of the
+ * node. A non-zero return value means the request was not sent and the
+ * callback will not be called.
+ *****************************************************************************/
+
+/**
+ * Asynchronous version of whiteboard_node_sib_access_insert_M3Triples.
+ *
+ * @param self A WhiteBoardNode instance
+ * @param triples Pointer to the list of triples to insert (Blank Nodes allowed, Wildcards not allowed)
+ * @param nameSpace NULL if no namespace, else one or more namespaces corresponding to prefixes used in the the triple element strings
+ * @param cb Pointer to the callback function that is called when the insert has been answered, NULL if none.
+ * @param data Pointer to user data for the callback function, NULL if none.
+ * @return ss_StatusOK (zero) if the request was sent, otherwise a non-zero ssStatus_t value.
+ */
+ssStatus_t whiteboard_node_sib_access_insert_M3Triples_async(WhiteBoardNode *self,
+							     GSList *triples,
+							     const gchar *nameSpace,
+							     WhiteBoardNodeAsyncCompleteCB cb,
+							     gpointer data);
+
+/**
+ * Asynchronous version of whiteboard_node_sib_access_update_M3Triples.
+ *
+ * @param self A WhiteBoardNode instance
+ * @param add_triples Pointer to the list of triples to add (Blank Nodes allowed, Wildcards not allowed)
+ * @param remove_triples Pointer to the list of triples to remove (Blank Nodes not allowed, Wildcards allowed)
+ * @param nameSpace NULL if no namespace, else one or more namespaces corresponding to prefixes used in the the triple element strings
+ * @param cb Pointer to the callback function that is called when the update has been answered, NULL if none.
+ * @param data Pointer to user data for the callback function, NULL if none.
+ * @return ss_StatusOK (zero) if the request was sent, otherwise a non-zero ssStatus_t value.
+ */
+ssStatus_t whiteboard_node_sib_access_update_M3Triples_async(WhiteBoardNode *self,
+							     GSList *add_triples,
+							     GSList *remove_triples,
+							     const gchar *nameSpace,
+							     WhiteBoardNodeAsyncCompleteCB cb,
+							     gpointer data);
+
+/**
+ * Asynchronous version of whiteboard_node_sib_access_remove_M3Triples.
+ *
+ * @param self A WhiteBoardNode instance
+ * @param triples Pointer to the list of triples to remove (Blank Nodes not allowed, Wildcards allowed)
+ * @param nameSpace NULL if no namespace, else one or more namespaces corresponding to prefixes used in the the triple element strings
+ * @param cb Pointer to the callback function that is called when the remove has been answered, NULL if none.
+ * @param data Pointer to user data for the callback function, NULL if none.
+ * @return ss_StatusOK (zero) if the request was sent, otherwise a non-zero ssStatus_t value.
+ */
+ssStatus_t whiteboard_node_sib_access_remove_M3Triples_async(WhiteBoardNode *self,
+							     GSList *triples,
+							     const gchar *nameSpace,
+							     WhiteBoardNodeAsyncCompleteCB cb,
+							     gpointer data);
+
+/**
+ * Asynchronous version of whiteboard_node_sib_access_query_template. If the query can not be created in the smartspace, cb is called with a non-zero status and no results.
+ *
+ * @param self A WhiteBoardNode instance
+ * @param templates Pointer to the list of template triples to be matched (Blank Nodes not allowed, Wildcards allowed)
+ * @param nameSpace NULL if no namespace, else one or more namespaces corresponding to prefixes used in the the triple element strings
+ * @param cb Pointer to the callback function that is called when results for the query have been received.
+ * @param data Pointer to user data for the callback function, NULL if none.
+ * @return ss_StatusOK (zero) if the request was sent, otherwise a non-zero ssStatus_t value.
+ */
+ssStatus_t whiteboard_node_sib_access_query_template_async(WhiteBoardNode *self,
+							   GSList* templates,
+							   const gchar *nameSpace,
+							   WhiteBoardNodeQueryTemplateCB cb,
+							   gpointer data);
+
+/**
+ * Asynchronous version of whiteboard_node_sib_access_query_sparql_select. If the query can not be created in the smartspace, cb is called with a non-zero status and no results.
+ *
+ * @param self A WhiteBoardNode instance
+ * @param select Pointer to a list of pointers to the selected variables.
+ * @param where Pointer to a list of pointers to triples of path nodes that must be matched.
+ * @param optional_lists Pointer to a list of pointers to a list of pointers to path nodes. NULL if no optional lists.
+ * @param nameSpace NULL if no namespace, else one or more namespaces corresponding to prefixes used in the the triple element strings
+ * @param cb Pointer to the callback function that is called when results for the query have been received.
+ * @param data Pointer to user data for the callback function, NULL if none.
+ * @return ss_StatusOK (zero) if the request was sent, otherwise a non-zero ssStatus_t value.
+ */
+ssStatus_t whiteboard_node_sib_access_query_sparql_select_async(WhiteBoardNode *self,
+								GSList* select,
+								GSList* where,
+								GSList* optional_lists,
+								const gchar *nameSpace,
+								WhiteBoardNodeQuerySPARQLselectCB cb,
+								gpointer data);
+
+/**
+ * Asynchronous version of whiteboard_node_sib_access_query_wql_values.
+ *
+ * @param self A WhiteBoardNode instance
+ * @param node Pointer to the ssPathNode_t structure specifying the starting node for the WQL-values query.
+ * @param pathExpr Pointer to the string containing the path expression for the WQL-values query
+ * @param cb Pointer to the callback function that is called when results for the query have been received.
+ * @param data Optional pointer to user data for the callback function.
+ * @return ss_StatusOK (zero) if the request was sent, otherwise a non-zero ssStatus_t value.
+ */
+ssStatus_t whiteboard_node_sib_access_query_wql_values_async(WhiteBoardNode *self,
+							     const ssPathNode_t *node,
+							     const gchar *pathExpr,
+							     WhiteBoardNodeQueryWQLnodelistCB cb,
+							     gpointer data);
+
+/**
+ * Asynchronous version of whiteboard_node_sib_access_query_wql_related.
+ *
+ * @param self A WhiteBoardNode instance
+ * @param startNode Pointer to the ssPathNode_t structure specifying the start node.
+ * @param pathExpr Pointer to the string containing the path expression.
+ * @param endNode Pointer to the ssPathNode_t structure specifying the end node.
+ * @param cb Pointer to the callback function that is called when results for the query have been received.
+ * @param data Optional pointer to user data for the callback function.
+ * @return ss_StatusOK (zero) if the request was sent, otherwise a non-zero ssStatus_t value.
+ */
+ssStatus_t whiteboard_node_sib_access_query_wql_related_async(WhiteBoardNode *self,
+							      const ssPathNode_t *startNode,
+							      const gchar *pathExpr,
+							      const ssPathNode_t *endNode,
+							      WhiteBoardNodeQSCommonWQLbooleanCB cb,
+							      gpointer data);
+
+/**
+ * Asynchronous version of whiteboard_node_sib_access_query_wql_nodeClasses.
+ *
+ * @param self A WhiteBoardNode instance
+ * @param pathNode Pointer to the ssPathNode_t structure specifying the node whose classes are queried.
+ * @param cb Pointer to the callback function that is called when results for the query have been received.
+ * @param data Optional pointer to user data for the callback function.
+ * @return ss_StatusOK (zero) if the request was sent, otherwise a non-zero ssStatus_t value.
+ */
+ssStatus_t whiteboard_node_sib_access_query_wql_nodeClasses_async(WhiteBoardNode *self,
+								  const ssPathNode_t *pathNode,
+								  WhiteBoardNodeQueryWQLnodelistCB cb,
+								  gpointer data);
+
+/**
+ * Asynchronous version of whiteboard_node_sib_access_query_wql_ofClass.
+ *
+ * @param self A WhiteBoardNode instance
+ * @param pathNode Pointer to the ssPathNode_t structure specifying the node.
+ * @param classNode Pointer to the ssPathNode_t structure specifying the class.
+ * @param cb Pointer to the callback function that is called when results for the query have been received.
+ * @param data Optional pointer to user data for the callback function.
+ * @return ss_StatusOK (zero) if the request was sent, otherwise a non-zero ssStatus_t value.
+ */
+ssStatus_t whiteboard_node_sib_access_query_wql_ofClass_async(WhiteBoardNode *self,
+							      const ssPathNode_t *pathNode,
+							      const ssPathNode_t *classNode,
+							      WhiteBoardNodeQSCommonWQLbooleanCB cb,
+							      gpointer data);
+
+/**
+ * Asynchronous version of whiteboard_node_sib_access_query_wql_isSubclass.
+ *
+ * @param self A WhiteBoardNode instance
+ * @param subclass Pointer to the ssPathNode_t structure specifying the subclass reference.
+ * @param superclass Pointer to the ssPathNode_t structure specifying the superclass reference.
+ * @param cb Pointer to the callback function that is called when results for the query have been received.
+ * @param data Optional pointer to user data for the callback function.
+ * @return ss_StatusOK (zero) if the request was sent, otherwise a non-zero ssStatus_t value.
+ */
+ssStatus_t whiteboard_node_sib_access_query_wql_isSubclass_async(WhiteBoardNode *self,
+								 const ssPathNode_t *subclass,
+								 const ssPathNode_t *superclass,
+								 WhiteBoardNodeQSCommonWQLbooleanCB cb,
+								 gpointer data);
+
+/*****************************************************************************
+ * Batched insert
+ *
+ * An insert batch collects the triples of many small inserts into one
+ * triple list which is sent to the smartspace as a single asynchronous
+ * insert request. The batch is sent when it holds max_triples triples or
+ * max_bytes bytes of generated XML, when max_delay milliseconds have passed
+ * since the first triple was added to it, or when it is flushed explicitly.
+ *****************************************************************************/
+
+/**
+ * Create a new insert batch for a node.
+ *
+ * @param self A WhiteBoardNode instance
+ * @param nameSpace NULL if no namespace, else one or more namespaces corresponding to prefixes used in the triple element strings of all appended triples
+ * @param max_triples Number of triples that causes the batch to be sent, zero for no limit.
+ * @param max_bytes Size of the generated triple list in bytes that causes the batch to be sent, zero for no limit.
+ * @param max_delay Maximum time in milliseconds the first triple of the batch waits before the batch is sent, zero for no limit. The timer runs in the GMainContext of the node.
+ * @param cb Pointer to the callback function that is called when an insert sent from the batch has been answered, NULL if none.
+ * @param data Pointer to user data for the callback function, NULL if none.
+ * @return New batch or NULL if the namespace could not be parsed. Free with whiteboard_node_insert_batch_free().
+ */
+WhiteBoardNodeInsertBatch *whiteboard_node_insert_batch_new(WhiteBoardNode *self,
+							    const gchar *nameSpace,
+							    guint max_triples,
+							    gsize max_bytes,
+							    guint max_delay,
+							    WhiteBoardNodeAsyncCompleteCB cb,
+							    gpointer data);
+
+/**
+ * Append triples to an insert batch. The triples are converted to XML
+ * immediately, so the list may be freed after the call. Either all or none
+ * of the triples are appended. If a limit of the batch is reached, the batch
+ * is sent before returning.
+ *
+ * @param batch An insert batch
+ * @param triples Pointer to the list of triples to insert (Blank Nodes allowed, Wildcards not allowed)
+ * @return ss_StatusOK (zero) if the triples were appended (and a possible send succeeded), otherwise a non-zero ssStatus_t value.
+ */
+ssStatus_t whiteboard_node_insert_batch_append(WhiteBoardNodeInsertBatch *batch,
+					       GSList *triples);
+
+/**
+ * Send the triples collected in an insert batch, if any.
+ *
+ * @param batch An insert batch
+ * @return ss_StatusOK (zero) if the batch was empty or the insert request was sent, otherwise a non-zero ssStatus_t value. The collected triples are dropped also on failure.
+ */
+ssStatus_t whiteboard_node_insert_batch_flush(WhiteBoardNodeInsertBatch *batch);
+
+/**
+ * Flush and free an insert batch.
+ *
+ * @param batch An insert batch
+ * @return Status of the final flush.
+ */
+ssStatus_t whiteboard_node_insert_batch_free(WhiteBoardNodeInsertBatch *batch);
+
 /*****************************************************************************
  * Utilities
  *****************************************************************************/
@@ -1073,6 +1459,181 @@ void ssFreePathNodeList (GSList **pathNodeList);
  */
 void ssFreePathNode( ssPathNode_t *pathNode);
 
+/**
+ * Create a term dictionary. A dictionary keeps a single copy of each distinct element string interned to it, so that triples repeating the same subjects, predicates and objects share their strings and equal interned strings can be compared by pointer. A dictionary is not thread safe.
+ *
+ * @return new dictionary, to be freed with ssTermDict_free().
+ */
+ssTermDict_t *ssTermDict_new(void);
+
+/**
+ * Free a term dictionary and all strings interned to it.
+ *
+ * @param dict Pointer to pointer of dictionary to free; set NULL upon return.
+ */
+void ssTermDict_free(ssTermDict_t **dict);
+
+/**
+ * Intern a string.
+ *
+ * @param dict Dictionary.
+ * @param term String to intern. NULL and ssMATCH_ANY are returned as such.
+ * @return the dictionary's copy of term, valid until the dictionary is freed. Interning equal strings returns the same pointer.
+ */
+ssElement_ct ssTermDict_intern(ssTermDict_t *dict, ssElement_ct term);
+
+/**
+ * Replace the strings of a triple, e.g. one parsed from a subscription result, with interned strings. The original strings are freed with g_free(). Afterwards the triple must not be freed with ssFreeTriple().
+ *
+ * @param dict Dictionary.
+ * @param triple Triple with strings allocated from the g-heap.
+ * @return ssStatus_t.
+ */
+ssStatus_t ssTermDict_intern_triple(ssTermDict_t *dict, ssTriple_t *triple);
+
+/**
+ * Create new triple with interned strings and prepend it to triple list. As ssPrependTriple(), but the strings are interned to dict instead of duplicated.
+ * @return ssStatus_t.
+ */
+ssStatus_t ssTermDict_prepend_triple(ssTermDict_t *dict, GSList **currentList, ssElement_ct subject, ssElement_ct predicate, ssElement_ct object,
+				     ssElementType_t subjType, ssElementType_t objType);
+
+/**
+ * Free a list of triples whose strings are interned, leaving the strings to their dictionary.
+ *
+ * @param tripleList Pointer to pointer of list to free; set NULL upon return.
+ */
+void ssFreeInternedTripleList (GSList **tripleList);
+
+/**
+ * Create a refcounted element string. Terms can be shared by any number of shared triples, see ssTriple_new_shared().
+ *
+ * @param str String to copy. NULL and ssMATCH_ANY are returned as such.
+ * @return new term with one reference, to be released with ssTerm_unref().
+ */
+ssElement_t ssTerm_new(ssElement_ct str);
+
+/**
+ * Take a reference of a term.
+ *
+ * @param term Term created with ssTerm_new().
+ * @return term.
+ */
+ssElement_t ssTerm_ref(ssElement_t term);
+
+/**
+ * Release a reference of a term, freeing it with the last one.
+ *
+ * @param term Term created with ssTerm_new().
+ */
+void ssTerm_unref(ssElement_t term);
+
+/**
+ * Create a shared triple. A shared triple is an immutable, refcounted ssTriple_t that can be put in the triple lists of any number of consumers and passed to all functions taking triples. ssCopyTriple() returns a new reference of a shared triple instead of a deep copy, and ssFreeTriple() and ssFreeTripleList() release a reference. The subjType of a shared triple has ssElement_TYPE_SHARED set; read it with ssElementType().
+ *
+ * @param subject Term created with ssTerm_new(), or ssMATCH_ANY. The triple takes a reference of each term.
+ * @param predicate Term created with ssTerm_new(), or ssMATCH_ANY.
+ * @param object Term created with ssTerm_new(), or ssMATCH_ANY.
+ * @param subjType Subject type
+ * @param objType Object type
+ * @return new shared triple with one reference.
+ */
+ssTriple_t *ssTriple_new_shared(ssElement_t subject, ssElement_t predicate, ssElement_t object,
+				ssElementType_t subjType, ssElementType_t objType);
+
+/**
+ * Turn a triple, e.g. one received in subscription or query results, into a shared triple. The original triple is freed.
+ *
+ * @param triple Triple allocated as by ssPrependTriple(). A shared triple is returned as such.
+ * @return shared triple replacing triple.
+ */
+ssTriple_t *ssTriple_share(ssTriple_t *triple);
+
+/**
+ * Turn all triples of a list into shared triples in place, see ssTriple_share().
+ *
+ * @param tripleList List of triples.
+ */
+void ssTripleList_share(GSList *tripleList);
+
+/**
+ * Take a reference of a shared triple.
+ *
+ * @param triple Shared triple.
+ * @return triple.
+ */
+ssTriple_t *ssTriple_ref(ssTriple_t *triple);
+
+/**
+ * Release a reference of a shared triple, freeing it and releasing its terms with the last one.
+ *
+ * @param triple Shared triple.
+ */
+void ssTriple_unref(ssTriple_t *triple);
+
+/**
+ * Check whether a triple is a shared triple.
+ *
+ * @param triple Triple.
+ * @return TRUE if triple was created with ssTriple_new_shared() or ssTriple_share().
+ */
+gboolean ssTriple_is_shared(const ssTriple_t *triple);
+
+/**
+ * Create a triple batch. A batch stores triples by column: the element strings of all triples are kept in one string heap and each triple takes only three offsets and two type bytes, so that large sets of triples can be built, iterated and passed to whiteboard_node_sib_access_insert_TripleBatch() and similar functions without per-triple allocations.
+ *
+ * @param capacity number of triples to allocate space for, the batch grows as needed.
+ * @return new batch, to be freed with ssTripleBatch_free().
+ */
+ssTripleBatch_t *ssTripleBatch_new(guint capacity);
+
+/**
+ * Free a triple batch.
+ *
+ * @param batch Pointer to pointer of batch to free; set NULL upon return.
+ */
+void ssTripleBatch_free(ssTripleBatch_t **batch);
+
+/**
+ * Remove all triples from a batch, keeping its allocated space for reuse.
+ *
+ * @param batch Batch to clear.
+ */
+void ssTripleBatch_clear(ssTripleBatch_t *batch);
+
+/**
+ * Append a triple to a batch. The strings are copied into the batch. Arguments are as for ssPrependTriple().
+ * @return ssStatus_t.
+ */
+ssStatus_t ssTripleBatch_append(ssTripleBatch_t *batch, ssElement_ct subject, ssElement_ct predicate, ssElement_ct object,
+				ssElementType_t subjType, ssElementType_t objType);
+
+/**
+ * Get the number of triples in a batch.
+ *
+ * @param batch Batch.
+ * @return number of triples.
+ */
+guint ssTripleBatch_length(const ssTripleBatch_t *batch);
+
+/**
+ * Get the total size of the element strings of a batch.
+ *
+ * @param batch Batch.
+ * @return size in bytes, including the terminating zeros.
+ */
+guint ssTripleBatch_strings_size(const ssTripleBatch_t *batch);
+
+/**
+ * Get a triple of a batch.
+ *
+ * @param batch Batch.
+ * @param index Index of the triple, less than ssTripleBatch_length().
+ * @param triple Structure to fill. Its strings belong to the batch and remain valid until the batch is changed or freed; the triple must not be freed with ssFreeTriple().
+ * @return ssStatus_t.
+ */
+ssStatus_t ssTripleBatch_get(const ssTripleBatch_t *batch, guint index, ssTriple_t *triple);
+
 /**
  * Create a prefix to namespace hash table
  *
@@ -1109,6 +1670,31 @@ gchar *fullUri (const gchar *s, int sLen, GHashTable *prefix2ns_map);
  * @return none.
  */
 void nsLocal2prefixLocal (ssElement_t *g_heap_str, GHashTable *prefix2ns_map);
+
+/**
+ * Build a namespace lookup for replacing many uris with nsLocal2prefixLocal_trie().
+ *
+ * @param prefix2ns_map a GHashTable returned by new_prefix2ns_map(). The trie refers to the prefixes of the table, so the table must not be changed or freed before the trie.
+ * @return the trie, to be freed with ssNsTrie_free().
+ */
+ssNsTrie_t *ssNsTrie_new (GHashTable *prefix2ns_map);
+
+/**
+ * Free a trie returned by ssNsTrie_new().
+ *
+ * @param ns_trie the trie, may be NULL.
+ * @return none.
+ */
+void ssNsTrie_free (ssNsTrie_t *ns_trie);
+
+/**
+ * Replace full uri string with prefixed name, like nsLocal2prefixLocal(), using the longest matching namespace.
+ *
+ * @param g_heap_str address to pointer of uri string allocated from the g-heap, replaced as by nsLocal2prefixLocal().
+ * @param ns_trie a trie returned by ssNsTrie_new()
+ * @return none.
+ */
+void nsLocal2prefixLocal_trie (ssElement_t *g_heap_str, const ssNsTrie_t *ns_trie);
 G_END_DECLS
 
 #endif
@@ -0,0 +1,137 @@
+/*
+
+  Copyright (c) 2009, Nokia Corporation
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.  
+    * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in
+    the documentation and/or other materials provided with the
+    distribution.  
+    * Neither the name of Nokia nor the names of its contributors 
+    may be used to endorse or promote products derived from this 
+    software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+  EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+/*
+ * Whiteboard Library
+ *
+ * whiteboard_trace.h
+ *
+ * Copyright 2009 Nokia Corporation
+ */
+
+#ifndef WHITEBOARD_TRACE_H
+#define WHITEBOARD_TRACE_H
+
+#include <glib.h>
+
+/* Environment variable naming the file traces are written to */
+#define WHITEBOARD_TRACE_FILE_ENV "WHITEBOARD_TRACE_FILE"
+
+/* First bytes of a trace file, followed by a WhiteBoardTraceHeader */
+#define WHITEBOARD_TRACE_MAGIC "WBTRACE"
+#define WHITEBOARD_TRACE_VERSION 1
+
+/**
+ * Points in the lifecycle of an SSAP message where a trace record is
+ * written.
+ */
+typedef enum
+{
+	WHITEBOARD_TRACE_XML_BUILD_START = 1,
+	WHITEBOARD_TRACE_XML_BUILD_END,
+	WHITEBOARD_TRACE_DBUS_SEND,
+	WHITEBOARD_TRACE_REPLY_RECEIVED,
+	WHITEBOARD_TRACE_PARSE_START,
+	WHITEBOARD_TRACE_PARSE_END,
+	WHITEBOARD_TRACE_DISPATCH_START,
+	WHITEBOARD_TRACE_DISPATCH_END,
+	WHITEBOARD_TRACE_EVENT_LAST
+} WhiteBoardTraceEvent;
+
+/**
+ * Trace file header. Fields are in host byte order.
+ */
+typedef struct _WhiteBoardTraceHeader
+{
+	gchar magic[8];      /* WHITEBOARD_TRACE_MAGIC, NUL padded */
+	guint32 version;     /* WHITEBOARD_TRACE_VERSION */
+	guint32 record_size; /* sizeof(WhiteBoardTraceRecord) */
+} WhiteBoardTraceHeader;
+
+/**
+ * One trace record. Fields are in host byte order.
+ */
+typedef struct _WhiteBoardTraceRecord
+{
+	guint64 timestamp;   /* monotonic clock, nanoseconds */
+	guint32 thread;      /* small per-process thread number */
+	gint32 msgnumber;    /* SSAP message number, -1 if not known */
+	gint32 access_id;    /* query/subscription access id, -1 if not known */
+	guint16 event;       /* WhiteBoardTraceEvent */
+	guint16 reserved;
+	guint32 bytes;       /* payload size, 0 if not applicable */
+	guint32 reserved2;
+} WhiteBoardTraceRecord;
+
+/* > 0 when tracing, < 0 until WHITEBOARD_TRACE_FILE_ENV has been read */
+extern volatile gint whiteboard_trace_enabled;
+
+/**
+ * Write a trace record if tracing is enabled. Arguments are not evaluated
+ * otherwise.
+ *
+ * @param event WhiteBoardTraceEvent
+ * @param msgnumber SSAP message number or -1
+ * @param access_id Access id or -1
+ * @param bytes Payload size or 0
+ */
+#define whiteboard_trace(event, msgnumber, access_id, bytes) \
+	do { \
+		if (G_UNLIKELY(whiteboard_trace_enabled)) \
+			whiteboard_trace_emit(event, msgnumber, access_id, bytes); \
+	} while (0)
+
+void whiteboard_trace_emit(WhiteBoardTraceEvent event, gint msgnumber,
+			   gint access_id, guint bytes);
+
+/**
+ * Start writing trace records to a file, replacing a file opened earlier.
+ * Tracing is started automatically if WHITEBOARD_TRACE_FILE_ENV is set.
+ *
+ * @param filename File to write to, truncated
+ * @return TRUE on success
+ */
+gboolean whiteboard_trace_open(const gchar *filename);
+
+/**
+ * Stop tracing and close the trace file, writing out the records still
+ * buffered by all threads first.
+ */
+void whiteboard_trace_close(void);
+
+/**
+ * Write out the records buffered by all threads. Also done at exit.
+ */
+void whiteboard_trace_flush(void);
+
+#endif /* WHITEBOARD_TRACE_H */
@@ -52,6 +52,18 @@
  * Type definitions
  *****************************************************************************/
 
+/* Handler of one (message type, interface, member) combination */
+typedef struct _WhiteBoardUtilDispatchEntry WhiteBoardUtilDispatchEntry;
+struct _WhiteBoardUtilDispatchEntry
+{
+	gint type;
+	const gchar *interface;
+	const gchar *member;
+	DBusObjectPathMessageFunction handler;
+};
+
+typedef struct _WhiteBoardUtilDispatchTable WhiteBoardUtilDispatchTable;
+
 /*****************************************************************************
  * Macros
  *****************************************************************************/
@@ -62,6 +74,10 @@
 
 #define WHITEBOARD_UTIL_PID_DIR "/tmp/"
 
+/* Environment variable holding the initial fd payload threshold in bytes,
+   see whiteboard_util_set_fd_payload_threshold() */
+#define WHITEBOARD_UTIL_FD_PAYLOAD_ENV "WHITEBOARD_FD_PAYLOAD_THRESHOLD"
+
 /*****************************************************************************
  * Miscellaneous utility functions
  *****************************************************************************/
@@ -139,8 +155,117 @@ gboolean whiteboard_util_send_message(const gchar *destination,const gchar *path
 				    dbus_uint32_t *serial,
 				    gint first_argument_type, ...);
 
+/**
+ * Build a hashed message dispatch table, normally once in class_init.
+ * The interface and member strings are not copied and must stay valid
+ * for the lifetime of the table.
+ *
+ * @param entries Array of entries terminated by one with a NULL handler
+ * @return New dispatch table
+ */
+WhiteBoardUtilDispatchTable *whiteboard_util_dispatch_table_new(const WhiteBoardUtilDispatchEntry *entries);
+
+/**
+ * Find the handler of a message by its type, interface and member.
+ *
+ * @param table Dispatch table
+ * @param msg DBus message pointer
+ * @return Handler function or NULL if none is registered
+ */
+DBusObjectPathMessageFunction whiteboard_util_dispatch_table_lookup(WhiteBoardUtilDispatchTable *table,
+								    DBusMessage *msg);
+
+/**
+ * Put a connection into corked mode. Messages sent on it without waiting
+ * for a reply (signals, method returns, plain method calls) are only
+ * queued, and written out together from an idle callback in the given
+ * main context or by whiteboard_util_flush(). Otherwise every such
+ * message is flushed to the socket right away.
+ *
+ * Connections registered with whiteboard_util_register_try() and
+ * whiteboard_util_register_sib_try() are corked on their main context.
+ *
+ * @param conn DBus connection pointer
+ * @param context Main context for the idle flush, NULL to flush only
+ * with whiteboard_util_flush()
+ */
+void whiteboard_util_cork(DBusConnection *conn, GMainContext *context);
+
+/**
+ * Flush a corked connection and return it to flushing every message.
+ *
+ * @param conn DBus connection pointer
+ */
+void whiteboard_util_uncork(DBusConnection *conn);
+
+/**
+ * Write out all messages queued on a connection now, cancelling a
+ * pending idle flush.
+ *
+ * @param conn DBus connection pointer
+ */
+void whiteboard_util_flush(DBusConnection *conn);
+
+/**
+ * Set the size above which string arguments of messages sent with
+ * whiteboard_util_send_message() and whiteboard_util_send_method_async()
+ * are shipped in a sealed memory file instead of the message body. Only
+ * the file descriptor and the string length travel over D-Bus, and
+ * whiteboard_util_parse_message() maps the string back transparently on
+ * the receiving side. The side channel is used only on connections that
+ * can pass unix file descriptors.
+ *
+ * The initial value is read from WHITEBOARD_UTIL_FD_PAYLOAD_ENV.
+ *
+ * @param threshold Payload size in bytes, 0 disables the side channel
+ */
+void whiteboard_util_set_fd_payload_threshold(gint threshold);
+
+/**
+ * Get the current fd payload threshold.
+ *
+ * @return Payload size in bytes, 0 if the side channel is disabled
+ */
+gint whiteboard_util_get_fd_payload_threshold();
+
+/**
+ * Utility function to send a dbus method call with arbitrary argument list
+ * without waiting for the reply. The notify function is called from the
+ * main context the connection has been set up with, when the reply arrives
+ * or the call times out (WHITEBOARD_SEND_TIMEOUT). If the reply has
+ * already been dispatched by the time the call returns, notify is called
+ * before returning, from the calling thread.
+ *
+ * In variable argument list last "type" argument must be WHITEBOARD_UTIL_LIST_END.
+ *
+ * @param destination DBus service name
+ * @param path DBus object path
+ * @param interface DBus interface name
+ * @param method DBus method name
+ * @param conn DBus connection pointer
+ * @param notify Function to call with the pending call when it completes
+ * @param user_data Data passed to the notify function
+ * @param free_user_data Function to free user_data after the call has
+ * completed (NULL allowed). Not called if this function fails.
+ * @param first_argument_type Defines the first message argument type
+ * @param ... Variable length list of dbus message parameters (type, value pairs)
+ *
+ * @return TRUE when successful, FALSE if fail
+ */
+gboolean whiteboard_util_send_method_async(const gchar *destination,
+					   const gchar *path,
+					   const gchar *interface,
+					   const gchar *method,
+					   DBusConnection *conn,
+					   DBusPendingCallNotifyFunction notify,
+					   void *user_data,
+					   DBusFreeFunction free_user_data,
+					   gint first_argument_type, ...);
+
 /**
  * Utility function to parse dbus message with arbitrary argument list.
+ * String arguments sent through the fd payload side channel are mapped
+ * read-only and stay valid as long as the message.
  *
  * @param msg DBus message pointer
  * @param first_argument_type Defines the first message argument type
@@ -113,13 +113,27 @@ typedef struct {
 #endif
 } wqlParseBlk_t;
 
+/* Reverse namespace map: a character trie of the namespace URIs of a
+   prefix2ns map, used to find the longest namespace a URI starts with */
+typedef struct _nsTrieNode_t {
+  struct _nsTrieNode_t *child;
+  struct _nsTrieNode_t *sibling;
+  const gchar *prefix; // non-NULL if a namespace ends at this node
+  gchar c;
+} nsTrieNode_t;
+
+struct _ssNsTrie {
+  nsTrieNode_t *nodes; // nodes[0] is the root
+  guint used;
+};
+
 typedef struct {
   commonParseBlk_t c;
   int inTripleList; //was: rdfns_specified; i.e. start of triple list XML doc.
   charStr inUseSibNsUri;
   int depth;
   GHashTable *sibs_prefix_ns_map;
-  GHashTable *usrs_prefix_ns_map;
+  const ssNsTrie_t *usrs_ns_trie; // the caller's, not freed by the parse
   GSList ** tripleList_pp;
   ssTriple_t *currentTriple;
   ssElement_t currentSubject; //assigned only in STD_RDF parse mode
@@ -129,6 +143,14 @@ typedef struct {
   ssBufDesc_t *bD_bNodeUriListXML;
   int predicateDepth; /* to limit mistaking deep stuff as subject's predicate */
   ssElement_t *tripleComponentToParse;
+  ssBufDesc_t charBuf; // character data of tripleComponentToParse, resolved at element end
+  gboolean toArena; // collect triples to arenaTriples and arenaStrings instead of tripleList_pp
+  ssTripleBatch_t *toBatch; // if set, collect triples here instead of tripleList_pp
+  ssTripleStreamCB tripleCB; // if set, pass each triple here instead of tripleList_pp
+  gpointer tripleCBData;
+  gboolean tripleCBStop; // tripleCB returned FALSE
+  ssBufDesc_t arenaTriples; // ssTriple_t records, strings as offsets+1 into arenaStrings
+  ssBufDesc_t arenaStrings;
   enum {STD_RDF, SIB_REIFIED} parseMode;
 } ParseTriplesBlk;
 
@@ -136,7 +158,7 @@ typedef struct {
   commonParseBlk_t c;
   GSList **selectedVariables;
   GSList **results;
-  GHashTable *usrs_prefix_ns_map;
+  const ssNsTrie_t *usrs_ns_trie; // the caller's, not freed by the parse
   gboolean inResults,
     inResult,
     inBindingsList,
@@ -145,6 +167,7 @@ typedef struct {
     inVariable,
     doneVariableList;
   gint valueIndex;
+  ssBufDesc_t charBuf; // character data of the current <uri> or <literal>
   gchar *parsedCharTxt;
 } ParseSparqlSelectBlk;
 
@@ -160,6 +183,31 @@ void ssFreePathNodeList (GSList **pathNodeList);
 ssStatus_t new_prefix2ns_map(const gchar *ns, GHashTable **map);
 gchar *fullUri (const gchar *s, int sLen, GHashTable *prefix_ns_map);
 void nsLocal2prefixLocal (gchar **g_heap_str, GHashTable *prefix2ns_map);
+ssNsTrie_t *ssNsTrie_new (GHashTable *prefix2ns_map);
+void ssNsTrie_free (ssNsTrie_t *ns_trie);
+void nsLocal2prefixLocal_trie (gchar **g_heap_str, const ssNsTrie_t *ns_trie);
+ssTermDict_t *ssTermDict_new(void);
+void ssTermDict_free(ssTermDict_t **dict);
+ssElement_ct ssTermDict_intern(ssTermDict_t *dict, ssElement_ct term);
+ssStatus_t ssTermDict_intern_triple(ssTermDict_t *dict, ssTriple_t *triple);
+ssStatus_t ssTermDict_prepend_triple(ssTermDict_t *dict, GSList **currentList, ssElement_ct subject, ssElement_ct predicate, ssElement_ct object, ssElementType_t subjType, ssElementType_t objType);
+void ssFreeInternedTripleList (GSList **tripleList);
+ssElement_t ssTerm_new(ssElement_ct str);
+ssElement_t ssTerm_ref(ssElement_t term);
+void ssTerm_unref(ssElement_t term);
+ssTriple_t *ssTriple_new_shared(ssElement_t subject, ssElement_t predicate, ssElement_t object, ssElementType_t subjType, ssElementType_t objType);
+ssTriple_t *ssTriple_share(ssTriple_t *triple);
+void ssTripleList_share(GSList *tripleList);
+ssTriple_t *ssTriple_ref(ssTriple_t *triple);
+void ssTriple_unref(ssTriple_t *triple);
+gboolean ssTriple_is_shared(const ssTriple_t *triple);
+ssTripleBatch_t *ssTripleBatch_new(guint capacity);
+void ssTripleBatch_free(ssTripleBatch_t **batch);
+void ssTripleBatch_clear(ssTripleBatch_t *batch);
+ssStatus_t ssTripleBatch_append(ssTripleBatch_t *batch, ssElement_ct subject, ssElement_ct predicate, ssElement_ct object, ssElementType_t subjType, ssElementType_t objType);
+guint ssTripleBatch_length(const ssTripleBatch_t *batch);
+guint ssTripleBatch_strings_size(const ssTripleBatch_t *batch);
+ssStatus_t ssTripleBatch_get(const ssTripleBatch_t *batch, guint index, ssTriple_t *triple);
 #endif
 #ifndef SIBMSG_H
 //These should be already in sibmsg.h
@@ -169,6 +217,7 @@ ssStatus_t addXML_start (ssBufDesc_t *bD, charStr *el, attrStr *attr, charStr *v
 ssStatus_t addXML_end   (ssBufDesc_t *bD, charStr *el);
 ssStatus_t addXML_append_attribute (ssBufDesc_t *bD, attrStr *attr);
 ssStatus_t addXML_append_str(ssBufDesc_t *desc, charStr *str);
+ssStatus_t addXML_append_CDATA(ssBufDesc_t *bD, const gchar *str, gint len);
 ssStatus_t addXML_close_element (ssBufDesc_t *bD);
 ssStatus_t addXML_close_element_append_content_end (ssBufDesc_t *bD, charStr *content, charStr *el);
 ssStatus_t addXML_pathNode (ssBufDesc_t *bD, const ssPathNode_t *node, charStr *nameVal);
@@ -180,21 +229,69 @@ ssStatus_t addXML_query_w_wql_n_n( ssBufDesc_t *bD, QueryType type, const ssPath
 ssStatus_t addXML_query_w_wql_n( ssBufDesc_t *bD, QueryType type, const ssPathNode_t *pathNode);
 ssStatus_t addXML_open_element (ssBufDesc_t *bD, charStr *el);
 ssBufDesc_t *ssBufDesc_new(void);
+ssBufDesc_t *ssBufDesc_new_sized(guint capacity);
+ssStatus_t ssBufDesc_reserve(ssBufDesc_t *bD, guint capacity);
+void ssBufDesc_reset(ssBufDesc_t *bD);
 void ssBufDesc_free(ssBufDesc_t **_bd);
 gchar *ssBufDesc_GetMessage(ssBufDesc_t *desc);
 gint ssBufDesc_GetMessageLen(ssBufDesc_t *desc);
 ssStatus_t parseM3_query_cnf_wql(GSList **results, const gchar * response);
 ssStatus_t parseM3_triples(GSList ** list_pp, const char * m3XML_triples_str, GHashTable *prefix_ns_map);
+ssStatus_t parseM3_triples_trie(GSList ** list_pp, const char * m3XML_triples_str, const ssNsTrie_t *ns_trie);
+ssStatus_t parseM3_triples_arena(ssTripleArena_t **arena, const char * m3XML_triples_str, const ssNsTrie_t *ns_trie);
+ssStatus_t parseM3_triples_batch(ssTripleBatch_t *batch, const char * m3XML_triples_str, const ssNsTrie_t *ns_trie);
+ssTripleStream_t *parseM3_triples_stream_new(const ssNsTrie_t *ns_trie, ssTripleStreamCB cb, gpointer user_data);
+ssStatus_t parseM3_triples_stream_feed(ssTripleStream_t *stream, const gchar *data, gint len, gboolean isFinal);
+void parseM3_triples_stream_free(ssTripleStream_t **stream);
+guint ssTripleArena_length(const ssTripleArena_t *arena);
+const ssTriple_t *ssTripleArena_get(const ssTripleArena_t *arena, guint index);
+void ssTripleArena_free(ssTripleArena_t **arena);
 ssStatus_t parseM3_query_results_sparql_select(GSList **selectedVariables, GSList **valRows, const gchar *resultXML, const GHashTable *prefix_ns_map);
+ssStatus_t parseM3_query_results_sparql_select_trie(GSList **selectedVariables, GSList **valRows, const gchar *resultXML, const ssNsTrie_t *ns_trie);
 #endif
-/*-----------------------------------------------------------------------------*/
+
+/* Refcounted element string, ssElement_t points to str */
 typedef struct {
-  char **uri_p;
-  gboolean done;
-} nsLocal2prefix_ctrlBlk;
+  gint refcount;
+  gchar str[1];
+} ssTerm_t;
+#define SSTERM_HDR(term) ((ssTerm_t *)((gchar *)(term) - G_STRUCT_OFFSET(ssTerm_t, str)))
+
+/* Refcounted immutable triple, its elements are ssTerm_t strings */
+typedef struct {
+  ssTriple_t triple; // first, so that a shared triple is an ssTriple_t
+  gint refcount;
+} ssSharedTriple_t;
+
+/* Interned element strings, owned by the dictionary */
+struct _ssTermDict {
+  GStringChunk *terms;
+};
+
+/* Triples stored by column: for each triple three term offsets into the
+   string heap and two type bytes */
+#define TRIPLEBATCH_NULL 0            // term offset of a NULL element
+#define TRIPLEBATCH_MATCH_ANY G_MAXUINT // term offset of ssMATCH_ANY
+struct _ssTripleBatch {
+  guint length;
+  guint capacity;
+  guint *terms;   // 3*capacity, offset+1 of subject, predicate and object
+  guchar *types;  // 2*capacity, subjType and objType
+  ssBufDesc_t strings; // zero terminated element strings
+};
+
+/* Parsed triples and their strings in one block, see parseM3_triples_arena() */
+struct _ssTripleArena {
+  guint length;
+  ssTriple_t *triples; // length triples, followed by the string bytes
+};
+
+/*-----------------------------------------------------------------------------*/
 //statics herein:
 static ssStatus_t ssBufDesc_buf_realloc(ssBufDesc_t *bD, gint newDatLen);
 #define SUFFIXeqSTR(PREFIXcharStr,SUFFIXstr,str) (g_str_has_prefix(str, PREFIXcharStr.txt) && 0==strcmp(&str[PREFIXcharStr.len], SUFFIXstr))
+static XML_Parser parseM3_parser_get (gboolean ns);
+static void parseM3_parser_put (XML_Parser p, gboolean ns);
 static void XMLCALL ns2hash_hndl (void *data, const XML_Char *prefix, const XML_Char *uri);
 static ssStatus_t xmlns_str_2_hash(const gchar *ns, GHashTable *prefix2ns_map);
 static ssStatus_t ssBufDesc_buf_realloc(ssBufDesc_t *bD, gint newDatLen);
@@ -214,7 +311,8 @@ static void XMLCALL start(void *data, const char *el, const char **attr);
 static void XMLCALL end (void *data, const char *el);
 static ssStatus_t parseM3XML_triples_start (ParseTriplesBlk *blk);
 static void parseM3XML_triples_end (ParseTriplesBlk *blk);
-static gchar *enclose_CDATA_section( gchar *str);
+static void parseM3XML_triples_resolve_component (ParseTriplesBlk *blk);
+static ssStatus_t parseM3XML_triples_arena_add (ParseTriplesBlk *blk, ssTriple_t *triple);
 
 static void XMLCALL CDATA_start(void* data);
 static void XMLCALL CDATA_end(void* data);
@@ -256,6 +354,13 @@ ssStatus_t ssPrependTriple (GSList **currentList, ssElement_ct subject, ssElemen
 
 ssStatus_t ssCopyTriple( ssTriple_t *src, ssTriple_t **dst)
 {
+  if (ssTriple_is_shared(src))
+    {
+      //immutable, so a reference will do
+      *dst = ssTriple_ref(src);
+      return ss_StatusOK;
+    }
+
   ssTriple_t *triple = (ssTriple_t *)g_new0(ssTriple_t,1);
   g_return_val_if_fail(triple, ss_NotEnoughResources);
 
@@ -276,6 +381,12 @@ void ssFreeTriple( ssTriple_t *triple)
 {
   if(!triple)
     return; //nothing to do
+
+  if (ssTriple_is_shared(triple))
+    {
+      ssTriple_unref(triple);
+      return;
+    }
   
   if (triple->subject && triple->subject!=ssMATCH_ANY) g_free (triple->subject);
   if (triple->predicate && triple->predicate!=ssMATCH_ANY) g_free (triple->predicate);
@@ -329,6 +440,370 @@ void ssFreePathNodeList (GSList **pathNodeList)
   whiteboard_log_debug_fe();
 }
 
+ssTermDict_t *ssTermDict_new(void)
+{
+  ssTermDict_t *dict = g_new0(ssTermDict_t, 1);
+  dict->terms = g_string_chunk_new(4096);
+  return dict;
+}
+
+void ssTermDict_free(ssTermDict_t **dict)
+{
+  if (!dict || !*dict)
+    return;
+  g_string_chunk_free((*dict)->terms);
+  g_free(*dict);
+  *dict = NULL;
+}
+
+ssElement_ct ssTermDict_intern(ssTermDict_t *dict, ssElement_ct term)
+{
+  g_return_val_if_fail(dict!=NULL, NULL);
+  if (!term || term==ssMATCH_ANY)
+    return term;
+  return (ssElement_ct)g_string_chunk_insert_const(dict->terms, (const gchar *)term);
+}
+
+/* Replaces the g-heap strings of triple with interned ones and frees them */
+ssStatus_t ssTermDict_intern_triple(ssTermDict_t *dict, ssTriple_t *triple)
+{
+  ssElement_t *elems[3];
+  ssElement_t interned;
+  gint n;
+
+  g_return_val_if_fail(dict!=NULL && triple!=NULL, ss_InvalidParameter);
+  elems[0] = &triple->subject;
+  elems[1] = &triple->predicate;
+  elems[2] = &triple->object;
+  for (n = 0; n < 3; n++)
+    {
+      if (!*elems[n] || *elems[n]==ssMATCH_ANY)
+	continue;
+      interned = (ssElement_t)ssTermDict_intern(dict, *elems[n]);
+      g_free(*elems[n]);
+      *elems[n] = interned;
+    }
+  return ss_StatusOK;
+}
+
+ssStatus_t ssTermDict_prepend_triple(ssTermDict_t *dict, GSList **currentList, ssElement_ct subject, ssElement_ct predicate, ssElement_ct object, ssElementType_t subjType, ssElementType_t objType)
+{
+  g_return_val_if_fail(dict!=NULL, ss_InvalidParameter);
+  //same restrictions as for ssPrependTriple
+  g_return_val_if_fail(currentList
+		       && predicate
+		       && (subjType==ssElement_TYPE_URI || subjType==ssElement_TYPE_BNODE)
+		       && ( objType==ssElement_TYPE_URI ||  objType==ssElement_TYPE_BNODE ||
+			   (object && objType==ssElement_TYPE_LIT)),
+		       ss_InvalidParameter);
+
+  ssTriple_t *triple = (ssTriple_t *)g_new0(ssTriple_t,1);
+  g_return_val_if_fail(triple, ss_NotEnoughResources);
+  triple->subject = (ssElement_t)ssTermDict_intern(dict, subject);
+  triple->predicate = (ssElement_t)ssTermDict_intern(dict, predicate);
+  triple->object = (ssElement_t)ssTermDict_intern(dict, object);
+  triple->subjType = subjType;
+  triple->objType = objType;
+
+  *currentList = g_slist_prepend(*currentList, triple);
+  return ss_StatusOK;
+}
+
+void ssFreeInternedTripleList (GSList **tripleList)
+{
+  if (!tripleList || !*tripleList)
+    return; //nothing to do
+
+  GSList *list;
+  for (list = *tripleList; list; list = list->next)
+    g_free(list->data); //strings belong to the dictionary
+  g_slist_free(*tripleList);
+  *tripleList = NULL;
+}
+
+ssElement_t ssTerm_new(ssElement_ct str)
+{
+  ssTerm_t *term;
+  gsize len;
+
+  if (!str || str==ssMATCH_ANY)
+    return (ssElement_t)str;
+  len = strlen((const char *)str);
+  term = g_malloc(G_STRUCT_OFFSET(ssTerm_t, str) + len + 1);
+  term->refcount = 1;
+  memcpy(term->str, str, len + 1);
+  return (ssElement_t)term->str;
+}
+
+ssElement_t ssTerm_ref(ssElement_t term)
+{
+  if (term && term!=ssMATCH_ANY)
+    g_atomic_int_inc(&SSTERM_HDR(term)->refcount);
+  return term;
+}
+
+void ssTerm_unref(ssElement_t term)
+{
+  if (term && term!=ssMATCH_ANY && g_atomic_int_dec_and_test(&SSTERM_HDR(term)->refcount))
+    g_free(SSTERM_HDR(term));
+}
+
+/* Shared triples are marked in their subjType, so that ssFreeTriple() and
+   ssCopyTriple() can tell them from plain ones */
+gboolean ssTriple_is_shared(const ssTriple_t *triple)
+{
+  return triple && (triple->subjType & ssElement_TYPE_SHARED);
+}
+
+/* Takes references of the given terms */
+ssTriple_t *ssTriple_new_shared(ssElement_t subject, ssElement_t predicate, ssElement_t object, ssElementType_t subjType, ssElementType_t objType)
+{
+  ssSharedTriple_t *shared = g_new0(ssSharedTriple_t, 1);
+
+  shared->refcount = 1;
+  shared->triple.subject = ssTerm_ref(subject);
+  shared->triple.predicate = ssTerm_ref(predicate);
+  shared->triple.object = ssTerm_ref(object);
+  shared->triple.subjType = (ssElementType_t)(ssElementType(subjType) | ssElement_TYPE_SHARED);
+  shared->triple.objType = objType;
+  return &shared->triple;
+}
+
+/* Turns a triple allocated with the g-heap, e.g. a parsed one, into a
+   shared triple. The original triple is freed. */
+ssTriple_t *ssTriple_share(ssTriple_t *triple)
+{
+  ssTriple_t *shared;
+  ssElement_t s, p, o;
+
+  if (!triple || ssTriple_is_shared(triple))
+    return triple;
+  s = ssTerm_new(triple->subject);
+  p = ssTerm_new(triple->predicate);
+  o = ssTerm_new(triple->object);
+  shared = ssTriple_new_shared(s, p, o, triple->subjType, triple->objType);
+  ssTerm_unref(s);
+  ssTerm_unref(p);
+  ssTerm_unref(o);
+  ssFreeTriple(triple);
+  return shared;
+}
+
+void ssTripleList_share(GSList *tripleList)
+{
+  GSList *l;
+  for (l = tripleList; l; l = l->next)
+    l->data = ssTriple_share((ssTriple_t *)l->data);
+}
+
+ssTriple_t *ssTriple_ref(ssTriple_t *triple)
+{
+  g_return_val_if_fail(triple!=NULL, NULL);
+  g_return_val_if_fail(ssTriple_is_shared(triple), NULL);
+  g_atomic_int_inc(&((ssSharedTriple_t *)triple)->refcount);
+  return triple;
+}
+
+void ssTriple_unref(ssTriple_t *triple)
+{
+  ssSharedTriple_t *shared = (ssSharedTriple_t *)triple;
+
+  if (!triple)
+    return;
+  g_return_if_fail(ssTriple_is_shared(triple));
+  if (!g_atomic_int_dec_and_test(&shared->refcount))
+    return;
+
+  ssTerm_unref(shared->triple.subject);
+  ssTerm_unref(shared->triple.predicate);
+  ssTerm_unref(shared->triple.object);
+  g_free(shared);
+}
+
+ssTripleBatch_t *ssTripleBatch_new(guint capacity)
+{
+  ssTripleBatch_t *batch = g_new0(ssTripleBatch_t, 1);
+  if (capacity)
+    {
+      batch->terms = g_new(guint, 3*capacity);
+      batch->types = g_new(guchar, 2*capacity);
+      batch->capacity = capacity;
+    }
+  return batch;
+}
+
+void ssTripleBatch_free(ssTripleBatch_t **batch)
+{
+  if (!batch || !*batch)
+    return;
+  g_free((*batch)->terms);
+  g_free((*batch)->types);
+  g_free((*batch)->strings.buf);
+  g_free(*batch);
+  *batch = NULL;
+}
+
+/* Removes all triples, keeping the allocated space */
+void ssTripleBatch_clear(ssTripleBatch_t *batch)
+{
+  g_return_if_fail(batch!=NULL);
+  batch->length = 0;
+  ssBufDesc_reset(&batch->strings);
+}
+
+static guint ssTripleBatch_add_term(ssTripleBatch_t *batch, ssElement_ct term)
+{
+  guint offset;
+  gint len;
+
+  if (!term)
+    return TRIPLEBATCH_NULL;
+  if (term==ssMATCH_ANY)
+    return TRIPLEBATCH_MATCH_ANY;
+  len = strlen((const char *)term) + 1;
+  if (ssBufDesc_buf_realloc(&batch->strings, batch->strings.datLen + len) != ss_StatusOK)
+    return TRIPLEBATCH_NULL;
+  offset = batch->strings.datLen;
+  memcpy(batch->strings.buf + offset, term, len);
+  batch->strings.datLen += len;
+  return offset + 1;
+}
+
+ssStatus_t ssTripleBatch_append(ssTripleBatch_t *batch, ssElement_ct subject, ssElement_ct predicate, ssElement_ct object, ssElementType_t subjType, ssElementType_t objType)
+{
+  guint *terms;
+  guint datLen;
+
+  g_return_val_if_fail(batch!=NULL, ss_InvalidParameter);
+  if (batch->length == batch->capacity)
+    {
+      guint capacity = (batch->capacity)? 2*batch->capacity : 64;
+      guint *newTerms = g_try_renew(guint, batch->terms, 3*capacity);
+      if (!newTerms)
+	return ss_NotEnoughResources;
+      batch->terms = newTerms;
+      guchar *newTypes = g_try_renew(guchar, batch->types, 2*capacity);
+      if (!newTypes)
+	return ss_NotEnoughResources;
+      batch->types = newTypes;
+      batch->capacity = capacity;
+    }
+
+  datLen = batch->strings.datLen;
+  terms = &batch->terms[3*batch->length];
+  terms[0] = ssTripleBatch_add_term(batch, subject);
+  terms[1] = ssTripleBatch_add_term(batch, predicate);
+  terms[2] = ssTripleBatch_add_term(batch, object);
+  if ((subject && !terms[0]) || (predicate && !terms[1]) || (object && !terms[2]))
+    {
+      batch->strings.datLen = datLen; // drop the strings of the partial triple
+      return ss_NotEnoughResources;
+    }
+  batch->types[2*batch->length] = (guchar)subjType;
+  batch->types[2*batch->length+1] = (guchar)objType;
+  batch->length++;
+  return ss_StatusOK;
+}
+
+guint ssTripleBatch_length(const ssTripleBatch_t *batch)
+{
+  return (batch)? batch->length : 0;
+}
+
+guint ssTripleBatch_strings_size(const ssTripleBatch_t *batch)
+{
+  return (batch)? batch->strings.datLen : 0;
+}
+
+static ssElement_t ssTripleBatch_term(const ssTripleBatch_t *batch, guint offset)
+{
+  if (offset == TRIPLEBATCH_NULL)
+    return NULL;
+  if (offset == TRIPLEBATCH_MATCH_ANY)
+    return (ssElement_t)ssMATCH_ANY;
+  return (ssElement_t)(batch->strings.buf + offset - 1);
+}
+
+/* Fills triple with the index'th triple of the batch. The strings belong to
+   the batch and are valid until it is changed. */
+ssStatus_t ssTripleBatch_get(const ssTripleBatch_t *batch, guint index, ssTriple_t *triple)
+{
+  const guint *terms;
+
+  g_return_val_if_fail(batch!=NULL && triple!=NULL && index < batch->length, ss_InvalidParameter);
+  terms = &batch->terms[3*index];
+  triple->subject = ssTripleBatch_term(batch, terms[0]);
+  triple->predicate = ssTripleBatch_term(batch, terms[1]);
+  triple->object = ssTripleBatch_term(batch, terms[2]);
+  triple->subjType = (ssElementType_t)batch->types[2*index];
+  triple->objType = (ssElementType_t)batch->types[2*index+1];
+  return ss_StatusOK;
+}
+
+/* Expat parsers kept for reuse by the thread, one of each kind */
+typedef struct {
+  XML_Parser parser;
+  XML_Parser nsParser; // created with XML_ParserCreateNS(NULL, 0)
+} parserCache_t;
+
+static GStaticPrivate parserCache_key = G_STATIC_PRIVATE_INIT;
+
+static void parserCache_free (gpointer data)
+{
+  parserCache_t *cache = data;
+  if (cache->parser)
+    XML_ParserFree(cache->parser);
+  if (cache->nsParser)
+    XML_ParserFree(cache->nsParser);
+  g_free(cache);
+}
+
+/* Takes a parser from the cache of the calling thread, or creates one.
+   The parser has no handlers or user data set. */
+static XML_Parser parseM3_parser_get (gboolean ns)
+{
+  parserCache_t *cache = g_static_private_get(&parserCache_key);
+  XML_Parser p = NULL;
+
+  if (cache)
+    {
+      XML_Parser *slot = (ns)? &cache->nsParser : &cache->parser;
+      p = *slot;
+      *slot = NULL;
+    }
+  if (!p)
+    p = (ns)? XML_ParserCreateNS(NULL, 0) : XML_ParserCreate(NULL);
+  return p;
+}
+
+/* Resets a parser taken with parseM3_parser_get() and keeps it for the
+   next parse of the calling thread. Parsers taken while the slot was
+   empty, i.e. by nested parses, are freed. */
+static void parseM3_parser_put (XML_Parser p, gboolean ns)
+{
+  parserCache_t *cache;
+  XML_Parser *slot;
+
+  if (!p)
+    return;
+  if (!XML_ParserReset(p, NULL))
+    {
+      XML_ParserFree(p);
+      return;
+    }
+  cache = g_static_private_get(&parserCache_key);
+  if (!cache)
+    {
+      cache = g_new0(parserCache_t, 1);
+      g_static_private_set(&parserCache_key, cache, parserCache_free);
+    }
+  slot = (ns)? &cache->nsParser : &cache->parser;
+  if (*slot)
+    XML_ParserFree(p);
+  else
+    *slot = p;
+}
+
 static void XMLCALL
 ns2hash_hndl (void *data,
 	      const XML_Char *prefix,
@@ -348,7 +823,7 @@ static ssStatus_t xmlns_str_2_hash(const gchar *ns, GHashTable *prefix2ns_map)
   whiteboard_log_debug_fb();
   g_return_val_if_fail (ns && prefix2ns_map, ss_InvalidParameter);
 
-  ns_parser = XML_ParserCreateNS(NULL, 0);
+  ns_parser = parseM3_parser_get(TRUE);
   if(!ns_parser)
     return ss_NotEnoughResources;
 
@@ -359,7 +834,7 @@ static ssStatus_t xmlns_str_2_hash(const gchar *ns, GHashTable *prefix2ns_map)
   status = (status || !XML_Parse(ns_parser, ns, strlen(ns), 0))?ss_ParsingError:0;
   status = (status || !XML_Parse(ns_parser, "></ns>", 6, 1))?   ss_ParsingError:0;
 
-  XML_ParserFree (ns_parser);
+  parseM3_parser_put(ns_parser, TRUE);
   whiteboard_log_debug_fe();
   return status;
 }
@@ -380,6 +855,9 @@ ssStatus_t new_prefix2ns_map(const gchar *ns, GHashTable **map)
   return status;
 }
 
+/* Prefixes shorter than this are looked up from a stack buffer */
+#define FULLURI_PREFIX_MAX 64
+
 //the returned string, if not NULL, must be freed with g_free (as in many other places.. :-O
 gchar *fullUri (const gchar *s, int sLen, GHashTable *prefix_ns_map)
 {
@@ -400,12 +878,17 @@ gchar *fullUri (const gchar *s, int sLen, GHashTable *prefix_ns_map)
       for (i=0; i<sLen && s[i]!=':';i++);
       if (i<sLen-1) 
 	{ //valid prefix only if something comes after ':' 
-	  char *prefix = g_strndup(s,i);
-	  if( strncmp(prefix, "http",4) != 0)
+	  if( i<4 || strncmp(s, "http",4) != 0)
 	    {
+	      // prefixes are short, look them up without a heap copy
+	      gchar prefixBuf[FULLURI_PREFIX_MAX];
+	      gchar *prefix = (i<FULLURI_PREFIX_MAX)? prefixBuf : g_malloc(i+1);
+	      memcpy(prefix, s, i);
+	      prefix[i] = 0;
 	      uri = (char *)g_hash_table_lookup(prefix_ns_map, prefix);
+	      if (prefix != prefixBuf)
+		g_free(prefix);
 	    }
-	  g_free(prefix);
 	}
       
       if (uri)
@@ -437,6 +920,7 @@ ssStatus_t addXML_templateTriple(gpointer _triple, GHashTable *prefix_ns_map, gp
   whiteboard_log_debug_fb();
   ssBufDesc_t *bD = (ssBufDesc_t *)_bd;
   ssTriple_t *triple = _triple;
+  ssElementType_t subjType = ssElementType(triple->subjType);
   attrStr attr;
   charStr _str0;
   ssStatus_t status;
@@ -451,11 +935,11 @@ ssStatus_t addXML_templateTriple(gpointer _triple, GHashTable *prefix_ns_map, gp
   attr.name = &SIB_TYPE;
   if (triple->subject) 
     {
-      if( triple->subjType==ssElement_TYPE_URI) //default and most common(?) case
+      if( subjType==ssElement_TYPE_URI) //default and most common(?) case
 	attr.defined = &SIB_URI;
-      else if( triple->subjType==ssElement_TYPE_LIT )
+      else if( subjType==ssElement_TYPE_LIT )
 	attr.defined = &SIB_LITERAL;
-      else if(triple->subjType == ssElement_TYPE_BNODE )
+      else if(subjType == ssElement_TYPE_BNODE )
 	attr.defined = &SIB_BNODE;
       else
 	whiteboard_log_warning("invalid subject type");
@@ -463,13 +947,13 @@ ssStatus_t addXML_templateTriple(gpointer _triple, GHashTable *prefix_ns_map, gp
   //else somebody didn't check the validity!
   else
     {
-      if (triple->subjType==ssElement_TYPE_BNODE)
+      if (subjType==ssElement_TYPE_BNODE)
 	attr.defined = &SIB_BNODE;
       else
 	attr.defined = &SIB_URI;
     }
   
-  if (triple->subject || triple->subjType==ssElement_TYPE_BNODE) 
+  if (triple->subject || subjType==ssElement_TYPE_BNODE) 
     {
       char *full_uri = (!prefix_ns_map || !triple->subject)?NULL:fullUri((char *)triple->subject, strlen((char *)triple->subject), prefix_ns_map);
       _str0.txt = (full_uri)?full_uri:(char *)triple->subject;
@@ -534,23 +1018,7 @@ ssStatus_t addXML_templateTriple(gpointer _triple, GHashTable *prefix_ns_map, gp
 	  status = addXML_start (bD, &SIB_OBJECT, &attr, NULL, 0);
 	  g_return_val_if_fail(status == ss_StatusOK,status);
 
-	  gchar *legalstring = enclose_CDATA_section(tmp);
-	  if(legalstring)
-	    {
-	      _str0.txt = (char *)legalstring;
-	      _str0.len = strlen( (char *)legalstring);
-	    }
-	  else
-	    {
-	      _str0.txt=NULL;
-	      _str0.len=0;
-	    }
-	  
-	  status = addXML_append_str( bD, &_str0 );
-	  
-	  if(legalstring)
-	    g_free(legalstring);
-	  
+	  status = addXML_append_CDATA( bD, tmp, strlen(tmp) );
 	  g_return_val_if_fail(status == ss_StatusOK,status);
 	  //	  status = addXML_append_str( bD, &SIB_CDATA_END);
 	  //	  g_return_val_if_fail(status == ss_StatusOK,status);
@@ -582,42 +1050,6 @@ ssStatus_t addXML_templateTriple(gpointer _triple, GHashTable *prefix_ns_map, gp
   return ss_StatusOK;
 }
 
-gchar *enclose_CDATA_section( gchar *str)
-{
-  gchar *illegal = "]]>";
-  gchar *legal = "]]]]><![CDATA[>";
-  gchar *result = NULL;
-  if( strlen(str) > 0)
-    {
-      gchar **splitted = g_strsplit( str, illegal,-1);
-
-      int i = 0;
-      int count = g_strv_length( splitted );
-      GString *legalstring = g_string_new("<![CDATA[");
-      
-      for( i = 0; i < count; i++)
-	{
-	  if( (i == 0) && (strlen( splitted[i] ) == 0) ) // starts with illegal 
-	{
-	  legalstring = g_string_append(legalstring, legal);
-	}
-      else if( strlen(splitted[i]) > 0 )
-	{
-	  legalstring = g_string_append(legalstring, splitted[i] );
-	  if( (i+1 < count) )
-	    {
-	      legalstring = g_string_append(legalstring, legal);
-	    }
-	}	
-	}
-      legalstring = g_string_append(legalstring,"]]>");
-      result = legalstring->str;
-      g_strfreev(splitted);
-      g_string_free( legalstring,FALSE);
-    }
-  return result;
-}
-
 ssStatus_t addXML_start (ssBufDesc_t *bD, charStr *el, attrStr *attr, charStr *value, int complete)
 {
   int newLen;
@@ -817,6 +1249,59 @@ ssStatus_t addXML_append_str(ssBufDesc_t *desc, charStr *str)
   return ss_StatusOK;
 }
 
+/* Appends str as a CDATA section, splitting every "]]>" of str into two
+   sections. Written directly into the buffer in a single pass, an empty
+   string appends nothing. */
+ssStatus_t addXML_append_CDATA(ssBufDesc_t *bD, const gchar *str, gint len)
+{
+  static const gchar split[] = "]]><![CDATA[";
+  const gint splitLen = sizeof(split)-1;
+  const gchar *p, *end, *hit;
+  gint n;
+  whiteboard_log_debug_fb();
+  if (!str || len <= 0)
+    return ss_StatusOK;
+
+  if (ssBufDesc_buf_realloc(bD, bD->datLen + SIB_CDATA_START.len + len + SIB_CDATA_END.len + 1) != ss_StatusOK)
+    return ss_NotEnoughResources;
+
+  memcpy(bD->buf + bD->datLen, SIB_CDATA_START.txt, SIB_CDATA_START.len);
+  bD->datLen += SIB_CDATA_START.len;
+
+  p = str;
+  end = str + len;
+  while ((hit = memchr(p, ']', end - p)) != NULL)
+    {
+      if (end - hit < 3 || hit[1] != ']' || hit[2] != '>')
+	{
+	  hit++;
+	  n = hit - p;
+	  memcpy(bD->buf + bD->datLen, p, n);
+	  bD->datLen += n;
+	  p = hit;
+	  continue;
+	}
+      // copy up to and including "]]", the '>' starts the next section
+      n = hit + 2 - p;
+      if (ssBufDesc_buf_realloc(bD, bD->datLen + n + splitLen + (end - hit - 2) + SIB_CDATA_END.len + 1) != ss_StatusOK)
+	return ss_NotEnoughResources;
+      memcpy(bD->buf + bD->datLen, p, n);
+      bD->datLen += n;
+      memcpy(bD->buf + bD->datLen, split, splitLen);
+      bD->datLen += splitLen;
+      p = hit + 2;
+    }
+  n = end - p;
+  memcpy(bD->buf + bD->datLen, p, n);
+  bD->datLen += n;
+
+  memcpy(bD->buf + bD->datLen, SIB_CDATA_END.txt, SIB_CDATA_END.len);
+  bD->datLen += SIB_CDATA_END.len;
+  bD->buf[bD->datLen] = 0;
+  whiteboard_log_debug_fe();
+  return ss_StatusOK;
+}
+
 ssStatus_t addXML_close_element (ssBufDesc_t *bD)
 {
   int newLen;
@@ -886,22 +1371,8 @@ ssStatus_t addXML_pathNode (ssBufDesc_t *bD, const ssPathNode_t *node, charStr *
   if(node->nodeType==ssElement_TYPE_LIT)
     {
       status = addXML_close_element(bD);
-      gchar *tmp = enclose_CDATA_section ( (gchar *)node->string);
-      if(tmp)
-	{
-	  cont.txt = tmp;
-	  cont.len = strlen(tmp);
-	}
-      else
-	{
-	  cont.txt = NULL;
-	  cont.len = 0;
-	}
-      status = addXML_append_str (bD, &cont);
-
-      if(tmp)
-	 g_free(tmp);
-
+      g_return_val_if_fail(status == ss_StatusOK, status);
+      status = addXML_append_CDATA (bD, (gchar *)node->string, strlen((gchar *)node->string));
       g_return_val_if_fail(status == ss_StatusOK, status);
       status = addXML_end( bD, &SIB_PATH_NODE);
       g_return_val_if_fail(status == ss_StatusOK, status);
@@ -932,22 +1403,7 @@ ssStatus_t addXML_queryResultNode(ssBufDesc_t *bD, const ssPathNode_t *node)
 
   if (node->nodeType==ssElement_TYPE_LIT)
     {
-      gchar *tmp = enclose_CDATA_section ( (gchar *)node->string);
-      if( tmp)
-	{
-	  cont.txt = tmp;
-	  cont.len = strlen(tmp);
-	}
-      else
-	{
-	  cont.txt=NULL;
-	  cont.len=0;
-	}
-      status = addXML_append_str (bD, &cont);
-
-      if(tmp)
-	g_free(tmp);
-
+      status = addXML_append_CDATA (bD, (gchar *)node->string, strlen((gchar *)node->string));
       g_return_val_if_fail(status == ss_StatusOK, status);
       status = addXML_end( bD, &SIB_LITERAL);
       g_return_val_if_fail(status == ss_StatusOK, status);
@@ -1272,22 +1728,57 @@ ssBufDesc_t *ssBufDesc_new()
   return buf;
 }
 
+ssBufDesc_t *ssBufDesc_new_sized(guint capacity)
+{
+  ssBufDesc_t *buf = NULL;
+  whiteboard_log_debug_fb();
+  buf = ssBufDesc_new();
+  if (buf && capacity > 0 && ssBufDesc_reserve(buf, capacity) != ss_StatusOK)
+    ssBufDesc_free(&buf);
+  whiteboard_log_debug_fe();
+  return buf;
+}
+
+ssStatus_t ssBufDesc_reserve(ssBufDesc_t *bD, guint capacity)
+{
+  gchar *newBuf;
+  whiteboard_log_debug_fb();
+  if (capacity > bD->bufLen)
+    {
+      newBuf = (gchar *)g_try_realloc (bD->buf, capacity);
+      if (!newBuf)
+	return ss_NotEnoughResources;
+      bD->buf = newBuf;
+      bD->bufLen = capacity;
+    }
+  whiteboard_log_debug_fe();
+  return ss_StatusOK;
+}
+
 static ssStatus_t ssBufDesc_buf_realloc(ssBufDesc_t *bD, gint newDatLen)
 {
-  gint numBufs;
+  guint newBufLen;
   whiteboard_log_debug_fb();
   if (newDatLen > bD->bufLen)
     {
-      /* Modification to avoid overtly large realloc --jho */
-      numBufs = (newDatLen / BUFF_INCREMENT ) + 1; 
-      /* numBufs = (newDatLen % BUFF_INCREMENT ) + 1; */
-      bD->buf = (gchar *)g_try_realloc (bD->buf, (bD->bufLen += (numBufs*BUFF_INCREMENT)));
+      /* Grow geometrically, so that building a message of n bytes
+	 costs O(n) copying in total */
+      newBufLen = (bD->bufLen > 0)? bD->bufLen : BUFF_INCREMENT;
+      while (newBufLen < newDatLen && newBufLen <= G_MAXUINT/2)
+	newBufLen *= 2;
+      if (newBufLen < newDatLen)
+	newBufLen = newDatLen;
+      return ssBufDesc_reserve(bD, newBufLen);
     }
   whiteboard_log_debug_fe();
-  if (!bD->buf)
-    return ss_NotEnoughResources;
-  else
-    return ss_StatusOK;
+  return ss_StatusOK;
+}
+
+void ssBufDesc_reset(ssBufDesc_t *bD)
+{
+  bD->datLen = 0;
+  if (bD->buf)
+    bD->buf[0] = 0;
 }
 
 void ssBufDesc_free(ssBufDesc_t **_bd)
@@ -1890,9 +2381,9 @@ elementSPARQLSelect_start (void *data, const char *el, const char **attr)
     {
       if (blk->inBinding)
 	{
-	  if (blk->parsedCharTxt==NULL && ( strcmp(el,"uri")==0 || strcmp(el,"literal")==0 ))
+	  if (blk->charBuf.datLen==0 && ( strcmp(el,"uri")==0 || strcmp(el,"literal")==0 ))
 	    return;
-	  else if (blk->parsedCharTxt!=NULL)
+	  else if (blk->charBuf.datLen!=0)
 	    whiteboard_log_debug("%s",errorContentNotInBinding);
 	  else
 	    whiteboard_log_debug("new element withing <binding> which repeats or is not <uri> or <literal>");
@@ -1956,11 +2447,13 @@ elementSPARQLSelect_end (void *data, const char *el)
 	  return;
 	}
       if (blk->inResults)
-	if(blk->inResult && blk->inBinding && blk->parsedCharTxt!=NULL && (strcmp(el,"uri")==0 || strcmp(el,"literal")==0))
+	if(blk->inResult && blk->inBinding && blk->charBuf.datLen!=0 && (strcmp(el,"uri")==0 || strcmp(el,"literal")==0))
 	  { //binding has been defined for defined triple element value
 	    //so, add a triple element to the internal triple element list (=results, here) and
 	    //update (overwrite NULL), for the current (blk->valueIndex) variable's value with the current (last on list) triple address
 	    ssPathNode_t *pN = g_new0(ssPathNode_t, 1);
+	    blk->parsedCharTxt = g_strndup(blk->charBuf.buf, blk->charBuf.datLen);
+	    ssBufDesc_reset(&blk->charBuf);
 	    if (strcmp(el,"uri")==0)
 	      {
 		pN->nodeType = ssElement_TYPE_URI;
@@ -1969,12 +2462,8 @@ elementSPARQLSelect_end (void *data, const char *el)
 		//for now, URIs are assumed already in full form.
 
 		//translate, if needed, to user namespace form
-		if (blk->usrs_prefix_ns_map) {
-		  nsLocal2prefix_ctrlBlk nsLocal2prefix_ctrl;
-		  nsLocal2prefix_ctrl.uri_p = &blk->parsedCharTxt;
-		  nsLocal2prefix_ctrl.done = FALSE;
-		  g_hash_table_foreach(blk->usrs_prefix_ns_map, nsLocal2prefixLocal_hndl, &nsLocal2prefix_ctrl);
-		}
+		if (blk->usrs_ns_trie)
+		  nsLocal2prefixLocal_trie(&blk->parsedCharTxt, blk->usrs_ns_trie);
 		pN->string = blk->parsedCharTxt;
 	      }
 	    else //"literal"
@@ -2037,6 +2526,16 @@ elementSPARQLSelect_end (void *data, const char *el)
 }
 
 ssStatus_t parseM3_query_results_sparql_select(GSList **selectedVariables, GSList **results, const gchar * response, const GHashTable *prefix_ns_map)
+{
+  ssNsTrie_t *ns_trie = (prefix_ns_map)? ssNsTrie_new((GHashTable *)prefix_ns_map) : NULL;
+  ssStatus_t status;
+
+  status = parseM3_query_results_sparql_select_trie(selectedVariables, results, response, ns_trie);
+  ssNsTrie_free(ns_trie);
+  return status;
+}
+
+ssStatus_t parseM3_query_results_sparql_select_trie(GSList **selectedVariables, GSList **results, const gchar * response, const ssNsTrie_t *ns_trie)
 {
   whiteboard_log_debug_fb();
   ParseSparqlSelectBlk blk;
@@ -2046,7 +2545,7 @@ ssStatus_t parseM3_query_results_sparql_select(GSList **selectedVariables, GSLis
 
   blk.selectedVariables = selectedVariables;
   blk.results = results;
-  blk.usrs_prefix_ns_map = prefix_ns_map;
+  blk.usrs_ns_trie = ns_trie;
   blk.parsedCharTxt = NULL;
   blk.inBindingsList = FALSE;
   blk.inBinding = FALSE;
@@ -2056,10 +2555,14 @@ ssStatus_t parseM3_query_results_sparql_select(GSList **selectedVariables, GSLis
   blk.inVariable = FALSE;
   blk.doneVariableList = FALSE;
   blk.valueIndex = -1;
+  blk.charBuf.buf = NULL;
+  blk.charBuf.datLen = 0;
+  blk.charBuf.bufLen = 0;
 
-  blk.c.p = XML_ParserCreate(NULL);
+  blk.c.p = parseM3_parser_get(FALSE);
   if (! blk.c.p) {
     whiteboard_log_error("Couldn't allocate memory for parser\n");
+    g_free(blk.charBuf.buf);
     whiteboard_log_debug_fe();
     return ss_NotEnoughResources;
   }
@@ -2068,7 +2571,8 @@ ssStatus_t parseM3_query_results_sparql_select(GSList **selectedVariables, GSLis
   XML_SetCharacterDataHandler(blk.c.p, sparqlSelect_charhndl);
 
   XML_Parse(blk.c.p, response, strlen(response), 1);
-  XML_ParserFree(blk.c.p);
+  parseM3_parser_put(blk.c.p, FALSE);
+  g_free(blk.charBuf.buf);
   whiteboard_log_debug_fe();
   return blk.c.parseStatus;
   whiteboard_log_debug_fe();
@@ -2086,7 +2590,7 @@ ssStatus_t parseM3_query_cnf_wql(GSList **results, const gchar * response)
 
   blk.pp = NULL;
 
-  blk.c.p = XML_ParserCreate(NULL);
+  blk.c.p = parseM3_parser_get(FALSE);
   if (! blk.c.p) {
     whiteboard_log_error("Couldn't allocate memory for parser\n");
     whiteboard_log_debug_fe();
@@ -2099,7 +2603,7 @@ ssStatus_t parseM3_query_cnf_wql(GSList **results, const gchar * response)
   XML_SetUserData(blk.c.p, &blk);
 
   XML_Parse(blk.c.p, response, strlen(response), 1);
-  XML_ParserFree(blk.c.p);
+  parseM3_parser_put(blk.c.p, FALSE);
 
   whiteboard_log_debug_fe();
   return blk.c.parseStatus;
@@ -2140,33 +2644,140 @@ endNameSpaceHndl (void *data,
   blk->depth--;
 }
 
-static void nsLocal2prefixLocal_hndl (gpointer _prefix, gpointer _ns, gpointer data)
+static void nsTrie_size_hndl (gpointer _prefix, gpointer _ns, gpointer data)
 {
-  nsLocal2prefix_ctrlBlk *ctrlblk = data;
-  if (ctrlblk->done)
+  *(guint *)data += strlen((const gchar *)_ns);
+}
+
+static void nsTrie_add_hndl (gpointer _prefix, gpointer _ns, gpointer data)
+{
+  ssNsTrie_t *trie = data;
+  nsTrieNode_t *node = trie->nodes;
+  nsTrieNode_t *child;
+  const gchar *ns;
+
+  for (ns = _ns; *ns; ns++)
+    {
+      for (child = node->child; child && child->c != *ns; child = child->sibling);
+      if (!child)
+	{
+	  child = &trie->nodes[trie->used++];
+	  child->c = *ns;
+	  child->sibling = node->child;
+	  node->child = child;
+	}
+      node = child;
+    }
+  if (!node->prefix)
+    node->prefix = _prefix;
+}
+
+/* The trie refers to the prefix strings of the map, so the map must
+   outlive it */
+ssNsTrie_t *ssNsTrie_new (GHashTable *prefix2ns_map)
+{
+  ssNsTrie_t *trie;
+  guint size = 1; // root
+
+  g_return_val_if_fail(prefix2ns_map!=NULL, NULL);
+
+  g_hash_table_foreach(prefix2ns_map, nsTrie_size_hndl, &size);
+  trie = g_new0(ssNsTrie_t, 1);
+  trie->nodes = g_new0(nsTrieNode_t, size);
+  trie->used = 1;
+  g_hash_table_foreach(prefix2ns_map, nsTrie_add_hndl, trie);
+  return trie;
+}
+
+void ssNsTrie_free (ssNsTrie_t *ns_trie)
+{
+  if (!ns_trie)
     return;
+  g_free(ns_trie->nodes);
+  g_free(ns_trie);
+}
 
-  char *uri = *ctrlblk->uri_p;
-  char *ns = _ns;
-  char *prefix = _prefix;
+/* Replaces *g_heap_str with "prefix:local" */
+static void nsLocal2prefixLocal_replace (gchar **g_heap_str, const gchar *prefix, gint nsLen)
+{
+  const gchar *uri = *g_heap_str;
+  gint prefixLen = strlen(prefix);
+  gint localLen = strlen(uri + nsLen);
+  gchar *prefix_local;
+
+  prefix_local = g_malloc(prefixLen + 1 + localLen + 1);
+  memcpy(prefix_local, prefix, prefixLen);
+  prefix_local[prefixLen] = ':';
+  memcpy(prefix_local + prefixLen + 1, uri + nsLen, localLen + 1);
+  g_free(*g_heap_str);
+  *g_heap_str = prefix_local;
+}
+
+/* Uses the longest namespace the uri starts with. Finding the namespace
+   takes one pass over the uri. */
+void nsLocal2prefixLocal_trie (gchar **g_heap_str, const ssNsTrie_t *ns_trie)
+{
+  const nsTrieNode_t *node;
+  const nsTrieNode_t *match;
+  const gchar *uri;
+  const gchar *s;
+  gint nsLen = 0;
+
+  if (!ns_trie || !g_heap_str || !*g_heap_str)
+    return; //nothing to do - its ok!
+
+  uri = *g_heap_str;
+  node = ns_trie->nodes;
+  match = (node->prefix)? node : NULL;
+  for (s = uri; *s; s++)
+    {
+      for (node = node->child; node && node->c != *s; node = node->sibling);
+      if (!node)
+	break;
+      if (node->prefix)
+	{
+	  match = node;
+	  nsLen = s - uri + 1;
+	}
+    }
+  if (match)
+    nsLocal2prefixLocal_replace(g_heap_str, match->prefix, nsLen);
+}
+
+typedef struct {
+  const gchar *uri;
+  const gchar *prefix; // of the longest namespace found so far
+  gint nsLen;
+} nsLocal2prefix_ctrlBlk;
+
+static void nsLocal2prefixLocal_hndl (gpointer _prefix, gpointer _ns, gpointer data)
+{
+  nsLocal2prefix_ctrlBlk *ctrlblk = data;
+  const gchar *ns = _ns;
   gint nsLen = strlen(ns);
-  if (g_strstr_len (uri, nsLen, ns)==uri) {
-    gchar * prefix_local = g_strjoin(":", prefix, uri+nsLen, NULL);
-    g_free (uri);
-    *ctrlblk->uri_p = prefix_local;
-    ctrlblk->done=TRUE;
+
+  if ((!ctrlblk->prefix || nsLen > ctrlblk->nsLen) &&
+      strncmp(ctrlblk->uri, ns, nsLen)==0) {
+    ctrlblk->prefix = _prefix;
+    ctrlblk->nsLen = nsLen;
   }
 }
 
+/* For a single uri, a pass over the map is cheaper than building a trie,
+   use nsLocal2prefixLocal_trie() for many */
 void nsLocal2prefixLocal (gchar **g_heap_str, GHashTable *prefix2ns_map)
 {
-  if (!prefix2ns_map)
+  nsLocal2prefix_ctrlBlk ctrlblk;
+
+  if (!prefix2ns_map || !g_heap_str || !*g_heap_str)
     return; //nothing to do - its ok!
 
-    nsLocal2prefix_ctrlBlk nsLocal2prefix_ctrl;
-    nsLocal2prefix_ctrl.uri_p = g_heap_str;
-    nsLocal2prefix_ctrl.done = FALSE;
-    g_hash_table_foreach(prefix2ns_map, nsLocal2prefixLocal_hndl, &nsLocal2prefix_ctrl);
+  ctrlblk.uri = *g_heap_str;
+  ctrlblk.prefix = NULL;
+  ctrlblk.nsLen = 0;
+  g_hash_table_foreach(prefix2ns_map, nsLocal2prefixLocal_hndl, &ctrlblk);
+  if (ctrlblk.prefix)
+    nsLocal2prefixLocal_replace(g_heap_str, ctrlblk.prefix, ctrlblk.nsLen);
 }
 
 
@@ -2186,16 +2797,12 @@ sparqlSelect_charhndl(void *data, const char *s, int sLen)
 	  parseM3_setQuitParse(&blk->c, ss_ParsingError);
 	  return;
 	}
-      gchar *tmp2 = g_strndup(s, sLen);
-      if (!blk->parsedCharTxt)
-	blk->parsedCharTxt = tmp2;
-      else
-	{
-	  gchar *tmp1 = blk->parsedCharTxt;
-	  blk->parsedCharTxt = g_strconcat(tmp1,tmp2,NULL); 
-	  g_free(tmp1);
-	  g_free(tmp2);
-	}
+      // expat may deliver the text in several chunks, collect them for the element end
+      charStr chunk;
+      chunk.txt = s;
+      chunk.len = sLen;
+      if (addXML_append_str(&blk->charBuf, &chunk) != ss_StatusOK)
+	parseM3_setQuitParse(&blk->c, ss_NotEnoughResources);
    }
   return;
 }
@@ -2205,47 +2812,49 @@ charhndl(void *data, const char *s, int sLen)
 {
   whiteboard_log_debug_fb();
   ParseTriplesBlk *blk = (ParseTriplesBlk*)data;
-  if (blk->c.parseStatus)
+  if (blk->c.parseStatus || !blk->tripleComponentToParse)
     return;
 
-  //#if PRINT_TRACE
-  int i;
-  //fprintf(stderr,"depth: %d, len: %d, s: ", blk->depth, sLen);
-  //for (i = 0; i < sLen; i++)
-    //fprintf (stderr,"%c", s[i]);
-  //fprintf(stderr,"\n");
-  //#endif
-  gchar* tmp_str;
-  if( *blk->tripleComponentToParse )
+  // expat may deliver the text in several chunks, it is resolved once at
+  // the element end by parseM3XML_triples_resolve_component()
+  charStr chunk;
+  chunk.txt = s;
+  chunk.len = sLen;
+  if (addXML_append_str(&blk->charBuf, &chunk) != ss_StatusOK)
+    parseM3_setQuitParse(&blk->c, ss_NotEnoughResources);
+  whiteboard_log_debug_fe();
+}
+
+/* Assigns the collected character data to the triple component being
+   parsed, expanded with the SIB's prefixes and then, for URIs, compacted
+   with the user's prefixes */
+static void parseM3XML_triples_resolve_component(ParseTriplesBlk *blk)
+{
+  ssElement_t *component = blk->tripleComponentToParse;
+  gchar *txt;
+
+  blk->tripleComponentToParse = NULL;
+  if (!component || blk->charBuf.datLen == 0)
+    return;
+
+  txt = fullUri(blk->charBuf.buf, blk->charBuf.datLen, blk->sibs_prefix_ns_map); //allocates a string from g-heap
+  ssBufDesc_reset(&blk->charBuf);
+  if (*component)
     {
-      //printf("appending to current component string\n");
-      gchar *old = (*blk->tripleComponentToParse);
-      gchar *new = fullUri(s, sLen, blk->sibs_prefix_ns_map);
-      *blk->tripleComponentToParse = (ssElement_t)g_strconcat( old, new, NULL);
+      //literal objects start as ""
+      gchar *old = (gchar *)*component;
+      *component = (ssElement_t)g_strconcat(old, txt, NULL);
       g_free(old);
-      g_free(new);
+      g_free(txt);
     }
   else
-    {
-      //printf("creating new component string\n");
-      *blk->tripleComponentToParse = (ssElement_t)fullUri(s, sLen, blk->sibs_prefix_ns_map); //allocates a string from g-heap
-    }
-  // now to see if it can be translated back to a user prefix
-  // as advised in the hash table documentation, this might not be so efficient.
-  //Also the expansion to full URI before back to user prefix, could be avoided with some reworking ...
-
-  //if we have a map (I personnally believe, some'ah people out there DON'T have maps!)
-  //for all subj, pred and for all obj of URI type: (?? subj cant be lit?)
-  if (blk->usrs_prefix_ns_map &&
-      (blk->tripleComponentToParse != &blk->currentTriple->object || blk->currentTriple->objType == ssElement_TYPE_URI)) {
-    //  gint x = g_hash_table_size(blk->usrs_prefix_ns_map);
-    //  if (x) //if zero, has it been destroyed, and not nulled?
-    nsLocal2prefix_ctrlBlk nsLocal2prefix_ctrl;
-    nsLocal2prefix_ctrl.uri_p = (char **)blk->tripleComponentToParse;
-    nsLocal2prefix_ctrl.done = FALSE;
-    g_hash_table_foreach(blk->usrs_prefix_ns_map, nsLocal2prefixLocal_hndl, &nsLocal2prefix_ctrl);
+    *component = (ssElement_t)txt;
+
+  //for all subj, pred and for all obj of URI type, translate back to a user prefix
+  if (blk->usrs_ns_trie &&
+      (component != &blk->currentTriple->object || blk->currentTriple->objType == ssElement_TYPE_URI)) {
+    nsLocal2prefixLocal_trie((gchar **)component, blk->usrs_ns_trie);
   }
-  whiteboard_log_debug_fe();
 }
 
 static void XMLCALL CDATA_start(void* data)
@@ -2316,6 +2925,7 @@ start(void *data, const char *el, const char **attr)
       }
 
     XML_SetCharacterDataHandler(blk->c.p, charhndl);
+    ssBufDesc_reset(&blk->charBuf);
 
     if (SUFFIXeqSTR(blk->inUseSibNsUri,SIB_SUBJECT.txt,el)) 
       {
@@ -2412,6 +3022,7 @@ end (void *data, const char *el)
   fprintf(stderr,"%d:<%s>e\n",blk->depth, el);
 #endif
   XML_SetCharacterDataHandler(blk->c.p, NULL);
+  parseM3XML_triples_resolve_component(blk);
   //  if (currentTriple && g_str_has_prefix(el, rdfns) && 0==strcmp(&el[rdfns_l], "Description")) {
   if (blk->predicateDepth == ((blk->parseMode==SIB_REIFIED)?blk->depth+2:blk->depth+1)) {
 
@@ -2478,7 +3089,38 @@ end (void *data, const char *el)
 	}
       }
 #endif
-      *blk->tripleList_pp = g_slist_prepend (*blk->tripleList_pp, (gpointer)blk->currentTriple);
+      if (blk->tripleCB)
+	{
+	  if (!blk->tripleCB(blk->currentTriple, blk->tripleCBData))
+	    {
+	      blk->tripleCBStop = TRUE;
+	      XML_StopParser(blk->c.p, XML_FALSE);
+	    }
+	  ssFreeTriple(blk->currentTriple);
+	}
+      else if (blk->toBatch)
+	{
+	  ssTriple_t *t = blk->currentTriple;
+	  if (ssTripleBatch_append(blk->toBatch, t->subject, t->predicate, t->object, t->subjType, t->objType) != ss_StatusOK)
+	    {
+	      parseM3_setQuitParse(&blk->c, ss_NotEnoughResources);
+	      whiteboard_log_debug_fe();
+	      return;
+	    }
+	  ssFreeTriple(blk->currentTriple);
+	}
+      else if (blk->toArena)
+	{
+	  if (parseM3XML_triples_arena_add(blk, blk->currentTriple) != ss_StatusOK)
+	    {
+	      parseM3_setQuitParse(&blk->c, ss_NotEnoughResources);
+	      whiteboard_log_debug_fe();
+	      return;
+	    }
+	  ssFreeTriple(blk->currentTriple);
+	}
+      else
+	*blk->tripleList_pp = g_slist_prepend (*blk->tripleList_pp, (gpointer)blk->currentTriple);
     }
     else
       {
@@ -2506,7 +3148,7 @@ parseM3XML_triples_start (ParseTriplesBlk *blk)
   blk->inUseSibNsUri.txt = "";
   blk->inUseSibNsUri.len = 0;
   blk->tripleComponentToParse = NULL;
-  blk->c.p = XML_ParserCreateNS(NULL, 0);
+  blk->c.p = parseM3_parser_get(TRUE);
   if (! blk->c.p) {
     whiteboard_log_error("Couldn't allocate memory for parser\n");
     return ss_NotEnoughResources;
@@ -2531,8 +3173,7 @@ parseM3XML_triples_end (ParseTriplesBlk *blk)
 {
   if (!blk)
     return;
-  if(blk->c.p)
-    XML_ParserFree(blk->c.p);
+  parseM3_parser_put(blk->c.p, TRUE);
   ssFreeTriple(blk->currentTriple);
 #ifdef SIB_ROLE
   if(blk->bnode_name2uri_map)
@@ -2542,12 +3183,25 @@ parseM3XML_triples_end (ParseTriplesBlk *blk)
 #endif
   if(blk->sibs_prefix_ns_map)
     g_hash_table_destroy (blk->sibs_prefix_ns_map);
-  //note: the usrs_prefix_ns_map, if any, is a copy, to be freed elsewhere.
-  g_free(blk);
+  //note: the usrs_ns_trie, if any, is the caller's, to be freed elsewhere.
+  g_free(blk->charBuf.buf);
+  g_free(blk->arenaTriples.buf);
+  g_free(blk->arenaStrings.buf);
 }
 
 ssStatus_t
 parseM3_triples_SIB (GSList ** list_pp, const char * m3XML_triples_str, GHashTable *prefix_ns_map, gchar **bNodeUriList_str)
+{
+  ssNsTrie_t *ns_trie = (prefix_ns_map)? ssNsTrie_new(prefix_ns_map) : NULL;
+  ssStatus_t status;
+
+  status = parseM3_triples_SIB_trie(list_pp, m3XML_triples_str, ns_trie, bNodeUriList_str);
+  ssNsTrie_free(ns_trie);
+  return status;
+}
+
+ssStatus_t
+parseM3_triples_SIB_trie (GSList ** list_pp, const char * m3XML_triples_str, const ssNsTrie_t *ns_trie, gchar **bNodeUriList_str)
 {
   g_return_val_if_fail(list_pp!=NULL && m3XML_triples_str!=NULL, ss_InvalidParameter);
 #ifdef SIB_ROLE
@@ -2557,14 +3211,12 @@ parseM3_triples_SIB (GSList ** list_pp, const char * m3XML_triples_str, GHashTab
   g_return_val_if_fail(bNodeUriList_str==NULL, ss_InvalidParameter);
 #endif
 
-  ParseTriplesBlk *blk = g_new0(ParseTriplesBlk, 1);
-  if (!blk) {
-    whiteboard_log_error("Couldn't allocate memory for triple parsing\n");
-    return ss_NotEnoughResources;
-  }
+  ParseTriplesBlk blkData;
+  ParseTriplesBlk *blk = &blkData;
+  memset(blk, 0, sizeof(ParseTriplesBlk));
 
   blk->tripleList_pp = list_pp;
-  blk->usrs_prefix_ns_map = prefix_ns_map;
+  blk->usrs_ns_trie = ns_trie;
   if (bNodeUriList_str) {
     blk->bD_bNodeUriListXML = ssBufDesc_new();
     if (!blk->bD_bNodeUriListXML) {
@@ -2598,6 +3250,185 @@ parseM3_triples_SIB (GSList ** list_pp, const char * m3XML_triples_str, GHashTab
   return ssS;
 }
 
+/* Appends a copy of triple to the arena being built. The strings are
+   stored as offsets, as the string buffer may still move. */
+static ssStatus_t
+parseM3XML_triples_arena_add (ParseTriplesBlk *blk, ssTriple_t *triple)
+{
+  ssTriple_t rec = *triple;
+  ssElement_t *elems[3];
+  gint n, len;
+
+  elems[0] = &rec.subject;
+  elems[1] = &rec.predicate;
+  elems[2] = &rec.object;
+  for (n = 0; n < 3; n++)
+    {
+      if (!*elems[n])
+	continue; // NULL stays NULL
+      len = strlen((const char *)*elems[n]) + 1;
+      if (ssBufDesc_buf_realloc(&blk->arenaStrings, blk->arenaStrings.datLen + len) != ss_StatusOK)
+	return ss_NotEnoughResources;
+      memcpy(blk->arenaStrings.buf + blk->arenaStrings.datLen, *elems[n], len);
+      *elems[n] = (ssElement_t)GUINT_TO_POINTER(blk->arenaStrings.datLen + 1);
+      blk->arenaStrings.datLen += len;
+    }
+  if (ssBufDesc_buf_realloc(&blk->arenaTriples, blk->arenaTriples.datLen + sizeof(ssTriple_t)) != ss_StatusOK)
+    return ss_NotEnoughResources;
+  memcpy(blk->arenaTriples.buf + blk->arenaTriples.datLen, &rec, sizeof(ssTriple_t));
+  blk->arenaTriples.datLen += sizeof(ssTriple_t);
+  return ss_StatusOK;
+}
+
+ssStatus_t
+parseM3_triples_arena (ssTripleArena_t **arena, const char * m3XML_triples_str, const ssNsTrie_t *ns_trie)
+{
+  g_return_val_if_fail(arena!=NULL && *arena==NULL && m3XML_triples_str!=NULL, ss_InvalidParameter);
+
+  ParseTriplesBlk blkData;
+  ParseTriplesBlk *blk = &blkData;
+  ssTripleArena_t *a;
+  gchar *strings;
+  guint i;
+  memset(blk, 0, sizeof(ParseTriplesBlk));
+
+  blk->toArena = TRUE;
+  blk->usrs_ns_trie = ns_trie;
+
+  ssStatus_t ssS = parseM3XML_triples_start (blk);
+  if  (!ssS) {
+    //borrowing ssS, will be 0 if XML_Parse finds error
+    ssS = XML_Parse(blk->c.p, m3XML_triples_str, strlen(m3XML_triples_str), 1);
+    if (ssS==0)
+      ssS = ss_ParsingError;
+    else
+      ssS = blk->c.parseStatus;
+  }
+
+  if (!ssS) {
+    a = g_try_malloc(sizeof(ssTripleArena_t) + blk->arenaTriples.datLen + blk->arenaStrings.datLen);
+    if (!a)
+      ssS = ss_NotEnoughResources;
+    else {
+      a->length = blk->arenaTriples.datLen / sizeof(ssTriple_t);
+      a->triples = (ssTriple_t *)(a + 1);
+      strings = (gchar *)(a->triples + a->length);
+      if (a->length) {
+	memcpy(a->triples, blk->arenaTriples.buf, blk->arenaTriples.datLen);
+	memcpy(strings, blk->arenaStrings.buf, blk->arenaStrings.datLen);
+      }
+      for (i = 0; i < a->length; i++) {
+	ssTriple_t *t = &a->triples[i];
+	if (t->subject)   t->subject   = (ssElement_t)(strings + GPOINTER_TO_UINT(t->subject) - 1);
+	if (t->predicate) t->predicate = (ssElement_t)(strings + GPOINTER_TO_UINT(t->predicate) - 1);
+	if (t->object)    t->object    = (ssElement_t)(strings + GPOINTER_TO_UINT(t->object) - 1);
+      }
+      *arena = a;
+    }
+  }
+
+  parseM3XML_triples_end (blk);
+  return ssS;
+}
+
+/* Appends the parsed triples to batch in document order. On failure the
+   batch may hold some of the triples. */
+ssStatus_t
+parseM3_triples_batch (ssTripleBatch_t *batch, const char * m3XML_triples_str, const ssNsTrie_t *ns_trie)
+{
+  g_return_val_if_fail(batch!=NULL && m3XML_triples_str!=NULL, ss_InvalidParameter);
+
+  ParseTriplesBlk blkData;
+  ParseTriplesBlk *blk = &blkData;
+  memset(blk, 0, sizeof(ParseTriplesBlk));
+
+  blk->toBatch = batch;
+  blk->usrs_ns_trie = ns_trie;
+
+  ssStatus_t ssS = parseM3XML_triples_start (blk);
+  if  (!ssS) {
+    //borrowing ssS, will be 0 if XML_Parse finds error
+    ssS = XML_Parse(blk->c.p, m3XML_triples_str, strlen(m3XML_triples_str), 1);
+    if (ssS==0)
+      ssS = ss_ParsingError;
+    else
+      ssS = blk->c.parseStatus;
+  }
+
+  parseM3XML_triples_end (blk);
+  return ssS;
+}
+
+/* A triple parse fed in chunks, see parseM3_triples_stream_new() */
+struct _ssTripleStream {
+  ParseTriplesBlk blk;
+  gboolean done; // final chunk parsed
+};
+
+ssTripleStream_t *parseM3_triples_stream_new(const ssNsTrie_t *ns_trie, ssTripleStreamCB cb, gpointer user_data)
+{
+  ssTripleStream_t *stream;
+  g_return_val_if_fail(cb!=NULL, NULL);
+
+  stream = g_new0(ssTripleStream_t, 1);
+  stream->blk.tripleCB = cb;
+  stream->blk.tripleCBData = user_data;
+  stream->blk.usrs_ns_trie = ns_trie;
+
+  if (parseM3XML_triples_start(&stream->blk) != ss_StatusOK)
+    parseM3_triples_stream_free(&stream);
+  return stream;
+}
+
+ssStatus_t parseM3_triples_stream_feed(ssTripleStream_t *stream, const gchar *data, gint len, gboolean isFinal)
+{
+  ParseTriplesBlk *blk;
+  ssStatus_t status;
+
+  g_return_val_if_fail(stream!=NULL && (data!=NULL || len==0), ss_InvalidParameter);
+  g_return_val_if_fail(!stream->done, ss_InvalidParameter);
+  blk = &stream->blk;
+  if (blk->tripleCBStop)
+    return ss_StatusOK; //the rest of the document is not wanted
+
+  if (XML_Parse(blk->c.p, data, len, isFinal) == XML_STATUS_ERROR)
+    status = (blk->tripleCBStop)? ss_StatusOK : ((blk->c.parseStatus)? blk->c.parseStatus : ss_ParsingError);
+  else
+    status = blk->c.parseStatus;
+
+  if (isFinal || status != ss_StatusOK)
+    stream->done = TRUE;
+  return status;
+}
+
+void parseM3_triples_stream_free(ssTripleStream_t **stream)
+{
+  if (!stream || !*stream)
+    return;
+  parseM3XML_triples_end(&(*stream)->blk);
+  g_free(*stream);
+  *stream = NULL;
+}
+
+guint ssTripleArena_length(const ssTripleArena_t *arena)
+{
+  return (arena)? arena->length : 0;
+}
+
+const ssTriple_t *ssTripleArena_get(const ssTripleArena_t *arena, guint index)
+{
+  g_return_val_if_fail(arena!=NULL && index < arena->length, NULL);
+  return &arena->triples[index];
+}
+
+void ssTripleArena_free(ssTripleArena_t **arena)
+{
+  if (!arena || !*arena)
+    return;
+  g_free(*arena);
+  *arena = NULL;
+}
+
 #ifdef SIB_ROLE
 /*-------------------------------------------------------------------------------------*/
 
@@ -2639,7 +3470,7 @@ ssStatus_t parseM3_query_req_wql(ssWqlDesc_t *qD, const gchar *qXml)
   blk.inLiteral = FALSE;
   blk.inExpr = FALSE;
   blk.pp = NULL;
-  blk.c.p = XML_ParserCreate(NULL);
+  blk.c.p = parseM3_parser_get(FALSE);
   if (! blk.c.p) {
     whiteboard_log_error("Couldn't allocate memory for parser\n");
     whiteboard_log_debug_fe();
@@ -2652,7 +3483,7 @@ ssStatus_t parseM3_query_req_wql(ssWqlDesc_t *qD, const gchar *qXml)
   XML_SetUserData(blk.c.p, &blk);
 
   XML_Parse(blk.c.p, qXml, strlen(qXml), 1);
-  XML_ParserFree(blk.c.p);
+  parseM3_parser_put(blk.c.p, FALSE);
   
   whiteboard_log_debug_fe();
   return blk.c.parseStatus;
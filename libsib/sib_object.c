@@ -78,9 +78,42 @@ static void sib_object_unregister_handler(DBusConnection *connection,
 static DBusHandlerResult sib_object_dispatch_message(DBusConnection *conn,
 						     DBusMessage *msg,
 						     gpointer data);
-static DBusHandlerResult sib_object_control_handler(DBusConnection* conn,
+static DBusHandlerResult sib_object_subscription_ind(DBusConnection* conn,
+						     DBusMessage* message,
+						     gpointer data);
+static DBusHandlerResult sib_object_unsubscribe_ind(DBusConnection* conn,
 						    DBusMessage* message,
 						    gpointer data);
+static DBusHandlerResult sib_object_leave_ind(DBusConnection* conn,
+					      DBusMessage* message,
+					      gpointer data);
+static DBusHandlerResult sib_object_join_return(DBusConnection* conn,
+						DBusMessage* message,
+						gpointer data);
+static DBusHandlerResult sib_object_leave_return(DBusConnection* conn,
+						 DBusMessage* message,
+						 gpointer data);
+static DBusHandlerResult sib_object_insert_return(DBusConnection* conn,
+						  DBusMessage* message,
+						  gpointer data);
+static DBusHandlerResult sib_object_remove_return(DBusConnection* conn,
+						  DBusMessage* message,
+						  gpointer data);
+static DBusHandlerResult sib_object_update_return(DBusConnection* conn,
+						  DBusMessage* message,
+						  gpointer data);
+static DBusHandlerResult sib_object_query_return(DBusConnection* conn,
+						 DBusMessage* message,
+						 gpointer data);
+static DBusHandlerResult sib_object_subscribe_return(DBusConnection* conn,
+						     DBusMessage* message,
+						     gpointer data);
+static DBusHandlerResult sib_object_unsubscribe_return(DBusConnection* conn,
+						       DBusMessage* message,
+						       gpointer data);
+static DBusHandlerResult sib_object_control_handler_starting(DBusConnection* conn,
+							     DBusMessage* message,
+							     gpointer data);
 
 static DBusHandlerResult sib_object_control_handler_register_sib(DBusConnection* conn,
 								 DBusMessage* message,
@@ -95,9 +128,6 @@ static DBusHandlerResult sib_object_control_handler_refresh(DBusConnection* conn
 							    DBusMessage* message,
 							    gpointer data);
 
-//atic DBusHandlerResult sib_object_control_handler_starting(DBusConnection* conn,
-//						    DBusMessage* message,
-//						    gpointer data);
 
 							
 
@@ -191,6 +221,9 @@ enum
 
 static guint sib_object_signals[NUM_SIGNALS];
 
+/* Message routing, built in class_init */
+static WhiteBoardUtilDispatchTable *sib_object_dispatch_table = NULL;
+
 static void sib_object_lock_send(SibObject *self)
 {
   g_mutex_lock(self->send_lock);
@@ -221,6 +254,46 @@ static void sib_object_class_init(SibObjectClass *self)
   // object->dispose = sib_object_dispose;
   object->finalize = sib_object_finalize;
 
+  {
+    static const WhiteBoardUtilDispatchEntry entries[] = {
+      { DBUS_MESSAGE_TYPE_SIGNAL, SIB_DBUS_KP_INTERFACE,
+	SIB_DBUS_KP_SIGNAL_SUBSCRIPTION_IND, sib_object_subscription_ind },
+      { DBUS_MESSAGE_TYPE_SIGNAL, SIB_DBUS_KP_INTERFACE,
+	SIB_DBUS_KP_SIGNAL_UNSUBSCRIBE_IND, sib_object_unsubscribe_ind },
+      { DBUS_MESSAGE_TYPE_SIGNAL, SIB_DBUS_KP_INTERFACE,
+	SIB_DBUS_KP_SIGNAL_LEAVE_IND, sib_object_leave_ind },
+      { DBUS_MESSAGE_TYPE_METHOD_RETURN, SIB_DBUS_KP_INTERFACE,
+	SIB_DBUS_KP_METHOD_JOIN, sib_object_join_return },
+      { DBUS_MESSAGE_TYPE_METHOD_RETURN, SIB_DBUS_KP_INTERFACE,
+	SIB_DBUS_KP_METHOD_LEAVE, sib_object_leave_return },
+      { DBUS_MESSAGE_TYPE_METHOD_RETURN, SIB_DBUS_KP_INTERFACE,
+	SIB_DBUS_KP_METHOD_INSERT, sib_object_insert_return },
+      { DBUS_MESSAGE_TYPE_METHOD_RETURN, SIB_DBUS_KP_INTERFACE,
+	SIB_DBUS_KP_METHOD_REMOVE, sib_object_remove_return },
+      { DBUS_MESSAGE_TYPE_METHOD_RETURN, SIB_DBUS_KP_INTERFACE,
+	SIB_DBUS_KP_METHOD_UPDATE, sib_object_update_return },
+      { DBUS_MESSAGE_TYPE_METHOD_RETURN, SIB_DBUS_KP_INTERFACE,
+	SIB_DBUS_KP_METHOD_QUERY, sib_object_query_return },
+      { DBUS_MESSAGE_TYPE_METHOD_RETURN, SIB_DBUS_KP_INTERFACE,
+	SIB_DBUS_KP_METHOD_SUBSCRIBE, sib_object_subscribe_return },
+      { DBUS_MESSAGE_TYPE_METHOD_RETURN, SIB_DBUS_KP_INTERFACE,
+	SIB_DBUS_KP_METHOD_UNSUBSCRIBE, sib_object_unsubscribe_return },
+      { DBUS_MESSAGE_TYPE_SIGNAL, SIB_DBUS_CONTROL_INTERFACE,
+	SIB_DBUS_CONTROL_SIGNAL_STARTING, sib_object_control_handler_starting },
+      { DBUS_MESSAGE_TYPE_METHOD_CALL, SIB_DBUS_CONTROL_INTERFACE,
+	SIB_DBUS_CONTROL_METHOD_REFRESH, sib_object_control_handler_refresh },
+      { DBUS_MESSAGE_TYPE_METHOD_CALL, SIB_DBUS_CONTROL_INTERFACE,
+	SIB_DBUS_CONTROL_METHOD_SHUTDOWN, sib_object_control_handler_shutdown },
+      { DBUS_MESSAGE_TYPE_METHOD_CALL, SIB_DBUS_CONTROL_INTERFACE,
+	SIB_DBUS_CONTROL_METHOD_HEALTHCHECK, sib_object_control_handler_healthcheck },
+      { DBUS_MESSAGE_TYPE_METHOD_CALL, SIB_DBUS_CONTROL_INTERFACE,
+	SIB_DBUS_CONTROL_METHOD_REGISTER_SIB, sib_object_control_handler_register_sib },
+      { 0, NULL, NULL, NULL }
+    };
+
+    sib_object_dispatch_table = whiteboard_util_dispatch_table_new(entries);
+  }
+
   /*********************************************************************/
 
   sib_object_signals[SIGNAL_REFRESH] =
@@ -852,498 +925,419 @@ static DBusHandlerResult sib_object_control_handler_register_sib(DBusConnection
   return DBUS_HANDLER_RESULT_HANDLED;
 }
 
-static DBusHandlerResult sib_object_handler(DBusConnection* conn,
-					    DBusMessage* message,
-					    gpointer data)
+static DBusHandlerResult sib_object_subscription_ind(DBusConnection *conn,
+						     DBusMessage *message,
+						     gpointer data)
 {
-  
   SibObject *context = (SibObject *) data;
-  DBusHandlerResult retval = DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
-  const gchar* member = NULL;
-  gint type = 0;
+  gchar *spaceid = NULL;
+  gchar *nodeid = NULL;
+  gchar *results_new = NULL;
+  gchar *results_obsolete = NULL;
+  gchar *subscription_id = NULL;
+  gint msgnum = -1;
+  gint seqnum = -10;
+
+  whiteboard_log_debug("Subsciprion ind signal\n");
+  if (whiteboard_util_parse_message(message,
+				    DBUS_TYPE_STRING, &spaceid,
+				    DBUS_TYPE_STRING, &nodeid,
+				    DBUS_TYPE_INT32, &msgnum,
+				    DBUS_TYPE_INT32, &seqnum,
+				    DBUS_TYPE_STRING, &subscription_id,
+				    DBUS_TYPE_STRING, &results_new,
+				    DBUS_TYPE_STRING, &results_obsolete,
+				    WHITEBOARD_UTIL_LIST_END))
+    {
+      g_signal_emit( context,
+		     sib_object_signals[SIGNAL_SUBSCRIPTION_IND],
+		     0,
+		     spaceid,
+		     nodeid,
+		     msgnum,
+		     seqnum,
+		     subscription_id,
+		     results_new,
+		     results_obsolete);
+    }
+  else
+    {
+      whiteboard_log_warning("Could not parse SUBSCRIPTION IND signal parameters\n");
+    }
 
-  whiteboard_log_debug_fb();
+  return DBUS_HANDLER_RESULT_HANDLED;
+}
+
+static DBusHandlerResult sib_object_unsubscribe_ind(DBusConnection *conn,
+						    DBusMessage *message,
+						    gpointer data)
+{
+  SibObject *context = (SibObject *) data;
+  gchar *spaceid = NULL;
+  gchar *nodeid = NULL;
+  gchar *subscription_id = NULL;
+  gint status;
+  gint msgnum = -1;
+
+  whiteboard_log_debug("Unsubscibe ind signal\n");
+  if (whiteboard_util_parse_message(message,
+			     DBUS_TYPE_STRING, &spaceid,
+			     DBUS_TYPE_STRING, &nodeid,
+			     DBUS_TYPE_INT32, &msgnum,
+			     DBUS_TYPE_INT32, &status,
+			     DBUS_TYPE_STRING, &subscription_id,
+			     WHITEBOARD_UTIL_LIST_END))
+    {
+      g_signal_emit( context,
+		     sib_object_signals[SIGNAL_UNSUBSCRIBE_IND],
+		     0,
+		     spaceid,
+		     nodeid,
+		     msgnum,
+		     status,
+		     subscription_id);
+    }
+  else
+    {
+      whiteboard_log_warning("Could not parse UNSUBSCRIBE IND signal parameters\n");
+    }
 
-  member = dbus_message_get_member(message);
-  type = dbus_message_get_type(message);
+  return DBUS_HANDLER_RESULT_HANDLED;
+}
 
-  g_return_val_if_fail(member != NULL,
-		       DBUS_HANDLER_RESULT_NOT_YET_HANDLED);
+static DBusHandlerResult sib_object_leave_ind(DBusConnection *conn,
+					      DBusMessage *message,
+					      gpointer data)
+{
+  SibObject *context = (SibObject *) data;
+  gchar *spaceid = NULL;
+  gchar *nodeid = NULL;
+  gint status;
+  gint msgnum = -1;
 
-  whiteboard_log_debug("%s %d\n", member, type);
-  switch (type)
+  whiteboard_log_debug("Leave ind signal\n");
+  if (whiteboard_util_parse_message(message,
+			     DBUS_TYPE_STRING, &spaceid,
+			     DBUS_TYPE_STRING, &nodeid,
+			     DBUS_TYPE_INT32, &msgnum,
+			     DBUS_TYPE_INT32, &status,
+			     WHITEBOARD_UTIL_LIST_END))
     {
-    case DBUS_MESSAGE_TYPE_SIGNAL:
-      {
-
-	if( !strcmp(member, SIB_DBUS_KP_SIGNAL_SUBSCRIPTION_IND) )
-	  {
-	    gchar *spaceid = NULL;
-	    gchar *nodeid = NULL;
-	    gchar *results_new = NULL;
-	    gchar *results_obsolete = NULL;
-	    gchar *subscription_id = NULL;
-	    gint msgnum = -1;
-	    gint seqnum = -10;
-
-	    whiteboard_log_debug("Subsciprion ind signal\n");
-	    if (whiteboard_util_parse_message(message,
-					      DBUS_TYPE_STRING, &spaceid,
-					      DBUS_TYPE_STRING, &nodeid,
-					      DBUS_TYPE_INT32, &msgnum,
-					      DBUS_TYPE_INT32, &seqnum,
-					      DBUS_TYPE_STRING, &subscription_id,
-					      DBUS_TYPE_STRING, &results_new,
-					      DBUS_TYPE_STRING, &results_obsolete,
-					      WHITEBOARD_UTIL_LIST_END))
-	      {
-		g_signal_emit( context,
-			       sib_object_signals[SIGNAL_SUBSCRIPTION_IND],
-			       0,
-			       spaceid,
-			       nodeid,
-			       msgnum,
-			       seqnum,
-			       subscription_id,
-			       results_new,
-			       results_obsolete);
-	      }
-	    else
-	      {
-		whiteboard_log_warning("Could not parse SUBSCRIPTION IND signal parameters\n");
-	      }
-	    retval = DBUS_HANDLER_RESULT_HANDLED;
-	  }
-	else if( !strcmp(member, SIB_DBUS_KP_SIGNAL_UNSUBSCRIBE_IND) )
-	  {
-	    gchar *spaceid = NULL;
-	    gchar *nodeid = NULL;
-	    gchar *subscription_id = NULL;
-	    gint status;
-	    gint msgnum = -1;
-	    
-	    whiteboard_log_debug("Unsubscibe ind signal\n");
-	    if (whiteboard_util_parse_message(message,
-				       DBUS_TYPE_STRING, &spaceid,
-				       DBUS_TYPE_STRING, &nodeid,
-				       DBUS_TYPE_INT32, &msgnum,
-				       DBUS_TYPE_INT32, &status,
-				       DBUS_TYPE_STRING, &subscription_id,
-				       WHITEBOARD_UTIL_LIST_END))
-	      {
-		g_signal_emit( context,
-			       sib_object_signals[SIGNAL_UNSUBSCRIBE_IND],
-			       0,
-			       spaceid,
-			       nodeid,
-			       msgnum,
-			       status,
-			       subscription_id);
-	      }
-	    else
-	      {
-		whiteboard_log_warning("Could not parse UNSUBSCRIBE IND signal parameters\n");
-	      }
-	    retval = DBUS_HANDLER_RESULT_HANDLED;
-	  }
-	else if( !strcmp(member, SIB_DBUS_KP_SIGNAL_LEAVE_IND) )
-	  {
-	    gchar *spaceid = NULL;
-	    gchar *nodeid = NULL;
-	    gint status;
-	    gint msgnum = -1;
-
-	    whiteboard_log_debug("Leave ind signal\n");
-	    if (whiteboard_util_parse_message(message,
-				       DBUS_TYPE_STRING, &spaceid,
-				       DBUS_TYPE_STRING, &nodeid,
-				       DBUS_TYPE_INT32, &msgnum,
-				       DBUS_TYPE_INT32, &status,
-				       WHITEBOARD_UTIL_LIST_END))
-	      {
-		g_signal_emit( context,
-			       sib_object_signals[SIGNAL_LEAVE_IND],
-			       0,
-			       spaceid,
-			       nodeid,
-			       msgnum,
-			       status);
-	      }
-	    else
-	      {
-		whiteboard_log_warning("Could not parse UNSUBSCRIBE IND signal parameters\n");
-	      }
-	    retval = DBUS_HANDLER_RESULT_HANDLED;
-	  }
-	else
-	  {
-	    whiteboard_log_error("Unknown signal: %s\n",
-			    member);
-	  }
-      }
-      break;
-
-    case DBUS_MESSAGE_TYPE_METHOD_RETURN:
-      if( !strcmp(member, SIB_DBUS_KP_METHOD_JOIN ) )
-	{
-	  gchar *spaceid = NULL;
-	  gchar *nodeid = NULL;
-	  gchar *credentials = NULL;
-	  gint msgnum = -1;
-	  gint success = -1;
-	  whiteboard_log_debug("Join method return\n");
-	  if (whiteboard_util_parse_message(message,
-				     DBUS_TYPE_STRING, &spaceid,
-				     DBUS_TYPE_STRING, &nodeid,
-				     DBUS_TYPE_INT32, &msgnum,
-				     DBUS_TYPE_INT32, &success,
-				     DBUS_TYPE_STRING, &credentials,
-				     WHITEBOARD_UTIL_LIST_END))
-	    {
-	      g_signal_emit( context,
-			     sib_object_signals[SIGNAL_JOIN_CNF],
-			     0,
-			     spaceid,
-			     nodeid,
-			     msgnum,
-			     success,
-			     credentials);
-	    }
-	  else
-	    {
-	      whiteboard_log_warning("Could not parse JOIN method return parameters\n");
-	    }
-	  retval = DBUS_HANDLER_RESULT_HANDLED;
-	}
-      else if( !strcmp(member, SIB_DBUS_KP_METHOD_LEAVE ) )
-	{
-	  gchar *spaceid = NULL;
-	  gchar *nodeid = NULL;
-	  gint msgnum = -1;
-	  gint success = -1;
-	  whiteboard_log_debug("Leave method return\n");
-	  if (whiteboard_util_parse_message(message,
-				     DBUS_TYPE_STRING, &spaceid,
-				     DBUS_TYPE_STRING, &nodeid,
-				     DBUS_TYPE_INT32, &msgnum,
-				     DBUS_TYPE_INT32, &success,
-				     WHITEBOARD_UTIL_LIST_END))
-	    {
-	      g_signal_emit( context,
-			     sib_object_signals[SIGNAL_LEAVE_CNF],
-			     0,
-			     spaceid,
-			     nodeid,
-			     msgnum,
-			     success);
-	    }
-	  else
-	    {
-	      whiteboard_log_warning("Could not parse LEAVE method return parameters\n");
-	    }
-	  retval = DBUS_HANDLER_RESULT_HANDLED;
-	}
-      else if( !strcmp(member, SIB_DBUS_KP_METHOD_INSERT ) )
-	{
-	  gchar *spaceid = NULL;
-	  gchar *nodeid = NULL;
-	  gchar *bNodes = NULL;
-	  gint msgnum = -1;
-	  gint success = -1;
-	  whiteboard_log_debug("Insert method return\n");
-	  if (whiteboard_util_parse_message(message,
-				     DBUS_TYPE_STRING, &spaceid,
-				     DBUS_TYPE_STRING, &nodeid,
-				     DBUS_TYPE_INT32, &msgnum,
-				     DBUS_TYPE_INT32, &success,
-				     DBUS_TYPE_STRING, &bNodes,
-				     WHITEBOARD_UTIL_LIST_END))
-	    {
-	      g_signal_emit( context,
-			     sib_object_signals[SIGNAL_INSERT_CNF],
-			     0,
-			     spaceid,
-			     nodeid,
-			     msgnum,
-			     success,
-			     bNodes);
-	    }
-	  else
-	    {
-	      whiteboard_log_warning("Could not parse INSERT method return parameters\n");
-	    }
-	  retval = DBUS_HANDLER_RESULT_HANDLED;
-	}
-      else if( !strcmp(member, SIB_DBUS_KP_METHOD_REMOVE ) )
-	{
-	  gchar *spaceid = NULL;
-	  gchar *nodeid = NULL;
-	  gint msgnum = -1;
-	  gint success = -1;
-	  whiteboard_log_debug("Remove method return\n");
-	  if (whiteboard_util_parse_message(message,
-				     DBUS_TYPE_STRING, &spaceid,
-				     DBUS_TYPE_STRING, &nodeid,
-				     DBUS_TYPE_INT32, &msgnum,
-				     DBUS_TYPE_INT32, &success,
-				     WHITEBOARD_UTIL_LIST_END))
-	    {
-	      g_signal_emit( context,
-			     sib_object_signals[SIGNAL_REMOVE_CNF],
-			     0,
-			     spaceid,
-			     nodeid,
-			     msgnum,
-			     success);
-	    }
-	  else
-	    {
-	      whiteboard_log_error("Could not parse REMOVE method return parameters\n");
-	    }
-	  retval = DBUS_HANDLER_RESULT_HANDLED;
-	}
-      else if( !strcmp(member, SIB_DBUS_KP_METHOD_UPDATE ) )
-	{
-	  gchar *spaceid = NULL;
-	  gchar *nodeid = NULL;
-	  gchar *bNodes = NULL;
-	  gint msgnum = -1;
-	  gint success = -1;
-	  whiteboard_log_debug("Update method return\n");
-	  if (whiteboard_util_parse_message(message,
-				     DBUS_TYPE_STRING, &spaceid,
-				     DBUS_TYPE_STRING, &nodeid,
-				     DBUS_TYPE_INT32, &msgnum,
-				     DBUS_TYPE_INT32, &success,
-				     DBUS_TYPE_STRING, &bNodes,
-				     WHITEBOARD_UTIL_LIST_END))
-	    {
-	      g_signal_emit( context,
-			     sib_object_signals[SIGNAL_UPDATE_CNF],
-			     0,
-			     spaceid,
-			     nodeid,
-			     msgnum,
-			     success,
-			     bNodes);
-	    }
-	  else
-	    {
-	      whiteboard_log_warning("Could not parse UPDATE method return parameters\n");
-	    }
-	  retval = DBUS_HANDLER_RESULT_HANDLED;
-	}
-      else if( !strcmp(member, SIB_DBUS_KP_METHOD_QUERY ) )
-	{
-	  gchar *spaceid = NULL;
-	  gchar *nodeid = NULL;
-	  gchar *results = NULL;
-	  gint msgnum = -1;
-	  gint success = -1;
-	  whiteboard_log_debug("Query method return\n");
-	  if (whiteboard_util_parse_message(message,
-				     DBUS_TYPE_STRING, &spaceid,
-				     DBUS_TYPE_STRING, &nodeid,
-				     DBUS_TYPE_INT32, &msgnum,
-				     DBUS_TYPE_INT32, &success,
-				     DBUS_TYPE_STRING, &results,
-				     WHITEBOARD_UTIL_LIST_END))
-	    {
-	      g_signal_emit( context,
-			     sib_object_signals[SIGNAL_QUERY_CNF],
-			     0,
-			     spaceid,
-			     nodeid,
-			     msgnum,
-			     success,
-			     results);
-	    }
-	  else
-	    {
-	      whiteboard_log_warning("Could not parse QUERY method return parameters\n");
-	    }
-	  retval = DBUS_HANDLER_RESULT_HANDLED;
-	}
-      else if( !strcmp(member, SIB_DBUS_KP_METHOD_SUBSCRIBE ) )
-	{
-	  gchar *spaceid = NULL;
-	  gchar *nodeid = NULL;
-	  gchar *results = NULL;
-	  gchar *subscription_id = NULL;
-	  gint msgnum = -1;
-	  gint success = -1;
-	  whiteboard_log_debug("Subscribe method return\n");
-	  if (whiteboard_util_parse_message(message,
-				     DBUS_TYPE_STRING, &spaceid,
-				     DBUS_TYPE_STRING, &nodeid,
-				     DBUS_TYPE_INT32, &msgnum,
-				     DBUS_TYPE_INT32, &success,
-				     DBUS_TYPE_STRING, &subscription_id,
-				     DBUS_TYPE_STRING, &results,
-				     WHITEBOARD_UTIL_LIST_END))
-	    {
-	      g_signal_emit( context,
-			     sib_object_signals[SIGNAL_SUBSCRIBE_CNF],
-			     0,
-			     spaceid,
-			     nodeid,
-			     msgnum,
-			     success,
-			     subscription_id,
-			     results);
-	    }
-	  else
-	    {
-	      whiteboard_log_warning("Could not parse SUBSCRIBE method return parameters\n");
-	    }
-	  retval = DBUS_HANDLER_RESULT_HANDLED;
-	}
-      else if( !strcmp(member, SIB_DBUS_KP_METHOD_UNSUBSCRIBE ) )
-	{
-	  gchar *spaceid = NULL;
-	  gchar *nodeid = NULL;
-	  gchar *subid = NULL;
-	  gint msgnum = -1;
-	  gint success = -1;
-	  whiteboard_log_debug("Unsubscribe method return\n");
-	  if (whiteboard_util_parse_message(message,
-					    DBUS_TYPE_STRING, &spaceid,
-					    DBUS_TYPE_STRING, &nodeid,
-					    DBUS_TYPE_INT32, &msgnum,
-					    DBUS_TYPE_INT32, &success,
-					    DBUS_TYPE_STRING, &subid,
-					    WHITEBOARD_UTIL_LIST_END))
-	    {
-	      g_signal_emit( context,
-			     sib_object_signals[SIGNAL_UNSUBSCRIBE_CNF],
-			     0,
-			     spaceid,
-			     nodeid,
-			     msgnum,
-			     success,
-			     subid);
-	    }
-	  else
-	    {
-	      whiteboard_log_warning("Could not parse SUBSCRIBE method return parameters\n");
-	    }
-	  retval = DBUS_HANDLER_RESULT_HANDLED;
-	}
-      else
-	{
-	  whiteboard_log_error("Unknown method return: %s\n", member);
-	}
-      break;
+      g_signal_emit( context,
+		     sib_object_signals[SIGNAL_LEAVE_IND],
+		     0,
+		     spaceid,
+		     nodeid,
+		     msgnum,
+		     status);
+    }
+  else
+    {
+      whiteboard_log_warning("Could not parse UNSUBSCRIBE IND signal parameters\n");
+    }
 
-    case DBUS_MESSAGE_TYPE_METHOD_CALL:
+  return DBUS_HANDLER_RESULT_HANDLED;
+}
 
+static DBusHandlerResult sib_object_join_return(DBusConnection *conn,
+						DBusMessage *message,
+						gpointer data)
+{
+  SibObject *context = (SibObject *) data;
+  gchar *spaceid = NULL;
+  gchar *nodeid = NULL;
+  gchar *credentials = NULL;
+  gint msgnum = -1;
+  gint success = -1;
+  whiteboard_log_debug("Join method return\n");
+  if (whiteboard_util_parse_message(message,
+			     DBUS_TYPE_STRING, &spaceid,
+			     DBUS_TYPE_STRING, &nodeid,
+			     DBUS_TYPE_INT32, &msgnum,
+			     DBUS_TYPE_INT32, &success,
+			     DBUS_TYPE_STRING, &credentials,
+			     WHITEBOARD_UTIL_LIST_END))
+    {
+      g_signal_emit( context,
+		     sib_object_signals[SIGNAL_JOIN_CNF],
+		     0,
+		     spaceid,
+		     nodeid,
+		     msgnum,
+		     success,
+		     credentials);
+    }
+  else
+    {
+      whiteboard_log_warning("Could not parse JOIN method return parameters\n");
+    }
 
-      {
-	whiteboard_log_warning("Unknown method call: %s\n",
-			member);
-      }
+  return DBUS_HANDLER_RESULT_HANDLED;
+}
 
-      break;
-    default:
-      whiteboard_log_warning("Unknown message type: %d\n", type);
-      break;
+static DBusHandlerResult sib_object_leave_return(DBusConnection *conn,
+						 DBusMessage *message,
+						 gpointer data)
+{
+  SibObject *context = (SibObject *) data;
+  gchar *spaceid = NULL;
+  gchar *nodeid = NULL;
+  gint msgnum = -1;
+  gint success = -1;
+  whiteboard_log_debug("Leave method return\n");
+  if (whiteboard_util_parse_message(message,
+			     DBUS_TYPE_STRING, &spaceid,
+			     DBUS_TYPE_STRING, &nodeid,
+			     DBUS_TYPE_INT32, &msgnum,
+			     DBUS_TYPE_INT32, &success,
+			     WHITEBOARD_UTIL_LIST_END))
+    {
+      g_signal_emit( context,
+		     sib_object_signals[SIGNAL_LEAVE_CNF],
+		     0,
+		     spaceid,
+		     nodeid,
+		     msgnum,
+		     success);
+    }
+  else
+    {
+      whiteboard_log_warning("Could not parse LEAVE method return parameters\n");
     }
 
-  whiteboard_log_debug_fe();
-
-  return retval;
+  return DBUS_HANDLER_RESULT_HANDLED;
 }
 
-static DBusHandlerResult sib_object_control_handler(DBusConnection* conn,
-						    DBusMessage* message,
-						    gpointer data)
+static DBusHandlerResult sib_object_insert_return(DBusConnection *conn,
+						  DBusMessage *message,
+						  gpointer data)
 {
-  DBusHandlerResult retval = DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
-  const gchar* member = NULL;
-  gint type = 0;
+  SibObject *context = (SibObject *) data;
+  gchar *spaceid = NULL;
+  gchar *nodeid = NULL;
+  gchar *bNodes = NULL;
+  gint msgnum = -1;
+  gint success = -1;
+  whiteboard_log_debug("Insert method return\n");
+  if (whiteboard_util_parse_message(message,
+			     DBUS_TYPE_STRING, &spaceid,
+			     DBUS_TYPE_STRING, &nodeid,
+			     DBUS_TYPE_INT32, &msgnum,
+			     DBUS_TYPE_INT32, &success,
+			     DBUS_TYPE_STRING, &bNodes,
+			     WHITEBOARD_UTIL_LIST_END))
+    {
+      g_signal_emit( context,
+		     sib_object_signals[SIGNAL_INSERT_CNF],
+		     0,
+		     spaceid,
+		     nodeid,
+		     msgnum,
+		     success,
+		     bNodes);
+    }
+  else
+    {
+      whiteboard_log_warning("Could not parse INSERT method return parameters\n");
+    }
 
-  whiteboard_log_debug_fb();
+  return DBUS_HANDLER_RESULT_HANDLED;
+}
 
-  member = dbus_message_get_member(message);
-  type = dbus_message_get_type(message);
+static DBusHandlerResult sib_object_remove_return(DBusConnection *conn,
+						  DBusMessage *message,
+						  gpointer data)
+{
+  SibObject *context = (SibObject *) data;
+  gchar *spaceid = NULL;
+  gchar *nodeid = NULL;
+  gint msgnum = -1;
+  gint success = -1;
+  whiteboard_log_debug("Remove method return\n");
+  if (whiteboard_util_parse_message(message,
+			     DBUS_TYPE_STRING, &spaceid,
+			     DBUS_TYPE_STRING, &nodeid,
+			     DBUS_TYPE_INT32, &msgnum,
+			     DBUS_TYPE_INT32, &success,
+			     WHITEBOARD_UTIL_LIST_END))
+    {
+      g_signal_emit( context,
+		     sib_object_signals[SIGNAL_REMOVE_CNF],
+		     0,
+		     spaceid,
+		     nodeid,
+		     msgnum,
+		     success);
+    }
+  else
+    {
+      whiteboard_log_error("Could not parse REMOVE method return parameters\n");
+    }
 
-  g_return_val_if_fail(member != NULL,
-		       DBUS_HANDLER_RESULT_NOT_YET_HANDLED);
+  return DBUS_HANDLER_RESULT_HANDLED;
+}
 
-  switch (type)
+static DBusHandlerResult sib_object_update_return(DBusConnection *conn,
+						  DBusMessage *message,
+						  gpointer data)
+{
+  SibObject *context = (SibObject *) data;
+  gchar *spaceid = NULL;
+  gchar *nodeid = NULL;
+  gchar *bNodes = NULL;
+  gint msgnum = -1;
+  gint success = -1;
+  whiteboard_log_debug("Update method return\n");
+  if (whiteboard_util_parse_message(message,
+			     DBUS_TYPE_STRING, &spaceid,
+			     DBUS_TYPE_STRING, &nodeid,
+			     DBUS_TYPE_INT32, &msgnum,
+			     DBUS_TYPE_INT32, &success,
+			     DBUS_TYPE_STRING, &bNodes,
+			     WHITEBOARD_UTIL_LIST_END))
+    {
+      g_signal_emit( context,
+		     sib_object_signals[SIGNAL_UPDATE_CNF],
+		     0,
+		     spaceid,
+		     nodeid,
+		     msgnum,
+		     success,
+		     bNodes);
+    }
+  else
     {
-    case DBUS_MESSAGE_TYPE_SIGNAL:
+      whiteboard_log_warning("Could not parse UPDATE method return parameters\n");
+    }
 
-      if (!strcmp(member, SIB_DBUS_CONTROL_SIGNAL_STARTING))
-	{
-	  /* If we get this signal it means that Sib has 
-	     been shut down (abnormally) and is restarting. To
-	     avoid duplicate processes we'll shut down and let
-	     Sib restart us right away. */
-	  whiteboard_log_debugc(WHITEBOARD_DEBUG_SIB,
-			 "Sib restart detected, " \
-			 "shutting down.\n");
-	  retval = sib_object_control_handler_shutdown(conn,
-						       message,
-						       data);
-	}
-      else
-	{
-	  whiteboard_log_error("Unknown signal: %s\n", member);
-	}
-		
-      break;
+  return DBUS_HANDLER_RESULT_HANDLED;
+}
 
-    case DBUS_MESSAGE_TYPE_METHOD_RETURN:
+static DBusHandlerResult sib_object_query_return(DBusConnection *conn,
+						 DBusMessage *message,
+						 gpointer data)
+{
+  SibObject *context = (SibObject *) data;
+  gchar *spaceid = NULL;
+  gchar *nodeid = NULL;
+  gchar *results = NULL;
+  gint msgnum = -1;
+  gint success = -1;
+  whiteboard_log_debug("Query method return\n");
+  if (whiteboard_util_parse_message(message,
+			     DBUS_TYPE_STRING, &spaceid,
+			     DBUS_TYPE_STRING, &nodeid,
+			     DBUS_TYPE_INT32, &msgnum,
+			     DBUS_TYPE_INT32, &success,
+			     DBUS_TYPE_STRING, &results,
+			     WHITEBOARD_UTIL_LIST_END))
+    {
+      g_signal_emit( context,
+		     sib_object_signals[SIGNAL_QUERY_CNF],
+		     0,
+		     spaceid,
+		     nodeid,
+		     msgnum,
+		     success,
+		     results);
+    }
+  else
+    {
+      whiteboard_log_warning("Could not parse QUERY method return parameters\n");
+    }
 
-      whiteboard_log_error("Unknown method return: %s\n",
-		      member);
-      
-      retval = DBUS_HANDLER_RESULT_HANDLED;
-      
-      break;
+  return DBUS_HANDLER_RESULT_HANDLED;
+}
 
-    case DBUS_MESSAGE_TYPE_METHOD_CALL:
+static DBusHandlerResult sib_object_subscribe_return(DBusConnection *conn,
+						     DBusMessage *message,
+						     gpointer data)
+{
+  SibObject *context = (SibObject *) data;
+  gchar *spaceid = NULL;
+  gchar *nodeid = NULL;
+  gchar *results = NULL;
+  gchar *subscription_id = NULL;
+  gint msgnum = -1;
+  gint success = -1;
+  whiteboard_log_debug("Subscribe method return\n");
+  if (whiteboard_util_parse_message(message,
+			     DBUS_TYPE_STRING, &spaceid,
+			     DBUS_TYPE_STRING, &nodeid,
+			     DBUS_TYPE_INT32, &msgnum,
+			     DBUS_TYPE_INT32, &success,
+			     DBUS_TYPE_STRING, &subscription_id,
+			     DBUS_TYPE_STRING, &results,
+			     WHITEBOARD_UTIL_LIST_END))
+    {
+      g_signal_emit( context,
+		     sib_object_signals[SIGNAL_SUBSCRIBE_CNF],
+		     0,
+		     spaceid,
+		     nodeid,
+		     msgnum,
+		     success,
+		     subscription_id,
+		     results);
+    }
+  else
+    {
+      whiteboard_log_warning("Could not parse SUBSCRIBE method return parameters\n");
+    }
 
-      if (!strcmp(member, SIB_DBUS_CONTROL_METHOD_REFRESH))
-	{
-	  retval = sib_object_control_handler_refresh(conn,
-						      message,
-						      data);
-	}
-      else if (!strcmp(member, SIB_DBUS_CONTROL_METHOD_SHUTDOWN))
-	{
-	  retval = sib_object_control_handler_shutdown(conn,
-						       message,
-						       data);
-	}
-      else if (!strcmp(member, SIB_DBUS_CONTROL_METHOD_HEALTHCHECK))
-	{
-	  retval = sib_object_control_handler_healthcheck(conn,
-							  message,
-							  data);
-	}
-      else if (!strcmp(member, SIB_DBUS_CONTROL_METHOD_REGISTER_SIB))
-	{
-	  retval = sib_object_control_handler_register_sib(conn,
-							   message,
-							   data);
-	}
-      else
-	{
-	  whiteboard_log_error("Unknown method call: %s\n",
-			  member);
-	}
+  return DBUS_HANDLER_RESULT_HANDLED;
+}
 
-      break;
-    default:
-      whiteboard_log_error("Unknown message type: %d\n", type);
-      break;
+static DBusHandlerResult sib_object_unsubscribe_return(DBusConnection *conn,
+						       DBusMessage *message,
+						       gpointer data)
+{
+  SibObject *context = (SibObject *) data;
+  gchar *spaceid = NULL;
+  gchar *nodeid = NULL;
+  gchar *subid = NULL;
+  gint msgnum = -1;
+  gint success = -1;
+  whiteboard_log_debug("Unsubscribe method return\n");
+  if (whiteboard_util_parse_message(message,
+				    DBUS_TYPE_STRING, &spaceid,
+				    DBUS_TYPE_STRING, &nodeid,
+				    DBUS_TYPE_INT32, &msgnum,
+				    DBUS_TYPE_INT32, &success,
+				    DBUS_TYPE_STRING, &subid,
+				    WHITEBOARD_UTIL_LIST_END))
+    {
+      g_signal_emit( context,
+		     sib_object_signals[SIGNAL_UNSUBSCRIBE_CNF],
+		     0,
+		     spaceid,
+		     nodeid,
+		     msgnum,
+		     success,
+		     subid);
+    }
+  else
+    {
+      whiteboard_log_warning("Could not parse SUBSCRIBE method return parameters\n");
     }
 
-  whiteboard_log_debug_fe();
+  return DBUS_HANDLER_RESULT_HANDLED;
+}
 
-  return retval;
+static DBusHandlerResult sib_object_control_handler_starting(DBusConnection *conn,
+							     DBusMessage *message,
+							     gpointer data)
+{
+  /* If we get this signal it means that Sib has
+     been shut down (abnormally) and is restarting. To
+     avoid duplicate processes we'll shut down and let
+     Sib restart us right away. */
+  whiteboard_log_debugc(WHITEBOARD_DEBUG_SIB,
+			"Sib restart detected, " \
+			"shutting down.\n");
+  return sib_object_control_handler_shutdown(conn,
+					     message,
+					     data);
 }
 
 static DBusHandlerResult sib_object_dispatch_message(DBusConnection *conn,
@@ -1351,23 +1345,17 @@ static DBusHandlerResult sib_object_dispatch_message(DBusConnection *conn,
 						     gpointer data)
 {
   DBusHandlerResult retval = DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
-  const gchar* interface = NULL;
+  DBusObjectPathMessageFunction handler = NULL;
   SibObject *self = (SibObject *)data;
   whiteboard_log_debug_fb();
 
-  interface = dbus_message_get_interface(message);
   g_return_val_if_fail(self != NULL,
 		       DBUS_HANDLER_RESULT_NOT_YET_HANDLED);
-  g_return_val_if_fail(interface != NULL,
-		       DBUS_HANDLER_RESULT_NOT_YET_HANDLED);
   sib_object_lock_recv(self);
-  if (!strcmp(interface, SIB_DBUS_KP_INTERFACE))
-    {
-      retval = sib_object_handler(conn, message, data);
-    }
-  else if (!strcmp(interface, SIB_DBUS_CONTROL_INTERFACE))
+  handler = whiteboard_util_dispatch_table_lookup(sib_object_dispatch_table, message);
+  if (handler)
     {
-      retval = sib_object_control_handler(conn, message, data);
+      retval = handler(conn, message, data);
     }
   else
     {
@@ -1376,10 +1364,14 @@ static DBusHandlerResult sib_object_dispatch_message(DBusConnection *conn,
 		     dbus_message_get_type(message),
 		     dbus_message_get_interface(message),
 		     dbus_message_get_member(message));
-		
-      retval = DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+
+      /* Stray control method returns are consumed, anything else is
+	 left to other handlers */
+      if (dbus_message_get_type(message) == DBUS_MESSAGE_TYPE_METHOD_RETURN &&
+	  dbus_message_has_interface(message, SIB_DBUS_CONTROL_INTERFACE))
+	retval = DBUS_HANDLER_RESULT_HANDLED;
     }
-	
+
   whiteboard_log_debug_fe();
   sib_object_unlock_recv(self);
   return retval;
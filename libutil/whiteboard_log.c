@@ -425,20 +425,503 @@ void whiteboard_log_print_message(gint level, gint id,
 
 
 #else
-   
+
+#include <syslog.h>
+
+#include "whiteboard_dbus_ifaces.h"
+
+/* Records are formatted on the calling thread into a ring buffer owned by
+   that thread and written to the sinks by a single writer thread. Each ring
+   has one producer (its thread) and one consumer (whoever holds
+   whiteboard_log_drain_mutex), so the hot path takes no locks. */
+#define WHITEBOARD_LOG_RING_SIZE 256 /* records, power of two */
+#define WHITEBOARD_LOG_RECORD_SIZE 256
+#define WHITEBOARD_LOG_FLUSH_INTERVAL 20000 /* usec */
+
+typedef struct _WhiteBoardLogRecord
+{
+  GLogLevelFlags level;
+  gchar text[WHITEBOARD_LOG_RECORD_SIZE];
+} WhiteBoardLogRecord;
+
+typedef struct _WhiteBoardLogRing
+{
+  volatile gint head;     /* advanced by the owning thread only */
+  volatile gint tail;     /* advanced by the consumer only */
+  volatile gint dropped;
+  volatile gint orphaned; /* owning thread has exited */
+  WhiteBoardLogRecord records[WHITEBOARD_LOG_RING_SIZE];
+} WhiteBoardLogRing;
+
+typedef struct _WhiteBoardLogSinks
+{
+  guint mask;
+  FILE *stream;
+  DBusConnection *connection;
+} WhiteBoardLogSinks;
+
+static GStaticPrivate whiteboard_log_ring_key = G_STATIC_PRIVATE_INIT;
+/* protects the ring list, the writer and the sink settings */
+static GStaticMutex whiteboard_log_mutex = G_STATIC_MUTEX_INIT;
+/* serializes consumers */
+static GStaticMutex whiteboard_log_drain_mutex = G_STATIC_MUTEX_INIT;
+static GSList *whiteboard_log_rings = NULL;
+static GThread *whiteboard_log_writer = NULL;
+static GMutex *whiteboard_log_wakeup_mutex = NULL;
+static GCond *whiteboard_log_wakeup = NULL;
+static gboolean whiteboard_log_wakeup_pending = FALSE;
+/* set while the writer sleeps without a timeout, producers then wake it */
+static volatile gint whiteboard_log_writer_idle = 0;
+static volatile gint whiteboard_log_dropped = 0;
+static guint whiteboard_log_sink_mask = WHITEBOARD_LOG_SINK_GLOG;
+static FILE *whiteboard_log_stream = NULL;
+static DBusConnection *whiteboard_log_dbus_connection = NULL;
+
+/* set in whiteboard_log_debug_mask until the filter has been read, every
+   context then takes the slow path once */
+#define WHITEBOARD_LOG_DEBUG_UNSET ((gint)0x80000000u)
+volatile gint whiteboard_log_debug_mask = -1;
+static GStaticMutex whiteboard_log_filter_mutex = G_STATIC_MUTEX_INIT;
+
+static const gchar *whiteboard_log_debug_contexts[] =
+{
+  "WHITEBOARD_DEBUG_BEGIN_END",
+  "WHITEBOARD_DEBUG_BASIC",
+  "WHITEBOARD_DEBUG_DISCOVER",
+  "WHITEBOARD_DEBUG_DBUS",
+  "WHITEBOARD_DEBUG_SIB_HANDLER",
+  "WHITEBOARD_DEBUG_NODE",
+  "WHITEBOARD_DEBUG_SIB",
+  "WHITEBOARD_DEBUG_USER_0",
+  "WHITEBOARD_DEBUG_USER_1",
+  "WHITEBOARD_DEBUG_USER_2",
+  "WHITEBOARD_DEBUG_USER_3",
+  "WHITEBOARD_DEBUG_USER_4",
+  "WHITEBOARD_DEBUG_USER_5",
+  "WHITEBOARD_DEBUG_USER_6",
+  "WHITEBOARD_DEBUG_USER_7",
+  "WHITEBOARD_DEBUG_USER_8",
+  "WHITEBOARD_DEBUG_USER_9",
+  NULL
+};
+
+static gboolean whiteboard_log_queued(void)
+{
+  WhiteBoardLogRing *ring;
+  gboolean queued = FALSE;
+  GSList *l;
+
+  g_static_mutex_lock(&whiteboard_log_mutex);
+  for (l = whiteboard_log_rings; l != NULL && !queued; l = g_slist_next(l))
+    {
+      ring = (WhiteBoardLogRing *)l->data;
+      queued = (g_atomic_int_get(&ring->head) != g_atomic_int_get(&ring->tail));
+    }
+  g_static_mutex_unlock(&whiteboard_log_mutex);
+
+  return queued;
+}
+
+/* Writes queued records at least every WHITEBOARD_LOG_FLUSH_INTERVAL, and
+   sleeps without a timeout while all rings are empty. The idle flag is
+   raised before the rings are checked and a producer tests it after
+   publishing a record, so either the record is seen here or the producer
+   wakes the writer. */
+static gpointer whiteboard_log_writer_thread(gpointer data)
+{
+  GTimeVal until;
+
+  for (;;)
+    {
+      g_mutex_lock(whiteboard_log_wakeup_mutex);
+      g_atomic_int_inc(&whiteboard_log_writer_idle);
+      if (!whiteboard_log_wakeup_pending && whiteboard_log_queued())
+	{
+	  g_atomic_int_compare_and_exchange(&whiteboard_log_writer_idle, 1, 0);
+	  g_get_current_time(&until);
+	  g_time_val_add(&until, WHITEBOARD_LOG_FLUSH_INTERVAL);
+	  g_cond_timed_wait(whiteboard_log_wakeup, whiteboard_log_wakeup_mutex, &until);
+	}
+      else
+	{
+	  while (!whiteboard_log_wakeup_pending)
+	    g_cond_wait(whiteboard_log_wakeup, whiteboard_log_wakeup_mutex);
+	}
+      g_atomic_int_compare_and_exchange(&whiteboard_log_writer_idle, 1, 0);
+      whiteboard_log_wakeup_pending = FALSE;
+      g_mutex_unlock(whiteboard_log_wakeup_mutex);
+
+      whiteboard_log_flush();
+    }
+  return NULL;
+}
+
+static void whiteboard_log_wake_writer(void)
+{
+  g_mutex_lock(whiteboard_log_wakeup_mutex);
+  g_atomic_int_compare_and_exchange(&whiteboard_log_writer_idle, 1, 0);
+  whiteboard_log_wakeup_pending = TRUE;
+  g_cond_signal(whiteboard_log_wakeup);
+  g_mutex_unlock(whiteboard_log_wakeup_mutex);
+}
+
+static void whiteboard_log_atexit(void)
+{
+  whiteboard_log_flush();
+}
+
+static gboolean whiteboard_log_start(void)
+{
+  gboolean started;
+
+  g_static_mutex_lock(&whiteboard_log_mutex);
+  if (whiteboard_log_writer == NULL)
+    {
+      if (whiteboard_log_wakeup == NULL)
+	{
+	  whiteboard_log_wakeup_mutex = g_mutex_new();
+	  whiteboard_log_wakeup = g_cond_new();
+	}
+      whiteboard_log_writer = g_thread_create(whiteboard_log_writer_thread,
+					      NULL, FALSE, NULL);
+      if (whiteboard_log_writer != NULL)
+	atexit(whiteboard_log_atexit);
+    }
+  started = (whiteboard_log_writer != NULL);
+  g_static_mutex_unlock(&whiteboard_log_mutex);
+
+  return started;
+}
+
+static void whiteboard_log_ring_release(gpointer data)
+{
+  WhiteBoardLogRing *ring = (WhiteBoardLogRing *)data;
+
+  /* freed by the consumer once drained */
+  g_atomic_int_inc(&ring->orphaned);
+  whiteboard_log_wake_writer();
+}
+
+static WhiteBoardLogRing *whiteboard_log_ring_get(void)
+{
+  WhiteBoardLogRing *ring;
+
+  if (!g_thread_supported())
+    return NULL;
+
+  ring = (WhiteBoardLogRing *)g_static_private_get(&whiteboard_log_ring_key);
+  if (ring == NULL)
+    {
+      if (!whiteboard_log_start())
+	return NULL;
+
+      ring = g_new0(WhiteBoardLogRing, 1);
+      g_static_mutex_lock(&whiteboard_log_mutex);
+      whiteboard_log_rings = g_slist_prepend(whiteboard_log_rings, ring);
+      g_static_mutex_unlock(&whiteboard_log_mutex);
+      g_static_private_set(&whiteboard_log_ring_key, ring,
+			   whiteboard_log_ring_release);
+    }
+  return ring;
+}
+
+static void whiteboard_log_enqueue(GLogLevelFlags level, const gchar *fmt,
+				   va_list ap)
+{
+  WhiteBoardLogRing *ring;
+  WhiteBoardLogRecord *rec;
+  gint head;
+  guint used;
+  gint len;
+
+  ring = whiteboard_log_ring_get();
+  if (ring == NULL)
+    {
+      /* no threads, log synchronously as before */
+      g_logv(G_LOG_DOMAIN, level, fmt, ap);
+      return;
+    }
+
+  head = ring->head;
+  used = (guint)(head - g_atomic_int_get(&ring->tail));
+  if (used >= WHITEBOARD_LOG_RING_SIZE)
+    {
+      g_atomic_int_inc(&ring->dropped);
+      return;
+    }
+
+  rec = &ring->records[head & (WHITEBOARD_LOG_RING_SIZE - 1)];
+  rec->level = level;
+  len = g_vsnprintf(rec->text, WHITEBOARD_LOG_RECORD_SIZE, fmt, ap);
+  if (len >= WHITEBOARD_LOG_RECORD_SIZE)
+    strcpy(rec->text + WHITEBOARD_LOG_RECORD_SIZE - 5, "...\n");
+
+  /* publishes the record to the consumer */
+  g_atomic_int_add(&ring->head, 1);
+
+  if (used + 1 == WHITEBOARD_LOG_RING_SIZE / 2 ||
+      g_atomic_int_get(&whiteboard_log_writer_idle))
+    whiteboard_log_wake_writer();
+}
+
+static void whiteboard_log_write(WhiteBoardLogSinks *sinks,
+				 GLogLevelFlags level, const gchar *text)
+{
+  if (sinks->mask & WHITEBOARD_LOG_SINK_GLOG)
+    g_log(G_LOG_DOMAIN, level, "%s", text);
+
+  if (sinks->mask & WHITEBOARD_LOG_SINK_STREAM)
+    fputs(text, sinks->stream);
+
+  if (sinks->mask & WHITEBOARD_LOG_SINK_SYSLOG)
+    {
+      gint priority = LOG_DEBUG;
+
+      if (level & G_LOG_LEVEL_WARNING)
+	priority = LOG_WARNING;
+      else if (level & G_LOG_LEVEL_INFO)
+	priority = LOG_INFO;
+      syslog(priority, "%s", text);
+    }
+
+  if ((sinks->mask & WHITEBOARD_LOG_SINK_DBUS) && sinks->connection &&
+      g_utf8_validate(text, -1, NULL))
+    {
+      DBusMessage *msg;
+      dbus_int32_t dlevel = level;
+      dbus_int32_t id = -1;
+
+      msg = dbus_message_new_signal(WHITEBOARD_DBUS_OBJECT,
+				    WHITEBOARD_DBUS_LOG_INTERFACE,
+				    WHITEBOARD_DBUS_LOG_SIGNAL_MESSAGE);
+      if (msg)
+	{
+	  if (dbus_message_append_args(msg,
+				       DBUS_TYPE_INT32, &dlevel,
+				       DBUS_TYPE_INT32, &id,
+				       DBUS_TYPE_STRING, &text,
+				       DBUS_TYPE_INVALID))
+	    dbus_connection_send(sinks->connection, msg, NULL);
+	  dbus_message_unref(msg);
+	}
+    }
+}
+
+/* Consumer side, called with whiteboard_log_drain_mutex held */
+static void whiteboard_log_drain(WhiteBoardLogRing *ring,
+				 WhiteBoardLogSinks *sinks)
+{
+  WhiteBoardLogRecord *rec;
+  gint head;
+  gint tail;
+  gint dropped;
+  gchar *text;
+
+  head = g_atomic_int_get(&ring->head);
+  for (tail = ring->tail; tail != head; tail++)
+    {
+      rec = &ring->records[tail & (WHITEBOARD_LOG_RING_SIZE - 1)];
+      whiteboard_log_write(sinks, rec->level, rec->text);
+    }
+  g_atomic_int_add(&ring->tail, head - ring->tail);
+
+  dropped = g_atomic_int_get(&ring->dropped);
+  if (dropped > 0)
+    {
+      g_atomic_int_add(&ring->dropped, -dropped);
+      g_atomic_int_add(&whiteboard_log_dropped, dropped);
+      text = g_strdup_printf("whiteboard_log: %d records dropped\n", dropped);
+      whiteboard_log_write(sinks, G_LOG_LEVEL_WARNING, text);
+      g_free(text);
+    }
+}
+
+void whiteboard_log_flush(void)
+{
+  WhiteBoardLogSinks sinks;
+  WhiteBoardLogRing *ring;
+  GSList *rings;
+  GSList *l;
+
+  g_static_mutex_lock(&whiteboard_log_drain_mutex);
+
+  g_static_mutex_lock(&whiteboard_log_mutex);
+  /* new rings are prepended, so the rest of the list stays put while
+     the lock is released; only we remove entries */
+  rings = whiteboard_log_rings;
+  sinks.mask = whiteboard_log_sink_mask;
+  sinks.stream = whiteboard_log_stream ? whiteboard_log_stream : stderr;
+  sinks.connection = whiteboard_log_dbus_connection;
+  if (sinks.connection)
+    dbus_connection_ref(sinks.connection);
+  g_static_mutex_unlock(&whiteboard_log_mutex);
+
+  l = rings;
+  while (l != NULL)
+    {
+      ring = (WhiteBoardLogRing *)l->data;
+      l = g_slist_next(l);
+
+      if (g_atomic_int_get(&ring->orphaned))
+	{
+	  whiteboard_log_drain(ring, &sinks);
+	  g_static_mutex_lock(&whiteboard_log_mutex);
+	  whiteboard_log_rings = g_slist_remove(whiteboard_log_rings, ring);
+	  g_static_mutex_unlock(&whiteboard_log_mutex);
+	  g_free(ring);
+	}
+      else
+	{
+	  whiteboard_log_drain(ring, &sinks);
+	}
+    }
+
+  if (sinks.mask & WHITEBOARD_LOG_SINK_STREAM)
+    fflush(sinks.stream);
+  if (sinks.connection)
+    {
+      if (sinks.mask & WHITEBOARD_LOG_SINK_DBUS)
+	dbus_connection_flush(sinks.connection);
+      dbus_connection_unref(sinks.connection);
+    }
+
+  g_static_mutex_unlock(&whiteboard_log_drain_mutex);
+}
+
+guint whiteboard_log_get_dropped(void)
+{
+  return (guint)g_atomic_int_get(&whiteboard_log_dropped);
+}
+
+void whiteboard_log_set_sinks(guint sinks)
+{
+  g_static_mutex_lock(&whiteboard_log_mutex);
+  whiteboard_log_sink_mask = sinks;
+  g_static_mutex_unlock(&whiteboard_log_mutex);
+}
+
+void whiteboard_log_set_stream(FILE *stream)
+{
+  whiteboard_log_flush();
+  g_static_mutex_lock(&whiteboard_log_mutex);
+  whiteboard_log_stream = stream;
+  g_static_mutex_unlock(&whiteboard_log_mutex);
+}
+
+void whiteboard_log_set_dbus_connection(DBusConnection *conn)
+{
+  DBusConnection *old;
+
+  g_static_mutex_lock(&whiteboard_log_mutex);
+  old = whiteboard_log_dbus_connection;
+  whiteboard_log_dbus_connection = conn ? dbus_connection_ref(conn) : NULL;
+  g_static_mutex_unlock(&whiteboard_log_mutex);
+
+  if (old)
+    dbus_connection_unref(old);
+}
+
+/* Parses WHITEBOARD_LOG_FILTER_ENV into the debug mask, once */
+static gint whiteboard_log_read_filter(void)
+{
+  const gchar *filter;
+  gchar **tokens;
+  gint mask;
+  gint i;
+  gint j;
+
+  g_static_mutex_lock(&whiteboard_log_filter_mutex);
+  mask = g_atomic_int_get(&whiteboard_log_debug_mask);
+  if (mask & WHITEBOARD_LOG_DEBUG_UNSET)
+    {
+      filter = getenv(WHITEBOARD_LOG_FILTER_ENV);
+      if (filter == NULL)
+	{
+	  mask = (1 << WHITEBOARD_DEBUG_LAST) - 1;
+	}
+      else
+	{
+	  mask = 0;
+	  tokens = g_strsplit(filter, ",", -1);
+	  for (i = 0; tokens[i]; i++)
+	    {
+	      g_strstrip(tokens[i]);
+	      for (j = 0; whiteboard_log_debug_contexts[j]; j++)
+		if (!strcmp(whiteboard_log_debug_contexts[j], tokens[i]))
+		  mask |= 1 << j;
+	    }
+	  g_strfreev(tokens);
+	}
+      whiteboard_log_set_debug_mask(mask);
+    }
+  g_static_mutex_unlock(&whiteboard_log_filter_mutex);
+
+  return mask;
+}
+
+void whiteboard_log_set_debug_mask(guint mask)
+{
+  gint old;
+
+  mask &= (1 << WHITEBOARD_DEBUG_LAST) - 1;
+  /* no g_atomic_int_set() in GLib 2.8 */
+  do
+    old = g_atomic_int_get(&whiteboard_log_debug_mask);
+  while (!g_atomic_int_compare_and_exchange(&whiteboard_log_debug_mask,
+					    old, (gint)mask));
+}
+
+guint whiteboard_log_get_debug_mask(void)
+{
+  gint mask = g_atomic_int_get(&whiteboard_log_debug_mask);
+
+  if (mask & WHITEBOARD_LOG_DEBUG_UNSET)
+    mask = whiteboard_log_read_filter();
+  return (guint)mask;
+}
+
+void whiteboard_log_debugc2(WhiteBoardDebugContext context,
+			    const gchar *fmt, ...)
+{
+  va_list ap;
+  gint mask = g_atomic_int_get(&whiteboard_log_debug_mask);
+
+  if (G_UNLIKELY(mask & WHITEBOARD_LOG_DEBUG_UNSET))
+    {
+      mask = whiteboard_log_read_filter();
+      if (!(mask & (1 << context)))
+	return;
+    }
+
+  va_start(ap, fmt);
+  whiteboard_log_enqueue(G_LOG_LEVEL_DEBUG, fmt, ap);
+  va_end(ap);
+}
+
 void whiteboard_log_debug2(const gchar *fmt, ...)
 {
-  va_list ap;					    
-  va_start(ap, fmt);				    
-  g_logv(G_LOG_DOMAIN, G_LOG_LEVEL_DEBUG, fmt, ap); 
+  va_list ap;
+
+  va_start(ap, fmt);
+  whiteboard_log_enqueue(G_LOG_LEVEL_DEBUG, fmt, ap);
   va_end(ap);
 }
 
 void whiteboard_log_warning2(const gchar *fmt, ...)
 {
-  va_list ap;					    
-  va_start(ap, fmt);				    
-  g_logv(G_LOG_DOMAIN, G_LOG_LEVEL_WARNING, fmt, ap); 
+  va_list ap;
+
+  va_start(ap, fmt);
+  whiteboard_log_enqueue(G_LOG_LEVEL_WARNING, fmt, ap);
+  va_end(ap);
+}
+
+void whiteboard_log_trace2(const gchar *fmt, ...)
+{
+  va_list ap;
+
+  va_start(ap, fmt);
+  whiteboard_log_enqueue(G_LOG_LEVEL_INFO, fmt, ap);
   va_end(ap);
 }
 
@@ -0,0 +1,274 @@
+/*
+
+  Copyright (c) 2009, Nokia Corporation
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.  
+    * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in
+    the documentation and/or other materials provided with the
+    distribution.  
+    * Neither the name of Nokia nor the names of its contributors 
+    may be used to endorse or promote products derived from this 
+    software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+  EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+/*
+ * Whiteboard Library
+ *
+ * whiteboard_trace.c
+ *
+ * Copyright 2009 Nokia Corporation
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "whiteboard_trace.h"
+#include "whiteboard_log.h"
+
+/* Records are collected in a per-thread buffer and written with a single
+   write() when it fills up, so the traced code pays for a clock read and
+   a few stores. The buffers are also kept in a list so that a flush
+   can drain the records of every thread, not only the caller's */
+#define WHITEBOARD_TRACE_BUFFER_RECORDS 128
+
+typedef struct _WhiteBoardTraceBuffer
+{
+  GMutex *lock; // only contended while another thread flushes
+  guint32 thread;
+  gint generation; // trace file the records belong to
+  guint count;
+  WhiteBoardTraceRecord records[WHITEBOARD_TRACE_BUFFER_RECORDS];
+} WhiteBoardTraceBuffer;
+
+volatile gint whiteboard_trace_enabled = -1;
+
+static GStaticMutex whiteboard_trace_mutex = G_STATIC_MUTEX_INIT;
+static GStaticPrivate whiteboard_trace_buffer_key = G_STATIC_PRIVATE_INIT;
+static GStaticMutex whiteboard_trace_buffers_mutex = G_STATIC_MUTEX_INIT;
+static GSList *whiteboard_trace_buffers = NULL;
+static gint whiteboard_trace_fd = -1;
+static volatile gint whiteboard_trace_generation = 0;
+static volatile gint whiteboard_trace_threads = 0;
+static gboolean whiteboard_trace_atexit_set = FALSE;
+
+static gboolean whiteboard_trace_write_all(gint fd, gconstpointer data, gsize len)
+{
+  const gchar *p = (const gchar *)data;
+  gssize n;
+
+  while (len > 0)
+    {
+      n = write(fd, p, len);
+      if (n < 0)
+	{
+	  if (errno == EINTR)
+	    continue;
+	  return FALSE;
+	}
+      p += n;
+      len -= n;
+    }
+  return TRUE;
+}
+
+/* Called with buf->lock held, or once buf is no longer listed */
+static void whiteboard_trace_buffer_write(WhiteBoardTraceBuffer *buf)
+{
+  g_static_mutex_lock(&whiteboard_trace_mutex);
+  if (whiteboard_trace_fd >= 0 && buf->generation == whiteboard_trace_generation)
+    whiteboard_trace_write_all(whiteboard_trace_fd, buf->records,
+			       buf->count * sizeof(WhiteBoardTraceRecord));
+  g_static_mutex_unlock(&whiteboard_trace_mutex);
+  buf->count = 0;
+}
+
+static void whiteboard_trace_buffer_free(gpointer data)
+{
+  WhiteBoardTraceBuffer *buf = (WhiteBoardTraceBuffer *)data;
+
+  g_static_mutex_lock(&whiteboard_trace_buffers_mutex);
+  whiteboard_trace_buffers = g_slist_remove(whiteboard_trace_buffers, buf);
+  g_static_mutex_unlock(&whiteboard_trace_buffers_mutex);
+
+  if (buf->count > 0)
+    whiteboard_trace_buffer_write(buf);
+  g_mutex_free(buf->lock);
+  g_free(buf);
+}
+
+static void whiteboard_trace_atexit(void)
+{
+  whiteboard_trace_flush();
+}
+
+/* Called with whiteboard_trace_mutex held */
+static gboolean whiteboard_trace_open_locked(const gchar *filename)
+{
+  WhiteBoardTraceHeader header;
+  gint fd;
+
+  if (whiteboard_trace_fd >= 0)
+    close(whiteboard_trace_fd);
+  whiteboard_trace_fd = -1;
+  whiteboard_trace_enabled = 0;
+  g_atomic_int_inc(&whiteboard_trace_generation);
+
+  fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+    {
+      whiteboard_log_warning("Could not open trace file %s: %s\n",
+			     filename, g_strerror(errno));
+      return FALSE;
+    }
+
+  memset(&header, 0, sizeof(header));
+  strncpy(header.magic, WHITEBOARD_TRACE_MAGIC, sizeof(header.magic));
+  header.version = WHITEBOARD_TRACE_VERSION;
+  header.record_size = sizeof(WhiteBoardTraceRecord);
+  if (!whiteboard_trace_write_all(fd, &header, sizeof(header)))
+    {
+      close(fd);
+      return FALSE;
+    }
+
+  if (!whiteboard_trace_atexit_set)
+    {
+      atexit(whiteboard_trace_atexit);
+      whiteboard_trace_atexit_set = TRUE;
+    }
+  whiteboard_trace_fd = fd;
+  whiteboard_trace_enabled = 1;
+  return TRUE;
+}
+
+gboolean whiteboard_trace_open(const gchar *filename)
+{
+  gboolean ret;
+
+  g_return_val_if_fail(filename != NULL, FALSE);
+
+  g_static_mutex_lock(&whiteboard_trace_mutex);
+  ret = whiteboard_trace_open_locked(filename);
+  g_static_mutex_unlock(&whiteboard_trace_mutex);
+  return ret;
+}
+
+void whiteboard_trace_close(void)
+{
+  whiteboard_trace_flush();
+
+  g_static_mutex_lock(&whiteboard_trace_mutex);
+  if (whiteboard_trace_fd >= 0)
+    close(whiteboard_trace_fd);
+  whiteboard_trace_fd = -1;
+  whiteboard_trace_enabled = 0;
+  g_atomic_int_inc(&whiteboard_trace_generation);
+  g_static_mutex_unlock(&whiteboard_trace_mutex);
+}
+
+void whiteboard_trace_flush(void)
+{
+  WhiteBoardTraceBuffer *buf;
+  GSList *l;
+
+  g_static_mutex_lock(&whiteboard_trace_buffers_mutex);
+  for (l = whiteboard_trace_buffers; l != NULL; l = l->next)
+    {
+      buf = (WhiteBoardTraceBuffer *)l->data;
+      g_mutex_lock(buf->lock);
+      if (buf->count > 0)
+	whiteboard_trace_buffer_write(buf);
+      g_mutex_unlock(buf->lock);
+    }
+  g_static_mutex_unlock(&whiteboard_trace_buffers_mutex);
+}
+
+void whiteboard_trace_emit(WhiteBoardTraceEvent event, gint msgnumber,
+			   gint access_id, guint bytes)
+{
+  WhiteBoardTraceBuffer *buf;
+  WhiteBoardTraceRecord *rec;
+  struct timespec ts;
+  const gchar *filename;
+  gint generation;
+
+  if (whiteboard_trace_enabled < 0)
+    {
+      g_static_mutex_lock(&whiteboard_trace_mutex);
+      if (whiteboard_trace_enabled < 0)
+	{
+	  filename = getenv(WHITEBOARD_TRACE_FILE_ENV);
+	  if (!filename || !whiteboard_trace_open_locked(filename))
+	    whiteboard_trace_enabled = 0;
+	}
+      g_static_mutex_unlock(&whiteboard_trace_mutex);
+      if (whiteboard_trace_enabled <= 0)
+	return;
+    }
+
+  buf = (WhiteBoardTraceBuffer *)g_static_private_get(&whiteboard_trace_buffer_key);
+  if (buf == NULL)
+    {
+      buf = g_new0(WhiteBoardTraceBuffer, 1);
+      buf->lock = g_mutex_new();
+      buf->thread = g_atomic_int_exchange_and_add(&whiteboard_trace_threads, 1) + 1;
+      buf->generation = g_atomic_int_get(&whiteboard_trace_generation);
+      g_static_private_set(&whiteboard_trace_buffer_key, buf,
+			   whiteboard_trace_buffer_free);
+
+      g_static_mutex_lock(&whiteboard_trace_buffers_mutex);
+      whiteboard_trace_buffers = g_slist_prepend(whiteboard_trace_buffers, buf);
+      g_static_mutex_unlock(&whiteboard_trace_buffers_mutex);
+    }
+
+  g_mutex_lock(buf->lock);
+  generation = g_atomic_int_get(&whiteboard_trace_generation);
+  if (buf->generation != generation)
+    {
+      // left over from a closed trace file
+      buf->count = 0;
+      buf->generation = generation;
+    }
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  rec = &buf->records[buf->count++];
+  rec->timestamp = (guint64)ts.tv_sec * G_GUINT64_CONSTANT(1000000000) + ts.tv_nsec;
+  rec->thread = buf->thread;
+  rec->msgnumber = msgnumber;
+  rec->access_id = access_id;
+  rec->event = event;
+  rec->reserved = 0;
+  rec->bytes = bytes;
+  rec->reserved2 = 0;
+
+  if (buf->count == WHITEBOARD_TRACE_BUFFER_RECORDS)
+    whiteboard_trace_buffer_write(buf);
+  g_mutex_unlock(buf->lock);
+}
@@ -39,6 +39,10 @@
  * Copyright 2007 Nokia Corporation
  */
 
+/* memfd_create(); must precede config.h and every system header */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
 #ifdef HAVE_CONFIG_H
 #include "config.h"
 #endif
@@ -46,7 +50,11 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdarg.h>
+#include <errno.h>
+#include <fcntl.h>
 #include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
 #include <unistd.h>
 
 #define DBUS_API_SUBJECT_TO_CHANGE
@@ -64,6 +72,65 @@
 #include "sib_dbus_ifaces.h"
 #include "whiteboard_log.h"
 
+#if defined(HAVE_MEMFD_CREATE) && defined(DBUS_TYPE_UNIX_FD)
+#define WHITEBOARD_UTIL_FD_PAYLOAD 1
+#endif
+
+#ifdef WHITEBOARD_UTIL_FD_PAYLOAD
+#define WHITEBOARD_UTIL_FD_PAYLOAD_SEALS \
+	(F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL)
+
+/* Read-only mappings of fd payloads, attached to the message they were
+   parsed from and unmapped when it is freed */
+typedef struct _WhiteBoardUtilPayloadMap WhiteBoardUtilPayloadMap;
+struct _WhiteBoardUtilPayloadMap
+{
+	gpointer addr;
+	gsize size;
+	WhiteBoardUtilPayloadMap *next;
+};
+
+static dbus_int32_t payload_map_slot = -1;
+#endif
+
+/* -1 until read from WHITEBOARD_UTIL_FD_PAYLOAD_ENV */
+static gint fd_payload_threshold = -1;
+
+/* Per-connection state of corked mode, see whiteboard_util_cork() */
+typedef struct _WhiteBoardUtilCork WhiteBoardUtilCork;
+struct _WhiteBoardUtilCork
+{
+	GMainContext *context;
+	GSource *idle;
+};
+
+static dbus_int32_t cork_slot = -1;
+static GStaticMutex cork_mutex = G_STATIC_MUTEX_INIT;
+
+/* Bound for the message template cache, it is cleared when full */
+#define MESSAGE_TEMPLATES_MAX 256
+
+/* Header fields identifying a message template */
+typedef struct _WhiteBoardUtilMessageKey WhiteBoardUtilMessageKey;
+struct _WhiteBoardUtilMessageKey
+{
+	gint type;
+	const gchar *destination;
+	const gchar *path;
+	const gchar *interface;
+	const gchar *method;
+};
+
+struct _WhiteBoardUtilDispatchTable
+{
+	/* WhiteBoardUtilMessageKey (type, interface, member) -> handler */
+	GHashTable *handlers;
+};
+
+/* Key (owning its strings) -> argumentless DBusMessage to copy */
+static GHashTable *message_templates = NULL;
+static GStaticMutex message_templates_mutex = G_STATIC_MUTEX_INIT;
+
 struct WhiteBoardLibHeader
 {
 	GObject parent;
@@ -307,6 +374,10 @@ gboolean whiteboard_util_register_try(gpointer uself, const gchar* uuid,const gc
 		    
 		    dbus_connection_setup_with_g_main(self->connection,
 						      self->main_context);
+		    /* Responses and indications are written out together
+		       once the main loop goes idle */
+		    whiteboard_util_cork(self->connection,
+					 self->main_context);
 
 		  }
 	}
@@ -552,6 +623,10 @@ gboolean whiteboard_util_register_sib_try(gpointer uself, const gchar* uuid,cons
 		    
 		    dbus_connection_setup_with_g_main(self->connection,
 						      self->main_context);
+		    /* Responses and indications are written out together
+		       once the main loop goes idle */
+		    whiteboard_util_cork(self->connection,
+					 self->main_context);
 
 		  }
 	}
@@ -569,6 +644,647 @@ gboolean whiteboard_util_register_sib_try(gpointer uself, const gchar* uuid,cons
         return retval;
 }
 
+static void whiteboard_util_cork_free(void *data)
+{
+	WhiteBoardUtilCork *cork = (WhiteBoardUtilCork *) data;
+
+	/* A pending idle flush holds a connection reference, so there is
+	   none left by the time the connection frees its data */
+	if (NULL != cork->context)
+		g_main_context_unref(cork->context);
+	g_free(cork);
+}
+
+static gboolean whiteboard_util_idle_flush(gpointer data)
+{
+	DBusConnection *conn = (DBusConnection *) data;
+	WhiteBoardUtilCork *cork;
+
+	g_static_mutex_lock(&cork_mutex);
+	cork = (WhiteBoardUtilCork *) dbus_connection_get_data(conn, cork_slot);
+	if (NULL != cork)
+		cork->idle = NULL;
+	g_static_mutex_unlock(&cork_mutex);
+
+	if (dbus_connection_get_is_connected(conn))
+		dbus_connection_flush(conn);
+
+	return FALSE;
+}
+
+/* Called after queueing a message that is not waited on */
+static void whiteboard_util_schedule_flush(DBusConnection *conn)
+{
+	WhiteBoardUtilCork *cork = NULL;
+	GSource *idle = NULL;
+
+	g_static_mutex_lock(&cork_mutex);
+	if (cork_slot >= 0)
+		cork = (WhiteBoardUtilCork *) dbus_connection_get_data(conn, cork_slot);
+	if (NULL != cork && NULL != cork->context && NULL == cork->idle)
+	{
+		idle = g_idle_source_new();
+		g_source_set_priority(idle, G_PRIORITY_HIGH_IDLE);
+		g_source_set_callback(idle, whiteboard_util_idle_flush,
+				      dbus_connection_ref(conn),
+				      (GDestroyNotify) dbus_connection_unref);
+		cork->idle = idle;
+		g_source_attach(idle, cork->context);
+		g_source_unref(idle);
+	}
+	g_static_mutex_unlock(&cork_mutex);
+
+	/* Uncorked connections keep the old flush-per-message behaviour */
+	if (NULL == cork)
+		dbus_connection_flush(conn);
+}
+
+void whiteboard_util_cork(DBusConnection *conn, GMainContext *context)
+{
+	WhiteBoardUtilCork *cork;
+
+	whiteboard_log_debug_fb();
+	g_return_if_fail(NULL != conn);
+
+	g_static_mutex_lock(&cork_mutex);
+	if (cork_slot < 0)
+		dbus_connection_allocate_data_slot(&cork_slot);
+
+	cork = (WhiteBoardUtilCork *) dbus_connection_get_data(conn, cork_slot);
+	if (NULL == cork)
+	{
+		cork = g_new0(WhiteBoardUtilCork, 1);
+		dbus_connection_set_data(conn, cork_slot, cork,
+					 whiteboard_util_cork_free);
+	}
+	if (NULL == cork->idle && context != cork->context)
+	{
+		if (NULL != cork->context)
+			g_main_context_unref(cork->context);
+		cork->context = (NULL != context) ? g_main_context_ref(context) : NULL;
+	}
+	g_static_mutex_unlock(&cork_mutex);
+
+	whiteboard_log_debug_fe();
+}
+
+void whiteboard_util_uncork(DBusConnection *conn)
+{
+	GSource *idle = NULL;
+	WhiteBoardUtilCork *cork = NULL;
+
+	whiteboard_log_debug_fb();
+	g_return_if_fail(NULL != conn);
+
+	g_static_mutex_lock(&cork_mutex);
+	if (cork_slot >= 0)
+		cork = (WhiteBoardUtilCork *) dbus_connection_get_data(conn, cork_slot);
+	if (NULL != cork)
+	{
+		idle = cork->idle;
+		cork->idle = NULL;
+		/* Frees cork */
+		dbus_connection_set_data(conn, cork_slot, NULL, NULL);
+	}
+	g_static_mutex_unlock(&cork_mutex);
+
+	if (NULL != idle)
+		g_source_destroy(idle);
+
+	dbus_connection_flush(conn);
+	whiteboard_log_debug_fe();
+}
+
+void whiteboard_util_flush(DBusConnection *conn)
+{
+	GSource *idle = NULL;
+	WhiteBoardUtilCork *cork = NULL;
+
+	g_return_if_fail(NULL != conn);
+
+	g_static_mutex_lock(&cork_mutex);
+	if (cork_slot >= 0)
+		cork = (WhiteBoardUtilCork *) dbus_connection_get_data(conn, cork_slot);
+	if (NULL != cork)
+	{
+		idle = cork->idle;
+		cork->idle = NULL;
+	}
+	g_static_mutex_unlock(&cork_mutex);
+
+	if (NULL != idle)
+		g_source_destroy(idle);
+
+	dbus_connection_flush(conn);
+}
+
+static guint whiteboard_util_message_key_hash(gconstpointer key)
+{
+	const WhiteBoardUtilMessageKey *k = (const WhiteBoardUtilMessageKey *) key;
+	guint hash = k->type;
+
+	if (NULL != k->destination)
+		hash = hash * 31 + g_str_hash(k->destination);
+	if (NULL != k->path)
+		hash = hash * 31 + g_str_hash(k->path);
+	hash = hash * 31 + g_str_hash(k->interface);
+	hash = hash * 31 + g_str_hash(k->method);
+	return hash;
+}
+
+static gboolean whiteboard_util_message_key_str_equal(const gchar *a,
+						      const gchar *b)
+{
+	return (a == b) || (NULL != a && NULL != b && 0 == strcmp(a, b));
+}
+
+static gboolean whiteboard_util_message_key_equal(gconstpointer a,
+						  gconstpointer b)
+{
+	const WhiteBoardUtilMessageKey *ka = (const WhiteBoardUtilMessageKey *) a;
+	const WhiteBoardUtilMessageKey *kb = (const WhiteBoardUtilMessageKey *) b;
+
+	return ka->type == kb->type &&
+		whiteboard_util_message_key_str_equal(ka->method, kb->method) &&
+		whiteboard_util_message_key_str_equal(ka->interface, kb->interface) &&
+		whiteboard_util_message_key_str_equal(ka->path, kb->path) &&
+		whiteboard_util_message_key_str_equal(ka->destination, kb->destination);
+}
+
+static void whiteboard_util_message_key_free(gpointer key)
+{
+	WhiteBoardUtilMessageKey *k = (WhiteBoardUtilMessageKey *) key;
+
+	g_free((gchar *) k->destination);
+	g_free((gchar *) k->path);
+	g_free((gchar *) k->interface);
+	g_free((gchar *) k->method);
+	g_free(k);
+}
+
+/* g_hash_table_remove_all() needs GLib 2.12 */
+static gboolean whiteboard_util_remove_all(gpointer key, gpointer value,
+					   gpointer data)
+{
+	return TRUE;
+}
+
+/* Create a method call or signal by copying a cached header template,
+   so names are validated and header fields marshalled only once per
+   (destination, path, interface, method) */
+static DBusMessage *whiteboard_util_message_new(gint type,
+						const gchar *destination,
+						const gchar *path,
+						const gchar *interface,
+						const gchar *method)
+{
+	WhiteBoardUtilMessageKey key = { type, destination, path,
+					 interface, method };
+	WhiteBoardUtilMessageKey *new_key;
+	DBusMessage *template;
+	DBusMessage *message = NULL;
+
+	/* Uncached forms, incl. interface-less calls */
+	if (NULL == interface || NULL == method || NULL == path)
+	{
+		if (DBUS_MESSAGE_TYPE_METHOD_CALL == type)
+			return dbus_message_new_method_call(destination, path,
+							    interface, method);
+		if (DBUS_MESSAGE_TYPE_SIGNAL == type)
+			return dbus_message_new_signal(path, interface, method);
+		return NULL;
+	}
+
+	g_static_mutex_lock(&message_templates_mutex);
+	if (NULL == message_templates)
+		message_templates = g_hash_table_new_full(
+			whiteboard_util_message_key_hash,
+			whiteboard_util_message_key_equal,
+			whiteboard_util_message_key_free,
+			(GDestroyNotify) dbus_message_unref);
+
+	template = (DBusMessage *) g_hash_table_lookup(message_templates, &key);
+	if (NULL == template)
+	{
+		if (DBUS_MESSAGE_TYPE_METHOD_CALL == type)
+			template = dbus_message_new_method_call(destination, path,
+								interface, method);
+		else if (DBUS_MESSAGE_TYPE_SIGNAL == type)
+			template = dbus_message_new_signal(path, interface, method);
+
+		if (NULL != template)
+		{
+			if (g_hash_table_size(message_templates) >= MESSAGE_TEMPLATES_MAX)
+				g_hash_table_foreach_remove(message_templates,
+							    whiteboard_util_remove_all, NULL);
+
+			new_key = g_new(WhiteBoardUtilMessageKey, 1);
+			new_key->type = type;
+			new_key->destination = g_strdup(destination);
+			new_key->path = g_strdup(path);
+			new_key->interface = g_strdup(interface);
+			new_key->method = g_strdup(method);
+			g_hash_table_insert(message_templates, new_key, template);
+		}
+	}
+
+	/* Copied outside the lock, the reference keeps the template alive
+	   should another thread flush the cache meanwhile */
+	if (NULL != template)
+		dbus_message_ref(template);
+	g_static_mutex_unlock(&message_templates_mutex);
+
+	/* The template is never sent, so the copy is unlocked and has no
+	   serial yet */
+	if (NULL != template)
+	{
+		message = dbus_message_copy(template);
+		dbus_message_unref(template);
+	}
+
+	return message;
+}
+
+WhiteBoardUtilDispatchTable *whiteboard_util_dispatch_table_new(const WhiteBoardUtilDispatchEntry *entries)
+{
+	WhiteBoardUtilDispatchTable *table;
+	WhiteBoardUtilMessageKey *key;
+
+	g_return_val_if_fail(NULL != entries, NULL);
+
+	table = g_new0(WhiteBoardUtilDispatchTable, 1);
+	table->handlers = g_hash_table_new_full(whiteboard_util_message_key_hash,
+						whiteboard_util_message_key_equal,
+						g_free, NULL);
+
+	for (; NULL != entries->handler; entries++)
+	{
+		key = g_new0(WhiteBoardUtilMessageKey, 1);
+		key->type = entries->type;
+		key->interface = entries->interface;
+		key->method = entries->member;
+		g_hash_table_replace(table->handlers, key,
+				     (gpointer) entries->handler);
+	}
+
+	return table;
+}
+
+DBusObjectPathMessageFunction whiteboard_util_dispatch_table_lookup(WhiteBoardUtilDispatchTable *table,
+								    DBusMessage *msg)
+{
+	WhiteBoardUtilMessageKey key = { 0, NULL, NULL, NULL, NULL };
+
+	g_return_val_if_fail(NULL != table, NULL);
+
+	key.type = dbus_message_get_type(msg);
+	key.interface = dbus_message_get_interface(msg);
+	key.method = dbus_message_get_member(msg);
+	if (NULL == key.interface || NULL == key.method)
+		return NULL;
+
+	return (DBusObjectPathMessageFunction)
+		g_hash_table_lookup(table->handlers, &key);
+}
+
+void whiteboard_util_set_fd_payload_threshold(gint threshold)
+{
+	gint old;
+
+	/* no g_atomic_int_set() in GLib 2.8 */
+	do
+		old = g_atomic_int_get(&fd_payload_threshold);
+	while (!g_atomic_int_compare_and_exchange(&fd_payload_threshold,
+						  old, MAX(threshold, 0)));
+}
+
+gint whiteboard_util_get_fd_payload_threshold()
+{
+	gint threshold = g_atomic_int_get(&fd_payload_threshold);
+	const gchar *env;
+
+	if (threshold < 0)
+	{
+		env = getenv(WHITEBOARD_UTIL_FD_PAYLOAD_ENV);
+		threshold = (NULL != env) ? MAX(atoi(env), 0) : 0;
+		/* a concurrent set wins over the environment */
+		if (!g_atomic_int_compare_and_exchange(&fd_payload_threshold,
+						       -1, threshold))
+			threshold = g_atomic_int_get(&fd_payload_threshold);
+	}
+
+	return threshold;
+}
+
+#ifdef WHITEBOARD_UTIL_FD_PAYLOAD
+/* Ship str (with its terminating NUL) in a sealed memfd as a
+   (UNIX_FD, UINT32 length) argument pair */
+static gboolean whiteboard_util_append_fd_payload(DBusMessage *msg,
+						  const gchar *str, gsize len)
+{
+	dbus_uint32_t length = len;
+	gsize done = 0;
+	gssize written;
+	gboolean retval = FALSE;
+	int fd;
+
+	fd = memfd_create("whiteboard-payload",
+			  MFD_CLOEXEC | MFD_ALLOW_SEALING);
+	if (fd < 0)
+	{
+		whiteboard_log_debugc(WHITEBOARD_DEBUG_DBUS,
+				      "memfd_create failed: %s\n",
+				      strerror(errno));
+		return FALSE;
+	}
+
+	while (done < len + 1)
+	{
+		written = write(fd, str + done, len + 1 - done);
+		if (written < 0)
+		{
+			if (EINTR == errno)
+				continue;
+			goto out;
+		}
+		done += written;
+	}
+
+	/* Sealed so that the receiver can map it without fearing SIGBUS or
+	   the contents changing under it */
+	if (fcntl(fd, F_ADD_SEALS, WHITEBOARD_UTIL_FD_PAYLOAD_SEALS) < 0)
+		goto out;
+
+	/* libdbus duplicates the descriptor */
+	retval = dbus_message_append_args(msg,
+					  DBUS_TYPE_UNIX_FD, &fd,
+					  DBUS_TYPE_UINT32, &length,
+					  DBUS_TYPE_INVALID);
+out:
+	close(fd);
+	return retval;
+}
+
+static void whiteboard_util_free_payload_maps(void *data)
+{
+	WhiteBoardUtilPayloadMap *map = (WhiteBoardUtilPayloadMap *) data;
+	WhiteBoardUtilPayloadMap *next;
+
+	while (NULL != map)
+	{
+		next = map->next;
+		munmap(map->addr, map->size);
+		g_free(map);
+		map = next;
+	}
+}
+
+/* Map the fd payload at iter, leaving iter at its length argument */
+static gboolean whiteboard_util_map_fd_payload(DBusMessage *msg,
+					       DBusMessageIter *iter,
+					       const gchar **str)
+{
+	WhiteBoardUtilPayloadMap *map = NULL;
+	WhiteBoardUtilPayloadMap *head = NULL;
+	dbus_uint32_t length = 0;
+	struct stat st;
+	gpointer addr;
+	int fd = -1;
+
+	/* The descriptor returned is a duplicate owned by us */
+	dbus_message_iter_get_basic(iter, &fd);
+	if (!dbus_message_iter_next(iter) ||
+	    DBUS_TYPE_UINT32 != dbus_message_iter_get_arg_type(iter))
+	{
+		whiteboard_log_warning("fd payload without length\n");
+		close(fd);
+		return FALSE;
+	}
+	dbus_message_iter_get_basic(iter, &length);
+
+	if (fstat(fd, &st) < 0 || (guint64) st.st_size != (guint64) length + 1 ||
+	    (fcntl(fd, F_GET_SEALS) & WHITEBOARD_UTIL_FD_PAYLOAD_SEALS) !=
+	    WHITEBOARD_UTIL_FD_PAYLOAD_SEALS)
+	{
+		whiteboard_log_warning("Rejecting unsealed or truncated fd payload\n");
+		close(fd);
+		return FALSE;
+	}
+
+	addr = mmap(NULL, (gsize) length + 1, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (MAP_FAILED == addr)
+	{
+		whiteboard_log_warning("fd payload mmap failed: %s\n",
+				       strerror(errno));
+		return FALSE;
+	}
+	if (((const gchar *) addr)[length] != '\0')
+	{
+		whiteboard_log_warning("fd payload is not NUL terminated\n");
+		munmap(addr, (gsize) length + 1);
+		return FALSE;
+	}
+
+	map = g_new(WhiteBoardUtilPayloadMap, 1);
+	map->addr = addr;
+	map->size = (gsize) length + 1;
+	map->next = NULL;
+
+	/* The first map owns the message data slot, later ones are chained
+	   after it so the slot never has to be replaced */
+	if (payload_map_slot < 0)
+		dbus_message_allocate_data_slot(&payload_map_slot);
+	head = (WhiteBoardUtilPayloadMap *) dbus_message_get_data(msg, payload_map_slot);
+	if (NULL != head)
+	{
+		map->next = head->next;
+		head->next = map;
+	}
+	else if (!dbus_message_set_data(msg, payload_map_slot, map,
+					whiteboard_util_free_payload_maps))
+	{
+		whiteboard_util_free_payload_maps(map);
+		return FALSE;
+	}
+
+	*str = (const gchar *) addr;
+	return TRUE;
+}
+
+/* Copy the string array under sub into a NULL terminated vector */
+static gboolean whiteboard_util_get_string_array(DBusMessageIter *sub,
+						 gchar ***strv,
+						 gint *n_elements)
+{
+	DBusMessageIter it = *sub;
+	const gchar *str;
+	gsize len;
+	gint count = 0;
+	gint i;
+
+	while (DBUS_TYPE_INVALID != dbus_message_iter_get_arg_type(&it))
+	{
+		count++;
+		dbus_message_iter_next(&it);
+	}
+
+	*strv = dbus_new0(gchar *, count + 1);
+	if (NULL == *strv)
+		return FALSE;
+
+	for (i = 0; i < count; i++)
+	{
+		dbus_message_iter_get_basic(sub, &str);
+		len = strlen(str) + 1;
+		(*strv)[i] = dbus_malloc(len);
+		if (NULL != (*strv)[i])
+			memcpy((*strv)[i], str, len);
+		else
+		{
+			dbus_free_string_array(*strv);
+			*strv = NULL;
+			return FALSE;
+		}
+		dbus_message_iter_next(sub);
+	}
+
+	*n_elements = count;
+	return TRUE;
+}
+
+/* Walk the argument list of dbus_message_get_args_valist() by hand,
+   accepting fd payloads in place of strings */
+static gboolean whiteboard_util_get_args_valist(DBusMessage *msg,
+						gint first_argument_type,
+						va_list var_args)
+{
+	DBusMessageIter iter;
+	DBusMessageIter sub;
+	gint type = first_argument_type;
+	gint arg_type;
+	gint element_type;
+	void *value;
+	gint *n_elements;
+
+	if (!dbus_message_iter_init(msg, &iter))
+		return (DBUS_TYPE_INVALID == type);
+
+	while (DBUS_TYPE_INVALID != type)
+	{
+		arg_type = dbus_message_iter_get_arg_type(&iter);
+		if (DBUS_TYPE_ARRAY == type)
+		{
+			element_type = va_arg(var_args, gint);
+			value = va_arg(var_args, void *);
+			n_elements = va_arg(var_args, gint *);
+			if (DBUS_TYPE_ARRAY != arg_type ||
+			    element_type != dbus_message_iter_get_element_type(&iter))
+			{
+				whiteboard_log_warning("Array argument type mismatch\n");
+				return FALSE;
+			}
+			dbus_message_iter_recurse(&iter, &sub);
+			if (dbus_type_is_fixed(element_type))
+			{
+				dbus_message_iter_get_fixed_array(&sub, value,
+								  n_elements);
+			}
+			else if (DBUS_TYPE_STRING == element_type ||
+				 DBUS_TYPE_OBJECT_PATH == element_type ||
+				 DBUS_TYPE_SIGNATURE == element_type)
+			{
+				/* Copied like libdbus does; the caller frees the
+				   result with dbus_free_string_array() */
+				if (!whiteboard_util_get_string_array(&sub,
+								      (gchar ***) value,
+								      n_elements))
+					return FALSE;
+			}
+			else
+			{
+				whiteboard_log_warning("Unsupported array argument\n");
+				return FALSE;
+			}
+		}
+		else
+		{
+			value = va_arg(var_args, void *);
+			if (DBUS_TYPE_STRING == type && DBUS_TYPE_UNIX_FD == arg_type)
+			{
+				if (!whiteboard_util_map_fd_payload(msg, &iter,
+								    (const gchar **) value))
+					return FALSE;
+			}
+			else if (arg_type != type)
+			{
+				whiteboard_log_warning("Argument type %d, expected %d\n",
+						       arg_type, type);
+				return FALSE;
+			}
+			else
+			{
+				dbus_message_iter_get_basic(&iter, value);
+			}
+		}
+		dbus_message_iter_next(&iter);
+		type = va_arg(var_args, gint);
+	}
+
+	return TRUE;
+}
+#endif
+
+/* Append the argument list, moving strings above the fd payload threshold
+   to the side channel when the connection can carry descriptors */
+static void whiteboard_util_append_args_valist(DBusConnection *conn,
+					       DBusMessage *msg,
+					       gint first_argument_type,
+					       va_list var_args)
+{
+#ifdef WHITEBOARD_UTIL_FD_PAYLOAD
+	gint threshold = whiteboard_util_get_fd_payload_threshold();
+	gint type = first_argument_type;
+	gint element_type;
+	const void *value;
+	gint n_elements;
+	const gchar *str;
+	gsize len;
+
+	if (0 == threshold ||
+	    !dbus_connection_can_send_type(conn, DBUS_TYPE_UNIX_FD))
+	{
+		dbus_message_append_args_valist(msg, first_argument_type, var_args);
+		return;
+	}
+
+	while (DBUS_TYPE_INVALID != type)
+	{
+		if (DBUS_TYPE_ARRAY == type)
+		{
+			element_type = va_arg(var_args, gint);
+			value = va_arg(var_args, const void *);
+			n_elements = va_arg(var_args, gint);
+			dbus_message_append_args(msg, type, element_type, value,
+						 n_elements, DBUS_TYPE_INVALID);
+		}
+		else
+		{
+			value = va_arg(var_args, const void *);
+			str = (DBUS_TYPE_STRING == type) ? *(const gchar **) value : NULL;
+			len = (NULL != str) ? strlen(str) : 0;
+			if (len < (gsize) threshold || len >= G_MAXUINT32 ||
+			    !whiteboard_util_append_fd_payload(msg, str, len))
+				dbus_message_append_args(msg, type, value,
+							 DBUS_TYPE_INVALID);
+		}
+		type = va_arg(var_args, gint);
+	}
+#else
+	dbus_message_append_args_valist(msg, first_argument_type, var_args);
+#endif
+}
+
 gboolean whiteboard_util_send_message(const gchar *destination, const gchar *path,
 				    const gchar *interface, const gchar *method, gint type,
 				    DBusConnection *conn, DBusMessage *msg,
@@ -588,10 +1304,11 @@ gboolean whiteboard_util_send_message(const gchar *destination, const gchar *pat
 	switch (type)
 	{
 	case DBUS_MESSAGE_TYPE_METHOD_CALL:
-		new_message = dbus_message_new_method_call(destination,
-							   path,
-							   interface,
-							   method);
+		new_message = whiteboard_util_message_new(type,
+							  destination,
+							  path,
+							  interface,
+							  method);
 		break;
 
 	case DBUS_MESSAGE_TYPE_METHOD_RETURN:
@@ -611,7 +1328,8 @@ gboolean whiteboard_util_send_message(const gchar *destination, const gchar *pat
 		break;
 
 	case DBUS_MESSAGE_TYPE_SIGNAL:
-		new_message = dbus_message_new_signal(path, interface, method);
+		new_message = whiteboard_util_message_new(type, NULL, path,
+							  interface, method);
 		break;
 
 	default:
@@ -642,7 +1360,8 @@ gboolean whiteboard_util_send_message(const gchar *destination, const gchar *pat
 	       type);*/
 
 	va_start(argp, first_argument_type);
-	dbus_message_append_args_valist(new_message, first_argument_type, argp);
+	whiteboard_util_append_args_valist(conn, new_message,
+					   first_argument_type, argp);
 	va_end(argp);
 
 	dbus_error_init(&err);
@@ -663,13 +1382,12 @@ gboolean whiteboard_util_send_message(const gchar *destination, const gchar *pat
 		if (DBUS_MESSAGE_TYPE_METHOD_RETURN == type)
 		{
 			dbus_connection_send(conn, new_message, &my_serial);
-			dbus_connection_flush(conn);
 		}
 		else
 		  {
 		    dbus_connection_send(conn, new_message, serial);
-			dbus_connection_flush(conn);
 		  }
+		whiteboard_util_schedule_flush(conn);
 	}
 
 	if (dbus_error_is_set(&err))
@@ -688,6 +1406,115 @@ gboolean whiteboard_util_send_message(const gchar *destination, const gchar *pat
 	return TRUE;
 }
 
+/* Wraps the notify of an async method call so that it runs exactly once,
+   whether libdbus calls it or the sender finds the call already completed */
+typedef struct _WhiteBoardUtilPendingNotify
+{
+	DBusPendingCallNotifyFunction notify;
+	void *user_data;
+	DBusFreeFunction free_user_data;
+	volatile gint fired;
+} WhiteBoardUtilPendingNotify;
+
+static void whiteboard_util_pending_notify(DBusPendingCall *pending,
+					   void *data)
+{
+	WhiteBoardUtilPendingNotify *pn = (WhiteBoardUtilPendingNotify *) data;
+
+	if (g_atomic_int_compare_and_exchange(&pn->fired, 0, 1))
+		pn->notify(pending, pn->user_data);
+}
+
+static void whiteboard_util_pending_notify_free(void *data)
+{
+	WhiteBoardUtilPendingNotify *pn = (WhiteBoardUtilPendingNotify *) data;
+
+	if (NULL != pn->free_user_data)
+		pn->free_user_data(pn->user_data);
+	g_free(pn);
+}
+
+gboolean whiteboard_util_send_method_async(const gchar *destination,
+					   const gchar *path,
+					   const gchar *interface,
+					   const gchar *method,
+					   DBusConnection *conn,
+					   DBusPendingCallNotifyFunction notify,
+					   void *user_data,
+					   DBusFreeFunction free_user_data,
+					   gint first_argument_type, ...)
+{
+	DBusMessage *new_message = NULL;
+	DBusPendingCall *pending = NULL;
+	WhiteBoardUtilPendingNotify *pn = NULL;
+	va_list argp;
+	gboolean retval = FALSE;
+
+	whiteboard_log_debug_fb();
+	g_return_val_if_fail(NULL != conn, FALSE);
+	g_return_val_if_fail(NULL != notify, FALSE);
+
+	new_message = whiteboard_util_message_new(DBUS_MESSAGE_TYPE_METHOD_CALL,
+						  destination,
+						  path,
+						  interface,
+						  method);
+	if (NULL == new_message)
+	{
+		whiteboard_log_warning("Message creation failed!\n");
+		return FALSE;
+	}
+
+	whiteboard_log_debugc(WHITEBOARD_DEBUG_DBUS,"Sending async method call: %s.%s\n",
+			      interface, method);
+
+	va_start(argp, first_argument_type);
+	whiteboard_util_append_args_valist(conn, new_message,
+					   first_argument_type, argp);
+	va_end(argp);
+
+	pn = g_new0(WhiteBoardUtilPendingNotify, 1);
+	pn->notify = notify;
+	pn->user_data = user_data;
+	pn->free_user_data = free_user_data;
+
+	/* pending is left NULL if the connection is already disconnected */
+	if (!dbus_connection_send_with_reply(conn, new_message, &pending,
+					     WHITEBOARD_SEND_TIMEOUT) ||
+	    NULL == pending)
+	{
+		whiteboard_log_debugc(WHITEBOARD_DEBUG_DBUS,
+				      "Async message send failed\n");
+		g_free(pn);
+	}
+	else if (!dbus_pending_call_set_notify(pending,
+					       whiteboard_util_pending_notify,
+					       pn,
+					       whiteboard_util_pending_notify_free))
+	{
+		whiteboard_log_debugc(WHITEBOARD_DEBUG_DBUS,
+				      "Could not set notify for pending call\n");
+		dbus_pending_call_cancel(pending);
+		g_free(pn);
+	}
+	else
+	{
+		/* Another thread may dispatch the reply before the notify is
+		   set, and libdbus never calls a notify set after completion */
+		if (dbus_pending_call_get_completed(pending))
+			whiteboard_util_pending_notify(pending, pn);
+		retval = TRUE;
+	}
+
+	/* The connection holds its own reference until the call completes */
+	if (NULL != pending)
+		dbus_pending_call_unref(pending);
+
+	dbus_message_unref(new_message);
+	whiteboard_log_debug_fe();
+	return retval;
+}
+
 gboolean whiteboard_util_parse_message(DBusMessage *msg,
 				     gint first_argument_type, ...)
 {
@@ -768,18 +1595,35 @@ gboolean whiteboard_util_parse_message(DBusMessage *msg,
 	
 	dbus_error_init(&err);
 	va_start(var_args, first_argument_type);
-	retval = dbus_message_get_args_valist(msg, &err,
-					      first_argument_type, var_args);
+#ifdef WHITEBOARD_UTIL_FD_PAYLOAD
+	if (NULL != strchr(dbus_message_get_signature(msg), DBUS_TYPE_UNIX_FD))
+	{
+		/* a bad payload comes from the peer, never abort on it */
+		retval = whiteboard_util_get_args_valist(msg, first_argument_type,
+							 var_args);
+		if (FALSE == retval)
+		{
+			whiteboard_log_warning("Invalid fd payload arguments, "
+					       "signature %s\n",
+					       dbus_message_get_signature(msg));
+		}
+	}
+	else
+#endif
+	{
+		retval = dbus_message_get_args_valist(msg, &err,
+						      first_argument_type,
+						      var_args);
+		if (FALSE == retval)
+		{
+			whiteboard_log_warning("%s: %s\n", err.name, err.message);
+		}
+	}
 	va_end(var_args);
 
 	dbus_error_free(&err);
 
-	if (FALSE == retval)
-	{
-		whiteboard_log_error("%s: %s\n", err.name, err.message);
-	}
-
-	return TRUE;
+	return retval;
 }
 
 gboolean whiteboard_util_split_objectid(gchar* objectid,
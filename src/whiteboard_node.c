@@ -45,6 +45,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #define DBUS_API_SUBJECT_TO_CHANGE
 
@@ -59,6 +60,7 @@
 #include "whiteboard_node.h"
 #include "whiteboard_dbus_ifaces.h"
 #include "whiteboard_log.h"
+#include "whiteboard_trace.h"
 #include "whiteboard_marshal.h"
 #include "whiteboard_command.h"
 #include "m3_sib_tokens.h"
@@ -111,8 +113,31 @@ char * sampleSparqlresults =
 #define SUBSCRIBE_FLAGS_SUBSCRIBE   (1)
 #define SUBSCRIBE_FLAGS_UNSUBSCRIBE (1 << 1)
 
+/* Approximate number of bytes of XML markup generated for a triple in
+   addition to its element strings */
+#define TRIPLE_XML_OVERHEAD 128
+
+/* Maximum total size of the message buffers kept for reuse by a node */
+#define BUFDESC_POOL_MAX_BYTES (1024*1024)
+
+/* Maximum number of distinct namespace strings whose prefix maps are cached */
+#define NS_MAP_CACHE_MAX 32
+
+/* A cached prefix to namespace map with the trie for parsing results in
+   its namespace, never modified after it has been built */
+typedef struct _NsMapData
+{
+  gint refcount; // ns_map_cache and the requests using it
+  GHashTable *prefix2ns;
+  ssNsTrie_t *trie; // refers to the prefixes of prefix2ns
+} NsMapData;
+
+#define NS_MAP_PREFIX2NS(ns_map) ((ns_map)? (ns_map)->prefix2ns : NULL)
+#define NS_MAP_TRIE(ns_map) ((ns_map)? (ns_map)->trie : NULL)
+
 typedef struct _SubscriptionData
 {
+  gint refcount; // subscription_map and the handlers using it
   gchar *subscription_id;
   gint update_sequence;
   QueryType type;
@@ -127,10 +152,40 @@ typedef struct _SubscriptionData
   } cb;
   gint flags;
   gpointer user_data;
-  GHashTable *prefix_ns_map;
+  NsMapData *ns_map;
   GSList **selectedVariables;//for sparql select query
+  gint64 started; // query sent, for statistics
 } SubscriptionData;
 
+/* Bookkeeping for a request sent with whiteboard_node_*_async, freed when
+   the pending call completes */
+typedef struct _AsyncRequestData
+{
+  WhiteBoardNode *node;
+  WhiteBoardNodeAsyncCompleteCB cb; // insert, update and remove
+  gpointer user_data;
+  SubscriptionData *sd; // queries, until the access_id has been received
+  gint msgnumber; // for tracing
+  gint64 started; // for statistics
+  WhiteBoardNodeStatKind kind; // insert, update and remove
+} AsyncRequestData;
+
+struct _WhiteBoardNodeInsertBatch
+{
+  gint refcount; // the pending timer holds a reference
+  WhiteBoardNode *node;
+  GHashTable *prefix_ns_map;
+  ssBufDesc_t *bd; // open <triple_list>, NULL when the batch is empty
+  guint count;
+  guint max_triples;
+  gsize max_bytes;
+  guint max_delay;
+  GSource *timer;
+  WhiteBoardNodeAsyncCompleteCB cb;
+  gpointer user_data;
+  GMutex *lock;
+};
+
 struct _WhiteBoardNode
 {
   GObject parent;
@@ -138,13 +193,26 @@ struct _WhiteBoardNode
   gchar *uuid;     // Object identifier 
   gchar *sib; /* URI of the SIB after join, NULL otherwise */
   gboolean joined;
-  gint msgnumber;
+  gint msgnumber; // accessed atomically, see whiteboard_node_next_msgnumber
   GHashTable *subscription_map; // subscription_id -> SubscriptionData
   DBusConnection *connection;
 
-  GMutex *lock;
+  GMutex *lock; // join and leave, i.e. sib and joined
+  GMutex *subscription_lock; // subscription_map and SubscriptionData flags
+
+  GSList *bufdesc_pool; // ssBufDesc_t buffers kept for reuse
+  guint bufdesc_pool_bytes;
+  GMutex *bufdesc_lock;
+
+  GHashTable *ns_map_cache; // namespace string -> shared NsMapData
+  GMutex *ns_map_lock;
   
   GMainContext *main_context;
+
+  WhiteBoardNodeStats *stats;
+  GMutex *stats_lock;
+  gboolean stats_export;
+  gint64 join_started; // completed by the join complete signal
 };
 
 struct _WhiteBoardNodeClass
@@ -191,14 +259,70 @@ static gboolean whiteboard_node_register(WhiteBoardNode* self);
 
 static void whiteboard_node_class_init(WhiteBoardNodeClass *self);
 static gboolean whiteboard_node_joined(WhiteBoardNode *self);
+
+static gchar *whiteboard_node_dup_sib(WhiteBoardNode *self);
+static gint whiteboard_node_next_msgnumber(WhiteBoardNode *self);
+static gint64 whiteboard_node_stats_now(void);
+static void whiteboard_node_stats_add(WhiteBoardNode *self, WhiteBoardNodeHistogram *h, gint64 started, ssStatus_t status);
+static void whiteboard_node_stats_op(WhiteBoardNode *self, gint kind, gint64 started, ssStatus_t status);
+static void whiteboard_node_stats_bytes(WhiteBoardNode *self, gsize out, gsize in);
+static gint whiteboard_node_stat_kind_for_method(const gchar *method);
+static gint whiteboard_node_stat_kind_for_query(QueryType type);
 static SubscriptionData *whiteboard_node_get_subscription_data(WhiteBoardNode *self, gint access_id);
 
 static gboolean whiteboard_node_add_subscription_data(WhiteBoardNode *self, gint access_id, SubscriptionData *sd);
 
 static gboolean whiteboard_node_remove_subscription_data(WhiteBoardNode *self, gint access_id);
 
+static void whiteboard_node_subscription_data_unref(SubscriptionData *sd);
+
+static AsyncRequestData *whiteboard_node_async_request_new(WhiteBoardNode *self, WhiteBoardNodeAsyncCompleteCB cb, gpointer user_data, SubscriptionData *sd);
+
+static void whiteboard_node_async_request_free(void *data);
+
+static void whiteboard_node_async_reply(DBusPendingCall *pending, void *data);
+
+static ssStatus_t whiteboard_node_triplelist_to_xml(ssBufDesc_t *bd, GSList *triples, GHashTable *prefix_ns_map, gboolean patternMatching);
+
+static guint whiteboard_node_triplelist_size_hint(GSList *triples);
+
+static ssBufDesc_t *whiteboard_node_bufdesc_get(WhiteBoardNode *self, guint capacity);
+
+static void whiteboard_node_bufdesc_put(WhiteBoardNode *self, ssBufDesc_t **bd);
+
+static ssStatus_t whiteboard_node_get_ns_map(WhiteBoardNode *self, const gchar *ns, NsMapData **ns_map);
+static void whiteboard_node_ns_map_unref(NsMapData *ns_map);
+static ssStatus_t whiteboard_node_get_prefix2ns_map(WhiteBoardNode *self, const gchar *ns, GHashTable **map);
+
+static ssStatus_t whiteboard_node_triplebatch_to_xml(ssBufDesc_t *bd, const ssTripleBatch_t *batch, GHashTable *prefix_ns_map, gboolean patternMatching);
+
+static ssStatus_t whiteboard_node_modify_triplebatch(WhiteBoardNode *self, const gchar *method, const ssTripleBatch_t *triples, gboolean update, const ssTripleBatch_t *remove_triples, const gchar *namespace);
+
+static DBusHandlerResult whiteboard_node_sib_inserted(DBusConnection *conn, DBusMessage *msg, gpointer data);
+
+static DBusHandlerResult whiteboard_node_sib_removed(DBusConnection *conn, DBusMessage *msg, gpointer data);
+
+static DBusHandlerResult whiteboard_node_join_complete(DBusConnection *conn, DBusMessage *msg, gpointer data);
+
+static DBusHandlerResult whiteboard_node_subscription_ind(DBusConnection *conn, DBusMessage *msg, gpointer data);
+
+static DBusHandlerResult whiteboard_node_unsubscribe_complete(DBusConnection *conn, DBusMessage *msg, gpointer data);
+
+static DBusHandlerResult whiteboard_node_subscribe_return(DBusConnection *conn, DBusMessage *msg, gpointer data);
+
+static DBusHandlerResult whiteboard_node_query_return(DBusConnection *conn, DBusMessage *msg, gpointer data);
+
+static DBusHandlerResult whiteboard_node_custom_command_return(DBusConnection *conn, DBusMessage *msg, gpointer data);
+
+static DBusHandlerResult whiteboard_node_log_message(DBusConnection *conn, DBusMessage *msg, gpointer data);
+
+static DBusHandlerResult whiteboard_node_control_get_stats(DBusConnection *conn, DBusMessage *msg, gpointer data);
+
 static guint whiteboard_node_signals[NUM_SIGNALS];
 
+/* Message routing, built in class_init */
+static WhiteBoardUtilDispatchTable *whiteboard_node_dispatch_table = NULL;
+
 static void whiteboard_node_class_init(WhiteBoardNodeClass *self)
 {
   GObjectClass* object = G_OBJECT_CLASS(self);
@@ -209,6 +333,34 @@ static void whiteboard_node_class_init(WhiteBoardNodeClass *self)
   // object->dispose = whiteboard_node_dispose;
   object->finalize = whiteboard_node_finalize;
 
+  {
+    static const WhiteBoardUtilDispatchEntry entries[] = {
+      { DBUS_MESSAGE_TYPE_SIGNAL, WHITEBOARD_DBUS_NODE_INTERFACE,
+	WHITEBOARD_DBUS_NODE_SIGNAL_SIB_INSERTED, whiteboard_node_sib_inserted },
+      { DBUS_MESSAGE_TYPE_SIGNAL, WHITEBOARD_DBUS_NODE_INTERFACE,
+	WHITEBOARD_DBUS_NODE_SIGNAL_SIB_REMOVED, whiteboard_node_sib_removed },
+      { DBUS_MESSAGE_TYPE_SIGNAL, WHITEBOARD_DBUS_NODE_INTERFACE,
+	WHITEBOARD_DBUS_NODE_SIGNAL_JOIN_COMPLETE, whiteboard_node_join_complete },
+      { DBUS_MESSAGE_TYPE_SIGNAL, WHITEBOARD_DBUS_NODE_INTERFACE,
+	WHITEBOARD_DBUS_NODE_SIGNAL_SUBSCRIPTION_IND, whiteboard_node_subscription_ind },
+      { DBUS_MESSAGE_TYPE_SIGNAL, WHITEBOARD_DBUS_NODE_INTERFACE,
+	WHITEBOARD_DBUS_NODE_SIGNAL_UNSUBSCRIBE_COMPLETE, whiteboard_node_unsubscribe_complete },
+      { DBUS_MESSAGE_TYPE_SIGNAL, WHITEBOARD_DBUS_NODE_INTERFACE,
+	WHITEBOARD_DBUS_NODE_METHOD_SUBSCRIBE, whiteboard_node_subscribe_return },
+      { DBUS_MESSAGE_TYPE_SIGNAL, WHITEBOARD_DBUS_NODE_INTERFACE,
+	WHITEBOARD_DBUS_NODE_METHOD_QUERY, whiteboard_node_query_return },
+      { DBUS_MESSAGE_TYPE_METHOD_RETURN, WHITEBOARD_DBUS_CONTROL_INTERFACE,
+	WHITEBOARD_DBUS_METHOD_CUSTOM_COMMAND, whiteboard_node_custom_command_return },
+      { DBUS_MESSAGE_TYPE_SIGNAL, WHITEBOARD_DBUS_LOG_INTERFACE,
+	WHITEBOARD_DBUS_LOG_SIGNAL_MESSAGE, whiteboard_node_log_message },
+      { DBUS_MESSAGE_TYPE_METHOD_CALL, WHITEBOARD_DBUS_CONTROL_INTERFACE,
+	WHITEBOARD_DBUS_CONTROL_METHOD_GET_STATS, whiteboard_node_control_get_stats },
+      { 0, NULL, NULL, NULL }
+    };
+
+    whiteboard_node_dispatch_table = whiteboard_util_dispatch_table_new(entries);
+  }
+
 
   /* NODE_ACCESS */
   /* Source */
@@ -335,574 +487,643 @@ static void whiteboard_node_custom_command_response(WhiteBoardNode* self,
   whiteboard_cmd_unref(response);
 }
 
-static DBusHandlerResult whiteboard_node_sib_access_handler(DBusConnection *conn,
-							    DBusMessage *msg,
-							    gpointer data)
+static DBusHandlerResult whiteboard_node_sib_inserted(DBusConnection *conn,
+						      DBusMessage *msg,
+						      gpointer data)
 {
   WhiteBoardNode *self = (WhiteBoardNode *) data;
-  const gchar* member = NULL;
-  gint type = 0;
+  gchar *uuid = NULL;
+  gchar *name = NULL;
 
-  whiteboard_log_debug_fb();
-  
-  member = dbus_message_get_member(msg);
-  type = dbus_message_get_type(msg);
-  switch (type)
+  whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
+			"Got sib inserted signal.\n");
+
+  whiteboard_util_parse_message(msg,
+				DBUS_TYPE_STRING, &uuid,
+				DBUS_TYPE_STRING, &name,
+				WHITEBOARD_UTIL_LIST_END);
+
+  g_signal_emit(self,
+		whiteboard_node_signals[SIGNAL_SIB_INSERTED],
+		0,
+		uuid,
+		name);
+
+  return DBUS_HANDLER_RESULT_HANDLED;
+}
+
+static DBusHandlerResult whiteboard_node_sib_removed(DBusConnection *conn,
+						     DBusMessage *msg,
+						     gpointer data)
+{
+  WhiteBoardNode *self = (WhiteBoardNode *) data;
+  gchar *uuid = NULL;
+  gchar *name = NULL;
+
+  whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
+			"Got node removed signal.\n");
+
+  whiteboard_util_parse_message(msg,
+				DBUS_TYPE_STRING, &uuid,
+				DBUS_TYPE_STRING, &name,
+				WHITEBOARD_UTIL_LIST_END);
+
+  g_signal_emit(self,
+		whiteboard_node_signals[SIGNAL_SIB_REMOVED],
+		0,
+		uuid,
+		name);
+
+  return DBUS_HANDLER_RESULT_HANDLED;
+}
+
+static DBusHandlerResult whiteboard_node_join_complete(DBusConnection *conn,
+						       DBusMessage *msg,
+						       gpointer data)
+{
+  WhiteBoardNode *self = (WhiteBoardNode *) data;
+  dbus_int32_t access_id=0;
+  //      gint msgstatus= -1;
+  ssStatus_t status;
+  whiteboard_util_parse_message(msg,
+				DBUS_TYPE_INT32, &access_id,
+				DBUS_TYPE_INT32, &status,
+				WHITEBOARD_UTIL_LIST_END);
+
+  whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
+			"Got join complete signal for accessid %d, status %d.\n", access_id, status);
+  whiteboard_node_stats_op(self, WHITEBOARD_NODE_STAT_JOIN, self->join_started, status);
+
+  g_mutex_lock(self->lock);
+  if(status && self->sib)
     {
-    case DBUS_MESSAGE_TYPE_METHOD_RETURN:
-      {
-	whiteboard_log_warning("Unknown method return: %s\n", member);
-      }
-      break;
-      
-    case DBUS_MESSAGE_TYPE_METHOD_CALL:
-      whiteboard_log_warning("Unknown method call: %d\n", type);
+      g_free(self->sib);
+      self->sib=NULL;
+      whiteboard_log_debug("Join failed, Deletin self->sib\n");
+    }
+  else
+    {
+      whiteboard_log_debug("Join ok, self->sib: %s\n", self->sib);
+      self->joined = TRUE;
+    }
+  g_mutex_unlock(self->lock);
 
-      break;
-    case DBUS_MESSAGE_TYPE_SIGNAL:
-      if (!strcmp(member, WHITEBOARD_DBUS_NODE_SIGNAL_SIB_INSERTED))
-	{
-	  gchar *uuid = NULL;
-	  gchar *name = NULL;
-			
-	  whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
-				"Got sib inserted signal.\n");
+  g_signal_emit(self,
+		whiteboard_node_signals[SIGNAL_JOIN_COMPLETE],
+		0,
+		status);
 
-	  whiteboard_util_parse_message(msg,
-					DBUS_TYPE_STRING, &uuid,
-					DBUS_TYPE_STRING, &name,
-					WHITEBOARD_UTIL_LIST_END);
-			
-	  g_signal_emit(self,
-			whiteboard_node_signals[SIGNAL_SIB_INSERTED],
-			0,
-			uuid,
-			name);
-	}
-      else if (!strcmp(member, WHITEBOARD_DBUS_NODE_SIGNAL_SIB_REMOVED))
+  return DBUS_HANDLER_RESULT_HANDLED;
+}
+
+static DBusHandlerResult whiteboard_node_subscription_ind(DBusConnection *conn,
+							  DBusMessage *msg,
+							  gpointer data)
+{
+  WhiteBoardNode *self = (WhiteBoardNode *) data;
+  gchar *results_added  = NULL;
+  gchar *results_removed  = NULL;
+  gchar *subscription_id = NULL;
+  gint access_id = -1;
+  gint update_sequence = 0;
+  ssStatus_t status;
+  gint64 started = whiteboard_node_stats_now();
+  gint64 parse_started;
+
+  whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
+			"Got subscription ind signal.\n");
+
+  whiteboard_util_parse_message(msg,
+				DBUS_TYPE_INT32, &access_id,
+				DBUS_TYPE_INT32, &update_sequence,
+				DBUS_TYPE_STRING, &subscription_id,
+				DBUS_TYPE_STRING, &results_added,
+				DBUS_TYPE_STRING, &results_removed,
+				WHITEBOARD_UTIL_LIST_END);
+
+  //no status was passed - instead, the scription_id string NULL indicates an error
+  //which is lumped with checking of other passed message parameters
+  status = ((access_id > 0) && (NULL != subscription_id) && (NULL != results_added)  && (NULL != results_removed))?
+    ss_StatusOK : ss_InternalError;
+  if(!status)
+    {
+      SubscriptionData  *sb = NULL;
+      whiteboard_node_stats_bytes(self, 0, strlen(results_added) + strlen(results_removed));
+      sb = whiteboard_node_get_subscription_data(self, access_id);
+
+      if (!sb || sb->cb.s_template==NULL)
 	{
-	  gchar *uuid = NULL;
-	  gchar *name = NULL;
-			
 	  whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
-				"Got node removed signal.\n");
-			
-	  whiteboard_util_parse_message(msg,
-					DBUS_TYPE_STRING, &uuid,
-					DBUS_TYPE_STRING, &name,
-					WHITEBOARD_UTIL_LIST_END);
-			
-	  g_signal_emit(self,
-			whiteboard_node_signals[SIGNAL_SIB_REMOVED],
-			0,
-			uuid,
-			name);
+				"SubscriptionData not found or callback not set. ID: %s.\n", subscription_id);
 	}
-      else if (!strcmp(member, WHITEBOARD_DBUS_NODE_SIGNAL_JOIN_COMPLETE))
+      else
 	{
-	  dbus_int32_t access_id=0;
-	  //	  gint msgstatus= -1;
-	  ssStatus_t status;
-	  whiteboard_util_parse_message(msg,
-					DBUS_TYPE_INT32, &access_id,
-					DBUS_TYPE_INT32, &status,
-					WHITEBOARD_UTIL_LIST_END);
+	  //verify sequence number, if used.  always 0 or 1,2..(SSAP_IND_WRAP_NUM-1),1,2..
+	  if (update_sequence==0
+	      && sb->update_sequence==0) //sb->update_sequence initialized with 0
+	    sb->update_sequence = -1;//lock 0 as only acceptable update_sequence
 
-	  whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
-				"Got join complete signal for accessid %d, status %d.\n", access_id, status);
-	  
-	  if(status && self->sib)
+	  if (sb->update_sequence!=-1 && ++sb->update_sequence==SSAP_IND_WRAP_NUM)
+	    sb->update_sequence = 1;
+
+	  if ((update_sequence!=sb->update_sequence)
+	      && !(update_sequence==0 && sb->update_sequence == -1))
+	    status = ss_IndicationSequenceError;//passed in callback and used to effect empty lists (no parsing)
+
+	  if(sb->type == QueryTypeTemplate)
 	    {
-	      g_free(self->sib);
-	      self->sib=NULL;
-	      whiteboard_log_debug("Join failed, Deletin self->sib\n");
+	      GSList **triples_added = (GSList **)g_new0(GSList *,1); // allocate space for pointer and make it an empty list
+
+	      GSList **triples_removed = (GSList **)g_new0(GSList *,1); // allocate space for pointer and make it an empty list
+
+	      whiteboard_trace(WHITEBOARD_TRACE_PARSE_START, -1, access_id,
+			       strlen(results_added) + strlen(results_removed));
+	      parse_started = whiteboard_node_stats_now();
+	      if (!status
+		  &&
+		  ((status = parseM3_triples_trie (triples_added, results_added, NS_MAP_TRIE(sb->ns_map)))
+		   ||
+		   (status = parseM3_triples_trie (triples_removed, results_removed, NS_MAP_TRIE(sb->ns_map)))
+		  )
+		 )
+		whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
+				      "error, when trying to generating triples from results\n");
+	      whiteboard_trace(WHITEBOARD_TRACE_PARSE_END, -1, access_id, 0);
+	      whiteboard_node_stats_add(self, &self->stats->parse, parse_started, status);
+	      whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
+				    "Calling subscription ind callback. Id: %s\n", subscription_id);
+	      sb->cb.s_template(status, triples_added, triples_removed, sb->user_data);
 	    }
-	  else
+	  else if(sb->type == QueryTypeWQLValues )
 	    {
-	      whiteboard_log_debug("Join ok, self->sib: %s\n", self->sib);
-	      self->joined = TRUE;
+	      GSList **nodelist_added = (GSList **)g_new0(GSList *,1); // allocate space for pointer
+	      GSList **nodelist_removed = (GSList **)g_new0(GSList *,1); // allocate space for pointer
+	      whiteboard_trace(WHITEBOARD_TRACE_PARSE_START, -1, access_id,
+			       strlen(results_added) + strlen(results_removed));
+	      parse_started = whiteboard_node_stats_now();
+	      if (!status
+		  &&
+		  ((status = parseM3_query_cnf_wql (nodelist_added, results_added))
+		   ||
+		   (status = parseM3_query_cnf_wql (nodelist_removed, results_removed))
+		  )
+		 )
+		whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
+					"Parse error, when trying to generating nodelist from results\n");
+	      whiteboard_trace(WHITEBOARD_TRACE_PARSE_END, -1, access_id, 0);
+	      whiteboard_node_stats_add(self, &self->stats->parse, parse_started, status);
+	      whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
+				    "Calling subscription ind callback. Id: %s\n", subscription_id);
+	      sb->cb.s_wql_values( status, nodelist_added, nodelist_removed, sb->user_data);
 	    }
-	  
-	  g_signal_emit(self,
-			whiteboard_node_signals[SIGNAL_JOIN_COMPLETE],
-			0,
-			status);
-	}
-      else if (!strcmp(member, WHITEBOARD_DBUS_NODE_SIGNAL_SUBSCRIPTION_IND))
-	{
-	  gchar *results_added  = NULL;
-	  gchar *results_removed  = NULL;
-	  gchar *subscription_id = NULL;
-	  gint access_id = -1;
-	  gint update_sequence = 0;
-	  ssStatus_t status;
-
-	  whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
-				"Got subscription ind signal.\n");
-
-	  whiteboard_util_parse_message(msg,
-					DBUS_TYPE_INT32, &access_id,
-					DBUS_TYPE_INT32, &update_sequence,
-					DBUS_TYPE_STRING, &subscription_id,
-					DBUS_TYPE_STRING, &results_added,
-					DBUS_TYPE_STRING, &results_removed,
-					WHITEBOARD_UTIL_LIST_END);
-
-	  //no status was passed - instead, the scription_id string NULL indicates an error
-	  //which is lumped with checking of other passed message parameters
-	  status = ((access_id > 0) && (NULL != subscription_id) && (NULL != results_added)  && (NULL != results_removed))?
-	    ss_StatusOK : ss_InternalError;
-	  if(!status)
+	  else if(sb->type == QueryTypeWQLRelated)
 	    {
-	      SubscriptionData  *sb = NULL;
-	      sb = whiteboard_node_get_subscription_data(self, access_id);
+	      gboolean resultVal=TRUE+FALSE+2; //hehe.. that will kill the unassigned-warning
+	      if(status)
+		whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
+				      "error passed before parse to generate node list from results\n");
 
-	      if (!sb || sb->cb.s_template==NULL)
-		{
-		  whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
-					"SubscriptionData not found or callback not set. ID: %s.\n", subscription_id);
-		}
-	      else
+	      if (!status)
 		{
-		  //verify sequence number, if used.  always 0 or 1,2..(SSAP_IND_WRAP_NUM-1),1,2..
-		  if (update_sequence==0
-		      && sb->update_sequence==0) //sb->update_sequence initialized with 0
-		    sb->update_sequence = -1;//lock 0 as only acceptable update_sequence
-
-		  if (sb->update_sequence!=-1 && ++sb->update_sequence==SSAP_IND_WRAP_NUM)
-		    sb->update_sequence = 1;
-
-		  if ((update_sequence!=sb->update_sequence)
-		      && !(update_sequence==0 && sb->update_sequence == -1))
-		    status = ss_IndicationSequenceError;//passed in callback and used to effect empty lists (no parsing)
-
-		  if(sb->type == QueryTypeTemplate)
-		    {
-		      GSList **triples_added = (GSList **)g_new0(GSList *,1); // allocate space for pointer and make it an empty list
-
-		      GSList **triples_removed = (GSList **)g_new0(GSList *,1); // allocate space for pointer and make it an empty list
-
-		      if (!status
-			  &&
-			  ((status = parseM3_triples (triples_added, results_added, sb->prefix_ns_map))
-			   ||
-			   (status = parseM3_triples (triples_removed, results_removed, sb->prefix_ns_map))
-			  )
-			 )
-			whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
-					      "error, when trying to generating triples from results\n");
-		      whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
-					    "Calling subscription ind callback. Id: %s\n", subscription_id);
-		      sb->cb.s_template(status, triples_added, triples_removed, sb->user_data);
-		    }
-		  else if(sb->type == QueryTypeWQLValues )
-		    {
-		      GSList **nodelist_added = (GSList **)g_new0(GSList *,1); // allocate space for pointer
-		      GSList **nodelist_removed = (GSList **)g_new0(GSList *,1); // allocate space for pointer		  
-		      if (!status
-			  &&
-			  ((status = parseM3_query_cnf_wql (nodelist_added, results_added))
-			   ||
-			   (status = parseM3_query_cnf_wql (nodelist_removed, results_removed))
-			  )
-			 )
-			whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
-						"Parse error, when trying to generating nodelist from results\n");
-		      whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
-					    "Calling subscription ind callback. Id: %s\n", subscription_id);
-		      sb->cb.s_wql_values( status, nodelist_added, nodelist_removed, sb->user_data);
-		    }
-		  else if(sb->type == QueryTypeWQLRelated)
-		    {
-		      gboolean resultVal=TRUE+FALSE+2; //hehe.. that will kill the unassigned-warning
-		      if(status)
-			whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
-					      "error passed before parse to generate node list from results\n");
-
-		      if (!status)
-			{
-			  if (0==strcmp (results_added, results_removed))
-			    {
-			      status = ss_ParsingError; // I.E. we dont know and thus can't assign the result value
-			      whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
-						    "Subscription results added and removed, both: %s.\n", results_added);
-			      status = ss_ParsingError; // I.E. we could guess, but shouldn't.
-			    }
-			  else if (0==strcmp(SIB_TRUE.txt, results_added))
-			    resultVal = TRUE;
-			  else if (0==strcmp(SIB_FALSE.txt, results_added))
-			    resultVal = FALSE;
-			  else
-			    status = ss_ParsingError; // I.E. we dont know and thus can't assign the result value
-			}
-		      whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
-					    "Calling query WQL callback for\n");
-		      sb->cb.q_wql_boolean(status, resultVal, sb->user_data);
-		    }
-		  else if(sb->type == QueryTypeSPARQLSelect)
+		  if (0==strcmp (results_added, results_removed))
 		    {
-		      GSList **valRows_added = (GSList **)g_new0(GSList *,1); // allocate space for pointer
-		      GSList **valRows_removed = (GSList **)g_new0(GSList *,1); // allocate space for pointer		  
-		      if (!status
-			  &&
-			  ((status = parseM3_query_results_sparql_select (sb->selectedVariables, valRows_added, results_added, sb->prefix_ns_map))
-			   ||
-			   (status = parseM3_query_results_sparql_select (sb->selectedVariables, valRows_removed, results_removed, sb->prefix_ns_map))
-			  )
-			 )
-			whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
-						"Parse error, when trying to generating nodelist from results\n");
+		      status = ss_ParsingError; // I.E. we dont know and thus can't assign the result value
 		      whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
-					    "Calling subscription ind callback. Id: %s\n", subscription_id);
-		      sb->cb.s_sparql_select (status, valRows_added, valRows_removed, sb->user_data);
+					    "Subscription results added and removed, both: %s.\n", results_added);
+		      status = ss_ParsingError; // I.E. we could guess, but shouldn't.
 		    }
+		  else if (0==strcmp(SIB_TRUE.txt, results_added))
+		    resultVal = TRUE;
+		  else if (0==strcmp(SIB_FALSE.txt, results_added))
+		    resultVal = FALSE;
 		  else
-		    {
-		      whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
-					    "Invalid Query type\n");  
-		    }
+		    status = ss_ParsingError; // I.E. we dont know and thus can't assign the result value
 		}
-	    }  
-	}
-      else if (!strcmp(member, WHITEBOARD_DBUS_NODE_SIGNAL_UNSUBSCRIBE_COMPLETE))
-	{
-	  dbus_int32_t msgstatus=-1;
-	  dbus_int32_t access_id = -1;
-	  gint status = -1;
-	  gchar *subscription_id=NULL;
-	  whiteboard_util_parse_message(msg,
-					DBUS_TYPE_INT32, &access_id,
-					DBUS_TYPE_INT32, &msgstatus,
-					DBUS_TYPE_STRING, &subscription_id,
-					WHITEBOARD_UTIL_LIST_END);
-	  if( (access_id != -1) &&  (msgstatus != -1) && ( subscription_id))
-	    whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
-				  "Got unsubscribe complete signal got access_id:%d, /w status: %d, subscription_id: %s.\n", access_id, msgstatus, subscription_id);
-	  else
-	    whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
-				  "Got unsubscribe complete signal, but could not parse paratemers\n");
-	  
-	  if(msgstatus == MSG_E_OK)
+	      whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
+				    "Calling query WQL callback for\n");
+	      sb->cb.q_wql_boolean(status, resultVal, sb->user_data);
+	    }
+	  else if(sb->type == QueryTypeSPARQLSelect)
 	    {
-	      status = 0;
-	      whiteboard_node_remove_subscription_data(self, access_id);
-	  
-	      g_signal_emit(self,
-			    whiteboard_node_signals[SIGNAL_UNSUBSCRIBE_COMPLETE],
-			    0,
-			    access_id,
-			    status);
+	      GSList **valRows_added = (GSList **)g_new0(GSList *,1); // allocate space for pointer
+	      GSList **valRows_removed = (GSList **)g_new0(GSList *,1); // allocate space for pointer
+	      whiteboard_trace(WHITEBOARD_TRACE_PARSE_START, -1, access_id,
+			       strlen(results_added) + strlen(results_removed));
+	      parse_started = whiteboard_node_stats_now();
+	      if (!status
+		  &&
+		  ((status = parseM3_query_results_sparql_select_trie (sb->selectedVariables, valRows_added, results_added, NS_MAP_TRIE(sb->ns_map)))
+		   ||
+		   (status = parseM3_query_results_sparql_select_trie (sb->selectedVariables, valRows_removed, results_removed, NS_MAP_TRIE(sb->ns_map)))
+		  )
+		 )
+		whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
+					"Parse error, when trying to generating nodelist from results\n");
+	      whiteboard_trace(WHITEBOARD_TRACE_PARSE_END, -1, access_id, 0);
+	      whiteboard_node_stats_add(self, &self->stats->parse, parse_started, status);
+	      whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
+				    "Calling subscription ind callback. Id: %s\n", subscription_id);
+	      sb->cb.s_sparql_select (status, valRows_added, valRows_removed, sb->user_data);
 	    }
 	  else
 	    {
-	      status = -1;
-	      g_signal_emit(self,
-			    whiteboard_node_signals[SIGNAL_UNSUBSCRIBE_COMPLETE],
-			    0,
-			    access_id,
-			    status);
+	      whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
+				    "Invalid Query type\n");
 	    }
 	}
-      else if (!strcmp(member, WHITEBOARD_DBUS_NODE_METHOD_SUBSCRIBE))
+      if (sb)
+	whiteboard_node_subscription_data_unref(sb);
+    }
+
+  whiteboard_node_stats_op(self, WHITEBOARD_NODE_STAT_INDICATION, started, status);
+  return DBUS_HANDLER_RESULT_HANDLED;
+}
+
+static DBusHandlerResult whiteboard_node_unsubscribe_complete(DBusConnection *conn,
+							      DBusMessage *msg,
+							      gpointer data)
+{
+  WhiteBoardNode *self = (WhiteBoardNode *) data;
+  dbus_int32_t msgstatus=-1;
+  dbus_int32_t access_id = -1;
+  gint status = -1;
+  gchar *subscription_id=NULL;
+  whiteboard_util_parse_message(msg,
+				DBUS_TYPE_INT32, &access_id,
+				DBUS_TYPE_INT32, &msgstatus,
+				DBUS_TYPE_STRING, &subscription_id,
+				WHITEBOARD_UTIL_LIST_END);
+  if( (access_id != -1) &&  (msgstatus != -1) && ( subscription_id))
+    whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
+			  "Got unsubscribe complete signal got access_id:%d, /w status: %d, subscription_id: %s.\n", access_id, msgstatus, subscription_id);
+  else
+    whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
+			  "Got unsubscribe complete signal, but could not parse paratemers\n");
+
+  if(msgstatus == MSG_E_OK)
+    {
+      status = 0;
+      whiteboard_node_remove_subscription_data(self, access_id);
+
+      g_signal_emit(self,
+		    whiteboard_node_signals[SIGNAL_UNSUBSCRIBE_COMPLETE],
+		    0,
+		    access_id,
+		    status);
+    }
+  else
+    {
+      status = -1;
+      g_signal_emit(self,
+		    whiteboard_node_signals[SIGNAL_UNSUBSCRIBE_COMPLETE],
+		    0,
+		    access_id,
+		    status);
+    }
+
+  return DBUS_HANDLER_RESULT_HANDLED;
+}
+
+static DBusHandlerResult whiteboard_node_subscribe_return(DBusConnection *conn,
+							  DBusMessage *msg,
+							  gpointer data)
+{
+  WhiteBoardNode *self = (WhiteBoardNode *) data;
+  gint access_id = -1;
+  ssStatus_t status = -1;
+  gchar *subscription_id = NULL;
+  gchar *results = NULL;
+  gint64 parse_started;
+  whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
+			"Got SUBSCRIBE method return.\n");
+
+  whiteboard_util_parse_message(msg,
+				DBUS_TYPE_INT32, &access_id,
+				DBUS_TYPE_INT32, &status,
+				DBUS_TYPE_STRING, &subscription_id,
+				DBUS_TYPE_STRING, &results,
+				WHITEBOARD_UTIL_LIST_END);
+  if( (access_id > 0) && (status == ss_StatusOK) && (NULL != subscription_id) && (NULL != results) )
+    {
+      SubscriptionData  *sb = NULL;
+      whiteboard_node_stats_bytes(self, 0, strlen(results));
+      sb = whiteboard_node_get_subscription_data(self, access_id);
+      if (sb && sb->cb.s_template)
+	{
+	  //?? is the allocated subscription_id used? freed?
+	  g_mutex_lock(self->subscription_lock);
+	  sb->subscription_id = g_strdup(subscription_id);
+	  sb->flags = 0;
+	  g_mutex_unlock(self->subscription_lock);
+	}
+      else if (sb)
+	{
+	  whiteboard_node_subscription_data_unref(sb);
+	  sb=NULL;
+	}
+
+      if (sb==NULL)
 	{
-	  gint access_id = -1;
-	  ssStatus_t status = -1;
-	  gchar *subscription_id = NULL;
-	  gchar *results = NULL;
 	  whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
-				"Got SUBSCRIBE method return.\n");
-	  
-	  whiteboard_util_parse_message(msg,
-					DBUS_TYPE_INT32, &access_id,
-					DBUS_TYPE_INT32, &status,
-					DBUS_TYPE_STRING, &subscription_id,
-					DBUS_TYPE_STRING, &results,
-					WHITEBOARD_UTIL_LIST_END);
-	  if( (access_id > 0) && (status == ss_StatusOK) && (NULL != subscription_id) && (NULL != results) )
-	    {
-	      SubscriptionData  *sb = NULL;
-	      sb = whiteboard_node_get_subscription_data(self, access_id);
-	      if (sb && sb->cb.s_template)
-		{
-		  //?? is the allocated subscription_id used? freed?
-		  sb->subscription_id = g_strdup(subscription_id);
-		  sb->flags = 0;
-		}
-	      else
-		sb=NULL;
+				"SubscriptionData not found or callback not set. ID: %s.\n", subscription_id);
+	}
+      else if(sb->type == QueryTypeTemplate)
+	{
+	  GSList **initial_triples = (GSList **)g_new0(GSList *,1); // allocate space for pointer and make it an empty list
+	  GSList **no_triples = (GSList **)g_new0(GSList *,1); // allocate space for pointer and make it an empty list
 
-	      if (sb==NULL)
-		{
-		  whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
-					"SubscriptionData not found or callback not set. ID: %s.\n", subscription_id);
-		}
-	      else if(sb->type == QueryTypeTemplate)
-		{
-		  GSList **initial_triples = (GSList **)g_new0(GSList *,1); // allocate space for pointer and make it an empty list
-		  GSList **no_triples = (GSList **)g_new0(GSList *,1); // allocate space for pointer and make it an empty list
+	  if(status)
+	      whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
+				    "error passed before parse to generate triples from results\n");
+	  whiteboard_trace(WHITEBOARD_TRACE_PARSE_START, -1, access_id, strlen(results));
+	  parse_started = whiteboard_node_stats_now();
+	  if (!status && /*and NOW changes*/
+	      (status = parseM3_triples_trie (initial_triples, results, NS_MAP_TRIE(sb->ns_map))))
+	    whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
+				  "error, when trying to generating triples from results\n");
+	  whiteboard_trace(WHITEBOARD_TRACE_PARSE_END, -1, access_id, 0);
+	  whiteboard_node_stats_add(self, &self->stats->parse, parse_started, status);
+	  whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
+				"Calling subscription ind callback. Id: %s\n", subscription_id);
+	  sb->cb.s_template( status, initial_triples, no_triples, sb->user_data);
+	}
+      else if (sb->type == QueryTypeSPARQLSelect)
 
-		  if(status)
-		      whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
-					    "error passed before parse to generate triples from results\n");
-		  if (!status && /*and NOW changes*/
-		      (status = parseM3_triples (initial_triples, results, sb->prefix_ns_map)))
-		    whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
-					  "error, when trying to generating triples from results\n");
-		  whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
-					"Calling subscription ind callback. Id: %s\n", subscription_id);
-		  sb->cb.s_template( status, initial_triples, no_triples, sb->user_data);
-		}
-	      else if (sb->type == QueryTypeSPARQLSelect)
+	{
+	  GSList **selectedVariables  = (GSList **)g_new0(GSList *,1); // allocate space for pointer and make it an empty list
+	  GSList **valRows = (GSList **)g_new0(GSList *,1); // allocate space for pointer and make it an empty list
 
-		{
-		  GSList **selectedVariables  = (GSList **)g_new0(GSList *,1); // allocate space for pointer and make it an empty list
-		  GSList **valRows = (GSList **)g_new0(GSList *,1); // allocate space for pointer and make it an empty list
-
-		  if(status)
-		    whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
-					  "error passed before parse to generate results\n");
-		  if(!status && /*and NOW changes*/
-		     (status = parseM3_query_results_sparql_select (selectedVariables, valRows, results, sb->prefix_ns_map)))
-		    whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
-					  "Parse error, when trying to generating nodelist from results\n");
-		      
-		  whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
-					"Calling query WQL callback for\n");
-		  sb->cb.q_sparql_select(status, selectedVariables, valRows, sb->user_data);
-		}
-	      else if(sb->type == QueryTypeWQLValues )
-		{
-		  GSList **nodelist = (GSList **)g_new0(GSList *,1); // allocate space for pointer and make it an empty list.
-		  GSList **nullList = (GSList **)g_new0(GSList *,1); // allocate space for pointer and make it an empty list.
+	  if(status)
+	    whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
+				  "error passed before parse to generate results\n");
+	  whiteboard_trace(WHITEBOARD_TRACE_PARSE_START, -1, access_id, strlen(results));
+	  parse_started = whiteboard_node_stats_now();
+	  if(!status && /*and NOW changes*/
+	     (status = parseM3_query_results_sparql_select_trie (selectedVariables, valRows, results, NS_MAP_TRIE(sb->ns_map))))
+	    whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
+				  "Parse error, when trying to generating nodelist from results\n");
+	  whiteboard_trace(WHITEBOARD_TRACE_PARSE_END, -1, access_id, 0);
+	  whiteboard_node_stats_add(self, &self->stats->parse, parse_started, status);
 
-		  ssStatus_t status = parseM3_query_cnf_wql (nodelist, results);
-		  if( status == ss_StatusOK )
-		    {
-		      if( (NULL != sb) &&
-			  (NULL != sb->cb.s_wql_values) )
-			{
-			  whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
-						"Calling subscription ind callback. Id: %s\n", subscription_id);
-			  sb->cb.s_wql_values( 0, nodelist, nullList, sb->user_data);
-			}
-		      else
-			{
-			  whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
-						"SubscriptionData not found or callback not set. ID: %s.\n", subscription_id);
-			}
-		    }
-		  else
-		    {
-		      whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
-					    "Parse error, when trying to generating nodelist from results\n");
-		    }
-		}
-	      else if(sb->type == QueryTypeWQLRelated)
+	  whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
+				"Calling query WQL callback for\n");
+	  sb->cb.q_sparql_select(status, selectedVariables, valRows, sb->user_data);
+	}
+      else if(sb->type == QueryTypeWQLValues )
+	{
+	  GSList **nodelist = (GSList **)g_new0(GSList *,1); // allocate space for pointer and make it an empty list.
+	  GSList **nullList = (GSList **)g_new0(GSList *,1); // allocate space for pointer and make it an empty list.
+
+	  whiteboard_trace(WHITEBOARD_TRACE_PARSE_START, -1, access_id, strlen(results));
+	  parse_started = whiteboard_node_stats_now();
+	  ssStatus_t status = parseM3_query_cnf_wql (nodelist, results);
+	  whiteboard_trace(WHITEBOARD_TRACE_PARSE_END, -1, access_id, 0);
+	  whiteboard_node_stats_add(self, &self->stats->parse, parse_started, status);
+	  if( status == ss_StatusOK )
+	    {
+	      if( (NULL != sb) &&
+		  (NULL != sb->cb.s_wql_values) )
 		{
-		  gboolean resultVal=TRUE+FALSE+2; //hehe.. that will kill the unassigned-warning
-		  if(status)
-		      whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
-					    "error passed before parse to generate node list from results\n");
-
-		  if (!status)
-		    {
-		      if (0==strcmp(SIB_TRUE.txt, results))
-			resultVal = TRUE;
-		      else if (0==strcmp(SIB_FALSE.txt, results))
-			resultVal = FALSE;
-		      else
-			status = ss_ParsingError; // I.E. we dont know and thus can't assign the result value
-		    }
 		  whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
-					"Calling query WQL callback for\n");
-		  sb->cb.q_wql_boolean(status, resultVal, sb->user_data);
+					"Calling subscription ind callback. Id: %s\n", subscription_id);
+		  sb->cb.s_wql_values( 0, nodelist, nullList, sb->user_data);
 		}
 	      else
 		{
 		  whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
-					"Invalid query type in subcriptionData\n");
+					"SubscriptionData not found or callback not set. ID: %s.\n", subscription_id);
 		}
-	    }  
+	    }
 	  else
 	    {
 	      whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
-				    "Could not get subscribe response parameters\n"); 
+				    "Parse error, when trying to generating nodelist from results\n");
 	    }
-	   
-	  
 	}
-      else if (!strcmp(member, WHITEBOARD_DBUS_NODE_METHOD_QUERY))
+      else if(sb->type == QueryTypeWQLRelated)
 	{
-	  gint access_id = -1;
-	  ssStatus_t status;
-	  gchar *results = NULL;
+	  gboolean resultVal=TRUE+FALSE+2; //hehe.. that will kill the unassigned-warning
+	  if(status)
+	      whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
+				    "error passed before parse to generate node list from results\n");
+
+	  if (!status)
+	    {
+	      if (0==strcmp(SIB_TRUE.txt, results))
+		resultVal = TRUE;
+	      else if (0==strcmp(SIB_FALSE.txt, results))
+		resultVal = FALSE;
+	      else
+		status = ss_ParsingError; // I.E. we dont know and thus can't assign the result value
+	    }
 	  whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
-				"Got QUERY method return.\n");
-	  
-	  if(whiteboard_util_parse_message(msg,
-					   DBUS_TYPE_INT32, &access_id,
-					   DBUS_TYPE_INT32, &status,
-					   DBUS_TYPE_STRING, &results,
-					   WHITEBOARD_UTIL_LIST_END))
-	    {	      
-	      status = ( (status == ss_StatusOK) && (access_id > 0) && (NULL != results) )? ss_StatusOK : ss_InternalError;
-#if 0 //testing sparql results
-	      results = sampleSparqlresults;
-	      status = ss_StatusOK;
-#endif
-	      if (status == ss_StatusOK)
-		{
-		  SubscriptionData  *sb = NULL;
-		  sb = whiteboard_node_get_subscription_data(self, access_id);
-		  //the call back should be made with or without triples at the first detectable failure
-		  if (sb == NULL)
-		    status = ss_NotEnoughResources;
-		  else if (sb->cb.q_template == NULL) 
-		    status = ss_InternalError; //it was a required parameter!
-		  
-		  if(status)
-		    {
-		      whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
-					    "SubscriptionData not found or callback not set.\n");
-		    }
-		  else if(sb->type == QueryTypeTemplate)
-		    { //noted *25.3.2010 - status must be 0, due to check above, - this block works, but was intended to take also non-zero status
-		      GSList **triples = (GSList **)g_new0(GSList *,1); // allocate space for pointer and make it an empty list
-
-		      if(status)
-			whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
-					      "error passed before parse to generate triple list from results\n");
-		      if(!status && /*and NOW changes*/
-			 (status = parseM3_triples (triples, results, sb->prefix_ns_map)))
-			whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
-					      "error, when trying to generating triples from results\n");
-		      
-		      whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
-					    "Calling Query template callback\n");
-		      sb->cb.q_template(status, triples, sb->user_data);
-		    }
-		  else if (sb->type == QueryTypeSPARQLSelect)
-		    { //noted *25.3.2010
-		      GSList **selectedVariables  = (GSList **)g_new0(GSList *,1); // allocate space for pointer and make it an empty list
-		      GSList **valRows = (GSList **)g_new0(GSList *,1); // allocate space for pointer and make it an empty list
-
-		      if(status)
-			whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
-					      "error passed before parse to generate node list from results\n");
-		      if(!status && /*and NOW changes*/
-			 (status = parseM3_query_results_sparql_select (selectedVariables, valRows, results, sb->prefix_ns_map)))
-			whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
-					      "Parse error, when trying to generating nodelist from results\n");
-		      
-		      whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
-					    "Calling query WQL callback for\n");
-		      sb->cb.q_sparql_select(status, selectedVariables, valRows, sb->user_data);
-		      
-		    }
-		  else if ((sb->type == QueryTypeWQLValues) ||
-			   (sb->type == QueryTypeWQLNodeTypes) )
-		    { //noted *25.3.2010
-		      GSList **nodelist = (GSList **)g_new0(GSList *,1); // allocate space for pointer and make it an empty list
-
-		      if(status)
-			whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
-					      "error passed before parse to generate node list from results\n");
-		      if(!status && /*and NOW changes*/
-			 (status = parseM3_query_cnf_wql (nodelist, results)))
-			whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
-					      "Parse error, when trying to generating nodelist from results\n");
-		      
-		      whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
-					    "Calling query WQL callback for\n");
-		      sb->cb.q_wql_values(status, nodelist, sb->user_data);
-		      
-		    }
-		  else if(sb->type == QueryTypeWQLRelated ||
-			  sb->type == QueryTypeWQLIsType ||
-			  sb->type == QueryTypeWQLIsSubType)
-		    { //noted *25.3.2010
-		      gboolean resultVal=TRUE+FALSE+2; //hehe.. that will kill the unassigned-warning
-		      if(status)
-			whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
-					      "error passed before parse to generate node list from results\n");
-		      
-		      if (!status)
-			{
-			  if (0==strcmp(SIB_TRUE.txt, results))
-			    resultVal = TRUE;
-			  else if (0==strcmp(SIB_FALSE.txt, results))
-			    resultVal = FALSE;
-			  else
-			    status = ss_ParsingError; // I.E. we dont know and thus can't assign the result value
-			}
-		      whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
-					    "Calling query WQL callback for\n");
-		      sb->cb.q_wql_boolean(status, resultVal, sb->user_data);
-		    }
-		  else
-		    {
-		      whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
-					    "Invalid query type\n");
-		    }
-		  // remove subscription id struct...
-		  whiteboard_node_remove_subscription_data(self, access_id);
-		  whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
-					"SubscriptionData removed\n");
-		}  
-	      else
+				"Calling query WQL callback for\n");
+	  sb->cb.q_wql_boolean(status, resultVal, sb->user_data);
+	}
+      else
+	{
+	  whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
+				"Invalid query type in subcriptionData\n");
+	}
+      if (sb)
+	whiteboard_node_subscription_data_unref(sb);
+    }
+  else
+    {
+      whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
+			    "Could not get subscribe response parameters\n");
+    }
+
+  return DBUS_HANDLER_RESULT_HANDLED;
+}
+
+static DBusHandlerResult whiteboard_node_query_return(DBusConnection *conn,
+						      DBusMessage *msg,
+						      gpointer data)
+{
+  WhiteBoardNode *self = (WhiteBoardNode *) data;
+  gint access_id = -1;
+  ssStatus_t status;
+  gchar *results = NULL;
+  gint64 parse_started;
+  whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
+			"Got QUERY method return.\n");
+
+  if(whiteboard_util_parse_message(msg,
+				   DBUS_TYPE_INT32, &access_id,
+				   DBUS_TYPE_INT32, &status,
+				   DBUS_TYPE_STRING, &results,
+				   WHITEBOARD_UTIL_LIST_END))
+    {
+      status = ( (status == ss_StatusOK) && (access_id > 0) && (NULL != results) )? ss_StatusOK : ss_InternalError;
+      if (results)
+	whiteboard_node_stats_bytes(self, 0, strlen(results));
+#if 0 //testing sparql results
+      results = sampleSparqlresults;
+      status = ss_StatusOK;
+#endif
+      if (status == ss_StatusOK)
+	{
+	  SubscriptionData  *sb = NULL;
+	  sb = whiteboard_node_get_subscription_data(self, access_id);
+	  //the call back should be made with or without triples at the first detectable failure
+	  if (sb == NULL)
+	    status = ss_NotEnoughResources;
+	  else if (sb->cb.q_template == NULL)
+	    status = ss_InternalError; //it was a required parameter!
+
+	  if(status)
+	    {
+	      whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
+				    "SubscriptionData not found or callback not set.\n");
+	    }
+	  else if(sb->type == QueryTypeTemplate)
+	    { //noted *25.3.2010 - status must be 0, due to check above, - this block works, but was intended to take also non-zero status
+	      GSList **triples = (GSList **)g_new0(GSList *,1); // allocate space for pointer and make it an empty list
+
+	      if(status)
+		whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
+				      "error passed before parse to generate triple list from results\n");
+	      whiteboard_trace(WHITEBOARD_TRACE_PARSE_START, -1, access_id, strlen(results));
+	      parse_started = whiteboard_node_stats_now();
+	      if(!status && /*and NOW changes*/
+		 (status = parseM3_triples_trie (triples, results, NS_MAP_TRIE(sb->ns_map))))
+		whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
+				      "error, when trying to generating triples from results\n");
+	      whiteboard_trace(WHITEBOARD_TRACE_PARSE_END, -1, access_id, 0);
+	      whiteboard_node_stats_add(self, &self->stats->parse, parse_started, status);
+
+	      whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
+				    "Calling Query template callback\n");
+	      sb->cb.q_template(status, triples, sb->user_data);
+	    }
+	  else if (sb->type == QueryTypeSPARQLSelect)
+	    { //noted *25.3.2010
+	      GSList **selectedVariables  = (GSList **)g_new0(GSList *,1); // allocate space for pointer and make it an empty list
+	      GSList **valRows = (GSList **)g_new0(GSList *,1); // allocate space for pointer and make it an empty list
+
+	      if(status)
+		whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
+				      "error passed before parse to generate node list from results\n");
+	      whiteboard_trace(WHITEBOARD_TRACE_PARSE_START, -1, access_id, strlen(results));
+	      parse_started = whiteboard_node_stats_now();
+	      if(!status && /*and NOW changes*/
+		 (status = parseM3_query_results_sparql_select_trie (selectedVariables, valRows, results, NS_MAP_TRIE(sb->ns_map))))
+		whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
+				      "Parse error, when trying to generating nodelist from results\n");
+	      whiteboard_trace(WHITEBOARD_TRACE_PARSE_END, -1, access_id, 0);
+	      whiteboard_node_stats_add(self, &self->stats->parse, parse_started, status);
+
+	      whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
+				    "Calling query WQL callback for\n");
+	      sb->cb.q_sparql_select(status, selectedVariables, valRows, sb->user_data);
+
+	    }
+	  else if ((sb->type == QueryTypeWQLValues) ||
+		   (sb->type == QueryTypeWQLNodeTypes) )
+	    { //noted *25.3.2010
+	      GSList **nodelist = (GSList **)g_new0(GSList *,1); // allocate space for pointer and make it an empty list
+
+	      if(status)
+		whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
+				      "error passed before parse to generate node list from results\n");
+	      whiteboard_trace(WHITEBOARD_TRACE_PARSE_START, -1, access_id, strlen(results));
+	      parse_started = whiteboard_node_stats_now();
+	      if(!status && /*and NOW changes*/
+		 (status = parseM3_query_cnf_wql (nodelist, results)))
+		whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
+				      "Parse error, when trying to generating nodelist from results\n");
+	      whiteboard_trace(WHITEBOARD_TRACE_PARSE_END, -1, access_id, 0);
+	      whiteboard_node_stats_add(self, &self->stats->parse, parse_started, status);
+
+	      whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
+				    "Calling query WQL callback for\n");
+	      sb->cb.q_wql_values(status, nodelist, sb->user_data);
+
+	    }
+	  else if(sb->type == QueryTypeWQLRelated ||
+		  sb->type == QueryTypeWQLIsType ||
+		  sb->type == QueryTypeWQLIsSubType)
+	    { //noted *25.3.2010
+	      gboolean resultVal=TRUE+FALSE+2; //hehe.. that will kill the unassigned-warning
+	      if(status)
+		whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
+				      "error passed before parse to generate node list from results\n");
+
+	      if (!status)
 		{
-		  whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
-					"Error with query, access_id: %d,status %d\n", access_id, status); 
-		  if(access_id > 0)
-		    {
-		      SubscriptionData  *sb = NULL;
-		      sb = whiteboard_node_get_subscription_data(self, access_id);
-		      //the call back should be made with or without triples at the first detectable failure
-		      if (sb  && sb->cb.q_template )
-			{
-			  switch(sb->type)
-			    {
-			    case QueryTypeWQLRelated:
-			    case QueryTypeWQLIsType:
-			    case QueryTypeWQLIsSubType:
-			      sb->cb.q_wql_boolean(status, FALSE, sb->user_data);
-			      break;
-			    case QueryTypeTemplate:
-			      sb->cb.q_template(status, NULL, sb->user_data);
-			      break;
-			    case QueryTypeWQLValues:
-			    case QueryTypeWQLNodeTypes:
-			      sb->cb.q_wql_values( status, NULL, sb->user_data);
-			      break;
-			    default:
-			      break;
-			    }
-			}
-		      else
-			{
-			  whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
-						"SubscriptionData not found or callback not set.\n");
-			}
-		    }
+		  if (0==strcmp(SIB_TRUE.txt, results))
+		    resultVal = TRUE;
+		  else if (0==strcmp(SIB_FALSE.txt, results))
+		    resultVal = FALSE;
+		  else
+		    status = ss_ParsingError; // I.E. we dont know and thus can't assign the result value
 		}
+	      whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
+				    "Calling query WQL callback for\n");
+	      sb->cb.q_wql_boolean(status, resultVal, sb->user_data);
 	    }
 	  else
 	    {
 	      whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
-				    "Could not get query response parameters\n"); 		  
+				    "Invalid query type\n");
 	    }
+	  if (sb && sb->started)
+	    whiteboard_node_stats_op(self, whiteboard_node_stat_kind_for_query(sb->type), sb->started, status);
+	  // remove subscription id struct...
+	  whiteboard_node_remove_subscription_data(self, access_id);
+	  whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
+				"SubscriptionData removed\n");
+	  if (sb)
+	    whiteboard_node_subscription_data_unref(sb);
 	}
       else
 	{
-	  whiteboard_log_warning("Unknown signal type: %d\n", type);
+	  whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
+				"Error with query, access_id: %d,status %d\n", access_id, status);
+	  if(access_id > 0)
+	    {
+	      SubscriptionData  *sb = NULL;
+	      sb = whiteboard_node_get_subscription_data(self, access_id);
+	      //the call back should be made with or without triples at the first detectable failure
+	      if (sb  && sb->cb.q_template )
+		{
+		  if (sb->started)
+		    whiteboard_node_stats_op(self, whiteboard_node_stat_kind_for_query(sb->type), sb->started, status);
+		  switch(sb->type)
+		    {
+		    case QueryTypeWQLRelated:
+		    case QueryTypeWQLIsType:
+		    case QueryTypeWQLIsSubType:
+		      sb->cb.q_wql_boolean(status, FALSE, sb->user_data);
+		      break;
+		    case QueryTypeTemplate:
+		      sb->cb.q_template(status, NULL, sb->user_data);
+		      break;
+		    case QueryTypeWQLValues:
+		    case QueryTypeWQLNodeTypes:
+		      sb->cb.q_wql_values( status, NULL, sb->user_data);
+		      break;
+		    default:
+		      break;
+		    }
+		}
+	      else
+		{
+		  whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
+					"SubscriptionData not found or callback not set.\n");
+		}
+	      if (sb)
+		whiteboard_node_subscription_data_unref(sb);
+	    }
 	}
-      break;
-    default:
-      
-      whiteboard_log_warning("Unknown message type: %d\n", type);
-      
-      break;
     }
+  else
+    {
+      whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
+			    "Could not get query response parameters\n");
+    }
+
   return DBUS_HANDLER_RESULT_HANDLED;
 }
 
@@ -912,133 +1133,374 @@ static gboolean whiteboard_node_joined(WhiteBoardNode *self)
   return ( (self->sib!= NULL) && self->joined);
 }
 
-static DBusHandlerResult whiteboard_node_control_handler(DBusConnection *conn,
-							 DBusMessage *msg,
-							 gpointer data)
+/* Copy of the sib joined to, or NULL if not joined. Taken under the lock
+   so that a concurrent leave can not free it while a request is sent;
+   release with g_free() */
+static gchar *whiteboard_node_dup_sib(WhiteBoardNode *self)
 {
-  WhiteBoardNode *self = (WhiteBoardNode *) data;
-  const gchar* member = NULL;
-  gint type = 0;
+  gchar *sib = NULL;
 
-  whiteboard_log_debug_fb();
+  g_return_val_if_fail(self != NULL , NULL);
+  g_mutex_lock(self->lock);
+  if (whiteboard_node_joined(self))
+    sib = g_strdup(self->sib);
+  g_mutex_unlock(self->lock);
+  return sib;
+}
 
-  member = dbus_message_get_member(msg);
-  type = dbus_message_get_type(msg);
+/* Takes a message buffer from the pool of the node, or allocates a new one
+   if the pool is empty. The buffer has room for at least capacity bytes. */
+static ssBufDesc_t *whiteboard_node_bufdesc_get(WhiteBoardNode *self, guint capacity)
+{
+  ssBufDesc_t *bd = NULL;
 
-  switch (type)
+  g_mutex_lock(self->bufdesc_lock);
+  if (self->bufdesc_pool)
     {
-    case DBUS_MESSAGE_TYPE_METHOD_RETURN:
+      bd = (ssBufDesc_t *)self->bufdesc_pool->data;
+      self->bufdesc_pool = g_slist_delete_link(self->bufdesc_pool, self->bufdesc_pool);
+      self->bufdesc_pool_bytes -= bd->bufLen;
+    }
+  g_mutex_unlock(self->bufdesc_lock);
 
-      if (!strcmp(member, WHITEBOARD_DBUS_METHOD_CUSTOM_COMMAND))
-	{
-	  whiteboard_node_custom_command_response(self, msg);
-	}
-      else
-	{
-	  whiteboard_log_warning("Unknown method return: %s\n",
-				 member);
-	}
+  if (!bd)
+    return ssBufDesc_new_sized(capacity);
 
-      break;
+  if (ssBufDesc_reserve(bd, capacity) != ss_StatusOK)
+    ssBufDesc_free(&bd);
+  return bd;
+}
 
-    case DBUS_MESSAGE_TYPE_METHOD_CALL:
+/* Returns a message buffer to the pool of the node keeping its capacity,
+   or frees it if the pool would grow over BUFDESC_POOL_MAX_BYTES */
+static void whiteboard_node_bufdesc_put(WhiteBoardNode *self, ssBufDesc_t **bd)
+{
+  if (!*bd)
+    return;
 
-      if (!strcmp(member, WHITEBOARD_DBUS_METHOD_CUSTOM_COMMAND))
-	{
-	  // whiteboard_node_custom_command_request(self, msg);
-	}
-      else
-	{
-	  whiteboard_log_warning("Unknown method call: %s\n",
-				 member);
-	}
+  ssBufDesc_reset(*bd);
+  g_mutex_lock(self->bufdesc_lock);
+  if (self->bufdesc_pool_bytes + (*bd)->bufLen <= BUFDESC_POOL_MAX_BYTES)
+    {
+      self->bufdesc_pool = g_slist_prepend(self->bufdesc_pool, *bd);
+      self->bufdesc_pool_bytes += (*bd)->bufLen;
+      *bd = NULL;
+    }
+  g_mutex_unlock(self->bufdesc_lock);
 
-      break;
+  if (*bd)
+    ssBufDesc_free(bd);
+}
 
-    case DBUS_MESSAGE_TYPE_SIGNAL:
+/* Empties the namespace map cache; g_hash_table_remove_all() needs GLib 2.12 */
+static gboolean whiteboard_node_ns_map_expire(gpointer key, gpointer value, gpointer data)
+{
+  return TRUE;
+}
 
-      whiteboard_log_warning("Unknown signal: %s\n", member);
+static void whiteboard_node_ns_map_unref(NsMapData *ns_map)
+{
+  if (!g_atomic_int_dec_and_test(&ns_map->refcount))
+    return;
 
-      break;
+  ssNsTrie_free(ns_map->trie);
+  g_hash_table_unref(ns_map->prefix2ns);
+  g_free(ns_map);
+}
 
-    default:
+/* Assigns *ns_map with a reference to the prefix to namespace map parsed
+   from ns and its trie. Maps are cached per namespace string and never
+   modified after they have been built, so they can be shared between
+   threads and requests, and the trie is built only once per map.
+   The reference must be released with whiteboard_node_ns_map_unref(). */
+static ssStatus_t whiteboard_node_get_ns_map(WhiteBoardNode *self, const gchar *ns, NsMapData **ns_map)
+{
+  ssStatus_t status;
+  GHashTable *prefix2ns = NULL;
+  NsMapData *cached;
 
-      whiteboard_log_warning("Unknown message type: %d\n", type);
+  g_return_val_if_fail (ns!=NULL && *ns_map==NULL, ss_InvalidParameter);
 
-      break;
+  g_mutex_lock(self->ns_map_lock);
+  cached = (NsMapData *)g_hash_table_lookup(self->ns_map_cache, ns);
+  if (cached)
+    {
+      g_atomic_int_inc(&cached->refcount);
+      *ns_map = cached;
     }
+  g_mutex_unlock(self->ns_map_lock);
+  if (*ns_map)
+    return ss_StatusOK;
 
-  whiteboard_log_debug_fe();
+  status = new_prefix2ns_map(ns, &prefix2ns);
+  if (status != ss_StatusOK)
+    return status;
 
-  return DBUS_HANDLER_RESULT_HANDLED;
+  cached = g_new0(NsMapData, 1);
+  cached->refcount = 2; // the cache and the caller
+  cached->prefix2ns = prefix2ns;
+  cached->trie = ssNsTrie_new(prefix2ns);
+
+  g_mutex_lock(self->ns_map_lock);
+  /* Maps still referenced by pending requests survive the flush */
+  if (g_hash_table_size(self->ns_map_cache) >= NS_MAP_CACHE_MAX)
+    g_hash_table_foreach_remove(self->ns_map_cache, whiteboard_node_ns_map_expire, NULL);
+  g_hash_table_replace(self->ns_map_cache, g_strdup(ns), cached);
+  g_mutex_unlock(self->ns_map_lock);
+
+  *ns_map = cached;
+  return ss_StatusOK;
 }
 
-static DBusHandlerResult whiteboard_node_log_handler(DBusConnection *conn,
-						     DBusMessage *msg,
-						     gpointer data)
+/* Assigns *map with a reference to the cached prefix to namespace map of
+   ns, for requests that do not parse results. The reference must be
+   released with g_hash_table_unref(). */
+static ssStatus_t whiteboard_node_get_prefix2ns_map(WhiteBoardNode *self, const gchar *ns, GHashTable **map)
 {
-  WhiteBoardNode *self = (WhiteBoardNode *) data;
-  const gchar* member = NULL;
-  gint type = 0;
+  ssStatus_t status;
+  NsMapData *ns_map = NULL;
 
-  whiteboard_log_debug_fb();
+  g_return_val_if_fail (ns!=NULL && *map==NULL, ss_InvalidParameter);
 
-  member = dbus_message_get_member(msg);
-  type = dbus_message_get_type(msg);
+  status = whiteboard_node_get_ns_map(self, ns, &ns_map);
+  if (status != ss_StatusOK)
+    return status;
 
-  switch (type)
-    {
-    case DBUS_MESSAGE_TYPE_METHOD_RETURN:
+  *map = g_hash_table_ref(ns_map->prefix2ns);
+  whiteboard_node_ns_map_unref(ns_map);
+  return ss_StatusOK;
+}
 
-      whiteboard_log_warning("Unknown method return: %s\n", member);
+/* Message numbers are allocated without holding any lock, so that requests
+   of several threads can be generated and sent concurrently */
+static gint whiteboard_node_next_msgnumber(WhiteBoardNode *self)
+{
+  return g_atomic_int_exchange_and_add(&self->msgnumber, 1) + 1;
+}
 
-      break;
+static gint64 whiteboard_node_stats_now(void)
+{
+  struct timespec ts;
 
-    case DBUS_MESSAGE_TYPE_METHOD_CALL:
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (gint64)ts.tv_sec * G_USEC_PER_SEC + ts.tv_nsec / 1000;
+}
 
-      whiteboard_log_warning("Unknown method call: %s\n", member);
+/* Values below 8 have a bucket each, above that every power of two is
+   split in 8 buckets by the bits following the most significant one */
+static guint whiteboard_node_histogram_index(guint64 us)
+{
+  guint shift;
+
+  if (us > G_MAXUINT32)
+    us = G_MAXUINT32;
+  if (us < (1 << WHITEBOARD_NODE_HISTOGRAM_SUB_BITS))
+    return (guint)us;
+  shift = g_bit_storage((gulong)us) - 1 - WHITEBOARD_NODE_HISTOGRAM_SUB_BITS;
+  return ((shift + 1) << WHITEBOARD_NODE_HISTOGRAM_SUB_BITS) +
+    (guint)((us >> shift) & ((1 << WHITEBOARD_NODE_HISTOGRAM_SUB_BITS) - 1));
+}
 
-      break;
+static guint64 whiteboard_node_histogram_value(guint index)
+{
+  guint shift;
 
-    case DBUS_MESSAGE_TYPE_SIGNAL:
+  if (index < (1 << WHITEBOARD_NODE_HISTOGRAM_SUB_BITS))
+    return index;
+  shift = (index >> WHITEBOARD_NODE_HISTOGRAM_SUB_BITS) - 1;
+  return (guint64)((1 << WHITEBOARD_NODE_HISTOGRAM_SUB_BITS) +
+		   (index & ((1 << WHITEBOARD_NODE_HISTOGRAM_SUB_BITS) - 1))) << shift;
+}
 
-      if (!strcmp(member, WHITEBOARD_DBUS_LOG_SIGNAL_MESSAGE))
-	{
-	  gint level = 0;
-	  gint id = 0;
-	  gchar *message = NULL;
+static void whiteboard_node_stats_add(WhiteBoardNode *self,
+				      WhiteBoardNodeHistogram *h,
+				      gint64 started,
+				      ssStatus_t status)
+{
+  gint64 elapsed = whiteboard_node_stats_now() - started;
+  guint64 us = (elapsed > 0) ? (guint64)elapsed : 0;
+
+  g_mutex_lock(self->stats_lock);
+  h->count++;
+  if (status != ss_StatusOK)
+    h->errors++;
+  h->total_us += us;
+  if (us > h->max_us)
+    h->max_us = us;
+  h->buckets[whiteboard_node_histogram_index(us)]++;
+  g_mutex_unlock(self->stats_lock);
+}
 
-	  whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
-				"Got log message signal.\n");
-
-	  whiteboard_util_parse_message(msg,
-					DBUS_TYPE_INT32, &level,
-					DBUS_TYPE_INT32, &id,
-					DBUS_TYPE_STRING, &message,
-					DBUS_TYPE_INVALID);
-
-	  g_signal_emit(self,
-			whiteboard_node_signals[SIGNAL_LOG_MESSAGE],
-			0,
-			level,
-			id,
-			message);
-	}
-      else
-	{
-	  whiteboard_log_warning("Unknown signal: %s\n", member);
-	}
+static void whiteboard_node_stats_op(WhiteBoardNode *self,
+				     gint kind,
+				     gint64 started,
+				     ssStatus_t status)
+{
+  if (kind < 0 || kind >= WHITEBOARD_NODE_STAT_LAST || started == 0)
+    return;
+  whiteboard_node_stats_add(self, &self->stats->ops[kind], started, status);
+}
 
-      break;
+static void whiteboard_node_stats_bytes(WhiteBoardNode *self, gsize out, gsize in)
+{
+  g_mutex_lock(self->stats_lock);
+  self->stats->bytes_out += out;
+  self->stats->bytes_in += in;
+  g_mutex_unlock(self->stats_lock);
+}
 
-    default:
+static gint whiteboard_node_stat_kind_for_method(const gchar *method)
+{
+  if (!strcmp(method, WHITEBOARD_DBUS_NODE_METHOD_INSERT))
+    return WHITEBOARD_NODE_STAT_INSERT;
+  else if (!strcmp(method, WHITEBOARD_DBUS_NODE_METHOD_UPDATE))
+    return WHITEBOARD_NODE_STAT_UPDATE;
+  else if (!strcmp(method, WHITEBOARD_DBUS_NODE_METHOD_REMOVE))
+    return WHITEBOARD_NODE_STAT_REMOVE;
+  return -1;
+}
+
+static gint whiteboard_node_stat_kind_for_query(QueryType type)
+{
+  if (type < QueryTypeTemplate || type > QueryTypeSPARQLSelect)
+    return -1;
+  return WHITEBOARD_NODE_STAT_QUERY_TEMPLATE + (type - QueryTypeTemplate);
+}
 
-      whiteboard_log_warning("Unknown message type: %d\n", type);
+static void whiteboard_node_stats_append(DBusMessageIter *array,
+					 const gchar *name,
+					 const WhiteBoardNodeHistogram *h)
+{
+  DBusMessageIter entry;
+  dbus_uint64_t count = h->count;
+  dbus_uint64_t errors = h->errors;
+  dbus_uint64_t mean = (h->count) ? h->total_us / h->count : 0;
+  dbus_uint64_t p50 = whiteboard_node_histogram_percentile(h, 50.0);
+  dbus_uint64_t p99 = whiteboard_node_histogram_percentile(h, 99.0);
+  dbus_uint64_t max = h->max_us;
+
+  dbus_message_iter_open_container(array, DBUS_TYPE_STRUCT, NULL, &entry);
+  dbus_message_iter_append_basic(&entry, DBUS_TYPE_STRING, &name);
+  dbus_message_iter_append_basic(&entry, DBUS_TYPE_UINT64, &count);
+  dbus_message_iter_append_basic(&entry, DBUS_TYPE_UINT64, &errors);
+  dbus_message_iter_append_basic(&entry, DBUS_TYPE_UINT64, &mean);
+  dbus_message_iter_append_basic(&entry, DBUS_TYPE_UINT64, &p50);
+  dbus_message_iter_append_basic(&entry, DBUS_TYPE_UINT64, &p99);
+  dbus_message_iter_append_basic(&entry, DBUS_TYPE_UINT64, &max);
+  dbus_message_iter_close_container(array, &entry);
+}
 
-      break;
+static DBusHandlerResult whiteboard_node_control_get_stats(DBusConnection *conn,
+							   DBusMessage *msg,
+							   gpointer data)
+{
+  WhiteBoardNode *self = (WhiteBoardNode *) data;
+  DBusMessage *reply = NULL;
+  DBusMessageIter iter;
+  DBusMessageIter array;
+  WhiteBoardNodeStats stats;
+  dbus_uint64_t bytes_out;
+  dbus_uint64_t bytes_in;
+  gint kind;
+
+  whiteboard_log_debug_fb();
+
+  if (!self->stats_export)
+    {
+      reply = dbus_message_new_error(msg, DBUS_ERROR_NOT_SUPPORTED,
+				     "Statistics export disabled");
+    }
+  else
+    {
+      whiteboard_node_get_stats(self, &stats);
+      reply = dbus_message_new_method_return(msg);
+      if (reply)
+	{
+	  /* Routed back by the daemon like any control method return */
+	  dbus_message_set_path(reply, dbus_message_get_path(msg));
+	  dbus_message_set_interface(reply, dbus_message_get_interface(msg));
+	  dbus_message_set_member(reply, dbus_message_get_member(msg));
+
+	  dbus_message_iter_init_append(reply, &iter);
+	  dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY,
+					   DBUS_STRUCT_BEGIN_CHAR_AS_STRING
+					   DBUS_TYPE_STRING_AS_STRING
+					   DBUS_TYPE_UINT64_AS_STRING
+					   DBUS_TYPE_UINT64_AS_STRING
+					   DBUS_TYPE_UINT64_AS_STRING
+					   DBUS_TYPE_UINT64_AS_STRING
+					   DBUS_TYPE_UINT64_AS_STRING
+					   DBUS_TYPE_UINT64_AS_STRING
+					   DBUS_STRUCT_END_CHAR_AS_STRING,
+					   &array);
+	  for (kind = 0; kind < WHITEBOARD_NODE_STAT_LAST; kind++)
+	    {
+	      if (stats.ops[kind].count > 0)
+		whiteboard_node_stats_append(&array, whiteboard_node_stat_name(kind), &stats.ops[kind]);
+	    }
+	  if (stats.parse.count > 0)
+	    whiteboard_node_stats_append(&array, "parse", &stats.parse);
+	  if (stats.xml_build.count > 0)
+	    whiteboard_node_stats_append(&array, "xml_build", &stats.xml_build);
+	  dbus_message_iter_close_container(&iter, &array);
+
+	  bytes_out = stats.bytes_out;
+	  bytes_in = stats.bytes_in;
+	  dbus_message_iter_append_basic(&iter, DBUS_TYPE_UINT64, &bytes_out);
+	  dbus_message_iter_append_basic(&iter, DBUS_TYPE_UINT64, &bytes_in);
+	}
+    }
+
+  if (reply)
+    {
+      dbus_connection_send(conn, reply, NULL);
+      whiteboard_util_flush(conn);
+      dbus_message_unref(reply);
+    }
+  else
+    {
+      whiteboard_log_error("Out of memory!\n");
     }
 
   whiteboard_log_debug_fe();
+  return DBUS_HANDLER_RESULT_HANDLED;
+}
+
+static DBusHandlerResult whiteboard_node_custom_command_return(DBusConnection *conn,
+							       DBusMessage *msg,
+							       gpointer data)
+{
+  WhiteBoardNode *self = (WhiteBoardNode *) data;
+
+  whiteboard_node_custom_command_response(self, msg);
+
+  return DBUS_HANDLER_RESULT_HANDLED;
+}
+
+static DBusHandlerResult whiteboard_node_log_message(DBusConnection *conn,
+						     DBusMessage *msg,
+						     gpointer data)
+{
+  WhiteBoardNode *self = (WhiteBoardNode *) data;
+  gint level = 0;
+  gint id = 0;
+  gchar *message = NULL;
+
+  whiteboard_log_debugc(WHITEBOARD_DEBUG_NODE,
+			"Got log message signal.\n");
+
+  whiteboard_util_parse_message(msg,
+				DBUS_TYPE_INT32, &level,
+				DBUS_TYPE_INT32, &id,
+				DBUS_TYPE_STRING, &message,
+				DBUS_TYPE_INVALID);
+
+  g_signal_emit(self,
+		whiteboard_node_signals[SIGNAL_LOG_MESSAGE],
+		0,
+		level,
+		id,
+		message);
 
   return DBUS_HANDLER_RESULT_HANDLED;
 }
@@ -1047,38 +1509,25 @@ static DBusHandlerResult whiteboard_node_dispatch_message(DBusConnection *conn,
 							  DBusMessage *msg,
 							  gpointer data)
 {
-  const gchar* interface = NULL;
+  DBusObjectPathMessageFunction handler = NULL;
 
   whiteboard_log_debug_fb();
 
   whiteboard_log_debug("%s %s %d\n", dbus_message_get_interface(msg), dbus_message_get_member(msg), dbus_message_get_type(msg));
 
-  interface = dbus_message_get_interface(msg);
-  if(interface)
+  handler = whiteboard_util_dispatch_table_lookup(whiteboard_node_dispatch_table, msg);
+  if (handler)
     {
-      if (!strcmp(interface, WHITEBOARD_DBUS_NODE_INTERFACE))
-	{
-	  whiteboard_log_debug("Got sib_access message\n");
-	  whiteboard_node_sib_access_handler(conn, msg, data);
-	}
-      else if(!strcmp(interface, WHITEBOARD_DBUS_CONTROL_INTERFACE))
-	{
-	  whiteboard_log_debug("Got control message\n");
-	  whiteboard_node_control_handler(conn, msg, data);
-	}
-      else if (!strcmp(interface, WHITEBOARD_DBUS_LOG_INTERFACE))
-	{
-	  whiteboard_log_debug("Got log message\n");
-	  whiteboard_node_log_handler(conn, msg, data);
-	}
-      else
-	{
-	  whiteboard_log_warning("Unknown interface: %s\n", interface);
-	}
+      whiteboard_trace(WHITEBOARD_TRACE_DISPATCH_START, -1, -1, 0);
+      handler(conn, msg, data);
+      whiteboard_trace(WHITEBOARD_TRACE_DISPATCH_END, -1, -1, 0);
     }
   else
     {
-      whiteboard_log_warning("Interface not set\n");
+      whiteboard_log_warning("Unknown message: type:%d, if:%s, mem:%s\n",
+			     dbus_message_get_type(msg),
+			     dbus_message_get_interface(msg),
+			     dbus_message_get_member(msg));
     }
   whiteboard_log_debug_fe();
 
@@ -1087,12 +1536,14 @@ static DBusHandlerResult whiteboard_node_dispatch_message(DBusConnection *conn,
 
 static gboolean invalidTriple (ssTriple_t *t, gboolean patternMatching)
 {
+  ssElementType_t subjType = ssElementType(t->subjType);
+
   if (patternMatching)
     return
          !t->subject
       || !t->predicate
       || !t->object
-      || !(t->subjType == ssElement_TYPE_URI)
+      || !(subjType    == ssElement_TYPE_URI)
       || !(t->objType  == ssElement_TYPE_URI || (t->object != ssMATCH_ANY && t->objType == ssElement_TYPE_LIT));
 
   else
@@ -1101,7 +1552,7 @@ static gboolean invalidTriple (ssTriple_t *t, gboolean patternMatching)
       || t->predicate == ssMATCH_ANY
       || t->object    == ssMATCH_ANY
       || t->predicate == NULL
-      || !(t->subjType == ssElement_TYPE_BNODE || (t->subject &&  t->subjType == ssElement_TYPE_URI))
+      || !(subjType    == ssElement_TYPE_BNODE || (t->subject &&  subjType    == ssElement_TYPE_URI))
       || !(t->objType  == ssElement_TYPE_BNODE || (t->object  && (t->objType  == ssElement_TYPE_URI ||
                                                                   t->objType  == ssElement_TYPE_LIT)));
 }
@@ -1169,6 +1620,15 @@ GObject *whiteboard_node_new(GMainContext *main_context)
   self->subscription_map = g_hash_table_new(g_direct_hash, g_direct_equal);
 
   self->lock = g_mutex_new();
+  self->subscription_lock = g_mutex_new();
+  self->bufdesc_lock = g_mutex_new();
+
+  self->ns_map_cache = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+					     (GDestroyNotify)whiteboard_node_ns_map_unref);
+  self->ns_map_lock = g_mutex_new();
+
+  self->stats = g_new0(WhiteBoardNodeStats, 1);
+  self->stats_lock = g_mutex_new();
   
   if (main_context != NULL)
     self->main_context = main_context;
@@ -1216,6 +1676,9 @@ static gboolean whiteboard_node_register(WhiteBoardNode* self)
       address = g_strdup("unix:path=/tmp/dbus-test");
     }
 
+  /* The connection is shared by all threads using the node */
+  dbus_threads_init_default();
+
   /* Open a connection to the address */
   connection = dbus_g_connection_open(address, &gerror);
   if (gerror != NULL)
@@ -1336,6 +1799,23 @@ static void whiteboard_node_finalize(GObject* object)
     }
 
   g_hash_table_destroy(self->subscription_map);
+
+  while (self->bufdesc_pool)
+    {
+      ssBufDesc_t *bd = (ssBufDesc_t *)self->bufdesc_pool->data;
+      self->bufdesc_pool = g_slist_delete_link(self->bufdesc_pool, self->bufdesc_pool);
+      ssBufDesc_free(&bd);
+    }
+  self->bufdesc_pool_bytes = 0;
+
+  g_hash_table_destroy(self->ns_map_cache);
+
+  g_mutex_free(self->stats_lock);
+  g_free(self->stats);
+  g_mutex_free(self->ns_map_lock);
+  g_mutex_free(self->bufdesc_lock);
+  g_mutex_free(self->subscription_lock);
+  g_mutex_free(self->lock);
   
   whiteboard_log_debug_fe();
 }
@@ -1354,6 +1834,78 @@ const gchar *whiteboard_node_get_uuid(WhiteBoardNode *self)
   return (const gchar*) self->uuid;
 }
 
+void whiteboard_node_get_stats(WhiteBoardNode *self, WhiteBoardNodeStats *stats)
+{
+  g_return_if_fail(self != NULL);
+  g_return_if_fail(stats != NULL);
+
+  g_mutex_lock(self->stats_lock);
+  memcpy(stats, self->stats, sizeof(WhiteBoardNodeStats));
+  g_mutex_unlock(self->stats_lock);
+}
+
+void whiteboard_node_reset_stats(WhiteBoardNode *self)
+{
+  g_return_if_fail(self != NULL);
+
+  g_mutex_lock(self->stats_lock);
+  memset(self->stats, 0, sizeof(WhiteBoardNodeStats));
+  g_mutex_unlock(self->stats_lock);
+}
+
+void whiteboard_node_set_stats_export(WhiteBoardNode *self, gboolean enable)
+{
+  g_return_if_fail(self != NULL);
+  self->stats_export = enable;
+}
+
+const gchar *whiteboard_node_stat_name(WhiteBoardNodeStatKind kind)
+{
+  static const gchar *names[WHITEBOARD_NODE_STAT_LAST] = {
+    "join",
+    "leave",
+    "insert",
+    "update",
+    "remove",
+    "subscribe",
+    "query_template",
+    "query_wql_values",
+    "query_wql_nodetypes",
+    "query_wql_related",
+    "query_wql_istype",
+    "query_wql_issubtype",
+    "query_sparql_select",
+    "indication"
+  };
+
+  if (kind < 0 || kind >= WHITEBOARD_NODE_STAT_LAST)
+    return NULL;
+  return names[kind];
+}
+
+guint64 whiteboard_node_histogram_percentile(const WhiteBoardNodeHistogram *h,
+					     gdouble percentile)
+{
+  guint64 rank;
+  guint64 seen = 0;
+  guint i;
+
+  g_return_val_if_fail(h != NULL, 0);
+  if (h->count == 0)
+    return 0;
+
+  rank = (guint64)((h->count * CLAMP(percentile, 0.0, 100.0) + 99.0) / 100.0);
+  if (rank == 0)
+    rank = 1;
+  for (i = 0; i < WHITEBOARD_NODE_HISTOGRAM_BUCKETS; i++)
+    {
+      seen += h->buckets[i];
+      if (seen >= rank)
+	return whiteboard_node_histogram_value(i);
+    }
+  return h->max_us;
+}
+
 gint whiteboard_node_sib_access_join(WhiteBoardNode *self,
 				     ssElement_ct udn)
 {
@@ -1365,7 +1917,7 @@ gint whiteboard_node_sib_access_join(WhiteBoardNode *self,
   
   g_mutex_lock(self->lock);
 
-  gint msgnum = ++(self->msgnumber);
+  gint msgnum = whiteboard_node_next_msgnumber(self);
   const gchar *nodeid = whiteboard_node_get_uuid(self);
   if( self->sib )
     {
@@ -1374,7 +1926,9 @@ gint whiteboard_node_sib_access_join(WhiteBoardNode *self,
   else
     {
       whiteboard_log_debug("Node (%s) joining SS: %s\n",nodeid, udn);
+      self->join_started = whiteboard_node_stats_now();
       
+      whiteboard_trace(WHITEBOARD_TRACE_DBUS_SEND, msgnum, -1, 0);
       whiteboard_util_send_method_with_reply(WHITEBOARD_DBUS_SERVICE,
 					     WHITEBOARD_DBUS_OBJECT,
 					     WHITEBOARD_DBUS_NODE_INTERFACE,
@@ -1385,6 +1939,7 @@ gint whiteboard_node_sib_access_join(WhiteBoardNode *self,
 					     DBUS_TYPE_STRING, &udn,
 					     DBUS_TYPE_INT32, &msgnum,
 					     WHITEBOARD_UTIL_LIST_END);
+      whiteboard_trace(WHITEBOARD_TRACE_REPLY_RECEIVED, msgnum, -1, 0);
       if(reply)
 	{
 	  whiteboard_util_parse_message(reply,
@@ -1396,6 +1951,11 @@ gint whiteboard_node_sib_access_join(WhiteBoardNode *self,
 	{
 	  self->sib = g_strdup((char *)udn); 
 	}
+      else
+	{
+	  // no join complete signal follows
+	  whiteboard_node_stats_op(self, WHITEBOARD_NODE_STAT_JOIN, self->join_started, ss_OperationFailed);
+	}
       whiteboard_log_debug("Join reply for sib: %s, accessid: %d\n", ((join_id > 0)? self->sib : (char *)udn), join_id);
     }
   g_mutex_unlock(self->lock);
@@ -1412,7 +1972,8 @@ gint whiteboard_node_sib_access_leave(WhiteBoardNode *self)
 
   g_return_val_if_fail(NULL != self, ss_InvalidParameter);
   g_mutex_lock(self->lock);
-  gint msgnum = ++(self->msgnumber);
+  gint msgnum = whiteboard_node_next_msgnumber(self);
+  gint64 started = whiteboard_node_stats_now();
   const gchar *nodeid = whiteboard_node_get_uuid(self);
 
   if( !whiteboard_node_joined(self))
@@ -1425,6 +1986,7 @@ gint whiteboard_node_sib_access_leave(WhiteBoardNode *self)
     {
       whiteboard_log_debug("Node (%s) leaving\n", nodeid);
       
+      whiteboard_trace(WHITEBOARD_TRACE_DBUS_SEND, msgnum, -1, 0);
       whiteboard_util_send_method_with_reply(WHITEBOARD_DBUS_SERVICE,
 					     WHITEBOARD_DBUS_OBJECT,
 					     WHITEBOARD_DBUS_NODE_INTERFACE,
@@ -1434,6 +1996,7 @@ gint whiteboard_node_sib_access_leave(WhiteBoardNode *self)
 					     DBUS_TYPE_STRING, &nodeid,
 					     DBUS_TYPE_INT32, &msgnum,
 					     WHITEBOARD_UTIL_LIST_END);
+      whiteboard_trace(WHITEBOARD_TRACE_REPLY_RECEIVED, msgnum, -1, 0);
       
       status = (reply)? ss_StatusOK : ss_InternalError;
       if(!status)
@@ -1447,6 +2010,7 @@ gint whiteboard_node_sib_access_leave(WhiteBoardNode *self)
       self->sib = NULL;
       self->joined = FALSE;
       whiteboard_log_debug("leave reply, success: %d\n", status);
+      whiteboard_node_stats_op(self, WHITEBOARD_NODE_STAT_LEAVE, started, status);
     }
   g_mutex_unlock(self->lock);
   whiteboard_log_debug_fe();
@@ -1478,9 +2042,10 @@ gint whiteboard_node_sib_access_insert_M3Triples(WhiteBoardNode *self,
 
   g_return_val_if_fail(self!=NULL, ss_InvalidParameter);
   g_return_val_if_fail(triples != NULL && triples->data!=NULL, ss_InvalidParameter);
-  g_mutex_lock(self->lock);
   const char *nodeid = whiteboard_node_get_uuid(self);
-  gint msgnum = ++(self->msgnumber);
+  gchar *sib = NULL;
+  gint msgnum = whiteboard_node_next_msgnumber(self);
+  gint64 started = whiteboard_node_stats_now();
   ssBufDesc_t *bd = NULL;
   GHashTable *prefix_ns_map=NULL;
 
@@ -1495,23 +2060,22 @@ gint whiteboard_node_sib_access_insert_M3Triples(WhiteBoardNode *self,
       ssStatus_t status;
 
       //initializing status//
-      status = (!namespace)? ss_StatusOK : new_prefix2ns_map(namespace, &prefix_ns_map);
+      status = (!namespace)? ss_StatusOK : whiteboard_node_get_prefix2ns_map(self, namespace, &prefix_ns_map);
       //g_return_val_if_fail (status==ss_StatusOK, status);
       if(status != ss_StatusOK)
 	{
-	  g_mutex_unlock(self->lock);
 	  return status;
 	}
 
-      bd = ssBufDesc_new();
+      bd = whiteboard_node_bufdesc_get(self, whiteboard_node_triplelist_size_hint(triples));
       if (!bd) {
-	if(prefix_ns_map) g_hash_table_destroy(prefix_ns_map);
+	if(prefix_ns_map) g_hash_table_unref(prefix_ns_map);
 	{
-	  g_mutex_unlock(self->lock);
 	  return ss_NotEnoughResources;
 	}
       }
 
+      whiteboard_trace(WHITEBOARD_TRACE_XML_BUILD_START, msgnum, -1, 0);
       status = addXML_start (bd, &SIB_TRIPLELIST, NULL, NULL, 0);
       
       while (status==ss_StatusOK && l && (t=(ssTriple_t *)l->data) && !invalidTriple(t,FALSE)) {
@@ -1528,22 +2092,30 @@ gint whiteboard_node_sib_access_insert_M3Triples(WhiteBoardNode *self,
 	addXML_end (bd, &SIB_TRIPLELIST);
       
 	insert_message = ssBufDesc_GetMessage(bd);
-
-	printf("Insert graph: %s\n", insert_message);
-
-
-	whiteboard_util_send_method_with_reply(WHITEBOARD_DBUS_SERVICE,
-					       WHITEBOARD_DBUS_OBJECT,
-					       WHITEBOARD_DBUS_NODE_INTERFACE,
-					       WHITEBOARD_DBUS_NODE_METHOD_INSERT,
-					       whiteboard_node_validate_connection(self),
-					       &reply,
-					       DBUS_TYPE_STRING, &nodeid,
-					       DBUS_TYPE_STRING, &self->sib,
-					       DBUS_TYPE_INT32, &msgnum,
-					       DBUS_TYPE_INT32, &encoding,
-					       DBUS_TYPE_STRING, &insert_message,
-					       WHITEBOARD_UTIL_LIST_END);
+	whiteboard_trace(WHITEBOARD_TRACE_XML_BUILD_END, msgnum, -1, ssBufDesc_GetMessageLen(bd));
+	whiteboard_node_stats_add(self, &self->stats->xml_build, started, ss_StatusOK);
+	whiteboard_node_stats_bytes(self, ssBufDesc_GetMessageLen(bd), 0);
+
+	whiteboard_log_debug("Insert graph: %s\n", insert_message);
+
+
+	whiteboard_trace(WHITEBOARD_TRACE_DBUS_SEND, msgnum, -1, ssBufDesc_GetMessageLen(bd));
+	sib = whiteboard_node_dup_sib(self);
+	if (sib)
+	  whiteboard_util_send_method_with_reply(WHITEBOARD_DBUS_SERVICE,
+						 WHITEBOARD_DBUS_OBJECT,
+						 WHITEBOARD_DBUS_NODE_INTERFACE,
+						 WHITEBOARD_DBUS_NODE_METHOD_INSERT,
+						 whiteboard_node_validate_connection(self),
+						 &reply,
+						 DBUS_TYPE_STRING, &nodeid,
+						 DBUS_TYPE_STRING, &sib,
+						 DBUS_TYPE_INT32, &msgnum,
+						 DBUS_TYPE_INT32, &encoding,
+						 DBUS_TYPE_STRING, &insert_message,
+						 WHITEBOARD_UTIL_LIST_END);
+	g_free(sib);
+	whiteboard_trace(WHITEBOARD_TRACE_REPLY_RECEIVED, msgnum, -1, 0);
 	if(reply)
 	  {
 	    whiteboard_util_parse_message(reply,
@@ -1575,10 +2147,10 @@ gint whiteboard_node_sib_access_insert_M3Triples(WhiteBoardNode *self,
 	  }
 	//ssBufDesc_free(&desc);
       }
-      ssBufDesc_free(&bd);
-      if(prefix_ns_map) g_hash_table_destroy(prefix_ns_map);
+      whiteboard_node_stats_op(self, WHITEBOARD_NODE_STAT_INSERT, started, success);
+      whiteboard_node_bufdesc_put(self, &bd);
+      if(prefix_ns_map) g_hash_table_unref(prefix_ns_map);
     }
-  g_mutex_unlock(self->lock);
   whiteboard_log_debug_fe();
   return success;
   
@@ -1602,9 +2174,10 @@ gint whiteboard_node_sib_access_update_M3Triples(WhiteBoardNode *self,
   g_return_val_if_fail(insert_triples != NULL || remove_triples!=NULL, ss_InvalidParameter);
   g_return_val_if_fail(insert_triples == NULL || insert_triples->data!=NULL, ss_InvalidParameter);
   g_return_val_if_fail(remove_triples == NULL || remove_triples->data!=NULL, ss_InvalidParameter);
-  g_mutex_lock(self->lock);  
   const gchar *nodeid = whiteboard_node_get_uuid(self);
-  gint msgnum = ++(self->msgnumber);
+  gchar *sib = NULL;
+  gint msgnum = whiteboard_node_next_msgnumber(self);
+  gint64 started = whiteboard_node_stats_now();
 
   ssBufDesc_t *bd_insert = NULL;
   ssBufDesc_t *bd_remove = NULL;
@@ -1620,25 +2193,24 @@ gint whiteboard_node_sib_access_update_M3Triples(WhiteBoardNode *self,
       ssTriple_t *t;
 
       //initializing status//
-      status = (!namespace)? ss_StatusOK : new_prefix2ns_map(namespace, &prefix_ns_map);
+      status = (!namespace)? ss_StatusOK : whiteboard_node_get_prefix2ns_map(self, namespace, &prefix_ns_map);
       if (status!=ss_StatusOK)
 	{
-	  g_mutex_unlock(self->lock);  
 	  return status;
 	}
 
-      bd_insert = ssBufDesc_new();
-      bd_remove = ssBufDesc_new();
+      bd_insert = whiteboard_node_bufdesc_get(self, 0);
+      bd_remove = whiteboard_node_bufdesc_get(self, 0);
       if (!bd_insert || !bd_remove) {
 	if (!bd_insert) //the first succeeded
-	  ssBufDesc_free(&bd_insert);
-	if (prefix_ns_map) g_hash_table_destroy(prefix_ns_map);
+	  whiteboard_node_bufdesc_put(self, &bd_insert);
+	if (prefix_ns_map) g_hash_table_unref(prefix_ns_map);
 	
-	  g_mutex_unlock(self->lock);
 	  return ss_NotEnoughResources;
 	  
       }
 
+      whiteboard_trace(WHITEBOARD_TRACE_XML_BUILD_START, msgnum, -1, 0);
       status = addXML_start (bd_insert, &SIB_TRIPLELIST, NULL, NULL, 0);
 
       l = insert_triples;
@@ -1665,19 +2237,32 @@ gint whiteboard_node_sib_access_update_M3Triples(WhiteBoardNode *self,
       removelist = ssBufDesc_GetMessage(bd_remove);
 
       if (!status)
-	whiteboard_util_send_method_with_reply(WHITEBOARD_DBUS_SERVICE,
-					       WHITEBOARD_DBUS_OBJECT,
-					       WHITEBOARD_DBUS_NODE_INTERFACE,
-					       WHITEBOARD_DBUS_NODE_METHOD_UPDATE,
-					       whiteboard_node_validate_connection(self),
-					       &reply,
-					       DBUS_TYPE_STRING, &nodeid,
-					       DBUS_TYPE_STRING, &self->sib,
-					       DBUS_TYPE_INT32, &msgnum,
-					       DBUS_TYPE_INT32, &encoding,
-					       DBUS_TYPE_STRING, &insertlist,
-					       DBUS_TYPE_STRING, &removelist,
-					       WHITEBOARD_UTIL_LIST_END);
+	{
+	  whiteboard_trace(WHITEBOARD_TRACE_XML_BUILD_END, msgnum, -1,
+			   ssBufDesc_GetMessageLen(bd_insert) + ssBufDesc_GetMessageLen(bd_remove));
+	  whiteboard_node_stats_add(self, &self->stats->xml_build, started, ss_StatusOK);
+	  whiteboard_node_stats_bytes(self,
+				      ssBufDesc_GetMessageLen(bd_insert) + ssBufDesc_GetMessageLen(bd_remove), 0);
+	  whiteboard_trace(WHITEBOARD_TRACE_DBUS_SEND, msgnum, -1,
+			   ssBufDesc_GetMessageLen(bd_insert) + ssBufDesc_GetMessageLen(bd_remove));
+	  sib = whiteboard_node_dup_sib(self);
+	  if (sib)
+	    whiteboard_util_send_method_with_reply(WHITEBOARD_DBUS_SERVICE,
+						   WHITEBOARD_DBUS_OBJECT,
+						   WHITEBOARD_DBUS_NODE_INTERFACE,
+						   WHITEBOARD_DBUS_NODE_METHOD_UPDATE,
+						   whiteboard_node_validate_connection(self),
+						   &reply,
+						   DBUS_TYPE_STRING, &nodeid,
+						   DBUS_TYPE_STRING, &sib,
+						   DBUS_TYPE_INT32, &msgnum,
+						   DBUS_TYPE_INT32, &encoding,
+						   DBUS_TYPE_STRING, &insertlist,
+						   DBUS_TYPE_STRING, &removelist,
+						   WHITEBOARD_UTIL_LIST_END);
+	  g_free(sib);
+	  whiteboard_trace(WHITEBOARD_TRACE_REPLY_RECEIVED, msgnum, -1, 0);
+	}
 
       if(!status && reply)
 	{
@@ -1712,11 +2297,11 @@ gint whiteboard_node_sib_access_update_M3Triples(WhiteBoardNode *self,
 	  status = (status)?status : ss_OperationFailed;
 	}
 
-      ssBufDesc_free(&bd_insert);
-      ssBufDesc_free(&bd_remove);
-      if(prefix_ns_map) g_hash_table_destroy(prefix_ns_map);
+      whiteboard_node_stats_op(self, WHITEBOARD_NODE_STAT_UPDATE, started, status);
+      whiteboard_node_bufdesc_put(self, &bd_insert);
+      whiteboard_node_bufdesc_put(self, &bd_remove);
+      if(prefix_ns_map) g_hash_table_unref(prefix_ns_map);
     }
-  g_mutex_unlock(self->lock);
   whiteboard_log_debug_fe();
   return status;
 }
@@ -1737,9 +2322,10 @@ gint whiteboard_node_sib_access_remove_M3Triples(WhiteBoardNode *self,
 
   g_return_val_if_fail(self!=NULL, ss_InvalidParameter);
   g_return_val_if_fail(triples!=NULL && triples->data!=NULL, ss_InvalidParameter);
-  g_mutex_lock(self->lock);
   const gchar *nodeid = whiteboard_node_get_uuid(self);
-  gint msgnum = ++(self->msgnumber);
+  gchar *sib = NULL;
+  gint msgnum = whiteboard_node_next_msgnumber(self);
+  gint64 started = whiteboard_node_stats_now();
   EncodingType encoding = EncodingM3XML;
         
   if( !whiteboard_node_joined(self))
@@ -1752,19 +2338,18 @@ gint whiteboard_node_sib_access_remove_M3Triples(WhiteBoardNode *self,
       ssTriple_t *t;
 
       //initializing status//
-      status = (!namespace)? ss_StatusOK : new_prefix2ns_map(namespace, &prefix_ns_map);
+      status = (!namespace)? ss_StatusOK : whiteboard_node_get_prefix2ns_map(self, namespace, &prefix_ns_map);
       if(status!=ss_StatusOK)
 	{
-	  g_mutex_unlock(self->lock);
 	  return status;
 	}
-      bd = ssBufDesc_new();
+      bd = whiteboard_node_bufdesc_get(self, 0);
       if (!bd) {
-	if(prefix_ns_map) g_hash_table_destroy(prefix_ns_map);
-	g_mutex_unlock(self->lock);
+	if(prefix_ns_map) g_hash_table_unref(prefix_ns_map);
 	return ss_NotEnoughResources;
       }
 
+      whiteboard_trace(WHITEBOARD_TRACE_XML_BUILD_START, msgnum, -1, 0);
       status = addXML_start (bd, &SIB_TRIPLELIST, NULL, NULL, 0);
       
       l = triples;
@@ -1779,35 +2364,224 @@ gint whiteboard_node_sib_access_remove_M3Triples(WhiteBoardNode *self,
       removelist = ssBufDesc_GetMessage(bd);
 
       if (!status)
+	{
+	  whiteboard_trace(WHITEBOARD_TRACE_XML_BUILD_END, msgnum, -1, ssBufDesc_GetMessageLen(bd));
+	  whiteboard_node_stats_add(self, &self->stats->xml_build, started, ss_StatusOK);
+	  whiteboard_node_stats_bytes(self, ssBufDesc_GetMessageLen(bd), 0);
+	  whiteboard_trace(WHITEBOARD_TRACE_DBUS_SEND, msgnum, -1, ssBufDesc_GetMessageLen(bd));
+	  sib = whiteboard_node_dup_sib(self);
+	  if (sib)
+	    whiteboard_util_send_method_with_reply(WHITEBOARD_DBUS_SERVICE,
+						   WHITEBOARD_DBUS_OBJECT,
+						   WHITEBOARD_DBUS_NODE_INTERFACE,
+						   WHITEBOARD_DBUS_NODE_METHOD_REMOVE,
+						   whiteboard_node_validate_connection(self),
+						   &reply,
+						   DBUS_TYPE_STRING, &nodeid,
+						   DBUS_TYPE_STRING, &sib,
+						   DBUS_TYPE_INT32, &msgnum,
+						   DBUS_TYPE_INT32, &encoding,
+						   DBUS_TYPE_STRING, &removelist,
+						   WHITEBOARD_UTIL_LIST_END);
+	  g_free(sib);
+	  whiteboard_trace(WHITEBOARD_TRACE_REPLY_RECEIVED, msgnum, -1, 0);
+	}
+      if(!status && reply)
+	{
+	  whiteboard_util_parse_message(reply,
+					DBUS_TYPE_INT32, &status,
+                                        //DBUS_TYPE_INT32, &success,
+					DBUS_TYPE_STRING, &response,
+					WHITEBOARD_UTIL_LIST_END);
+	  dbus_message_unref(reply);
+	}
+
+      whiteboard_node_stats_op(self, WHITEBOARD_NODE_STAT_REMOVE, started, status);
+      whiteboard_node_bufdesc_put(self, &bd);
+      if(prefix_ns_map) g_hash_table_unref(prefix_ns_map);
+    }
+  whiteboard_log_debug("Remove operation %s (status=%d)\n", (status)?"failed":"succeeded", status);
+  whiteboard_log_debug_fe();
+  return status;  
+}
+
+/* Generates a triple list from a batch, the strings are used in place */
+static ssStatus_t whiteboard_node_triplebatch_to_xml(ssBufDesc_t *bd,
+						     const ssTripleBatch_t *batch,
+						     GHashTable *prefix_ns_map,
+						     gboolean patternMatching)
+{
+  ssTriple_t t;
+  guint i, n = ssTripleBatch_length(batch);
+  ssStatus_t status;
+
+  status = ssBufDesc_reserve(bd, ssBufDesc_GetMessageLen(bd) + 2*SIB_TRIPLELIST.len + 5 +
+			     n*TRIPLE_XML_OVERHEAD + ssTripleBatch_strings_size(batch));
+  status = (status)?status : addXML_start (bd, &SIB_TRIPLELIST, NULL, NULL, 0);
+  for (i = 0; status==ss_StatusOK && i < n; i++) {
+    ssTripleBatch_get(batch, i, &t);
+    if (invalidTriple(&t, patternMatching))
+      status = ss_InvalidTripleSpecification;
+    else
+      status = addXML_templateTriple(&t, prefix_ns_map, (gpointer)bd);
+  }
+
+  return (status)?status : addXML_end (bd, &SIB_TRIPLELIST);
+}
+
+/* Sends an insert or remove of triples, or an update of triples and
+   remove_triples, and waits for the reply */
+static ssStatus_t whiteboard_node_modify_triplebatch(WhiteBoardNode *self,
+						     const gchar *method,
+						     const ssTripleBatch_t *triples,
+						     gboolean update,
+						     const ssTripleBatch_t *remove_triples,
+						     const gchar *namespace)
+{
+  EncodingType encoding = EncodingM3XML;
+  ssStatus_t status;
+  gchar *response = NULL;
+  const gchar *list1 = NULL;
+  const gchar *list2 = NULL;
+  DBusMessage *reply = NULL;
+  ssBufDesc_t *bd1 = NULL;
+  ssBufDesc_t *bd2 = NULL;
+  GHashTable *prefix_ns_map = NULL;
+
+  whiteboard_log_debug_fb();
+  const gchar *nodeid = whiteboard_node_get_uuid(self);
+  gchar *sib = NULL;
+  gint msgnum = whiteboard_node_next_msgnumber(self);
+  gint64 started = whiteboard_node_stats_now();
+
+  if( !whiteboard_node_joined(self))
+    {
+      whiteboard_log_debug("Node (%s) not joined, can not %s triples\n", nodeid, method);
+      whiteboard_log_debug_fe();
+      return ss_InvalidParameter;
+    }
+
+  status = (!namespace)? ss_StatusOK : whiteboard_node_get_prefix2ns_map(self, namespace, &prefix_ns_map);
+  if (status != ss_StatusOK)
+    {
+      whiteboard_log_debug_fe();
+      return status;
+    }
+
+  bd1 = whiteboard_node_bufdesc_get(self, 0);
+  if (update)
+    bd2 = whiteboard_node_bufdesc_get(self, 0);
+  if (!bd1 || (update && !bd2))
+    status = ss_NotEnoughResources;
+
+  whiteboard_trace(WHITEBOARD_TRACE_XML_BUILD_START, msgnum, -1, 0);
+  status = (status)?status : whiteboard_node_triplebatch_to_xml(bd1, triples, prefix_ns_map, FALSE);
+  if (update)
+    status = (status)?status : whiteboard_node_triplebatch_to_xml(bd2, remove_triples, prefix_ns_map, TRUE);
+
+  if (!status)
+    {
+      whiteboard_trace(WHITEBOARD_TRACE_XML_BUILD_END, msgnum, -1,
+		       ssBufDesc_GetMessageLen(bd1) + (update ? ssBufDesc_GetMessageLen(bd2) : 0));
+      whiteboard_node_stats_add(self, &self->stats->xml_build, started, ss_StatusOK);
+      whiteboard_node_stats_bytes(self, ssBufDesc_GetMessageLen(bd1) + (update ? ssBufDesc_GetMessageLen(bd2) : 0), 0);
+      whiteboard_trace(WHITEBOARD_TRACE_DBUS_SEND, msgnum, -1,
+		       ssBufDesc_GetMessageLen(bd1) + (update ? ssBufDesc_GetMessageLen(bd2) : 0));
+      list1 = ssBufDesc_GetMessage(bd1);
+      sib = whiteboard_node_dup_sib(self);
+      if (!sib)
+	whiteboard_log_debug("Node (%s) left, can not %s triples\n", nodeid, method);
+      else if (update)
+	{
+	  list2 = ssBufDesc_GetMessage(bd2);
+	  whiteboard_util_send_method_with_reply(WHITEBOARD_DBUS_SERVICE,
+						 WHITEBOARD_DBUS_OBJECT,
+						 WHITEBOARD_DBUS_NODE_INTERFACE,
+						 method,
+						 whiteboard_node_validate_connection(self),
+						 &reply,
+						 DBUS_TYPE_STRING, &nodeid,
+						 DBUS_TYPE_STRING, &sib,
+						 DBUS_TYPE_INT32, &msgnum,
+						 DBUS_TYPE_INT32, &encoding,
+						 DBUS_TYPE_STRING, &list1,
+						 DBUS_TYPE_STRING, &list2,
+						 WHITEBOARD_UTIL_LIST_END);
+	}
+      else
 	whiteboard_util_send_method_with_reply(WHITEBOARD_DBUS_SERVICE,
 					       WHITEBOARD_DBUS_OBJECT,
 					       WHITEBOARD_DBUS_NODE_INTERFACE,
-					       WHITEBOARD_DBUS_NODE_METHOD_REMOVE,
+					       method,
 					       whiteboard_node_validate_connection(self),
 					       &reply,
 					       DBUS_TYPE_STRING, &nodeid,
-					       DBUS_TYPE_STRING, &self->sib,
+					       DBUS_TYPE_STRING, &sib,
 					       DBUS_TYPE_INT32, &msgnum,
 					       DBUS_TYPE_INT32, &encoding,
-					       DBUS_TYPE_STRING, &removelist,
+					       DBUS_TYPE_STRING, &list1,
 					       WHITEBOARD_UTIL_LIST_END);
-      if(!status && reply)
+      g_free(sib);
+      whiteboard_trace(WHITEBOARD_TRACE_REPLY_RECEIVED, msgnum, -1, 0);
+
+      if (reply)
 	{
 	  whiteboard_util_parse_message(reply,
 					DBUS_TYPE_INT32, &status,
-                                        //DBUS_TYPE_INT32, &success,
 					DBUS_TYPE_STRING, &response,
 					WHITEBOARD_UTIL_LIST_END);
+	  if (NULL == response)
+	    {
+	      whiteboard_log_debug("Invalid %s response\n", method);
+	      status = ss_OperationFailed;
+	    }
 	  dbus_message_unref(reply);
 	}
-
-      ssBufDesc_free(&bd);
-      if(prefix_ns_map) g_hash_table_destroy(prefix_ns_map);
+      else
+	{
+	  whiteboard_log_debug("no %s REPLY\n", method);
+	  status = ss_OperationFailed;
+	}
     }
-  whiteboard_log_debug("Remove operation %s (status=%d)\n", (status)?"failed":"succeeded", status);
-  g_mutex_unlock(self->lock);
+
+  whiteboard_node_stats_op(self, whiteboard_node_stat_kind_for_method(method), started, status);
+  whiteboard_node_bufdesc_put(self, &bd1);
+  whiteboard_node_bufdesc_put(self, &bd2);
+  if (prefix_ns_map) g_hash_table_unref(prefix_ns_map);
+  whiteboard_log_debug("%s operation %s (status=%d)\n", method, (status)?"failed":"succeeded", status);
   whiteboard_log_debug_fe();
-  return status;  
+  return status;
+}
+
+ssStatus_t whiteboard_node_sib_access_insert_TripleBatch(WhiteBoardNode *self,
+							 const ssTripleBatch_t *triples,
+							 const gchar *namespace)
+{
+  g_return_val_if_fail(self!=NULL, ss_InvalidParameter);
+  g_return_val_if_fail(ssTripleBatch_length(triples) > 0, ss_InvalidParameter);
+  return whiteboard_node_modify_triplebatch(self, WHITEBOARD_DBUS_NODE_METHOD_INSERT,
+					    triples, FALSE, NULL, namespace);
+}
+
+ssStatus_t whiteboard_node_sib_access_update_TripleBatch(WhiteBoardNode *self,
+							 const ssTripleBatch_t *insert_triples,
+							 const ssTripleBatch_t *remove_triples,
+							 const gchar *namespace)
+{
+  g_return_val_if_fail(self!=NULL, ss_InvalidParameter);
+  g_return_val_if_fail(ssTripleBatch_length(insert_triples) > 0 || ssTripleBatch_length(remove_triples) > 0, ss_InvalidParameter);
+  return whiteboard_node_modify_triplebatch(self, WHITEBOARD_DBUS_NODE_METHOD_UPDATE,
+					    insert_triples, TRUE, remove_triples, namespace);
+}
+
+ssStatus_t whiteboard_node_sib_access_remove_TripleBatch(WhiteBoardNode *self,
+							 const ssTripleBatch_t *triples,
+							 const gchar *namespace)
+{
+  g_return_val_if_fail(self!=NULL, ss_InvalidParameter);
+  g_return_val_if_fail(ssTripleBatch_length(triples) > 0, ss_InvalidParameter);
+  return whiteboard_node_modify_triplebatch(self, WHITEBOARD_DBUS_NODE_METHOD_REMOVE,
+					    triples, FALSE, NULL, namespace);
 }
 
 gint whiteboard_node_sib_access_query_template(WhiteBoardNode *self,
@@ -1821,19 +2595,19 @@ gint whiteboard_node_sib_access_query_template(WhiteBoardNode *self,
   QueryType type = QueryTypeTemplate;
   DBusMessage *reply=NULL;
   ssBufDesc_t *desc=NULL;
-  GHashTable *prefix_ns_map=NULL;
+  NsMapData *ns_map=NULL;
 
   whiteboard_log_debug_fb();
   g_return_val_if_fail(self!=NULL, ss_InvalidParameter);
   g_return_val_if_fail( cb != NULL ,ss_InvalidParameter);
   g_return_val_if_fail( templates != NULL , ss_InvalidParameter);
-  g_mutex_lock(self->lock);
   const gchar *nodeid = whiteboard_node_get_uuid(self);
-  gint msgnum = ++(self->msgnumber);
+  gchar *sib = NULL;
+  gint msgnum = whiteboard_node_next_msgnumber(self);
+  gint64 started = whiteboard_node_stats_now();
   if( !whiteboard_node_joined(self))
     {
       whiteboard_log_debug("Node (%s) not joined, can not create query\n",nodeid);
-      g_mutex_unlock(self->lock);
       return ss_InvalidParameter;
     }
   else
@@ -1843,23 +2617,22 @@ gint whiteboard_node_sib_access_query_template(WhiteBoardNode *self,
       ssStatus_t status;
 
       //initializing status//
-      status = (!namespace)? ss_StatusOK : new_prefix2ns_map(namespace, &prefix_ns_map);
+      status = (!namespace)? ss_StatusOK : whiteboard_node_get_ns_map(self, namespace, &ns_map);
       if (status!=ss_StatusOK)
 	{
-	  g_mutex_unlock(self->lock);
 	  return status;
 	}
-      desc = ssBufDesc_new();
+      desc = whiteboard_node_bufdesc_get(self, 0);
       if (!desc) {
-	if (prefix_ns_map) g_hash_table_destroy(prefix_ns_map);
-	g_mutex_unlock(self->lock);
+	if (ns_map) whiteboard_node_ns_map_unref(ns_map);
 	return ss_NotEnoughResources;
       }
 
+      whiteboard_trace(WHITEBOARD_TRACE_XML_BUILD_START, msgnum, -1, 0);
       status = addXML_start (desc, &SIB_TRIPLELIST, NULL, NULL, 0);
 
       while (status==ss_StatusOK && l && (t=(ssTriple_t *)l->data) && !invalidTriple(t,TRUE)) {
-	status = addXML_templateTriple(t, prefix_ns_map, (gpointer)desc);
+	status = addXML_templateTriple(t, NS_MAP_PREFIX2NS(ns_map), (gpointer)desc);
 	l=l->next;
       }
       if (!status && l!=NULL)
@@ -1868,26 +2641,33 @@ gint whiteboard_node_sib_access_query_template(WhiteBoardNode *self,
       status=(status)?status : addXML_end (desc, &SIB_TRIPLELIST);
 
       if (status) {
-	ssBufDesc_free(&desc);
-	if (prefix_ns_map) g_hash_table_destroy(prefix_ns_map);
-	g_mutex_unlock(self->lock);
+	whiteboard_node_bufdesc_put(self, &desc);
+	if (ns_map) whiteboard_node_ns_map_unref(ns_map);
 	return status;
       }
 
       subscribe_message = ssBufDesc_GetMessage(desc);
-      
-      whiteboard_util_send_method_with_reply(WHITEBOARD_DBUS_SERVICE,
-					     WHITEBOARD_DBUS_OBJECT,
-					     WHITEBOARD_DBUS_NODE_INTERFACE,
-					     WHITEBOARD_DBUS_NODE_METHOD_QUERY,
-					     whiteboard_node_validate_connection(self),
-					     &reply,
-					     DBUS_TYPE_STRING, &nodeid,
-					     DBUS_TYPE_STRING, &self->sib,
-					     DBUS_TYPE_INT32, &msgnum,
-					     DBUS_TYPE_INT32, &type,
-					     DBUS_TYPE_STRING, &subscribe_message,
-					     WHITEBOARD_UTIL_LIST_END);
+      whiteboard_trace(WHITEBOARD_TRACE_XML_BUILD_END, msgnum, -1, ssBufDesc_GetMessageLen(desc));
+      whiteboard_node_stats_add(self, &self->stats->xml_build, started, ss_StatusOK);
+      whiteboard_node_stats_bytes(self, ssBufDesc_GetMessageLen(desc), 0);
+      whiteboard_trace(WHITEBOARD_TRACE_DBUS_SEND, msgnum, -1, ssBufDesc_GetMessageLen(desc));
+
+      sib = whiteboard_node_dup_sib(self);
+      if (sib)
+	whiteboard_util_send_method_with_reply(WHITEBOARD_DBUS_SERVICE,
+					       WHITEBOARD_DBUS_OBJECT,
+					       WHITEBOARD_DBUS_NODE_INTERFACE,
+					       WHITEBOARD_DBUS_NODE_METHOD_QUERY,
+					       whiteboard_node_validate_connection(self),
+					       &reply,
+					       DBUS_TYPE_STRING, &nodeid,
+					       DBUS_TYPE_STRING, &sib,
+					       DBUS_TYPE_INT32, &msgnum,
+					       DBUS_TYPE_INT32, &type,
+					       DBUS_TYPE_STRING, &subscribe_message,
+					       WHITEBOARD_UTIL_LIST_END);
+      g_free(sib);
+      whiteboard_trace(WHITEBOARD_TRACE_REPLY_RECEIVED, msgnum, -1, 0);
       if(reply)
 	{
 	  whiteboard_util_parse_message(reply,
@@ -1903,21 +2683,21 @@ gint whiteboard_node_sib_access_query_template(WhiteBoardNode *self,
 	      SubscriptionData *sd = NULL;
 	      sd = g_new0(SubscriptionData, 1);
 	      sd->cb.q_template = cb;
-	      sd->prefix_ns_map = prefix_ns_map;
+	      sd->ns_map = ns_map;
 	      sd->user_data = data;
 	      sd->type = QueryTypeTemplate;
+	      sd->started = started;
 	      if(!whiteboard_node_add_subscription_data(self, access_id, sd))
 		{
 		  whiteboard_log_debug("Could not add subscription data to subscription map\n");
-		  if (prefix_ns_map) g_hash_table_destroy(prefix_ns_map);
+		  if (ns_map) whiteboard_node_ns_map_unref(ns_map);
 		  g_free(sd);
 		}
 	    }
 	  dbus_message_unref(reply);
 	}
-      ssBufDesc_free(&desc);
+      whiteboard_node_bufdesc_put(self, &desc);
     }
-  g_mutex_unlock(self->lock);
   whiteboard_log_debug_fe();
   return (access_id > 0) ? ss_StatusOK : ss_GeneralError;
 }
@@ -1935,7 +2715,7 @@ ssStatus_t whiteboard_node_sib_access_query_sparql_select(WhiteBoardNode *self,
   QueryType type = QueryTypeSPARQLSelect;
   DBusMessage *reply=NULL;
   ssBufDesc_t *desc=NULL;
-  GHashTable *prefix_ns_map=NULL;
+  NsMapData *ns_map=NULL;
 
   whiteboard_log_debug_fb();
   g_return_val_if_fail(self!=NULL, ss_InvalidParameter);
@@ -1943,13 +2723,13 @@ ssStatus_t whiteboard_node_sib_access_query_sparql_select(WhiteBoardNode *self,
   g_return_val_if_fail( where != NULL || optional_lists != NULL, ss_InvalidParameter);
   g_return_val_if_fail( optional_lists == NULL || optional_lists->data != NULL, ss_InvalidParameter);
 
-  g_mutex_lock(self->lock);
   const gchar *nodeid = whiteboard_node_get_uuid(self);
-  gint msgnum = ++(self->msgnumber);
+  gchar *sib = NULL;
+  gint msgnum = whiteboard_node_next_msgnumber(self);
+  gint64 started = whiteboard_node_stats_now();
   if( !whiteboard_node_joined(self))
     {
       whiteboard_log_debug("Node (%s) not joined, can not create query\n",nodeid);
-      g_mutex_unlock(self->lock);
       return ss_InvalidParameter;
     }
   else
@@ -1959,42 +2739,48 @@ ssStatus_t whiteboard_node_sib_access_query_sparql_select(WhiteBoardNode *self,
       ssStatus_t status;
 
       //initializing status//
-      status = (!namespace)? ss_StatusOK : new_prefix2ns_map(namespace, &prefix_ns_map);
+      status = (!namespace)? ss_StatusOK : whiteboard_node_get_ns_map(self, namespace, &ns_map);
       if (status!=ss_StatusOK)
 	{
-	  g_mutex_unlock(self->lock);
 	  return status;
 	}
-      desc = ssBufDesc_new();
+      desc = whiteboard_node_bufdesc_get(self, 0);
       if (!desc) {
-	if (prefix_ns_map) g_hash_table_destroy(prefix_ns_map);
-	g_mutex_unlock(self->lock);
+	if (ns_map) whiteboard_node_ns_map_unref(ns_map);
 	return ss_NotEnoughResources;
       }
 
-      status = generateSPARQLSelectQueryString(desc, select, where, optional_lists, prefix_ns_map);
+      whiteboard_trace(WHITEBOARD_TRACE_XML_BUILD_START, msgnum, -1, 0);
+      status = generateSPARQLSelectQueryString(desc, select, where, optional_lists, NS_MAP_PREFIX2NS(ns_map));
 
       if (status) {
-	ssBufDesc_free(&desc);
-	if (prefix_ns_map) g_hash_table_destroy(prefix_ns_map);
-	g_mutex_unlock(self->lock);
+	whiteboard_node_bufdesc_put(self, &desc);
+	if (ns_map) whiteboard_node_ns_map_unref(ns_map);
 	return status;
       }
 
       subscribe_message = ssBufDesc_GetMessage(desc);
+      whiteboard_trace(WHITEBOARD_TRACE_XML_BUILD_END, msgnum, -1, ssBufDesc_GetMessageLen(desc));
+      whiteboard_node_stats_add(self, &self->stats->xml_build, started, ss_StatusOK);
+      whiteboard_node_stats_bytes(self, ssBufDesc_GetMessageLen(desc), 0);
       
-      whiteboard_util_send_method_with_reply(WHITEBOARD_DBUS_SERVICE,
-					     WHITEBOARD_DBUS_OBJECT,
-					     WHITEBOARD_DBUS_NODE_INTERFACE,
-					     WHITEBOARD_DBUS_NODE_METHOD_QUERY,
-					     whiteboard_node_validate_connection(self),
-					     &reply,
-					     DBUS_TYPE_STRING, &nodeid,
-					     DBUS_TYPE_STRING, &self->sib,
-					     DBUS_TYPE_INT32, &msgnum,
-					     DBUS_TYPE_INT32, &type,
-					     DBUS_TYPE_STRING, &subscribe_message,
-					     WHITEBOARD_UTIL_LIST_END);
+      whiteboard_trace(WHITEBOARD_TRACE_DBUS_SEND, msgnum, -1, ssBufDesc_GetMessageLen(desc));
+      sib = whiteboard_node_dup_sib(self);
+      if (sib)
+	whiteboard_util_send_method_with_reply(WHITEBOARD_DBUS_SERVICE,
+					       WHITEBOARD_DBUS_OBJECT,
+					       WHITEBOARD_DBUS_NODE_INTERFACE,
+					       WHITEBOARD_DBUS_NODE_METHOD_QUERY,
+					       whiteboard_node_validate_connection(self),
+					       &reply,
+					       DBUS_TYPE_STRING, &nodeid,
+					       DBUS_TYPE_STRING, &sib,
+					       DBUS_TYPE_INT32, &msgnum,
+					       DBUS_TYPE_INT32, &type,
+					       DBUS_TYPE_STRING, &subscribe_message,
+					       WHITEBOARD_UTIL_LIST_END);
+      g_free(sib);
+      whiteboard_trace(WHITEBOARD_TRACE_REPLY_RECEIVED, msgnum, -1, 0);
       if(reply)
 	{
 	  whiteboard_util_parse_message(reply,
@@ -2010,22 +2796,22 @@ ssStatus_t whiteboard_node_sib_access_query_sparql_select(WhiteBoardNode *self,
 	      SubscriptionData *sd = NULL;
 	      sd = g_new0(SubscriptionData, 1);
 	      sd->cb.q_template = cb;
-	      sd->prefix_ns_map = prefix_ns_map;
+	      sd->ns_map = ns_map;
 	      sd->user_data = data;
 	      sd->type = type;
+	      sd->started = started;
 	      if(!whiteboard_node_add_subscription_data(self, access_id, sd))
 		{
 		  whiteboard_log_debug("Could not add subscription data to subscription map\n");
-		  if (prefix_ns_map) g_hash_table_destroy(prefix_ns_map);
+		  if (ns_map) whiteboard_node_ns_map_unref(ns_map);
 		  g_free(sd);
 		}
 	    }
 	  dbus_message_unref(reply);
 	}
 
-      ssBufDesc_free(&desc);
+      whiteboard_node_bufdesc_put(self, &desc);
     }
-  g_mutex_unlock(self->lock);
   whiteboard_log_debug_fe();
   return (access_id > 0) ? ss_StatusOK : ss_GeneralError;
 }
@@ -2049,43 +2835,50 @@ ssStatus_t whiteboard_node_sib_access_query_wql_isSubclass(WhiteBoardNode *self,
 		       (subclassNode->nodeType==ssElement_TYPE_URI || subclassNode->nodeType==ssElement_TYPE_LIT), ss_InvalidParameter);
   g_return_val_if_fail(superclassNode != NULL && superclassNode->string!=NULL && 
 		       (superclassNode->nodeType==ssElement_TYPE_URI || superclassNode->nodeType==ssElement_TYPE_LIT), ss_InvalidParameter);
-  g_mutex_lock(self->lock);
   const gchar *nodeid = whiteboard_node_get_uuid(self);
+  gchar *sib = NULL;
   if( !whiteboard_node_joined(self))
     {
       whiteboard_log_debug("Node (%s) has not joined, can not update triples\n",nodeid);
-      g_mutex_unlock(self->lock);
       return ss_InvalidParameter;
     }
 
-  gint msgnum = ++(self->msgnumber);
+  gint msgnum = whiteboard_node_next_msgnumber(self);
+  gint64 started = whiteboard_node_stats_now();
 
-  ssBufDesc_t *bD = ssBufDesc_new();
+  ssBufDesc_t *bD = whiteboard_node_bufdesc_get(self, 0);
   if (!bD) {
-    g_mutex_unlock(self->lock);
     return ss_NotEnoughResources;
   }
 
+  whiteboard_trace(WHITEBOARD_TRACE_XML_BUILD_START, msgnum, -1, 0);
   status = addXML_query_w_wql_n_n (bD, type, subclassNode, superclassNode);
   if (status) {
-    ssBufDesc_free(&bD);
-    g_mutex_unlock(self->lock);
+    whiteboard_node_bufdesc_put(self, &bD);
     return status;
   }
 
   query = ssBufDesc_GetMessage(bD);
-  whiteboard_util_send_method_with_reply(WHITEBOARD_DBUS_SERVICE,
-					 WHITEBOARD_DBUS_OBJECT,
-					 WHITEBOARD_DBUS_NODE_INTERFACE,
-					 WHITEBOARD_DBUS_NODE_METHOD_QUERY,
-					 whiteboard_node_validate_connection(self),
-					 &reply,
-					 DBUS_TYPE_STRING, &nodeid,
-					 DBUS_TYPE_STRING, &self->sib,
-					 DBUS_TYPE_INT32, &msgnum,
-					 DBUS_TYPE_INT32, &type,
-					 DBUS_TYPE_STRING, &query,
-					 WHITEBOARD_UTIL_LIST_END);
+  whiteboard_trace(WHITEBOARD_TRACE_XML_BUILD_END, msgnum, -1, ssBufDesc_GetMessageLen(bD));
+  whiteboard_node_stats_add(self, &self->stats->xml_build, started, ss_StatusOK);
+  whiteboard_node_stats_bytes(self, ssBufDesc_GetMessageLen(bD), 0);
+  whiteboard_trace(WHITEBOARD_TRACE_DBUS_SEND, msgnum, -1, ssBufDesc_GetMessageLen(bD));
+  sib = whiteboard_node_dup_sib(self);
+  if (sib)
+    whiteboard_util_send_method_with_reply(WHITEBOARD_DBUS_SERVICE,
+					   WHITEBOARD_DBUS_OBJECT,
+					   WHITEBOARD_DBUS_NODE_INTERFACE,
+					   WHITEBOARD_DBUS_NODE_METHOD_QUERY,
+					   whiteboard_node_validate_connection(self),
+					   &reply,
+					   DBUS_TYPE_STRING, &nodeid,
+					   DBUS_TYPE_STRING, &sib,
+					   DBUS_TYPE_INT32, &msgnum,
+					   DBUS_TYPE_INT32, &type,
+					   DBUS_TYPE_STRING, &query,
+					   WHITEBOARD_UTIL_LIST_END);
+  g_free(sib);
+  whiteboard_trace(WHITEBOARD_TRACE_REPLY_RECEIVED, msgnum, -1, 0);
 
   status = (reply)? ss_StatusOK : ss_InternalError;
   if(!status)
@@ -2109,6 +2902,7 @@ ssStatus_t whiteboard_node_sib_access_query_wql_isSubclass(WhiteBoardNode *self,
 	      sd->cb.q_wql_boolean = cb;
 	      sd->user_data = data;
 	      sd->type = type;
+	      sd->started = started;
 	      if(!whiteboard_node_add_subscription_data(self, access_id, sd))
 		{
 		  status = ss_InternalError;
@@ -2120,8 +2914,7 @@ ssStatus_t whiteboard_node_sib_access_query_wql_isSubclass(WhiteBoardNode *self,
       dbus_message_unref(reply);
     }
 
-  ssBufDesc_free(&bD);
-  g_mutex_unlock(self->lock);
+  whiteboard_node_bufdesc_put(self, &bD);
   whiteboard_log_debug_fe();
   return status;
 }
@@ -2145,43 +2938,50 @@ ssStatus_t whiteboard_node_sib_access_query_wql_ofClass(WhiteBoardNode *self,
 		       (pathNode->nodeType==ssElement_TYPE_URI || pathNode->nodeType==ssElement_TYPE_LIT), ss_InvalidParameter);
   g_return_val_if_fail(classNode != NULL && classNode->string!=NULL && 
 		       classNode->nodeType==ssElement_TYPE_URI, ss_InvalidParameter);
-  g_mutex_lock(self->lock);
   const gchar *nodeid = whiteboard_node_get_uuid(self);
+  gchar *sib = NULL;
   if( !whiteboard_node_joined(self))
     {
       whiteboard_log_debug("Node (%s) has not joined, can not update triples\n",nodeid);
-      g_mutex_unlock(self->lock);
       return ss_InvalidParameter;
     }
 
-  gint msgnum = ++(self->msgnumber);
+  gint msgnum = whiteboard_node_next_msgnumber(self);
+  gint64 started = whiteboard_node_stats_now();
 
-  ssBufDesc_t *bD = ssBufDesc_new();
+  ssBufDesc_t *bD = whiteboard_node_bufdesc_get(self, 0);
   if (!bD) {
-    g_mutex_unlock(self->lock);
     return ss_NotEnoughResources;
   }
 
+  whiteboard_trace(WHITEBOARD_TRACE_XML_BUILD_START, msgnum, -1, 0);
   status = addXML_query_w_wql_n_n (bD, type, pathNode, classNode);
   if (status) {
-    ssBufDesc_free(&bD);
-    g_mutex_unlock(self->lock);
+    whiteboard_node_bufdesc_put(self, &bD);
     return status;
   }
 
   query = ssBufDesc_GetMessage(bD);
-  whiteboard_util_send_method_with_reply(WHITEBOARD_DBUS_SERVICE,
-					 WHITEBOARD_DBUS_OBJECT,
-					 WHITEBOARD_DBUS_NODE_INTERFACE,
-					 WHITEBOARD_DBUS_NODE_METHOD_QUERY,
-					 whiteboard_node_validate_connection(self),
-					 &reply,
-					 DBUS_TYPE_STRING, &nodeid,
-					 DBUS_TYPE_STRING, &self->sib,
-					 DBUS_TYPE_INT32, &msgnum,
-					 DBUS_TYPE_INT32, &type,
-					 DBUS_TYPE_STRING, &query,
-					 WHITEBOARD_UTIL_LIST_END);
+  whiteboard_trace(WHITEBOARD_TRACE_XML_BUILD_END, msgnum, -1, ssBufDesc_GetMessageLen(bD));
+  whiteboard_node_stats_add(self, &self->stats->xml_build, started, ss_StatusOK);
+  whiteboard_node_stats_bytes(self, ssBufDesc_GetMessageLen(bD), 0);
+  whiteboard_trace(WHITEBOARD_TRACE_DBUS_SEND, msgnum, -1, ssBufDesc_GetMessageLen(bD));
+  sib = whiteboard_node_dup_sib(self);
+  if (sib)
+    whiteboard_util_send_method_with_reply(WHITEBOARD_DBUS_SERVICE,
+					   WHITEBOARD_DBUS_OBJECT,
+					   WHITEBOARD_DBUS_NODE_INTERFACE,
+					   WHITEBOARD_DBUS_NODE_METHOD_QUERY,
+					   whiteboard_node_validate_connection(self),
+					   &reply,
+					   DBUS_TYPE_STRING, &nodeid,
+					   DBUS_TYPE_STRING, &sib,
+					   DBUS_TYPE_INT32, &msgnum,
+					   DBUS_TYPE_INT32, &type,
+					   DBUS_TYPE_STRING, &query,
+					   WHITEBOARD_UTIL_LIST_END);
+  g_free(sib);
+  whiteboard_trace(WHITEBOARD_TRACE_REPLY_RECEIVED, msgnum, -1, 0);
 
   status = (reply)? ss_StatusOK : ss_InternalError;
   if(!status)
@@ -2205,6 +3005,7 @@ ssStatus_t whiteboard_node_sib_access_query_wql_ofClass(WhiteBoardNode *self,
 	      sd->cb.q_wql_boolean = cb;
 	      sd->user_data = data;
 	      sd->type = QueryTypeWQLIsType;
+	      sd->started = started;
 	      if(!whiteboard_node_add_subscription_data(self, access_id,sd))
 		{
 		  status = ss_InternalError;
@@ -2216,8 +3017,7 @@ ssStatus_t whiteboard_node_sib_access_query_wql_ofClass(WhiteBoardNode *self,
       dbus_message_unref(reply);
     }
 
-  ssBufDesc_free(&bD);
-  g_mutex_unlock(self->lock);
+  whiteboard_node_bufdesc_put(self, &bD);
   return status;
 }
 
@@ -2244,44 +3044,52 @@ ssStatus_t whiteboard_node_sib_access_subscribe_wql_related(WhiteBoardNode *self
 		       (endPathNode->nodeType==ssElement_TYPE_URI || endPathNode->nodeType==ssElement_TYPE_LIT), ss_InvalidParameter);
   g_return_val_if_fail( cb != NULL, ss_InvalidParameter);
   g_return_val_if_fail( subscription_id_p != NULL, ss_InvalidParameter);
-  g_mutex_lock(self->lock);
   *subscription_id_p = -1;
 
   const gchar *nodeid = whiteboard_node_get_uuid(self);
+  gchar *sib = NULL;
   if( !whiteboard_node_joined(self))
     {
       whiteboard_log_debug("Node (%s) has not joined, can not query\n",nodeid);
-      g_mutex_unlock(self->lock);
       return ss_InvalidParameter;
     }
 
-  ssBufDesc_t *bD = ssBufDesc_new();
+  gint msgnum = whiteboard_node_next_msgnumber(self);
+  gint64 started = whiteboard_node_stats_now();
+
+  ssBufDesc_t *bD = whiteboard_node_bufdesc_get(self, 0);
   if (!bD) {
-    g_mutex_unlock(self->lock);
     return ss_NotEnoughResources;
   }
 
+  whiteboard_trace(WHITEBOARD_TRACE_XML_BUILD_START, msgnum, -1, 0);
   status = addXML_query_w_wql_n_e_n (bD, type, startPathNode, pathExpr, endPathNode);
   if (status) {
-    ssBufDesc_free(&bD);
-    g_mutex_unlock(self->lock);
+    whiteboard_node_bufdesc_put(self, &bD);
     return status;
   }
 
-  gint msgnum = ++(self->msgnumber);
   query = ssBufDesc_GetMessage(bD);
-  whiteboard_util_send_method_with_reply(WHITEBOARD_DBUS_SERVICE,
-					 WHITEBOARD_DBUS_OBJECT,
-					 WHITEBOARD_DBUS_NODE_INTERFACE,
-					 WHITEBOARD_DBUS_NODE_METHOD_SUBSCRIBE,
-					 whiteboard_node_validate_connection(self),
-					 &reply,
-					 DBUS_TYPE_STRING, &nodeid,
-					 DBUS_TYPE_STRING, &self->sib,
-					 DBUS_TYPE_INT32, &msgnum,
-					 DBUS_TYPE_INT32, &type,
-					 DBUS_TYPE_STRING, &query,
-					 WHITEBOARD_UTIL_LIST_END);
+  whiteboard_trace(WHITEBOARD_TRACE_XML_BUILD_END, msgnum, -1, ssBufDesc_GetMessageLen(bD));
+  whiteboard_node_stats_add(self, &self->stats->xml_build, started, ss_StatusOK);
+  whiteboard_node_stats_bytes(self, ssBufDesc_GetMessageLen(bD), 0);
+  whiteboard_trace(WHITEBOARD_TRACE_DBUS_SEND, msgnum, -1, ssBufDesc_GetMessageLen(bD));
+  sib = whiteboard_node_dup_sib(self);
+  if (sib)
+    whiteboard_util_send_method_with_reply(WHITEBOARD_DBUS_SERVICE,
+					   WHITEBOARD_DBUS_OBJECT,
+					   WHITEBOARD_DBUS_NODE_INTERFACE,
+					   WHITEBOARD_DBUS_NODE_METHOD_SUBSCRIBE,
+					   whiteboard_node_validate_connection(self),
+					   &reply,
+					   DBUS_TYPE_STRING, &nodeid,
+					   DBUS_TYPE_STRING, &sib,
+					   DBUS_TYPE_INT32, &msgnum,
+					   DBUS_TYPE_INT32, &type,
+					   DBUS_TYPE_STRING, &query,
+					   WHITEBOARD_UTIL_LIST_END);
+  g_free(sib);
+  whiteboard_trace(WHITEBOARD_TRACE_REPLY_RECEIVED, msgnum, -1, 0);
 
   status = (reply)? ss_StatusOK : ss_InternalError;
   if(!status)
@@ -2317,8 +3125,8 @@ ssStatus_t whiteboard_node_sib_access_subscribe_wql_related(WhiteBoardNode *self
       dbus_message_unref(reply);
     }
 
-  ssBufDesc_free(&bD);
-  g_mutex_unlock(self->lock);
+  whiteboard_node_stats_op(self, WHITEBOARD_NODE_STAT_SUBSCRIBE, started, status);
+  whiteboard_node_bufdesc_put(self, &bD);
   whiteboard_log_debug_fe();
   return status;
 }
@@ -2344,43 +3152,50 @@ ssStatus_t whiteboard_node_sib_access_query_wql_related (WhiteBoardNode *self,
   g_return_val_if_fail(expr!=NULL, ss_InvalidParameter);
   g_return_val_if_fail(endNode != NULL && endNode->string!=NULL && 
 		       (endNode->nodeType==ssElement_TYPE_URI || endNode->nodeType==ssElement_TYPE_LIT), ss_InvalidParameter);
-  g_mutex_lock(self->lock);
   const gchar *nodeid = whiteboard_node_get_uuid(self);
+  gchar *sib = NULL;
   if( !whiteboard_node_joined(self))
     {
       whiteboard_log_debug("Node (%s) has not joined, can not update triples\n",nodeid);
-      g_mutex_unlock(self->lock);
       return ss_InvalidParameter;
     }
 
-  gint msgnum = ++(self->msgnumber);
+  gint msgnum = whiteboard_node_next_msgnumber(self);
+  gint64 started = whiteboard_node_stats_now();
 
-  ssBufDesc_t *bD = ssBufDesc_new();
+  ssBufDesc_t *bD = whiteboard_node_bufdesc_get(self, 0);
   if (!bD) {
-    g_mutex_unlock(self->lock);
     return ss_NotEnoughResources;
   }
 
+  whiteboard_trace(WHITEBOARD_TRACE_XML_BUILD_START, msgnum, -1, 0);
   status = addXML_query_w_wql_n_e_n (bD, type, startNode, expr, endNode);
   if (status) {
-    ssBufDesc_free(&bD);
-    g_mutex_unlock(self->lock);
+    whiteboard_node_bufdesc_put(self, &bD);
     return status;
   }
 
   query = ssBufDesc_GetMessage(bD);
-  whiteboard_util_send_method_with_reply(WHITEBOARD_DBUS_SERVICE,
-					 WHITEBOARD_DBUS_OBJECT,
-					 WHITEBOARD_DBUS_NODE_INTERFACE,
-					 WHITEBOARD_DBUS_NODE_METHOD_QUERY,
-					 whiteboard_node_validate_connection(self),
-					 &reply,
-					 DBUS_TYPE_STRING, &nodeid,
-					 DBUS_TYPE_STRING, &self->sib,
-					 DBUS_TYPE_INT32, &msgnum,
-					 DBUS_TYPE_INT32, &type,
-					 DBUS_TYPE_STRING, &query,
-					 WHITEBOARD_UTIL_LIST_END);
+  whiteboard_trace(WHITEBOARD_TRACE_XML_BUILD_END, msgnum, -1, ssBufDesc_GetMessageLen(bD));
+  whiteboard_node_stats_add(self, &self->stats->xml_build, started, ss_StatusOK);
+  whiteboard_node_stats_bytes(self, ssBufDesc_GetMessageLen(bD), 0);
+  whiteboard_trace(WHITEBOARD_TRACE_DBUS_SEND, msgnum, -1, ssBufDesc_GetMessageLen(bD));
+  sib = whiteboard_node_dup_sib(self);
+  if (sib)
+    whiteboard_util_send_method_with_reply(WHITEBOARD_DBUS_SERVICE,
+					   WHITEBOARD_DBUS_OBJECT,
+					   WHITEBOARD_DBUS_NODE_INTERFACE,
+					   WHITEBOARD_DBUS_NODE_METHOD_QUERY,
+					   whiteboard_node_validate_connection(self),
+					   &reply,
+					   DBUS_TYPE_STRING, &nodeid,
+					   DBUS_TYPE_STRING, &sib,
+					   DBUS_TYPE_INT32, &msgnum,
+					   DBUS_TYPE_INT32, &type,
+					   DBUS_TYPE_STRING, &query,
+					   WHITEBOARD_UTIL_LIST_END);
+  g_free(sib);
+  whiteboard_trace(WHITEBOARD_TRACE_REPLY_RECEIVED, msgnum, -1, 0);
 
   status = (reply)? ss_StatusOK : ss_InternalError;
   if(!status)
@@ -2404,6 +3219,7 @@ ssStatus_t whiteboard_node_sib_access_query_wql_related (WhiteBoardNode *self,
 	      sd->cb.q_wql_boolean = cb;
 	      sd->user_data = data;
 	      sd->type = QueryTypeWQLRelated;
+	      sd->started = started;
 	      if(!whiteboard_node_add_subscription_data(self, access_id,sd))
 		{
 		  status = ss_InternalError;
@@ -2415,8 +3231,7 @@ ssStatus_t whiteboard_node_sib_access_query_wql_related (WhiteBoardNode *self,
       dbus_message_unref(reply);
     }
 
-  ssBufDesc_free(&bD);
-  g_mutex_unlock(self->lock);
+  whiteboard_node_bufdesc_put(self, &bD);
   return status;
 }
 
@@ -2438,40 +3253,48 @@ gint whiteboard_node_sib_access_query_wql_values (WhiteBoardNode *self,
   g_return_val_if_fail( cb != NULL ,ss_InvalidParameter);
   g_return_val_if_fail( node != NULL , ss_InvalidParameter);
   g_return_val_if_fail( expr != NULL , ss_InvalidParameter);
-  g_mutex_lock(self->lock);
   const gchar *nodeid = whiteboard_node_get_uuid(self);
-  gint msgnum = ++(self->msgnumber);
+  gchar *sib = NULL;
+  gint msgnum = whiteboard_node_next_msgnumber(self);
+  gint64 started = whiteboard_node_stats_now();
   if( !whiteboard_node_joined(self))
     {
       whiteboard_log_debug("Node (%s) not joined, can not create query\n",nodeid);
-      g_mutex_unlock(self->lock);
       return ss_InvalidParameter;
     }
   else
     {
       ssStatus_t status;
-      desc = ssBufDesc_new();
+      desc = whiteboard_node_bufdesc_get(self, 0);
       //insert_message =  whiteboard_insert_new_request(triples);
+      whiteboard_trace(WHITEBOARD_TRACE_XML_BUILD_START, msgnum, -1, 0);
       status = addXML_query_w_wql_n_e (desc, type, node, expr);
       if (status) {
-	ssBufDesc_free(&desc);
-	g_mutex_unlock(self->lock);
+	whiteboard_node_bufdesc_put(self, &desc);
 	return status;
       }
 
       query = ssBufDesc_GetMessage(desc);
-      whiteboard_util_send_method_with_reply(WHITEBOARD_DBUS_SERVICE,
-					     WHITEBOARD_DBUS_OBJECT,
-					     WHITEBOARD_DBUS_NODE_INTERFACE,
-					     WHITEBOARD_DBUS_NODE_METHOD_QUERY,
-					     whiteboard_node_validate_connection(self),
-					     &reply,
-					     DBUS_TYPE_STRING, &nodeid,
-					     DBUS_TYPE_STRING, &self->sib,
-					     DBUS_TYPE_INT32, &msgnum,
-					     DBUS_TYPE_INT32, &type,
-					     DBUS_TYPE_STRING, &query,
-					     WHITEBOARD_UTIL_LIST_END);
+      whiteboard_trace(WHITEBOARD_TRACE_XML_BUILD_END, msgnum, -1, ssBufDesc_GetMessageLen(desc));
+      whiteboard_node_stats_add(self, &self->stats->xml_build, started, ss_StatusOK);
+      whiteboard_node_stats_bytes(self, ssBufDesc_GetMessageLen(desc), 0);
+      whiteboard_trace(WHITEBOARD_TRACE_DBUS_SEND, msgnum, -1, ssBufDesc_GetMessageLen(desc));
+      sib = whiteboard_node_dup_sib(self);
+      if (sib)
+	whiteboard_util_send_method_with_reply(WHITEBOARD_DBUS_SERVICE,
+					       WHITEBOARD_DBUS_OBJECT,
+					       WHITEBOARD_DBUS_NODE_INTERFACE,
+					       WHITEBOARD_DBUS_NODE_METHOD_QUERY,
+					       whiteboard_node_validate_connection(self),
+					       &reply,
+					       DBUS_TYPE_STRING, &nodeid,
+					       DBUS_TYPE_STRING, &sib,
+					       DBUS_TYPE_INT32, &msgnum,
+					       DBUS_TYPE_INT32, &type,
+					       DBUS_TYPE_STRING, &query,
+					       WHITEBOARD_UTIL_LIST_END);
+      g_free(sib);
+      whiteboard_trace(WHITEBOARD_TRACE_REPLY_RECEIVED, msgnum, -1, 0);
       if(reply)
 	{
 	  whiteboard_util_parse_message(reply,
@@ -2489,6 +3312,7 @@ gint whiteboard_node_sib_access_query_wql_values (WhiteBoardNode *self,
 	      sd->cb.q_wql_values = cb;
 	      sd->user_data = data;
 	      sd->type = QueryTypeWQLValues;
+	      sd->started = started;
 	      if(!whiteboard_node_add_subscription_data(self, access_id,sd))
 		{
 		  whiteboard_log_debug("Could not add subscription data to subscription map\n");
@@ -2498,11 +3322,10 @@ gint whiteboard_node_sib_access_query_wql_values (WhiteBoardNode *self,
 	  dbus_message_unref(reply);
 	  //	  ssBufDesc_free(&desc);
 	}
-      ssBufDesc_free(&desc);
+      whiteboard_node_bufdesc_put(self, &desc);
     }
   
   whiteboard_log_debug_fe();
-  g_mutex_unlock(self->lock);
   return (access_id > 0) ? ss_StatusOK : ss_GeneralError;
 }
 
@@ -2525,42 +3348,50 @@ gint whiteboard_node_sib_access_query_wql_nodeClasses (WhiteBoardNode *self,
 			(pathNode->nodeType == ssElement_TYPE_URI || pathNode->nodeType == ssElement_TYPE_LIT),
 			ss_InvalidParameter);
   g_return_val_if_fail( cb != NULL, ss_InvalidParameter);
-  g_mutex_lock(self->lock);
   const gchar *nodeid = whiteboard_node_get_uuid(self);
+  gchar *sib = NULL;
   if( !whiteboard_node_joined(self))
     {
       whiteboard_log_debug("Node (%s) not joined, can not create query\n",nodeid);
-      g_mutex_unlock(self->lock);
       return ss_InvalidParameter;
     }
 
-  bD = ssBufDesc_new();
+  gint msgnum = whiteboard_node_next_msgnumber(self);
+  gint64 started = whiteboard_node_stats_now();
+
+  bD = whiteboard_node_bufdesc_get(self, 0);
   if (!bD) {
-    g_mutex_unlock(self->lock);
     return ss_NotEnoughResources;
   }
 
+  whiteboard_trace(WHITEBOARD_TRACE_XML_BUILD_START, msgnum, -1, 0);
   status = addXML_query_w_wql_n (bD, type, pathNode);
   if (status) {
-    ssBufDesc_free(&bD);
-    g_mutex_unlock(self->lock);
+    whiteboard_node_bufdesc_put(self, &bD);
     return status;
   }
 
-  gint msgnum = ++(self->msgnumber);
   query = ssBufDesc_GetMessage(bD);
-  whiteboard_util_send_method_with_reply(WHITEBOARD_DBUS_SERVICE,
-					 WHITEBOARD_DBUS_OBJECT,
-					 WHITEBOARD_DBUS_NODE_INTERFACE,
-					 WHITEBOARD_DBUS_NODE_METHOD_QUERY,
-					 whiteboard_node_validate_connection(self),
-					 &reply,
-					 DBUS_TYPE_STRING, &nodeid,
-					 DBUS_TYPE_STRING, &self->sib,
-					 DBUS_TYPE_INT32, &msgnum,
-					 DBUS_TYPE_INT32, &type,
-					 DBUS_TYPE_STRING, &query,
-					 WHITEBOARD_UTIL_LIST_END);
+  whiteboard_trace(WHITEBOARD_TRACE_XML_BUILD_END, msgnum, -1, ssBufDesc_GetMessageLen(bD));
+  whiteboard_node_stats_add(self, &self->stats->xml_build, started, ss_StatusOK);
+  whiteboard_node_stats_bytes(self, ssBufDesc_GetMessageLen(bD), 0);
+  whiteboard_trace(WHITEBOARD_TRACE_DBUS_SEND, msgnum, -1, ssBufDesc_GetMessageLen(bD));
+  sib = whiteboard_node_dup_sib(self);
+  if (sib)
+    whiteboard_util_send_method_with_reply(WHITEBOARD_DBUS_SERVICE,
+					   WHITEBOARD_DBUS_OBJECT,
+					   WHITEBOARD_DBUS_NODE_INTERFACE,
+					   WHITEBOARD_DBUS_NODE_METHOD_QUERY,
+					   whiteboard_node_validate_connection(self),
+					   &reply,
+					   DBUS_TYPE_STRING, &nodeid,
+					   DBUS_TYPE_STRING, &sib,
+					   DBUS_TYPE_INT32, &msgnum,
+					   DBUS_TYPE_INT32, &type,
+					   DBUS_TYPE_STRING, &query,
+					   WHITEBOARD_UTIL_LIST_END);
+  g_free(sib);
+  whiteboard_trace(WHITEBOARD_TRACE_REPLY_RECEIVED, msgnum, -1, 0);
   status = (reply)? ss_StatusOK : ss_InternalError;
   if(!status)
     {
@@ -2583,6 +3414,7 @@ gint whiteboard_node_sib_access_query_wql_nodeClasses (WhiteBoardNode *self,
 	      sd->cb.q_wql_values = cb;
 	      sd->user_data = data;
 	      sd->type = type;
+	      sd->started = started;
 	      if(!whiteboard_node_add_subscription_data(self, access_id, sd))
 		{
 		  status = ss_InternalError;
@@ -2594,8 +3426,7 @@ gint whiteboard_node_sib_access_query_wql_nodeClasses (WhiteBoardNode *self,
       dbus_message_unref(reply);
     }
 
-  ssBufDesc_free(&bD);
-  g_mutex_unlock(self->lock);
+  whiteboard_node_bufdesc_put(self, &bD);
   whiteboard_log_debug_fe();
   return status;
 }
@@ -2620,14 +3451,13 @@ ssStatus_t whiteboard_node_sib_access_subscribe_template(WhiteBoardNode *self,
   g_return_val_if_fail( templates != NULL && templates->data != NULL, ss_InvalidParameter);
   g_return_val_if_fail( cb != NULL, ss_InvalidParameter);
   g_return_val_if_fail( subscription_id_p != NULL, ss_InvalidParameter);
-  g_mutex_lock(self->lock);
   *subscription_id_p = -1;
 
   const gchar *nodeid = whiteboard_node_get_uuid(self);
+  gchar *sib = NULL;
   if( !whiteboard_node_joined(self))
     {
       whiteboard_log_debug("Node (%s) not joined, can not create subscription\n",nodeid);
-      g_mutex_unlock(self->lock);
       return ss_InvalidParameter;
     }
 
@@ -2635,20 +3465,22 @@ ssStatus_t whiteboard_node_sib_access_subscribe_template(WhiteBoardNode *self,
   ssTriple_t *t;
 
   //initializing status//
-  status = (!namespace)? ss_StatusOK : new_prefix2ns_map(namespace, &prefix_ns_map);
+  status = (!namespace)? ss_StatusOK : whiteboard_node_get_prefix2ns_map(self, namespace, &prefix_ns_map);
 
   if (status!=ss_StatusOK)
     {
-      g_mutex_unlock(self->lock);
       return status;
     }
-  ssBufDesc_t *desc = ssBufDesc_new();
+  gint msgnum = whiteboard_node_next_msgnumber(self);
+  gint64 started = whiteboard_node_stats_now();
+
+  ssBufDesc_t *desc = whiteboard_node_bufdesc_get(self, 0);
   if (!desc) {
-    if (prefix_ns_map) g_hash_table_destroy(prefix_ns_map);
-    g_mutex_unlock(self->lock);
+    if (prefix_ns_map) g_hash_table_unref(prefix_ns_map);
     return ss_NotEnoughResources;
   }
 
+  whiteboard_trace(WHITEBOARD_TRACE_XML_BUILD_START, msgnum, -1, 0);
   status = addXML_start (desc, &SIB_TRIPLELIST, NULL, NULL, 0);
 
   while (status==ss_StatusOK && l && (t=(ssTriple_t *)l->data) && !invalidTriple(t,TRUE)) {
@@ -2661,26 +3493,32 @@ ssStatus_t whiteboard_node_sib_access_subscribe_template(WhiteBoardNode *self,
   status=(status)?status : addXML_end (desc, &SIB_TRIPLELIST);
 
   if (status) {
-    ssBufDesc_free(&desc);
-    if (prefix_ns_map) g_hash_table_destroy(prefix_ns_map);
-    g_mutex_unlock(self->lock);
+    whiteboard_node_bufdesc_put(self, &desc);
+    if (prefix_ns_map) g_hash_table_unref(prefix_ns_map);
     return -1; //must use -1 for now, not ssStatus_t, until a &subscriptionId parameter is used to pass back the value
   }
 
-  gint msgnum = ++(self->msgnumber);
   subscribe_message = ssBufDesc_GetMessage(desc);
-  whiteboard_util_send_method_with_reply(WHITEBOARD_DBUS_SERVICE,
-					 WHITEBOARD_DBUS_OBJECT,
-					 WHITEBOARD_DBUS_NODE_INTERFACE,
-					 WHITEBOARD_DBUS_NODE_METHOD_SUBSCRIBE,
-					 whiteboard_node_validate_connection(self),
-					 &reply,
-					 DBUS_TYPE_STRING, &nodeid,
-					 DBUS_TYPE_STRING, &self->sib,
-					 DBUS_TYPE_INT32, &msgnum,
-					 DBUS_TYPE_INT32, &type,
-					 DBUS_TYPE_STRING, &subscribe_message,
-					 WHITEBOARD_UTIL_LIST_END);
+  whiteboard_trace(WHITEBOARD_TRACE_XML_BUILD_END, msgnum, -1, ssBufDesc_GetMessageLen(desc));
+  whiteboard_node_stats_add(self, &self->stats->xml_build, started, ss_StatusOK);
+  whiteboard_node_stats_bytes(self, ssBufDesc_GetMessageLen(desc), 0);
+  whiteboard_trace(WHITEBOARD_TRACE_DBUS_SEND, msgnum, -1, ssBufDesc_GetMessageLen(desc));
+  sib = whiteboard_node_dup_sib(self);
+  if (sib)
+    whiteboard_util_send_method_with_reply(WHITEBOARD_DBUS_SERVICE,
+					   WHITEBOARD_DBUS_OBJECT,
+					   WHITEBOARD_DBUS_NODE_INTERFACE,
+					   WHITEBOARD_DBUS_NODE_METHOD_SUBSCRIBE,
+					   whiteboard_node_validate_connection(self),
+					   &reply,
+					   DBUS_TYPE_STRING, &nodeid,
+					   DBUS_TYPE_STRING, &sib,
+					   DBUS_TYPE_INT32, &msgnum,
+					   DBUS_TYPE_INT32, &type,
+					   DBUS_TYPE_STRING, &subscribe_message,
+					   WHITEBOARD_UTIL_LIST_END);
+  g_free(sib);
+  whiteboard_trace(WHITEBOARD_TRACE_REPLY_RECEIVED, msgnum, -1, 0);
   status = (reply)? ss_StatusOK : ss_InternalError;
   if(!status)
     {
@@ -2708,7 +3546,7 @@ ssStatus_t whiteboard_node_sib_access_subscribe_template(WhiteBoardNode *self,
 		{
 		  whiteboard_log_debug("Could not add query data to callback map\n");
 		  status = ss_InternalError;
-		  if (prefix_ns_map) g_hash_table_destroy(prefix_ns_map);
+		  if (prefix_ns_map) g_hash_table_unref(prefix_ns_map);
 		  g_free(sd);
 		}
 	    }
@@ -2716,8 +3554,8 @@ ssStatus_t whiteboard_node_sib_access_subscribe_template(WhiteBoardNode *self,
       dbus_message_unref(reply);
     }
 
-  ssBufDesc_free(&desc);
-  g_mutex_unlock(self->lock);
+  whiteboard_node_stats_op(self, WHITEBOARD_NODE_STAT_SUBSCRIBE, started, status);
+  whiteboard_node_bufdesc_put(self, &desc);
   whiteboard_log_debug_fe();
   return status;
 }
@@ -2743,44 +3581,52 @@ ssStatus_t whiteboard_node_sib_access_subscribe_wql_values(WhiteBoardNode *self,
   g_return_val_if_fail(pathExpr!=NULL, ss_InvalidParameter);
   g_return_val_if_fail( cb != NULL, ss_InvalidParameter);
   g_return_val_if_fail( subscription_id_p != NULL, ss_InvalidParameter);
-  g_mutex_lock(self->lock);
   *subscription_id_p = -1;
 
   const gchar *nodeid = whiteboard_node_get_uuid(self);
+  gchar *sib = NULL;
   if( !whiteboard_node_joined(self))
     {
       whiteboard_log_debug("Node (%s) not joined, can not create subscription\n",nodeid);
-      g_mutex_unlock(self->lock);
       return ss_InvalidParameter;
     }
 
-  ssBufDesc_t *desc = ssBufDesc_new();
+  gint msgnum = whiteboard_node_next_msgnumber(self);
+  gint64 started = whiteboard_node_stats_now();
+
+  ssBufDesc_t *desc = whiteboard_node_bufdesc_get(self, 0);
   if (!desc) {
-    g_mutex_unlock(self->lock);
     return ss_NotEnoughResources;
   }
 
+  whiteboard_trace(WHITEBOARD_TRACE_XML_BUILD_START, msgnum, -1, 0);
   status = addXML_query_w_wql_n_e (desc, type, pathNode, pathExpr);
   if (status) {
-    g_mutex_unlock(self->lock);
-    ssBufDesc_free(&desc);
+    whiteboard_node_bufdesc_put(self, &desc);
     return status;
   }
 
-  gint msgnum = ++(self->msgnumber);
   query = ssBufDesc_GetMessage(desc);
-  whiteboard_util_send_method_with_reply(WHITEBOARD_DBUS_SERVICE,
-					 WHITEBOARD_DBUS_OBJECT,
-					 WHITEBOARD_DBUS_NODE_INTERFACE,
-					 WHITEBOARD_DBUS_NODE_METHOD_SUBSCRIBE,
-					 whiteboard_node_validate_connection(self),
-					 &reply,
-					 DBUS_TYPE_STRING, &nodeid,
-					 DBUS_TYPE_STRING, &self->sib,
-					 DBUS_TYPE_INT32, &msgnum,
-					 DBUS_TYPE_INT32, &type,
-					 DBUS_TYPE_STRING, &query,
-					 WHITEBOARD_UTIL_LIST_END);
+  whiteboard_trace(WHITEBOARD_TRACE_XML_BUILD_END, msgnum, -1, ssBufDesc_GetMessageLen(desc));
+  whiteboard_node_stats_add(self, &self->stats->xml_build, started, ss_StatusOK);
+  whiteboard_node_stats_bytes(self, ssBufDesc_GetMessageLen(desc), 0);
+  whiteboard_trace(WHITEBOARD_TRACE_DBUS_SEND, msgnum, -1, ssBufDesc_GetMessageLen(desc));
+  sib = whiteboard_node_dup_sib(self);
+  if (sib)
+    whiteboard_util_send_method_with_reply(WHITEBOARD_DBUS_SERVICE,
+					   WHITEBOARD_DBUS_OBJECT,
+					   WHITEBOARD_DBUS_NODE_INTERFACE,
+					   WHITEBOARD_DBUS_NODE_METHOD_SUBSCRIBE,
+					   whiteboard_node_validate_connection(self),
+					   &reply,
+					   DBUS_TYPE_STRING, &nodeid,
+					   DBUS_TYPE_STRING, &sib,
+					   DBUS_TYPE_INT32, &msgnum,
+					   DBUS_TYPE_INT32, &type,
+					   DBUS_TYPE_STRING, &query,
+					   WHITEBOARD_UTIL_LIST_END);
+  g_free(sib);
+  whiteboard_trace(WHITEBOARD_TRACE_REPLY_RECEIVED, msgnum, -1, 0);
   status = (reply)? ss_StatusOK : ss_InternalError;
   if(!status)
     {
@@ -2815,8 +3661,8 @@ ssStatus_t whiteboard_node_sib_access_subscribe_wql_values(WhiteBoardNode *self,
       dbus_message_unref(reply);
     }
 
-  ssBufDesc_free(&desc);
-  g_mutex_unlock(self->lock);
+  whiteboard_node_stats_op(self, WHITEBOARD_NODE_STAT_SUBSCRIBE, started, status);
+  whiteboard_node_bufdesc_put(self, &desc);
   whiteboard_log_debug_fe();
   return status;
 }
@@ -2828,117 +3674,1117 @@ ssStatus_t whiteboard_node_sib_access_unsubscribe(WhiteBoardNode *self,
 
   whiteboard_log_debug_fb();
   g_return_val_if_fail(self!=NULL, ss_InvalidParameter);
-  g_mutex_lock(self->lock);
   const gchar *nodeid = whiteboard_node_get_uuid(self);
-  gint msgnum = ++(self->msgnumber);
+  gchar *sib = NULL;
+  gint msgnum = whiteboard_node_next_msgnumber(self);
   if( !whiteboard_node_joined(self))
     {
       whiteboard_log_debug("Node (%s) not joined, can not unsubscribe\n",nodeid);
-      g_mutex_unlock(self->lock);
       return ss_InvalidParameter;
     }
   else
     {
-      if((sb =  whiteboard_node_get_subscription_data(self, access_id)) != NULL)
+      gchar *subscription_id = NULL;
+
+      // the flags are checked and set under the lock, so that only one
+      // thread sends the unsubscribe
+      g_mutex_lock(self->subscription_lock);
+      sb = (SubscriptionData*) g_hash_table_lookup(self->subscription_map, GINT_TO_POINTER(access_id));
+      if (sb && sb->subscription_id != NULL && sb->flags == 0)
 	{
-	  g_return_val_if_fail(sb->subscription_id != NULL, ss_InvalidParameter);
-	  g_return_val_if_fail(sb->flags == 0, ss_InvalidParameter);
 	  sb->flags = SUBSCRIBE_FLAGS_UNSUBSCRIBE;
-	  whiteboard_util_send_signal(WHITEBOARD_DBUS_OBJECT,
-				      WHITEBOARD_DBUS_NODE_INTERFACE,
-				      WHITEBOARD_DBUS_NODE_SIGNAL_UNSUBSCRIBE,
-				      whiteboard_node_validate_connection(self),
-				      DBUS_TYPE_INT32, &access_id,
-				      DBUS_TYPE_STRING, &nodeid,
-				      DBUS_TYPE_STRING, &self->sib,
-				      DBUS_TYPE_INT32, &msgnum,
-				      DBUS_TYPE_STRING, &sb->subscription_id,
-				      WHITEBOARD_UTIL_LIST_END);
+	  subscription_id = g_strdup(sb->subscription_id);
+	}
+      g_mutex_unlock(self->subscription_lock);
+
+      if(sb != NULL)
+	{
+	  g_return_val_if_fail(subscription_id != NULL, ss_InvalidParameter);
+	  whiteboard_trace(WHITEBOARD_TRACE_DBUS_SEND, msgnum, access_id, 0);
+	  sib = whiteboard_node_dup_sib(self);
+	  if (sib)
+	    whiteboard_util_send_signal(WHITEBOARD_DBUS_OBJECT,
+					WHITEBOARD_DBUS_NODE_INTERFACE,
+					WHITEBOARD_DBUS_NODE_SIGNAL_UNSUBSCRIBE,
+					whiteboard_node_validate_connection(self),
+					DBUS_TYPE_INT32, &access_id,
+					DBUS_TYPE_STRING, &nodeid,
+					DBUS_TYPE_STRING, &sib,
+					DBUS_TYPE_INT32, &msgnum,
+					DBUS_TYPE_STRING, &subscription_id,
+					WHITEBOARD_UTIL_LIST_END);
+	  g_free(sib);
+	  g_free(subscription_id);
 	  //success = 0;
 	}
       else
 	{
 	  whiteboard_log_debug("Subscription /w access_id: %d not found, can not unsubscribe\n", access_id);
-	  g_mutex_unlock(self->lock);
 	  return ss_InvalidParameter;
 	}
     }
   whiteboard_log_debug_fe();
-  g_mutex_unlock(self->lock);
   return ss_StatusOK;
 }
 
 /*****************************************************************************
- * Custom commands
+ * Asynchronous SIB ACCESS functions
  *****************************************************************************/
 
-guint whiteboard_node_send_custom_command(WhiteBoardNode* self, WhiteBoardCmd* cmd)
+static AsyncRequestData *whiteboard_node_async_request_new(WhiteBoardNode *self,
+							   WhiteBoardNodeAsyncCompleteCB cb,
+							   gpointer user_data,
+							   SubscriptionData *sd)
 {
-  guint serial = 0;
-
-  whiteboard_log_debug_fb();
-
-  g_return_val_if_fail(self != NULL, 0);
-  g_return_val_if_fail(cmd != NULL, 0);
-
-  serial = whiteboard_cmd_send(cmd, self->connection);
-
-  whiteboard_log_debug_fe();
-
-  return serial;
+  AsyncRequestData *req = g_new0(AsyncRequestData, 1);
+
+  req->node = WHITEBOARD_NODE(g_object_ref(self));
+  req->cb = cb;
+  req->user_data = user_data;
+  req->sd = sd;
+  req->started = whiteboard_node_stats_now();
+  req->kind = WHITEBOARD_NODE_STAT_LAST; // set by the sender, not recorded otherwise
+  return req;
 }
 
-static SubscriptionData *whiteboard_node_get_subscription_data(WhiteBoardNode *self, gint access_id)
+static void whiteboard_node_async_request_free(void *data)
 {
-  SubscriptionData* sd = NULL;
-  
-  whiteboard_log_debug_fb();
-  g_return_val_if_fail(self != NULL, NULL);
-  
-  sd = (SubscriptionData*) g_hash_table_lookup(self->subscription_map,
-					       GINT_TO_POINTER(access_id));
-  
-  whiteboard_log_debug_fe();
-  
-  return sd;
+  AsyncRequestData *req = (AsyncRequestData *)data;
+
+  if (req->sd)
+    {
+      if (req->sd->ns_map)
+	whiteboard_node_ns_map_unref(req->sd->ns_map);
+      g_free(req->sd);
+    }
+  g_object_unref(req->node);
+  g_free(req);
 }
 
-static gboolean whiteboard_node_add_subscription_data(WhiteBoardNode *self, gint access_id, SubscriptionData *sd)
+/* Calls the query callback of sd without results, like the QUERY method
+   return handling does when the SIB reports an error */
+static void whiteboard_node_query_failed(SubscriptionData *sd, ssStatus_t status)
 {
-  gboolean ret = FALSE;
-  whiteboard_log_debug_fb();
-  // check that not existing previously
-  if( whiteboard_node_get_subscription_data(self, access_id) == NULL)
+  switch(sd->type)
     {
-      g_hash_table_insert(self->subscription_map, GINT_TO_POINTER(access_id), (gpointer)sd);
-      ret = TRUE;
+    case QueryTypeWQLRelated:
+    case QueryTypeWQLIsType:
+    case QueryTypeWQLIsSubType:
+      sd->cb.q_wql_boolean(status, FALSE, sd->user_data);
+      break;
+    case QueryTypeTemplate:
+      sd->cb.q_template(status, NULL, sd->user_data);
+      break;
+    case QueryTypeWQLValues:
+    case QueryTypeWQLNodeTypes:
+      sd->cb.q_wql_values(status, NULL, sd->user_data);
+      break;
+    case QueryTypeSPARQLSelect:
+      sd->cb.q_sparql_select(status, NULL, NULL, sd->user_data);
+      break;
+    default:
+      break;
     }
-  whiteboard_log_debug_fe();
-  return ret;
 }
 
-static gboolean whiteboard_node_remove_subscription_data(WhiteBoardNode *self, gint access_id)
+static void whiteboard_node_async_reply(DBusPendingCall *pending, void *data)
 {
-  gboolean ret = FALSE;
-  SubscriptionData *sd = NULL;
-  whiteboard_log_debug_fb();
-  // check that not existing previously
-  if( (sd = whiteboard_node_get_subscription_data(self, access_id) )!= NULL)
-    {
-      ret = g_hash_table_remove(self->subscription_map, GINT_TO_POINTER(access_id));
-      // subscription data freed here...
-      if(sd->subscription_id)
-	g_free(sd->subscription_id);
+  AsyncRequestData *req = (AsyncRequestData *)data;
+  DBusMessage *reply = NULL;
+  ssStatus_t status = ss_OperationFailed;
+  gboolean query_sent = FALSE;
 
-      if (sd->prefix_ns_map)
-	g_hash_table_destroy(sd->prefix_ns_map);
+  whiteboard_log_debug_fb();
 
-      g_free(sd);
-    }
-  else
+  reply = dbus_pending_call_steal_reply(pending);
+  whiteboard_trace(WHITEBOARD_TRACE_REPLY_RECEIVED, req->msgnumber, -1, 0);
+  if (reply == NULL ||
+      dbus_message_get_type(reply) != DBUS_MESSAGE_TYPE_METHOD_RETURN)
     {
-      whiteboard_log_debug("Can not remove subscription data, subscription id:%d not found\n", access_id);
+      whiteboard_log_debug("No reply for asynchronous request\n");
     }
-  whiteboard_log_debug_fe();
-  return ret;
+  else if (req->sd)
+    {
+      gint access_id = -1;
+
+      whiteboard_util_parse_message(reply,
+				    DBUS_TYPE_INT32, &access_id,
+				    WHITEBOARD_UTIL_LIST_END);
+      if (access_id <= 0)
+	{
+	  whiteboard_log_debug("Could not create query..\n");
+	}
+      else
+	{
+	  whiteboard_log_debug("Got query access_id:%d\n", access_id);
+	  if (whiteboard_node_add_subscription_data(req->node, access_id, req->sd))
+	    {
+	      req->sd = NULL; // owned by subscription_map from now on
+	      query_sent = TRUE;
+	      status = ss_StatusOK;
+	    }
+	  else
+	    {
+	      whiteboard_log_debug("Could not add subscription data to subscription map\n");
+	      status = ss_InternalError;
+	    }
+	}
+    }
+  else
+    {
+      gint response_status = -1;
+      gchar *response = NULL;
+
+      if (whiteboard_util_parse_message(reply,
+					DBUS_TYPE_INT32, &response_status,
+					DBUS_TYPE_STRING, &response,
+					WHITEBOARD_UTIL_LIST_END) &&
+	  NULL != response)
+	{
+	  whiteboard_log_debug("Async response: %s\n", response);
+	  status = response_status;
+	}
+      else
+	{
+	  whiteboard_log_debug("Invalid async response\n");
+	}
+    }
+
+  if (reply)
+    dbus_message_unref(reply);
+
+  if (req->sd)
+    {
+      whiteboard_node_stats_op(req->node, whiteboard_node_stat_kind_for_query(req->sd->type), req->started, status);
+      whiteboard_node_query_failed(req->sd, status);
+    }
+  else if (!query_sent) // otherwise recorded when the results arrive
+    {
+      whiteboard_node_stats_op(req->node, req->kind, req->started, status);
+      if (req->cb)
+	req->cb(req->node, status, req->user_data);
+    }
+
+  whiteboard_log_debug_fe();
+}
+
+/* Estimates the size of the XML generated for a triple list, namespace
+   prefixes expanded by the generator are not taken into account */
+static guint whiteboard_node_triplelist_size_hint(GSList *triples)
+{
+  GSList *l;
+  ssTriple_t *t;
+  guint size = 2*SIB_TRIPLELIST.len + 5;
+
+  for (l = triples; l; l = l->next)
+    {
+      t = (ssTriple_t *)l->data;
+      size += TRIPLE_XML_OVERHEAD;
+      if (t && t->subject)
+	size += strlen((char *)t->subject);
+      if (t && t->predicate)
+	size += strlen((char *)t->predicate);
+      if (t && t->object)
+	size += strlen((char *)t->object);
+    }
+  return size;
+}
+
+static ssStatus_t whiteboard_node_triplelist_to_xml(ssBufDesc_t *bd,
+						    GSList *triples,
+						    GHashTable *prefix_ns_map,
+						    gboolean patternMatching)
+{
+  GSList *l = triples;
+  ssTriple_t *t;
+  ssStatus_t status;
+
+  status = ssBufDesc_reserve(bd, ssBufDesc_GetMessageLen(bd) + whiteboard_node_triplelist_size_hint(triples));
+  status = (status)?status : addXML_start (bd, &SIB_TRIPLELIST, NULL, NULL, 0);
+  while (status==ss_StatusOK && l && (t=(ssTriple_t *)l->data) && !invalidTriple(t,patternMatching)) {
+    status = addXML_templateTriple(t, prefix_ns_map, (gpointer)bd);
+    l=l->next;
+  }
+  if (!status && l!=NULL)
+    status = ss_InvalidTripleSpecification;
+
+  return (status)?status : addXML_end (bd, &SIB_TRIPLELIST);
+}
+
+/* Sends a generated query, sd is owned by the request afterwards (also on
+   failure) */
+static ssStatus_t whiteboard_node_query_async(WhiteBoardNode *self,
+					      QueryType type,
+					      gint msgnum,
+					      ssBufDesc_t *bd,
+					      SubscriptionData *sd)
+{
+  AsyncRequestData *req = NULL;
+  ssStatus_t status = ss_StatusOK;
+  gchar *query = ssBufDesc_GetMessage(bd);
+
+  sd->type = type;
+  req = whiteboard_node_async_request_new(self, NULL, NULL, sd);
+  sd->started = req->started;
+  whiteboard_node_stats_bytes(self, ssBufDesc_GetMessageLen(bd), 0);
+
+  const gchar *nodeid = whiteboard_node_get_uuid(self);
+  gchar *sib = NULL;
+  req->msgnumber = msgnum;
+  whiteboard_trace(WHITEBOARD_TRACE_DBUS_SEND, msgnum, -1, ssBufDesc_GetMessageLen(bd));
+  sib = whiteboard_node_dup_sib(self);
+  if (!sib)
+    {
+      whiteboard_log_debug("Node (%s) not joined, can not create query\n",nodeid);
+      status = ss_InvalidParameter;
+    }
+  else if (!whiteboard_util_send_method_async(WHITEBOARD_DBUS_SERVICE,
+					      WHITEBOARD_DBUS_OBJECT,
+					      WHITEBOARD_DBUS_NODE_INTERFACE,
+					      WHITEBOARD_DBUS_NODE_METHOD_QUERY,
+					      whiteboard_node_validate_connection(self),
+					      whiteboard_node_async_reply,
+					      req,
+					      whiteboard_node_async_request_free,
+					      DBUS_TYPE_STRING, &nodeid,
+					      DBUS_TYPE_STRING, &sib,
+					      DBUS_TYPE_INT32, &msgnum,
+					      DBUS_TYPE_INT32, &type,
+					      DBUS_TYPE_STRING, &query,
+					      WHITEBOARD_UTIL_LIST_END))
+    {
+      status = ss_OperationFailed;
+    }
+  g_free(sib);
+
+  if (status)
+    whiteboard_node_async_request_free(req);
+  return status;
+}
+
+/* Sends an already generated triple list with method (insert or remove) */
+static ssStatus_t whiteboard_node_send_triplelist_async(WhiteBoardNode *self,
+							const gchar *method,
+							gint msgnum,
+							const gchar *triplelist,
+							WhiteBoardNodeAsyncCompleteCB cb,
+							gpointer data)
+{
+  EncodingType encoding = EncodingM3XML;
+  AsyncRequestData *req = NULL;
+  ssStatus_t status = ss_StatusOK;
+
+  req = whiteboard_node_async_request_new(self, cb, data, NULL);
+  req->kind = whiteboard_node_stat_kind_for_method(method);
+  whiteboard_node_stats_bytes(self, strlen(triplelist), 0);
+
+  const gchar *nodeid = whiteboard_node_get_uuid(self);
+  gchar *sib = NULL;
+  req->msgnumber = msgnum;
+  whiteboard_trace(WHITEBOARD_TRACE_DBUS_SEND, msgnum, -1, strlen(triplelist));
+  sib = whiteboard_node_dup_sib(self);
+  if (!sib)
+    {
+      whiteboard_log_debug("Node (%s) not joined, can not %s triples\n", nodeid, method);
+      status = ss_InvalidParameter;
+    }
+  else if (!whiteboard_util_send_method_async(WHITEBOARD_DBUS_SERVICE,
+					      WHITEBOARD_DBUS_OBJECT,
+					      WHITEBOARD_DBUS_NODE_INTERFACE,
+					      method,
+					      whiteboard_node_validate_connection(self),
+					      whiteboard_node_async_reply,
+					      req,
+					      whiteboard_node_async_request_free,
+					      DBUS_TYPE_STRING, &nodeid,
+					      DBUS_TYPE_STRING, &sib,
+					      DBUS_TYPE_INT32, &msgnum,
+					      DBUS_TYPE_INT32, &encoding,
+					      DBUS_TYPE_STRING, &triplelist,
+					      WHITEBOARD_UTIL_LIST_END))
+    {
+      status = ss_OperationFailed;
+    }
+  g_free(sib);
+
+  if (status)
+    whiteboard_node_async_request_free(req);
+  return status;
+}
+
+static ssStatus_t whiteboard_node_modify_async(WhiteBoardNode *self,
+					       const gchar *method,
+					       GSList *triples,
+					       gboolean patternMatching,
+					       const gchar *namespace,
+					       WhiteBoardNodeAsyncCompleteCB cb,
+					       gpointer data)
+{
+  GHashTable *prefix_ns_map = NULL;
+  ssBufDesc_t *bd = NULL;
+  ssStatus_t status;
+  gint msgnum = whiteboard_node_next_msgnumber(self);
+  gint64 started;
+
+  status = (!namespace)? ss_StatusOK : whiteboard_node_get_prefix2ns_map(self, namespace, &prefix_ns_map);
+  if (status)
+    return status;
+
+  bd = whiteboard_node_bufdesc_get(self, 0);
+  if (!bd) {
+    if (prefix_ns_map) g_hash_table_unref(prefix_ns_map);
+    return ss_NotEnoughResources;
+  }
+
+  started = whiteboard_node_stats_now();
+  whiteboard_trace(WHITEBOARD_TRACE_XML_BUILD_START, msgnum, -1, 0);
+  status = whiteboard_node_triplelist_to_xml(bd, triples, prefix_ns_map, patternMatching);
+  if (prefix_ns_map) g_hash_table_unref(prefix_ns_map);
+  if (!status)
+    {
+      whiteboard_trace(WHITEBOARD_TRACE_XML_BUILD_END, msgnum, -1, ssBufDesc_GetMessageLen(bd));
+      whiteboard_node_stats_add(self, &self->stats->xml_build, started, ss_StatusOK);
+      status = whiteboard_node_send_triplelist_async(self, method, msgnum, ssBufDesc_GetMessage(bd), cb, data);
+    }
+
+  whiteboard_node_bufdesc_put(self, &bd);
+  return status;
+}
+
+ssStatus_t whiteboard_node_sib_access_insert_M3Triples_async(WhiteBoardNode *self,
+							     GSList *triples,
+							     const gchar *namespace,
+							     WhiteBoardNodeAsyncCompleteCB cb,
+							     gpointer data)
+{
+  ssStatus_t status;
+
+  whiteboard_log_debug_fb();
+  g_return_val_if_fail(self!=NULL, ss_InvalidParameter);
+  g_return_val_if_fail(triples != NULL && triples->data!=NULL, ss_InvalidParameter);
+
+  status = whiteboard_node_modify_async(self, WHITEBOARD_DBUS_NODE_METHOD_INSERT,
+					triples, FALSE, namespace, cb, data);
+  whiteboard_log_debug_fe();
+  return status;
+}
+
+ssStatus_t whiteboard_node_sib_access_remove_M3Triples_async(WhiteBoardNode *self,
+							     GSList *triples,
+							     const gchar *namespace,
+							     WhiteBoardNodeAsyncCompleteCB cb,
+							     gpointer data)
+{
+  ssStatus_t status;
+
+  whiteboard_log_debug_fb();
+  g_return_val_if_fail(self!=NULL, ss_InvalidParameter);
+  g_return_val_if_fail(triples != NULL && triples->data!=NULL, ss_InvalidParameter);
+
+  status = whiteboard_node_modify_async(self, WHITEBOARD_DBUS_NODE_METHOD_REMOVE,
+					triples, TRUE, namespace, cb, data);
+  whiteboard_log_debug_fe();
+  return status;
+}
+
+ssStatus_t whiteboard_node_sib_access_update_M3Triples_async(WhiteBoardNode *self,
+							     GSList *insert_triples,
+							     GSList *remove_triples,
+							     const gchar *namespace,
+							     WhiteBoardNodeAsyncCompleteCB cb,
+							     gpointer data)
+{
+  EncodingType encoding = EncodingM3XML;
+  AsyncRequestData *req = NULL;
+  GHashTable *prefix_ns_map = NULL;
+  ssBufDesc_t *bd_insert = NULL;
+  ssBufDesc_t *bd_remove = NULL;
+  gchar *insertlist = NULL;
+  gchar *removelist = NULL;
+  ssStatus_t status;
+  gint msgnum;
+  gint64 started;
+
+  whiteboard_log_debug_fb();
+  g_return_val_if_fail(self!=NULL, ss_InvalidParameter);
+  g_return_val_if_fail(insert_triples != NULL || remove_triples!=NULL, ss_InvalidParameter);
+  g_return_val_if_fail(insert_triples == NULL || insert_triples->data!=NULL, ss_InvalidParameter);
+  g_return_val_if_fail(remove_triples == NULL || remove_triples->data!=NULL, ss_InvalidParameter);
+
+  status = (!namespace)? ss_StatusOK : whiteboard_node_get_prefix2ns_map(self, namespace, &prefix_ns_map);
+  if (status)
+    return status;
+
+  bd_insert = whiteboard_node_bufdesc_get(self, 0);
+  bd_remove = whiteboard_node_bufdesc_get(self, 0);
+  if (!bd_insert || !bd_remove)
+    status = ss_NotEnoughResources;
+
+  msgnum = whiteboard_node_next_msgnumber(self);
+  started = whiteboard_node_stats_now();
+  whiteboard_trace(WHITEBOARD_TRACE_XML_BUILD_START, msgnum, -1, 0);
+  status = (status)?status : whiteboard_node_triplelist_to_xml(bd_insert, insert_triples, prefix_ns_map, FALSE);
+  status = (status)?status : whiteboard_node_triplelist_to_xml(bd_remove, remove_triples, prefix_ns_map, TRUE);
+  if (prefix_ns_map) g_hash_table_unref(prefix_ns_map);
+
+  if (!status)
+    {
+      insertlist = ssBufDesc_GetMessage(bd_insert);
+      removelist = ssBufDesc_GetMessage(bd_remove);
+      whiteboard_trace(WHITEBOARD_TRACE_XML_BUILD_END, msgnum, -1,
+		       ssBufDesc_GetMessageLen(bd_insert) + ssBufDesc_GetMessageLen(bd_remove));
+      whiteboard_node_stats_add(self, &self->stats->xml_build, started, ss_StatusOK);
+      req = whiteboard_node_async_request_new(self, cb, data, NULL);
+      req->kind = WHITEBOARD_NODE_STAT_UPDATE;
+      whiteboard_node_stats_bytes(self, strlen(insertlist) + strlen(removelist), 0);
+
+      const gchar *nodeid = whiteboard_node_get_uuid(self);
+      gchar *sib = NULL;
+      req->msgnumber = msgnum;
+      whiteboard_trace(WHITEBOARD_TRACE_DBUS_SEND, msgnum, -1,
+		       ssBufDesc_GetMessageLen(bd_insert) + ssBufDesc_GetMessageLen(bd_remove));
+      sib = whiteboard_node_dup_sib(self);
+      if (!sib)
+	{
+	  whiteboard_log_debug("Node (%s) has not joined, can not update triples\n",nodeid);
+	  status = ss_InvalidParameter;
+	}
+      else if (!whiteboard_util_send_method_async(WHITEBOARD_DBUS_SERVICE,
+						  WHITEBOARD_DBUS_OBJECT,
+						  WHITEBOARD_DBUS_NODE_INTERFACE,
+						  WHITEBOARD_DBUS_NODE_METHOD_UPDATE,
+						  whiteboard_node_validate_connection(self),
+						  whiteboard_node_async_reply,
+						  req,
+						  whiteboard_node_async_request_free,
+						  DBUS_TYPE_STRING, &nodeid,
+						  DBUS_TYPE_STRING, &sib,
+						  DBUS_TYPE_INT32, &msgnum,
+						  DBUS_TYPE_INT32, &encoding,
+						  DBUS_TYPE_STRING, &insertlist,
+						  DBUS_TYPE_STRING, &removelist,
+						  WHITEBOARD_UTIL_LIST_END))
+	{
+	  status = ss_OperationFailed;
+	}
+      g_free(sib);
+
+      if (status)
+	whiteboard_node_async_request_free(req);
+    }
+
+  if (bd_insert) whiteboard_node_bufdesc_put(self, &bd_insert);
+  if (bd_remove) whiteboard_node_bufdesc_put(self, &bd_remove);
+  whiteboard_log_debug_fe();
+  return status;
+}
+
+ssStatus_t whiteboard_node_sib_access_query_template_async(WhiteBoardNode *self,
+							   GSList* templates,
+							   const gchar *namespace,
+							   WhiteBoardNodeQueryTemplateCB cb,
+							   gpointer data)
+{
+  NsMapData *ns_map = NULL;
+  SubscriptionData *sd = NULL;
+  ssBufDesc_t *bd = NULL;
+  ssStatus_t status;
+  gint msgnum;
+  gint64 started;
+
+  whiteboard_log_debug_fb();
+  g_return_val_if_fail(self!=NULL, ss_InvalidParameter);
+  g_return_val_if_fail( cb != NULL ,ss_InvalidParameter);
+  g_return_val_if_fail( templates != NULL , ss_InvalidParameter);
+
+  status = (!namespace)? ss_StatusOK : whiteboard_node_get_ns_map(self, namespace, &ns_map);
+  if (status)
+    return status;
+
+  bd = whiteboard_node_bufdesc_get(self, 0);
+  if (!bd) {
+    if (ns_map) whiteboard_node_ns_map_unref(ns_map);
+    return ss_NotEnoughResources;
+  }
+
+  msgnum = whiteboard_node_next_msgnumber(self);
+  started = whiteboard_node_stats_now();
+  whiteboard_trace(WHITEBOARD_TRACE_XML_BUILD_START, msgnum, -1, 0);
+  status = whiteboard_node_triplelist_to_xml(bd, templates, NS_MAP_PREFIX2NS(ns_map), TRUE);
+  if (status)
+    {
+      if (ns_map) whiteboard_node_ns_map_unref(ns_map);
+    }
+  else
+    {
+      whiteboard_trace(WHITEBOARD_TRACE_XML_BUILD_END, msgnum, -1, ssBufDesc_GetMessageLen(bd));
+      whiteboard_node_stats_add(self, &self->stats->xml_build, started, ss_StatusOK);
+      sd = g_new0(SubscriptionData, 1);
+      sd->cb.q_template = cb;
+      sd->ns_map = ns_map;
+      sd->user_data = data;
+      status = whiteboard_node_query_async(self, QueryTypeTemplate, msgnum, bd, sd);
+    }
+
+  whiteboard_node_bufdesc_put(self, &bd);
+  whiteboard_log_debug_fe();
+  return status;
+}
+
+ssStatus_t whiteboard_node_sib_access_query_sparql_select_async(WhiteBoardNode *self,
+								GSList* select,
+								GSList* where,
+								GSList* optional_lists,
+								const gchar *namespace,
+								WhiteBoardNodeQuerySPARQLselectCB cb,
+								gpointer data)
+{
+  NsMapData *ns_map = NULL;
+  SubscriptionData *sd = NULL;
+  ssBufDesc_t *bd = NULL;
+  ssStatus_t status;
+  gint msgnum;
+  gint64 started;
+
+  whiteboard_log_debug_fb();
+  g_return_val_if_fail(self!=NULL, ss_InvalidParameter);
+  g_return_val_if_fail( cb != NULL ,ss_InvalidParameter);
+  g_return_val_if_fail( where != NULL || optional_lists != NULL, ss_InvalidParameter);
+  g_return_val_if_fail( optional_lists == NULL || optional_lists->data != NULL, ss_InvalidParameter);
+
+  status = (!namespace)? ss_StatusOK : whiteboard_node_get_ns_map(self, namespace, &ns_map);
+  if (status)
+    return status;
+
+  bd = whiteboard_node_bufdesc_get(self, 0);
+  if (!bd) {
+    if (ns_map) whiteboard_node_ns_map_unref(ns_map);
+    return ss_NotEnoughResources;
+  }
+
+  msgnum = whiteboard_node_next_msgnumber(self);
+  started = whiteboard_node_stats_now();
+  whiteboard_trace(WHITEBOARD_TRACE_XML_BUILD_START, msgnum, -1, 0);
+  status = generateSPARQLSelectQueryString(bd, select, where, optional_lists, NS_MAP_PREFIX2NS(ns_map));
+  if (status)
+    {
+      if (ns_map) whiteboard_node_ns_map_unref(ns_map);
+    }
+  else
+    {
+      whiteboard_trace(WHITEBOARD_TRACE_XML_BUILD_END, msgnum, -1, ssBufDesc_GetMessageLen(bd));
+      whiteboard_node_stats_add(self, &self->stats->xml_build, started, ss_StatusOK);
+      sd = g_new0(SubscriptionData, 1);
+      sd->cb.q_sparql_select = cb;
+      sd->ns_map = ns_map;
+      sd->user_data = data;
+      status = whiteboard_node_query_async(self, QueryTypeSPARQLSelect, msgnum, bd, sd);
+    }
+
+  whiteboard_node_bufdesc_put(self, &bd);
+  whiteboard_log_debug_fe();
+  return status;
+}
+
+ssStatus_t whiteboard_node_sib_access_query_wql_values_async(WhiteBoardNode *self,
+							     const ssPathNode_t *node,
+							     const gchar *pathExpr,
+							     WhiteBoardNodeQueryWQLnodelistCB cb,
+							     gpointer data)
+{
+  SubscriptionData *sd = NULL;
+  ssBufDesc_t *bd = NULL;
+  ssStatus_t status;
+  gint msgnum;
+  gint64 started;
+
+  whiteboard_log_debug_fb();
+  g_return_val_if_fail(self!=NULL, ss_InvalidParameter);
+  g_return_val_if_fail( cb != NULL ,ss_InvalidParameter);
+  g_return_val_if_fail( node != NULL , ss_InvalidParameter);
+  g_return_val_if_fail( pathExpr != NULL , ss_InvalidParameter);
+
+  bd = whiteboard_node_bufdesc_get(self, 0);
+  if (!bd)
+    return ss_NotEnoughResources;
+
+  msgnum = whiteboard_node_next_msgnumber(self);
+  started = whiteboard_node_stats_now();
+  whiteboard_trace(WHITEBOARD_TRACE_XML_BUILD_START, msgnum, -1, 0);
+  status = addXML_query_w_wql_n_e (bd, QueryTypeWQLValues, node, pathExpr);
+  if (!status)
+    {
+      whiteboard_trace(WHITEBOARD_TRACE_XML_BUILD_END, msgnum, -1, ssBufDesc_GetMessageLen(bd));
+      whiteboard_node_stats_add(self, &self->stats->xml_build, started, ss_StatusOK);
+      sd = g_new0(SubscriptionData, 1);
+      sd->cb.q_wql_values = cb;
+      sd->user_data = data;
+      status = whiteboard_node_query_async(self, QueryTypeWQLValues, msgnum, bd, sd);
+    }
+
+  whiteboard_node_bufdesc_put(self, &bd);
+  whiteboard_log_debug_fe();
+  return status;
+}
+
+ssStatus_t whiteboard_node_sib_access_query_wql_nodeClasses_async(WhiteBoardNode *self,
+								  const ssPathNode_t *pathNode,
+								  WhiteBoardNodeQueryWQLnodelistCB cb,
+								  gpointer data)
+{
+  SubscriptionData *sd = NULL;
+  ssBufDesc_t *bd = NULL;
+  ssStatus_t status;
+  gint msgnum;
+  gint64 started;
+
+  whiteboard_log_debug_fb();
+  g_return_val_if_fail(self!=NULL, ss_InvalidParameter);
+  g_return_val_if_fail( pathNode != NULL && pathNode->string != NULL &&
+			(pathNode->nodeType == ssElement_TYPE_URI || pathNode->nodeType == ssElement_TYPE_LIT),
+			ss_InvalidParameter);
+  g_return_val_if_fail( cb != NULL, ss_InvalidParameter);
+
+  bd = whiteboard_node_bufdesc_get(self, 0);
+  if (!bd)
+    return ss_NotEnoughResources;
+
+  msgnum = whiteboard_node_next_msgnumber(self);
+  started = whiteboard_node_stats_now();
+  whiteboard_trace(WHITEBOARD_TRACE_XML_BUILD_START, msgnum, -1, 0);
+  status = addXML_query_w_wql_n (bd, QueryTypeWQLNodeTypes, pathNode);
+  if (!status)
+    {
+      whiteboard_trace(WHITEBOARD_TRACE_XML_BUILD_END, msgnum, -1, ssBufDesc_GetMessageLen(bd));
+      whiteboard_node_stats_add(self, &self->stats->xml_build, started, ss_StatusOK);
+      sd = g_new0(SubscriptionData, 1);
+      sd->cb.q_wql_types = cb;
+      sd->user_data = data;
+      status = whiteboard_node_query_async(self, QueryTypeWQLNodeTypes, msgnum, bd, sd);
+    }
+
+  whiteboard_node_bufdesc_put(self, &bd);
+  whiteboard_log_debug_fe();
+  return status;
+}
+
+ssStatus_t whiteboard_node_sib_access_query_wql_related_async(WhiteBoardNode *self,
+							      const ssPathNode_t *startNode,
+							      const gchar *pathExpr,
+							      const ssPathNode_t *endNode,
+							      WhiteBoardNodeQSCommonWQLbooleanCB cb,
+							      gpointer data)
+{
+  SubscriptionData *sd = NULL;
+  ssBufDesc_t *bd = NULL;
+  ssStatus_t status;
+  gint msgnum;
+  gint64 started;
+
+  whiteboard_log_debug_fb();
+  g_return_val_if_fail(self!=NULL, ss_InvalidParameter);
+  g_return_val_if_fail(startNode != NULL && startNode->string!=NULL && 
+		       (startNode->nodeType==ssElement_TYPE_URI || startNode->nodeType==ssElement_TYPE_LIT), ss_InvalidParameter);
+  g_return_val_if_fail(pathExpr!=NULL, ss_InvalidParameter);
+  g_return_val_if_fail(endNode != NULL && endNode->string!=NULL && 
+		       (endNode->nodeType==ssElement_TYPE_URI || endNode->nodeType==ssElement_TYPE_LIT), ss_InvalidParameter);
+  g_return_val_if_fail( cb != NULL, ss_InvalidParameter);
+
+  bd = whiteboard_node_bufdesc_get(self, 0);
+  if (!bd)
+    return ss_NotEnoughResources;
+
+  msgnum = whiteboard_node_next_msgnumber(self);
+  started = whiteboard_node_stats_now();
+  whiteboard_trace(WHITEBOARD_TRACE_XML_BUILD_START, msgnum, -1, 0);
+  status = addXML_query_w_wql_n_e_n (bd, QueryTypeWQLRelated, startNode, pathExpr, endNode);
+  if (!status)
+    {
+      whiteboard_trace(WHITEBOARD_TRACE_XML_BUILD_END, msgnum, -1, ssBufDesc_GetMessageLen(bd));
+      whiteboard_node_stats_add(self, &self->stats->xml_build, started, ss_StatusOK);
+      sd = g_new0(SubscriptionData, 1);
+      sd->cb.q_wql_boolean = cb;
+      sd->user_data = data;
+      status = whiteboard_node_query_async(self, QueryTypeWQLRelated, msgnum, bd, sd);
+    }
+
+  whiteboard_node_bufdesc_put(self, &bd);
+  whiteboard_log_debug_fe();
+  return status;
+}
+
+ssStatus_t whiteboard_node_sib_access_query_wql_ofClass_async(WhiteBoardNode *self,
+							      const ssPathNode_t *pathNode,
+							      const ssPathNode_t *classNode,
+							      WhiteBoardNodeQSCommonWQLbooleanCB cb,
+							      gpointer data)
+{
+  SubscriptionData *sd = NULL;
+  ssBufDesc_t *bd = NULL;
+  ssStatus_t status;
+  gint msgnum;
+  gint64 started;
+
+  whiteboard_log_debug_fb();
+  g_return_val_if_fail(self!=NULL, ss_InvalidParameter);
+  g_return_val_if_fail(pathNode != NULL && pathNode->string!=NULL && 
+		       (pathNode->nodeType==ssElement_TYPE_URI || pathNode->nodeType==ssElement_TYPE_LIT), ss_InvalidParameter);
+  g_return_val_if_fail(classNode != NULL && classNode->string!=NULL && 
+		       classNode->nodeType==ssElement_TYPE_URI, ss_InvalidParameter);
+  g_return_val_if_fail( cb != NULL, ss_InvalidParameter);
+
+  bd = whiteboard_node_bufdesc_get(self, 0);
+  if (!bd)
+    return ss_NotEnoughResources;
+
+  msgnum = whiteboard_node_next_msgnumber(self);
+  started = whiteboard_node_stats_now();
+  whiteboard_trace(WHITEBOARD_TRACE_XML_BUILD_START, msgnum, -1, 0);
+  status = addXML_query_w_wql_n_n (bd, QueryTypeWQLIsType, pathNode, classNode);
+  if (!status)
+    {
+      whiteboard_trace(WHITEBOARD_TRACE_XML_BUILD_END, msgnum, -1, ssBufDesc_GetMessageLen(bd));
+      whiteboard_node_stats_add(self, &self->stats->xml_build, started, ss_StatusOK);
+      sd = g_new0(SubscriptionData, 1);
+      sd->cb.q_wql_boolean = cb;
+      sd->user_data = data;
+      status = whiteboard_node_query_async(self, QueryTypeWQLIsType, msgnum, bd, sd);
+    }
+
+  whiteboard_node_bufdesc_put(self, &bd);
+  whiteboard_log_debug_fe();
+  return status;
+}
+
+ssStatus_t whiteboard_node_sib_access_query_wql_isSubclass_async(WhiteBoardNode *self,
+								 const ssPathNode_t *subclassNode,
+								 const ssPathNode_t *superclassNode,
+								 WhiteBoardNodeQSCommonWQLbooleanCB cb,
+								 gpointer data)
+{
+  SubscriptionData *sd = NULL;
+  ssBufDesc_t *bd = NULL;
+  ssStatus_t status;
+  gint msgnum;
+  gint64 started;
+
+  whiteboard_log_debug_fb();
+  g_return_val_if_fail(self!=NULL, ss_InvalidParameter);
+  g_return_val_if_fail(subclassNode != NULL && subclassNode->string!=NULL && 
+		       (subclassNode->nodeType==ssElement_TYPE_URI || subclassNode->nodeType==ssElement_TYPE_LIT), ss_InvalidParameter);
+  g_return_val_if_fail(superclassNode != NULL && superclassNode->string!=NULL && 
+		       (superclassNode->nodeType==ssElement_TYPE_URI || superclassNode->nodeType==ssElement_TYPE_LIT), ss_InvalidParameter);
+  g_return_val_if_fail( cb != NULL, ss_InvalidParameter);
+
+  bd = whiteboard_node_bufdesc_get(self, 0);
+  if (!bd)
+    return ss_NotEnoughResources;
+
+  msgnum = whiteboard_node_next_msgnumber(self);
+  started = whiteboard_node_stats_now();
+  whiteboard_trace(WHITEBOARD_TRACE_XML_BUILD_START, msgnum, -1, 0);
+  status = addXML_query_w_wql_n_n (bd, QueryTypeWQLIsSubType, subclassNode, superclassNode);
+  if (!status)
+    {
+      whiteboard_trace(WHITEBOARD_TRACE_XML_BUILD_END, msgnum, -1, ssBufDesc_GetMessageLen(bd));
+      whiteboard_node_stats_add(self, &self->stats->xml_build, started, ss_StatusOK);
+      sd = g_new0(SubscriptionData, 1);
+      sd->cb.q_wql_boolean = cb;
+      sd->user_data = data;
+      status = whiteboard_node_query_async(self, QueryTypeWQLIsSubType, msgnum, bd, sd);
+    }
+
+  whiteboard_node_bufdesc_put(self, &bd);
+  whiteboard_log_debug_fe();
+  return status;
+}
+
+/*****************************************************************************
+ * Batched insert
+ *****************************************************************************/
+
+static void whiteboard_node_insert_batch_unref(gpointer data)
+{
+  WhiteBoardNodeInsertBatch *batch = (WhiteBoardNodeInsertBatch *)data;
+
+  if (!g_atomic_int_dec_and_test(&batch->refcount))
+    return;
+
+  if (batch->prefix_ns_map)
+    g_hash_table_unref(batch->prefix_ns_map);
+  g_mutex_free(batch->lock);
+  g_object_unref(batch->node);
+  g_free(batch);
+}
+
+static void whiteboard_node_insert_batch_stop_timer(WhiteBoardNodeInsertBatch *batch)
+{
+  if (batch->timer)
+    {
+      g_source_destroy(batch->timer);
+      g_source_unref(batch->timer);
+      batch->timer = NULL;
+    }
+}
+
+/* batch->lock must be held */
+static ssStatus_t whiteboard_node_insert_batch_send(WhiteBoardNodeInsertBatch *batch)
+{
+  ssStatus_t status;
+
+  whiteboard_node_insert_batch_stop_timer(batch);
+  if (!batch->bd)
+    return ss_StatusOK;
+
+  whiteboard_log_debug("Sending insert batch of %u triples\n", batch->count);
+  status = addXML_end(batch->bd, &SIB_TRIPLELIST);
+  if (!status)
+    status = whiteboard_node_send_triplelist_async(batch->node,
+						   WHITEBOARD_DBUS_NODE_METHOD_INSERT,
+						   whiteboard_node_next_msgnumber(batch->node),
+						   ssBufDesc_GetMessage(batch->bd),
+						   batch->cb, batch->user_data);
+  whiteboard_node_bufdesc_put(batch->node, &batch->bd);
+  batch->count = 0;
+  return status;
+}
+
+static gboolean whiteboard_node_insert_batch_timeout(gpointer data)
+{
+  WhiteBoardNodeInsertBatch *batch = (WhiteBoardNodeInsertBatch *)data;
+  ssStatus_t status;
+
+  g_mutex_lock(batch->lock);
+  status = whiteboard_node_insert_batch_send(batch);
+  g_mutex_unlock(batch->lock);
+  if (status)
+    whiteboard_log_debug("Sending insert batch on timeout failed: %d\n", status);
+  return FALSE;
+}
+
+WhiteBoardNodeInsertBatch *whiteboard_node_insert_batch_new(WhiteBoardNode *self,
+							    const gchar *namespace,
+							    guint max_triples,
+							    gsize max_bytes,
+							    guint max_delay,
+							    WhiteBoardNodeAsyncCompleteCB cb,
+							    gpointer data)
+{
+  WhiteBoardNodeInsertBatch *batch = NULL;
+  GHashTable *prefix_ns_map = NULL;
+
+  whiteboard_log_debug_fb();
+  g_return_val_if_fail(self!=NULL, NULL);
+
+  if (namespace && whiteboard_node_get_prefix2ns_map(self, namespace, &prefix_ns_map) != ss_StatusOK)
+    {
+      whiteboard_log_debug_fe();
+      return NULL;
+    }
+
+  batch = g_new0(WhiteBoardNodeInsertBatch, 1);
+  batch->refcount = 1;
+  batch->node = WHITEBOARD_NODE(g_object_ref(self));
+  batch->prefix_ns_map = prefix_ns_map;
+  batch->max_triples = max_triples;
+  batch->max_bytes = max_bytes;
+  batch->max_delay = max_delay;
+  batch->cb = cb;
+  batch->user_data = data;
+  batch->lock = g_mutex_new();
+
+  whiteboard_log_debug_fe();
+  return batch;
+}
+
+ssStatus_t whiteboard_node_insert_batch_append(WhiteBoardNodeInsertBatch *batch,
+					       GSList *triples)
+{
+  ssStatus_t status = ss_StatusOK;
+  GSList *l;
+  guint mark;
+  guint count = 0;
+
+  whiteboard_log_debug_fb();
+  g_return_val_if_fail(batch!=NULL, ss_InvalidParameter);
+  g_return_val_if_fail(triples != NULL && triples->data!=NULL, ss_InvalidParameter);
+
+  for (l = triples; l; l = l->next, count++)
+    if (!l->data || invalidTriple((ssTriple_t *)l->data, FALSE))
+      return ss_InvalidTripleSpecification;
+
+  g_mutex_lock(batch->lock);
+  if (!batch->bd)
+    {
+      batch->bd = whiteboard_node_bufdesc_get(batch->node, 0);
+      if (!batch->bd)
+	status = ss_NotEnoughResources;
+      else
+	status = addXML_start(batch->bd, &SIB_TRIPLELIST, NULL, NULL, 0);
+
+      if (!status && batch->max_delay > 0)
+	{
+	  batch->timer = g_timeout_source_new(batch->max_delay);
+	  g_atomic_int_inc(&batch->refcount);
+	  g_source_set_callback(batch->timer, whiteboard_node_insert_batch_timeout,
+				batch, whiteboard_node_insert_batch_unref);
+	  g_source_attach(batch->timer, whiteboard_node_get_main_context(batch->node));
+	}
+    }
+
+  if (!status)
+    {
+      mark = batch->bd->datLen;
+      for (l = triples; status==ss_StatusOK && l; l = l->next)
+	status = addXML_templateTriple(l->data, batch->prefix_ns_map, (gpointer)batch->bd);
+
+      if (status)
+	{
+	  // drop the partially generated triples
+	  batch->bd->datLen = mark;
+	  batch->bd->buf[mark] = 0;
+	}
+      else
+	{
+	  batch->count += count;
+	  if ((batch->max_triples > 0 && batch->count >= batch->max_triples) ||
+	      (batch->max_bytes > 0 && ssBufDesc_GetMessageLen(batch->bd) >= batch->max_bytes))
+	    status = whiteboard_node_insert_batch_send(batch);
+	}
+    }
+  else if (batch->bd)
+    {
+      whiteboard_node_bufdesc_put(batch->node, &batch->bd);
+    }
+  g_mutex_unlock(batch->lock);
+
+  whiteboard_log_debug_fe();
+  return status;
+}
+
+ssStatus_t whiteboard_node_insert_batch_flush(WhiteBoardNodeInsertBatch *batch)
+{
+  ssStatus_t status;
+
+  whiteboard_log_debug_fb();
+  g_return_val_if_fail(batch!=NULL, ss_InvalidParameter);
+
+  g_mutex_lock(batch->lock);
+  status = whiteboard_node_insert_batch_send(batch);
+  g_mutex_unlock(batch->lock);
+
+  whiteboard_log_debug_fe();
+  return status;
+}
+
+ssStatus_t whiteboard_node_insert_batch_free(WhiteBoardNodeInsertBatch *batch)
+{
+  ssStatus_t status;
+
+  whiteboard_log_debug_fb();
+  g_return_val_if_fail(batch!=NULL, ss_InvalidParameter);
+
+  status = whiteboard_node_insert_batch_flush(batch);
+  whiteboard_node_insert_batch_unref(batch);
+
+  whiteboard_log_debug_fe();
+  return status;
+}
+
+/*****************************************************************************
+ * Custom commands
+ *****************************************************************************/
+
+guint whiteboard_node_send_custom_command(WhiteBoardNode* self, WhiteBoardCmd* cmd)
+{
+  guint serial = 0;
+
+  whiteboard_log_debug_fb();
+
+  g_return_val_if_fail(self != NULL, 0);
+  g_return_val_if_fail(cmd != NULL, 0);
+
+  serial = whiteboard_cmd_send(cmd, self->connection);
+
+  whiteboard_log_debug_fe();
+
+  return serial;
+}
+
+/* Returns a reference, to be released with
+   whiteboard_node_subscription_data_unref() */
+static SubscriptionData *whiteboard_node_get_subscription_data(WhiteBoardNode *self, gint access_id)
+{
+  SubscriptionData* sd = NULL;
+  
+  whiteboard_log_debug_fb();
+  g_return_val_if_fail(self != NULL, NULL);
+  
+  g_mutex_lock(self->subscription_lock);
+  sd = (SubscriptionData*) g_hash_table_lookup(self->subscription_map,
+					       GINT_TO_POINTER(access_id));
+  if (sd)
+    g_atomic_int_inc(&sd->refcount);
+  g_mutex_unlock(self->subscription_lock);
+  
+  whiteboard_log_debug_fe();
+  
+  return sd;
+}
+
+/* The map takes the initial reference of sd */
+static gboolean whiteboard_node_add_subscription_data(WhiteBoardNode *self, gint access_id, SubscriptionData *sd)
+{
+  gboolean ret = FALSE;
+  whiteboard_log_debug_fb();
+  // check that not existing previously
+  g_mutex_lock(self->subscription_lock);
+  if( g_hash_table_lookup(self->subscription_map, GINT_TO_POINTER(access_id)) == NULL)
+    {
+      sd->refcount = 1;
+      g_hash_table_insert(self->subscription_map, GINT_TO_POINTER(access_id), (gpointer)sd);
+      ret = TRUE;
+    }
+  g_mutex_unlock(self->subscription_lock);
+  whiteboard_log_debug_fe();
+  return ret;
+}
+
+static gboolean whiteboard_node_remove_subscription_data(WhiteBoardNode *self, gint access_id)
+{
+  gboolean ret = FALSE;
+  SubscriptionData *sd = NULL;
+  whiteboard_log_debug_fb();
+  // check that not existing previously
+  g_mutex_lock(self->subscription_lock);
+  sd = (SubscriptionData*) g_hash_table_lookup(self->subscription_map, GINT_TO_POINTER(access_id));
+  if (sd)
+    ret = g_hash_table_remove(self->subscription_map, GINT_TO_POINTER(access_id));
+  g_mutex_unlock(self->subscription_lock);
+
+  if (sd)
+    {
+      // freed here, unless a handler still uses it
+      whiteboard_node_subscription_data_unref(sd);
+    }
+  else
+    {
+      whiteboard_log_debug("Can not remove subscription data, subscription id:%d not found\n", access_id);
+    }
+  whiteboard_log_debug_fe();
+  return ret;
+}
+
+static void whiteboard_node_subscription_data_unref(SubscriptionData *sd)
+{
+  if (!g_atomic_int_dec_and_test(&sd->refcount))
+    return;
+
+  if(sd->subscription_id)
+    g_free(sd->subscription_id);
+
+  if (sd->ns_map)
+    whiteboard_node_ns_map_unref(sd->ns_map);
+
+  g_free(sd);
 }
@@ -102,6 +102,42 @@ static DBusHandlerResult whiteboard_sib_access_subscribe_query(DBusConnection *c
 							       DBusMessage *msg,
 							       gpointer data,
 							       gint method);
+
+static DBusHandlerResult whiteboard_sib_access_leave(DBusConnection *conn,
+						     DBusMessage *msg,
+						     gpointer data);
+
+static DBusHandlerResult whiteboard_sib_access_query(DBusConnection *conn,
+						     DBusMessage *msg,
+						     gpointer data);
+
+static DBusHandlerResult whiteboard_sib_access_subscribe(DBusConnection *conn,
+							 DBusMessage *msg,
+							 gpointer data);
+
+static DBusHandlerResult whiteboard_sib_access_refresh(DBusConnection *conn,
+						       DBusMessage *msg,
+						       gpointer data);
+
+static DBusHandlerResult whiteboard_sib_access_shutdown(DBusConnection *conn,
+							DBusMessage *msg,
+							gpointer data);
+
+static DBusHandlerResult whiteboard_sib_access_restarting(DBusConnection *conn,
+							   DBusMessage *msg,
+							   gpointer data);
+
+static DBusHandlerResult whiteboard_sib_access_healthcheck(DBusConnection *conn,
+							   DBusMessage *msg,
+							   gpointer data);
+
+static DBusHandlerResult whiteboard_sib_access_custom_command_request(DBusConnection *conn,
+								      DBusMessage *msg,
+								      gpointer data);
+
+static DBusHandlerResult whiteboard_sib_access_custom_command_response(DBusConnection *conn,
+								       DBusMessage *msg,
+								       gpointer data);
 /******************************************************************************
  * WhiteBoardSIBAccessHandle definitions
  ******************************************************************************/
@@ -185,6 +221,9 @@ enum
 
 static guint whiteboard_sib_access_signals[NUM_SIGNALS];
 
+/* Message routing, built in class_init */
+static WhiteBoardUtilDispatchTable *whiteboard_sib_access_dispatch_table = NULL;
+
 static void whiteboard_sib_access_class_init(WhiteBoardSIBAccessClass *self)
 {
   GObjectClass* object = G_OBJECT_CLASS(self);
@@ -193,6 +232,42 @@ static void whiteboard_sib_access_class_init(WhiteBoardSIBAccessClass *self)
 
   object->finalize = whiteboard_sib_access_finalize;
 
+  {
+    static const WhiteBoardUtilDispatchEntry entries[] = {
+      { DBUS_MESSAGE_TYPE_SIGNAL, WHITEBOARD_DBUS_SIB_ACCESS_INTERFACE,
+	WHITEBOARD_DBUS_SIB_ACCESS_SIGNAL_JOIN, whiteboard_sib_access_join },
+      { DBUS_MESSAGE_TYPE_SIGNAL, WHITEBOARD_DBUS_SIB_ACCESS_INTERFACE,
+	WHITEBOARD_DBUS_SIB_ACCESS_SIGNAL_LEAVE, whiteboard_sib_access_leave },
+      { DBUS_MESSAGE_TYPE_SIGNAL, WHITEBOARD_DBUS_SIB_ACCESS_INTERFACE,
+	WHITEBOARD_DBUS_SIB_ACCESS_SIGNAL_UNSUBSCRIBE, whiteboard_sib_access_unsubscribe },
+      { DBUS_MESSAGE_TYPE_METHOD_CALL, WHITEBOARD_DBUS_SIB_ACCESS_INTERFACE,
+	WHITEBOARD_DBUS_SIB_ACCESS_METHOD_INSERT, whiteboard_sib_access_insert },
+      { DBUS_MESSAGE_TYPE_METHOD_CALL, WHITEBOARD_DBUS_SIB_ACCESS_INTERFACE,
+	WHITEBOARD_DBUS_SIB_ACCESS_METHOD_UPDATE, whiteboard_sib_access_update },
+      { DBUS_MESSAGE_TYPE_METHOD_CALL, WHITEBOARD_DBUS_SIB_ACCESS_INTERFACE,
+	WHITEBOARD_DBUS_SIB_ACCESS_METHOD_QUERY, whiteboard_sib_access_query },
+      { DBUS_MESSAGE_TYPE_METHOD_CALL, WHITEBOARD_DBUS_SIB_ACCESS_INTERFACE,
+	WHITEBOARD_DBUS_SIB_ACCESS_METHOD_SUBSCRIBE, whiteboard_sib_access_subscribe },
+      { DBUS_MESSAGE_TYPE_METHOD_CALL, WHITEBOARD_DBUS_SIB_ACCESS_INTERFACE,
+	WHITEBOARD_DBUS_SIB_ACCESS_METHOD_REMOVE, whiteboard_sib_access_remove },
+      { DBUS_MESSAGE_TYPE_SIGNAL, WHITEBOARD_DBUS_CONTROL_INTERFACE,
+	WHITEBOARD_DBUS_CONTROL_SIGNAL_STARTING, whiteboard_sib_access_restarting },
+      { DBUS_MESSAGE_TYPE_METHOD_RETURN, WHITEBOARD_DBUS_CONTROL_INTERFACE,
+	WHITEBOARD_DBUS_METHOD_CUSTOM_COMMAND, whiteboard_sib_access_custom_command_response },
+      { DBUS_MESSAGE_TYPE_METHOD_CALL, WHITEBOARD_DBUS_CONTROL_INTERFACE,
+	WHITEBOARD_DBUS_CONTROL_METHOD_REFRESH, whiteboard_sib_access_refresh },
+      { DBUS_MESSAGE_TYPE_METHOD_CALL, WHITEBOARD_DBUS_CONTROL_INTERFACE,
+	WHITEBOARD_DBUS_CONTROL_METHOD_SHUTDOWN, whiteboard_sib_access_shutdown },
+      { DBUS_MESSAGE_TYPE_METHOD_CALL, WHITEBOARD_DBUS_CONTROL_INTERFACE,
+	WHITEBOARD_DBUS_CONTROL_METHOD_HEALTHCHECK, whiteboard_sib_access_healthcheck },
+      { DBUS_MESSAGE_TYPE_METHOD_CALL, WHITEBOARD_DBUS_CONTROL_INTERFACE,
+	WHITEBOARD_DBUS_CONTROL_METHOD_CUSTOM_COMMAND, whiteboard_sib_access_custom_command_request },
+      { 0, NULL, NULL, NULL }
+    };
+
+    whiteboard_sib_access_dispatch_table = whiteboard_util_dispatch_table_new(entries);
+  }
+
   /*********************************************************************/
 
   whiteboard_sib_access_signals[SIGNAL_REFRESH] =
@@ -1344,193 +1419,32 @@ static DBusHandlerResult whiteboard_sib_access_custom_command_response(
   return DBUS_HANDLER_RESULT_HANDLED;
 }
 
-static DBusHandlerResult whiteboard_sib_access_handler(DBusConnection* conn,
-						       DBusMessage* message,
-						       gpointer data)
+static DBusHandlerResult whiteboard_sib_access_query(DBusConnection *conn,
+						     DBusMessage *msg,
+						     gpointer data)
 {
-  DBusHandlerResult retval = DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
-  const gchar* member = NULL;
-  gint type = 0;
-
-  whiteboard_log_debug_fb();
-
-  member = dbus_message_get_member(message);
-  type = dbus_message_get_type(message);
-
-  g_return_val_if_fail(member != NULL,
-		       DBUS_HANDLER_RESULT_NOT_YET_HANDLED);
-
-  switch (type)
-    {
-    case DBUS_MESSAGE_TYPE_SIGNAL:
-      if(!strcmp(member, WHITEBOARD_DBUS_SIB_ACCESS_SIGNAL_JOIN)) 
-	{
-	  whiteboard_log_debug("Got JOIN signal\n");
-	  retval = whiteboard_sib_access_join(conn,message,data);
-	}
-      else if(!strcmp(member, WHITEBOARD_DBUS_SIB_ACCESS_SIGNAL_LEAVE)) 
-	{
-	  whiteboard_log_debug("Got LEAVE signal\n");
-	  retval = whiteboard_sib_access_leave(conn,message,data);
-	}
-      else if(!strcmp(member, WHITEBOARD_DBUS_SIB_ACCESS_SIGNAL_UNSUBSCRIBE)) 
-	{
-	  whiteboard_log_debug("Got UNSUBSCRIBE signal\n");
-	  retval = whiteboard_sib_access_unsubscribe(conn,message,data);
-	}
-      break;
-
-    case DBUS_MESSAGE_TYPE_METHOD_RETURN:
-
-      whiteboard_log_warning("Unknown method return: %s\n", member);
-		
-      retval = DBUS_HANDLER_RESULT_HANDLED;
-		
-      break;
-
-    case DBUS_MESSAGE_TYPE_METHOD_CALL:
-
-      if(!strcmp(member, WHITEBOARD_DBUS_SIB_ACCESS_METHOD_INSERT)) 
-	{
-	  whiteboard_log_debug("Got INSERT method\n");
-	  retval = whiteboard_sib_access_insert(conn,message,data);
-	}
-      else if(!strcmp(member, WHITEBOARD_DBUS_SIB_ACCESS_METHOD_UPDATE)) 
-	{
-	  whiteboard_log_debug("Got UPDATE method\n");
-	  retval = whiteboard_sib_access_update(conn,message,data);
-	}
-      else if(!strcmp(member, WHITEBOARD_DBUS_SIB_ACCESS_METHOD_QUERY)) 
-	{
-	  whiteboard_log_debug("Got QUERY method\n");
-	  retval = whiteboard_sib_access_subscribe_query(conn,message,data, SIGNAL_QUERY);
-	}
-      else if(!strcmp(member, WHITEBOARD_DBUS_SIB_ACCESS_METHOD_SUBSCRIBE))
-	{
-	  whiteboard_log_debug("Got SUBSCRIBE/QUERY method\n");
-	  retval = whiteboard_sib_access_subscribe_query(conn,message,data,SIGNAL_SUBSCRIBE);
-	}
-      else if(!strcmp(member, WHITEBOARD_DBUS_SIB_ACCESS_METHOD_REMOVE)) 
-	{
-	  whiteboard_log_debug("Got REMOVE method\n");
-	  retval = whiteboard_sib_access_remove(conn,message,data);
-	}
-      else
-	{
-	  whiteboard_log_warning("Unknown method call: %s\n",
-				 member);
-	}
-
-      break;
-    default:
-      whiteboard_log_warning("Unknown message type: %d\n", type);
-      break;
-    }
-
-  whiteboard_log_debug_fe();
-
-  return retval;
+  return whiteboard_sib_access_subscribe_query(conn, msg, data, SIGNAL_QUERY);
 }
 
-static DBusHandlerResult whiteboard_sib_access_control_handler(DBusConnection* conn,
-							       DBusMessage* message,
-							       gpointer data)
+static DBusHandlerResult whiteboard_sib_access_subscribe(DBusConnection *conn,
+							 DBusMessage *msg,
+							 gpointer data)
 {
-  DBusHandlerResult retval = DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
-  const gchar* member = NULL;
-  gint type = 0;
-
-  whiteboard_log_debug_fb();
-
-  member = dbus_message_get_member(message);
-  type = dbus_message_get_type(message);
-
-  g_return_val_if_fail(member != NULL,
-		       DBUS_HANDLER_RESULT_NOT_YET_HANDLED);
-
-  switch (type)
-    {
-    case DBUS_MESSAGE_TYPE_SIGNAL:
-
-      if (!strcmp(member, WHITEBOARD_DBUS_CONTROL_SIGNAL_STARTING))
-	{
-	  /* If we get this signal it means that Whiteboard has 
-	     been shut down (abnormally) and is restarting. To
-	     avoid duplicate processes we'll shut down and let
-	     Whiteboard restart us right away. */
-	  whiteboard_log_debugc(WHITEBOARD_DEBUG_SIB,
-				"Whiteboard restart detected, " \
-				"shutting down.\n");
-	  retval = whiteboard_sib_access_shutdown(conn,
-						  message,
-						  data);
-	}
-      else
-	{
-	  whiteboard_log_warning("Unknown signal: %s\n", member);
-	}
-		
-      break;
-
-    case DBUS_MESSAGE_TYPE_METHOD_RETURN:
-
-      if (!strcmp(member, WHITEBOARD_DBUS_METHOD_CUSTOM_COMMAND))
-	{
-	  retval = whiteboard_sib_access_custom_command_response(conn,
-								 message,
-								 data);
-	}
-      else
-	{
-	  whiteboard_log_warning("Unknown method return: %s\n",
-				 member);
-	}
-		
-      retval = DBUS_HANDLER_RESULT_HANDLED;
-		
-      break;
-
-    case DBUS_MESSAGE_TYPE_METHOD_CALL:
-
-      if (!strcmp(member, WHITEBOARD_DBUS_CONTROL_METHOD_REFRESH))
-	{
-	  retval = whiteboard_sib_access_refresh(conn,
-						 message,
-						 data);
-	}
-      else if (!strcmp(member, WHITEBOARD_DBUS_CONTROL_METHOD_SHUTDOWN))
-	{
-	  retval = whiteboard_sib_access_shutdown(conn,
-						  message,
-						  data);
-	}
-      else if (!strcmp(member, WHITEBOARD_DBUS_CONTROL_METHOD_HEALTHCHECK))
-	{
-	  retval = whiteboard_sib_access_healthcheck(conn,
-						     message,
-						     data);
-	}
-      else if (!strcmp(member, WHITEBOARD_DBUS_CONTROL_METHOD_CUSTOM_COMMAND))
-	{
-	  retval = whiteboard_sib_access_custom_command_request(conn,
-								message,
-								data);
-	}
-      else
-	{
-	  whiteboard_log_warning("Unknown method call: %s\n",
-				 member);
-	}
-
-      break;
-    default:
-      whiteboard_log_warning("Unknown message type: %d\n", type);
-      break;
-    }
-
-  whiteboard_log_debug_fe();
+  return whiteboard_sib_access_subscribe_query(conn, msg, data, SIGNAL_SUBSCRIBE);
+}
 
-  return retval;
+static DBusHandlerResult whiteboard_sib_access_restarting(DBusConnection *conn,
+							   DBusMessage *msg,
+							   gpointer data)
+{
+  /* If we get this signal it means that Whiteboard has 
+     been shut down (abnormally) and is restarting. To
+     avoid duplicate processes we'll shut down and let
+     Whiteboard restart us right away. */
+  whiteboard_log_debugc(WHITEBOARD_DEBUG_SIB,
+			"Whiteboard restart detected, " \
+			"shutting down.\n");
+  return whiteboard_sib_access_shutdown(conn, msg, data);
 }
 
 static DBusHandlerResult whiteboard_sib_access_dispatch_message(DBusConnection *conn,
@@ -1538,22 +1452,15 @@ static DBusHandlerResult whiteboard_sib_access_dispatch_message(DBusConnection *
 								gpointer data)
 {
   DBusHandlerResult retval = DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
-  const gchar* interface = NULL;
+  DBusObjectPathMessageFunction handler = NULL;
 
   whiteboard_log_debug_fb();
 
-  interface = dbus_message_get_interface(message);
-
-  g_return_val_if_fail(interface != NULL,
-		       DBUS_HANDLER_RESULT_NOT_YET_HANDLED);
-
-  if (!strcmp(interface, WHITEBOARD_DBUS_SIB_ACCESS_INTERFACE))
+  handler = whiteboard_util_dispatch_table_lookup(whiteboard_sib_access_dispatch_table,
+						  message);
+  if (handler)
     {
-      retval = whiteboard_sib_access_handler(conn, message, data);
-    }
-  else if (!strcmp(interface, WHITEBOARD_DBUS_CONTROL_INTERFACE))
-    {
-      retval = whiteboard_sib_access_control_handler(conn, message, data);
+      retval = handler(conn, message, data);
     }
   else
     {
@@ -1562,8 +1469,13 @@ static DBusHandlerResult whiteboard_sib_access_dispatch_message(DBusConnection *
 			    dbus_message_get_type(message),
 			    dbus_message_get_interface(message),
 			    dbus_message_get_member(message));
-		
-      retval = DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+
+      /* Stray method returns on our interfaces are consumed, anything
+	 else is left to other handlers */
+      if (dbus_message_get_type(message) == DBUS_MESSAGE_TYPE_METHOD_RETURN &&
+	  (dbus_message_has_interface(message, WHITEBOARD_DBUS_SIB_ACCESS_INTERFACE) ||
+	   dbus_message_has_interface(message, WHITEBOARD_DBUS_CONTROL_INTERFACE)))
+	retval = DBUS_HANDLER_RESULT_HANDLED;
     }
 	
   whiteboard_log_debug_fe();
@@ -0,0 +1,299 @@
+/*
+
+  Copyright (c) 2009, Nokia Corporation
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+  
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.  
+    * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in
+    the documentation and/or other materials provided with the
+    distribution.  
+    * Neither the name of Nokia nor the names of its contributors 
+    may be used to endorse or promote products derived from this 
+    software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+  EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+/*
+ * Whiteboard Library
+ *
+ * whiteboard_trace_decode.c
+ *
+ * Reads a trace file written with WHITEBOARD_TRACE_FILE and prints
+ * latency statistics and a histogram for each stage of the SSAP message
+ * lifecycle.
+ *
+ * Copyright 2009 Nokia Corporation
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include <glib.h>
+
+#include "whiteboard_trace.h"
+
+#define HISTOGRAM_BUCKETS 32 /* log2 of microseconds */
+#define HISTOGRAM_WIDTH 50
+
+typedef struct _Stage
+{
+  const gchar *name;
+  WhiteBoardTraceEvent start;
+  WhiteBoardTraceEvent end;
+  gboolean same_thread; // start and end are written by the same thread
+} Stage;
+
+static const Stage stages[] =
+{
+  { "xml_build",      WHITEBOARD_TRACE_XML_BUILD_START, WHITEBOARD_TRACE_XML_BUILD_END,  TRUE },
+  { "dbus_roundtrip", WHITEBOARD_TRACE_DBUS_SEND,       WHITEBOARD_TRACE_REPLY_RECEIVED, FALSE },
+  { "request",        WHITEBOARD_TRACE_XML_BUILD_START, WHITEBOARD_TRACE_REPLY_RECEIVED, FALSE },
+  { "parse",          WHITEBOARD_TRACE_PARSE_START,     WHITEBOARD_TRACE_PARSE_END,      TRUE },
+  { "dispatch",       WHITEBOARD_TRACE_DISPATCH_START,  WHITEBOARD_TRACE_DISPATCH_END,   TRUE },
+  { NULL, 0, 0, FALSE }
+};
+
+/* Identifies the start record an end record belongs to */
+typedef struct _PendingKey
+{
+  gint stage;
+  guint32 thread;
+  gint32 msgnumber;
+  gint32 access_id;
+} PendingKey;
+
+static guint pending_key_hash(gconstpointer key)
+{
+  const PendingKey *k = (const PendingKey *)key;
+
+  return (k->stage * 31 + k->thread) * 1000003 + k->msgnumber * 131 + k->access_id;
+}
+
+static gboolean pending_key_equal(gconstpointer a, gconstpointer b)
+{
+  return memcmp(a, b, sizeof(PendingKey)) == 0;
+}
+
+static gint record_compare(gconstpointer a, gconstpointer b)
+{
+  const WhiteBoardTraceRecord *ra = (const WhiteBoardTraceRecord *)a;
+  const WhiteBoardTraceRecord *rb = (const WhiteBoardTraceRecord *)b;
+
+  if (ra->timestamp != rb->timestamp)
+    return (ra->timestamp < rb->timestamp) ? -1 : 1;
+  return 0;
+}
+
+static gint sample_compare(gconstpointer a, gconstpointer b)
+{
+  guint64 sa = *(const guint64 *)a;
+  guint64 sb = *(const guint64 *)b;
+
+  return (sa < sb) ? -1 : (sa > sb);
+}
+
+static GArray *read_records(const gchar *filename)
+{
+  WhiteBoardTraceHeader header;
+  WhiteBoardTraceRecord rec;
+  GArray *records;
+  gchar *buf;
+  FILE *f;
+
+  f = fopen(filename, "rb");
+  if (f == NULL)
+    {
+      fprintf(stderr, "%s: %s\n", filename, g_strerror(errno));
+      return NULL;
+    }
+
+  if (fread(&header, sizeof(header), 1, f) != 1 ||
+      strncmp(header.magic, WHITEBOARD_TRACE_MAGIC, sizeof(header.magic)) != 0)
+    {
+      fprintf(stderr, "%s: not a whiteboard trace file\n", filename);
+      fclose(f);
+      return NULL;
+    }
+  if (header.version != WHITEBOARD_TRACE_VERSION ||
+      header.record_size < sizeof(WhiteBoardTraceRecord))
+    {
+      fprintf(stderr, "%s: unsupported trace version %u (record size %u)\n",
+	      filename, header.version, header.record_size);
+      fclose(f);
+      return NULL;
+    }
+
+  records = g_array_new(FALSE, FALSE, sizeof(WhiteBoardTraceRecord));
+  buf = g_malloc(header.record_size);
+  while (fread(buf, header.record_size, 1, f) == 1)
+    {
+      memcpy(&rec, buf, sizeof(rec));
+      g_array_append_val(records, rec);
+    }
+  g_free(buf);
+  fclose(f);
+
+  /* threads write their records in batches */
+  g_array_sort(records, record_compare);
+  return records;
+}
+
+static void print_histogram(GArray *samples)
+{
+  guint buckets[HISTOGRAM_BUCKETS];
+  guint max = 0;
+  guint64 us;
+  guint i;
+  guint b;
+
+  memset(buckets, 0, sizeof(buckets));
+  for (i = 0; i < samples->len; i++)
+    {
+      us = g_array_index(samples, guint64, i) / 1000;
+      for (b = 0; us > 0 && b < HISTOGRAM_BUCKETS - 1; b++)
+	us >>= 1;
+      buckets[b]++;
+    }
+  for (b = 0; b < HISTOGRAM_BUCKETS; b++)
+    if (buckets[b] > max)
+      max = buckets[b];
+
+  for (b = 0; b < HISTOGRAM_BUCKETS; b++)
+    {
+      guint width;
+
+      if (buckets[b] == 0)
+	continue;
+      width = (guint)((guint64)buckets[b] * HISTOGRAM_WIDTH / max);
+      printf("  < %10" G_GUINT64_FORMAT " us %10u ",
+	     (guint64)1 << b, buckets[b]);
+      while (width-- > 0)
+	putchar('#');
+      putchar('\n');
+    }
+}
+
+static void print_stage(const Stage *stage, GArray *samples)
+{
+  guint64 sum = 0;
+  guint n = samples->len;
+  guint i;
+
+  if (n == 0)
+    return;
+
+  g_array_sort(samples, sample_compare);
+  for (i = 0; i < n; i++)
+    sum += g_array_index(samples, guint64, i);
+
+#define PCT(p) (g_array_index(samples, guint64, (n - 1) * (p) / 100) / 1000.0)
+  printf("%-15s %8u %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f\n",
+	 stage->name, n,
+	 g_array_index(samples, guint64, 0) / 1000.0,
+	 PCT(50), PCT(90), PCT(99),
+	 g_array_index(samples, guint64, n - 1) / 1000.0,
+	 sum / 1000.0 / n);
+#undef PCT
+}
+
+int main(int argc, char *argv[])
+{
+  GArray *records;
+  GArray *samples[G_N_ELEMENTS(stages)];
+  GHashTable *pending;
+  WhiteBoardTraceRecord *rec;
+  PendingKey key;
+  PendingKey *k;
+  guint64 *start;
+  guint i;
+  gint s;
+
+  if (argc != 2)
+    {
+      fprintf(stderr, "Usage: %s TRACEFILE\n", argv[0]);
+      return 1;
+    }
+
+  records = read_records(argv[1]);
+  if (records == NULL)
+    return 1;
+
+  pending = g_hash_table_new_full(pending_key_hash, pending_key_equal, g_free, g_free);
+  for (s = 0; stages[s].name; s++)
+    samples[s] = g_array_new(FALSE, FALSE, sizeof(guint64));
+
+  for (i = 0; i < records->len; i++)
+    {
+      rec = &g_array_index(records, WhiteBoardTraceRecord, i);
+      for (s = 0; stages[s].name; s++)
+	{
+	  memset(&key, 0, sizeof(key));
+	  key.stage = s;
+	  key.thread = stages[s].same_thread ? rec->thread : 0;
+	  key.msgnumber = rec->msgnumber;
+	  key.access_id = stages[s].same_thread ? rec->access_id : -1;
+
+	  if (rec->event == stages[s].start)
+	    {
+	      k = g_memdup(&key, sizeof(key));
+	      start = g_new(guint64, 1);
+	      *start = rec->timestamp;
+	      g_hash_table_replace(pending, k, start);
+	    }
+	  else if (rec->event == stages[s].end)
+	    {
+	      start = (guint64 *)g_hash_table_lookup(pending, &key);
+	      if (start)
+		{
+		  guint64 delta = rec->timestamp - *start;
+
+		  g_array_append_val(samples[s], delta);
+		  g_hash_table_remove(pending, &key);
+		}
+	    }
+	}
+    }
+
+  printf("%u records\n\n", records->len);
+  printf("%-15s %8s %10s %10s %10s %10s %10s %10s\n",
+	 "stage (us)", "count", "min", "p50", "p90", "p99", "max", "mean");
+  for (s = 0; stages[s].name; s++)
+    print_stage(&stages[s], samples[s]);
+
+  for (s = 0; stages[s].name; s++)
+    {
+      if (samples[s]->len == 0)
+	continue;
+      printf("\n%s\n", stages[s].name);
+      print_histogram(samples[s]);
+    }
+
+  for (s = 0; stages[s].name; s++)
+    g_array_free(samples[s], TRUE);
+  g_hash_table_destroy(pending);
+  g_array_free(records, TRUE);
+  return 0;
+}